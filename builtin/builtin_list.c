@@ -30,6 +30,10 @@
 #include <sys/param.h>
 
 #include <sys/stat.h>
+#include <string.h>
+#include <errno.h>
+
+#include "builtin/builtin.h"
 
 #include "builtin_proto.h"
 
@@ -68,3 +72,54 @@ const int g_builtin_count = nitems(g_builtins);
 /****************************************************************************
  * Public Functions
  ****************************************************************************/
+
+/****************************************************************************
+ * Name: builtin_find
+ *
+ * Description:
+ *   Find a builtin application by name.  This is equivalent to
+ *   builtin_isavail() but uses a binary search of the sorted builtin list
+ *   so that the cost of the lookup does not grow with the number of
+ *   applications.  The build sorts builtin_list.h by name and fails if it
+ *   is not in strcmp() order.
+ *
+ * Input Parameter:
+ *   appname - The name of the application
+ *
+ * Returned Value:
+ *   The index of the application that can be passed to
+ *   builtin_for_index() on success; -ENOENT if there is no application
+ *   with that name.
+ *
+ ****************************************************************************/
+
+int builtin_find(FAR const char *appname)
+{
+  int count = g_builtin_count - 1;  /* Skip the NULL terminator */
+  int lower;
+  int upper;
+
+  lower = 0;
+  upper = count;
+
+  while (lower < upper)
+    {
+      int mid = (lower + upper) >> 1;
+      int cmp = strcmp(g_builtins[mid].name, appname);
+
+      if (cmp == 0)
+        {
+          return mid;
+        }
+      else if (cmp < 0)
+        {
+          lower = mid + 1;
+        }
+      else
+        {
+          upper = mid;
+        }
+    }
+
+  return -ENOENT;
+}
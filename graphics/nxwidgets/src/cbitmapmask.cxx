@@ -0,0 +1,264 @@
+/****************************************************************************
+ * apps/graphics/nxwidgets/src/cbitmapmask.cxx
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.  The
+ * ASF licenses this file to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance with the
+ * License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <semaphore.h>
+#include <debug.h>
+
+#include "graphics/nxwidgets/nxconfig.hxx"
+#include "graphics/nxwidgets/cbitmap.hxx"
+#include "graphics/nxwidgets/cbitmapmask.hxx"
+
+#ifdef CONFIG_NXWIDGETS_BITMAPMASK
+
+/****************************************************************************
+ * Method Implementations
+ ****************************************************************************/
+
+using namespace NXWidgets;
+
+/**
+ * Constructor.
+ */
+
+CBitmapMaskCache::CBitmapMaskCache(void)
+{
+  for (int i = 0; i < CONFIG_NXWIDGETS_BITMAPMASK_NENTRIES; i++)
+    {
+      m_masks[i].data  = (FAR const void *)NULL;
+      m_masks[i].bits  = (FAR uint32_t *)NULL;
+      m_masks[i].nbits = 0;
+      m_masks[i].age   = 0;
+    }
+
+  m_clock  = 0;
+  m_hits   = 0;
+  m_misses = 0;
+
+  sem_init(&m_exclsem, 0, 1);
+}
+
+/**
+ * Destructor.
+ */
+
+CBitmapMaskCache::~CBitmapMaskCache(void)
+{
+  sem_destroy(&m_exclsem);
+
+  for (int i = 0; i < CONFIG_NXWIDGETS_BITMAPMASK_NENTRIES; i++)
+    {
+      if (m_masks[i].bits)
+        {
+          delete[] m_masks[i].bits;
+        }
+    }
+}
+
+/**
+ * Get the transparency mask of a bitmap.  If the mask is not in the
+ * cache, it is built in place of the least recently used mask.  The
+ * cache must be locked.
+ *
+ * @param bitmap The bitmap.
+ * @param transparentColor The transparent color of the bitmap.
+ * @return The mask or NULL if memory could not be allocated.
+ */
+
+FAR const struct SBitmapMask *
+CBitmapMaskCache::getMask(FAR const struct SBitmap *bitmap,
+                          nxgl_mxpixel_t transparentColor)
+{
+  FAR struct SBitmapMask *oldest = &m_masks[0];
+
+  m_clock++;
+
+  for (int i = 0; i < CONFIG_NXWIDGETS_BITMAPMASK_NENTRIES; i++)
+    {
+      FAR struct SBitmapMask *mask = &m_masks[i];
+
+      if (mask->data == bitmap->data && mask->data != NULL &&
+          mask->transparent == transparentColor &&
+          mask->width == bitmap->width && mask->height == bitmap->height &&
+          mask->stride == bitmap->stride)
+        {
+          m_hits++;
+          mask->age = m_clock;
+          return mask;
+        }
+
+      // Unused entries have an age of zero and are taken first
+
+      if (mask->age < oldest->age)
+        {
+          oldest = mask;
+        }
+    }
+
+  // Not cached.  Replace the least recently used mask.
+
+  m_misses++;
+
+  if (!buildMask(oldest, bitmap, transparentColor))
+    {
+      return (FAR const struct SBitmapMask *)NULL;
+    }
+
+  oldest->age = m_clock;
+  return oldest;
+}
+
+/**
+ * Discard the masks of bitmaps that use the given pixel data.  This
+ * must be called when the pixel data of a drawn bitmap is modified or
+ * freed.  The cache must not be locked.
+ *
+ * @param data The pixel data of the bitmap.
+ */
+
+void CBitmapMaskCache::invalidate(FAR const void *data)
+{
+  lock();
+
+  for (int i = 0; i < CONFIG_NXWIDGETS_BITMAPMASK_NENTRIES; i++)
+    {
+      if (m_masks[i].data == data)
+        {
+          m_masks[i].data = (FAR const void *)NULL;
+          m_masks[i].age  = 0;
+        }
+    }
+
+  unlock();
+}
+
+/**
+ * Discard all cached masks.  The cache must not be locked.
+ */
+
+void CBitmapMaskCache::flush(void)
+{
+  lock();
+
+  for (int i = 0; i < CONFIG_NXWIDGETS_BITMAPMASK_NENTRIES; i++)
+    {
+      m_masks[i].data = (FAR const void *)NULL;
+      m_masks[i].age  = 0;
+    }
+
+  unlock();
+}
+
+/**
+ * Build the mask of a bitmap into a mask entry.
+ *
+ * @param mask The entry to build into.
+ * @param bitmap The bitmap.
+ * @param transparentColor The transparent color of the bitmap.
+ * @return True if the mask was built; false if memory could not be
+ *   allocated.
+ */
+
+bool CBitmapMaskCache::buildMask(FAR struct SBitmapMask *mask,
+                                 FAR const struct SBitmap *bitmap,
+                                 nxgl_mxpixel_t transparentColor)
+{
+  unsigned int rowWords = ((unsigned int)bitmap->width + 31) >> 5;
+  unsigned int nbits    = rowWords * (unsigned int)bitmap->height;
+
+  // Re-use the memory of the old mask if it is large enough
+
+  mask->data = (FAR const void *)NULL;
+
+  if (nbits > mask->nbits)
+    {
+      if (mask->bits)
+        {
+          delete[] mask->bits;
+        }
+
+      mask->bits  = new uint32_t[nbits];
+      mask->nbits = mask->bits ? nbits : 0;
+
+      if (!mask->bits)
+        {
+          gerr("ERROR: Failed to allocate bitmap mask\n");
+          mask->age = 0;
+          return false;
+        }
+    }
+
+  mask->transparent = transparentColor;
+  mask->width       = bitmap->width;
+  mask->height      = bitmap->height;
+  mask->stride      = bitmap->stride;
+  mask->rowWords    = (uint16_t)rowWords;
+
+  // Build the mask one word (32 pixels) at a time
+
+  FAR const uint8_t *srcLine = (FAR const uint8_t *)bitmap->data;
+  FAR uint32_t *maskPtr      = mask->bits;
+  unsigned int nopaque       = 0;
+
+  for (nxgl_coord_t row = 0; row < bitmap->height; row++)
+    {
+      FAR const nxwidget_pixel_t *srcPtr =
+        (FAR const nxwidget_pixel_t *)srcLine;
+
+      for (nxgl_coord_t col = 0; col < bitmap->width; col += 32)
+        {
+          int npixels = bitmap->width - col;
+          if (npixels > 32)
+            {
+              npixels = 32;
+            }
+
+          uint32_t word = 0;
+          for (int bit = 0; bit < npixels; bit++)
+            {
+              if (*srcPtr++ != transparentColor)
+                {
+                  word |= (uint32_t)1 << bit;
+                  nopaque++;
+                }
+            }
+
+          *maskPtr++ = word;
+        }
+
+      srcLine += bitmap->stride;
+    }
+
+  mask->opaque = (nopaque == (unsigned int)bitmap->width * bitmap->height);
+  mask->empty  = (nopaque == 0);
+  mask->data   = bitmap->data;
+  return true;
+}
+
+#endif // CONFIG_NXWIDGETS_BITMAPMASK
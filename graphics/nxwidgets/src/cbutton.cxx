@@ -258,7 +258,7 @@ void CButton::drawBorder(CGraphicsPort *port, bool useClicked)
 
 void CButton::onClick(nxgl_coord_t x, nxgl_coord_t y)
 {
-  redraw();
+  markChanged();
 }
 
 /**
@@ -282,7 +282,7 @@ void CButton::onPreRelease(nxgl_coord_t x, nxgl_coord_t y)
 
 void CButton::onRelease(nxgl_coord_t x, nxgl_coord_t y)
 {
-  redraw();
+  markChanged();
 }
 
 /**
@@ -294,5 +294,5 @@ void CButton::onRelease(nxgl_coord_t x, nxgl_coord_t y)
 
 void CButton::onReleaseOutside(nxgl_coord_t x, nxgl_coord_t y)
 {
-  redraw();
+  markChanged();
 }
@@ -125,6 +125,21 @@ CGlyphButton::CGlyphButton(CWidgetControl *pWidgetControl,
   m_bitmapClicked         = clickedGlyph;
 }
 
+/**
+ * Destructor.
+ */
+
+CGlyphButton::~CGlyphButton(void)
+{
+#ifdef CONFIG_NXWIDGETS_BITMAPMASK
+  if (g_bitmapMasks)
+    {
+      g_bitmapMasks->invalidate(m_bitmapNormal->data);
+      g_bitmapMasks->invalidate(m_bitmapClicked->data);
+    }
+#endif
+}
+
 /**
  * Insert the dimensions that this widget wants to have into the rect
  * passed in as a parameter.  All coordinates are relative to the widget's
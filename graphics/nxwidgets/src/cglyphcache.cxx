@@ -0,0 +1,294 @@
+/****************************************************************************
+ * apps/graphics/nxwidgets/src/cglyphcache.cxx
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.  The
+ * ASF licenses this file to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance with the
+ * License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <semaphore.h>
+#include <debug.h>
+
+#include "graphics/nxwidgets/nxconfig.hxx"
+#include "graphics/nxwidgets/cnxfont.hxx"
+#include "graphics/nxwidgets/cbitmap.hxx"
+#include "graphics/nxwidgets/cglyphcache.hxx"
+
+#ifdef CONFIG_NXWIDGETS_GLYPHCACHE
+
+/****************************************************************************
+ * Method Implementations
+ ****************************************************************************/
+
+using namespace NXWidgets;
+
+/**
+ * Constructor.  Allocates the glyph pool.
+ */
+
+CGlyphCache::CGlyphCache(void)
+{
+  m_pool = new uint8_t[GLYPHCACHE_NSLOTS * CONFIG_NXWIDGETS_GLYPHCACHE_SLOTSIZE];
+  if (!m_pool)
+    {
+      gerr("ERROR: Failed to allocate the glyph pool\n");
+    }
+
+  sem_init(&m_exclsem, 0, 1);
+  resetStatistics();
+  flush();
+}
+
+/**
+ * Destructor.
+ */
+
+CGlyphCache::~CGlyphCache(void)
+{
+  sem_destroy(&m_exclsem);
+
+  if (m_pool)
+    {
+      delete[] m_pool;
+    }
+}
+
+/**
+ * Get an opaque, rendered glyph.  If the glyph is not in the cache, it
+ * is rendered into a free (or the least recently used) slot.  The cache
+ * must be locked.
+ *
+ * @param font The font to render with.  The current font color is used
+ *   as the foreground color.
+ * @param letter The character to render.
+ * @param width The width of the glyph in pixels (including xoffset).
+ * @param height The height of the glyph in rows.
+ * @param background The background color of the glyph.
+ * @param bitmap Location to return the glyph bitmap.
+ * @return True if the bitmap was returned; false if the glyph is too
+ *   large to fit in a cache slot.
+ */
+
+bool CGlyphCache::getGlyph(FAR CNxFont *font, nxwidget_char_t letter,
+                           nxgl_coord_t width, nxgl_coord_t height,
+                           nxgl_mxpixel_t background,
+                           FAR struct SBitmap *bitmap)
+{
+  // The background fill below works in whole nxwidget_pixel_t units so
+  // make sure that the slot can hold that many bytes too.
+
+  unsigned int stride  = ((unsigned int)width * CONFIG_NXWIDGETS_BPP + 7) >> 3;
+  unsigned int npixels = (unsigned int)width * (unsigned int)height;
+  unsigned int nbytes  = stride * (unsigned int)height;
+
+  if (npixels * sizeof(nxwidget_pixel_t) > nbytes)
+    {
+      nbytes = npixels * sizeof(nxwidget_pixel_t);
+    }
+
+  if (!m_pool || nbytes > CONFIG_NXWIDGETS_GLYPHCACHE_SLOTSIZE)
+    {
+      return false;
+    }
+
+  bitmap->bpp    = CONFIG_NXWIDGETS_BPP;
+  bitmap->fmt    = CONFIG_NXWIDGETS_FMT;
+  bitmap->width  = width;
+  bitmap->height = height;
+  bitmap->stride = stride;
+
+  // Search the hash bucket for the glyph
+
+  enum nx_fontid_e fontId = font->getFontId();
+  nxgl_mxpixel_t   color  = font->getColor();
+  unsigned int     bucket = hash(fontId, letter, color, background);
+
+  for (uint16_t index = m_hash[bucket]; index != GLYPHCACHE_NONE;
+       index = m_slots[index].hnext)
+    {
+      FAR struct SGlyphSlot *slot = &m_slots[index];
+      if (slot->letter == letter && slot->fontId == fontId &&
+          slot->color == color && slot->background == background)
+        {
+          // Found it.  Make it the most recently used glyph.
+
+          if (m_head != index)
+            {
+              unlinkLru(index);
+              linkLru(index);
+            }
+
+          m_hits++;
+          bitmap->data = (FAR const void *)slotData(index);
+          return true;
+        }
+    }
+
+  // Not cached.  Take the least recently used slot.  Unused slots are
+  // always at the tail of the LRU list.
+
+  m_misses++;
+
+  uint16_t index = m_tail;
+  FAR struct SGlyphSlot *slot = &m_slots[index];
+
+  if (slot->inuse)
+    {
+      unlinkHash(index);
+      m_evictions++;
+    }
+
+  unlinkLru(index);
+  linkLru(index);
+
+  slot->color      = color;
+  slot->background = background;
+  slot->fontId     = fontId;
+  slot->letter     = letter;
+  slot->stride     = stride;
+  slot->width      = width;
+  slot->height     = height;
+  slot->inuse      = true;
+  slot->hnext      = m_hash[bucket];
+  m_hash[bucket]   = index;
+
+  // Fill the slot with the background color then render the glyph on top
+  // of it.
+
+  FAR uint8_t *data = slotData(index);
+  bitmap->data      = (FAR const void *)data;
+
+  FAR nxwidget_pixel_t *bmPtr = (FAR nxwidget_pixel_t *)data;
+  for (unsigned int i = 0; i < npixels; i++)
+    {
+      *bmPtr++ = background;
+    }
+
+  font->drawChar(bitmap, letter);
+  return true;
+}
+
+/**
+ * Discard all cached glyphs.
+ */
+
+void CGlyphCache::flush(void)
+{
+  for (uint16_t i = 0; i < GLYPHCACHE_NSLOTS; i++)
+    {
+      m_hash[i]        = GLYPHCACHE_NONE;
+      m_slots[i].inuse = false;
+      m_slots[i].hnext = GLYPHCACHE_NONE;
+      m_slots[i].prev  = i - 1;
+      m_slots[i].next  = i + 1;
+    }
+
+  m_slots[0].prev                     = GLYPHCACHE_NONE;
+  m_slots[GLYPHCACHE_NSLOTS - 1].next = GLYPHCACHE_NONE;
+  m_head                              = 0;
+  m_tail                              = GLYPHCACHE_NSLOTS - 1;
+}
+
+/**
+ * Remove a slot from the LRU list.
+ *
+ * @param index The slot to remove.
+ */
+
+void CGlyphCache::unlinkLru(uint16_t index)
+{
+  FAR struct SGlyphSlot *slot = &m_slots[index];
+
+  if (slot->prev != GLYPHCACHE_NONE)
+    {
+      m_slots[slot->prev].next = slot->next;
+    }
+  else
+    {
+      m_head = slot->next;
+    }
+
+  if (slot->next != GLYPHCACHE_NONE)
+    {
+      m_slots[slot->next].prev = slot->prev;
+    }
+  else
+    {
+      m_tail = slot->prev;
+    }
+}
+
+/**
+ * Insert a slot at the most-recently-used end of the LRU list.
+ *
+ * @param index The slot to insert.
+ */
+
+void CGlyphCache::linkLru(uint16_t index)
+{
+  FAR struct SGlyphSlot *slot = &m_slots[index];
+
+  slot->prev = GLYPHCACHE_NONE;
+  slot->next = m_head;
+
+  if (m_head != GLYPHCACHE_NONE)
+    {
+      m_slots[m_head].prev = index;
+    }
+  else
+    {
+      m_tail = index;
+    }
+
+  m_head = index;
+}
+
+/**
+ * Remove a slot from its hash bucket.
+ *
+ * @param index The slot to remove.
+ */
+
+void CGlyphCache::unlinkHash(uint16_t index)
+{
+  FAR struct SGlyphSlot *slot = &m_slots[index];
+  FAR uint16_t *link = &m_hash[hash(slot->fontId, slot->letter,
+                                    slot->color, slot->background)];
+
+  while (*link != GLYPHCACHE_NONE)
+    {
+      if (*link == index)
+        {
+          *link = slot->hnext;
+          break;
+        }
+
+      link = &m_slots[*link].hnext;
+    }
+
+  slot->hnext = GLYPHCACHE_NONE;
+}
+
+#endif // CONFIG_NXWIDGETS_GLYPHCACHE
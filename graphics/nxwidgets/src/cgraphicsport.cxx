@@ -63,6 +63,7 @@
 #include <sys/types.h>
 #include <stdint.h>
 #include <stdbool.h>
+#include <cstring>
 #include <cerrno>
 #include <debug.h>
 
@@ -77,18 +78,110 @@
 #include "graphics/nxwidgets/cgraphicsport.hxx"
 #include "graphics/nxwidgets/cwidgetstyle.hxx"
 #include "graphics/nxwidgets/cbitmap.hxx"
+#include "graphics/nxwidgets/cglyphcache.hxx"
+#include "graphics/nxwidgets/cbitmapmask.hxx"
 #include "graphics/nxwidgets/singletons.hxx"
 
 /****************************************************************************
  * Pre-Processor Definitions
  ****************************************************************************/
 
+// nxgl_circletraps() describes a circle with this many trapezoids
+
+#define NCIRCLE_TRAPS 8
+
 /****************************************************************************
- * Method Implementations
+ * Private Functions
  ****************************************************************************/
 
 using namespace NXWidgets;
 
+/**
+ * Find the first bit in a mask row with the given value, skipping whole
+ * words that do not contain it.
+ *
+ * @param mask The mask row.
+ * @param bit The index of the first bit to examine.
+ * @param end The index of the bit after the last bit to examine.
+ * @param set True to find a set bit, false to find a clear bit.
+ * @return The index of the bit found or end if there is none.
+ */
+
+static unsigned int findMaskBit(FAR const uint32_t *mask, unsigned int bit,
+                                unsigned int end, bool set)
+{
+  while (bit < end)
+    {
+      uint32_t word = set ? mask[bit >> 5] : ~mask[bit >> 5];
+      word >>= (bit & 31);
+
+      if (word == 0)
+        {
+          // Nothing in the rest of this word
+
+          bit = (bit | 31) + 1;
+          continue;
+        }
+
+      while ((word & 1) == 0)
+        {
+          word >>= 1;
+          bit++;
+        }
+
+      break;
+    }
+
+  return bit < end ? bit : end;
+}
+
+/**
+ * Find the next run of non-transparent pixels in a row of a bitmap.
+ *
+ * @param src The first visible pixel of the row.
+ * @param mask The transparency mask of the row or NULL to compare pixels
+ *   against the transparent color.
+ * @param transparentColor The transparent color.
+ * @param maskX The bit in the mask row that corresponds to src[0].
+ * @param width The number of visible pixels in the row.
+ * @param start The pixel to begin the search at.  Returns the first pixel
+ *   of the run.
+ * @param end Returns the pixel after the last pixel of the run.
+ * @return True if a run was found.
+ */
+
+static bool findRun(FAR const nxwidget_pixel_t *src,
+                    FAR const uint32_t *mask,
+                    nxgl_mxpixel_t transparentColor,
+                    unsigned int maskX, unsigned int width,
+                    unsigned int &start, unsigned int &end)
+{
+  if (mask)
+    {
+      start = findMaskBit(mask, maskX + start, maskX + width, true) - maskX;
+      end   = findMaskBit(mask, maskX + start, maskX + width, false) - maskX;
+    }
+  else
+    {
+      while (start < width && src[start] == transparentColor)
+        {
+          start++;
+        }
+
+      end = start;
+      while (end < width && src[end] != transparentColor)
+        {
+          end++;
+        }
+    }
+
+  return start < width;
+}
+
+/****************************************************************************
+ * Method Implementations
+ ****************************************************************************/
+
 /**
  * Constructor.
  *
@@ -102,11 +195,21 @@ CGraphicsPort::CGraphicsPort(INxWindow *pNxWnd, nxgl_mxpixel_t backColor)
 {
   m_pNxWnd    = pNxWnd;
   m_backColor = backColor;
+  m_glyph     = (FAR uint8_t *)NULL;
+  m_glyphSize = 0;
+#ifdef CONFIG_NXWIDGETS_DAMAGE
+  m_clipped   = false;
+#endif
 }
 #else
 CGraphicsPort::CGraphicsPort(INxWindow *pNxWnd)
 {
-  m_pNxWnd = pNxWnd;
+  m_pNxWnd    = pNxWnd;
+  m_glyph     = (FAR uint8_t *)NULL;
+  m_glyphSize = 0;
+#ifdef CONFIG_NXWIDGETS_DAMAGE
+  m_clipped   = false;
+#endif
 }
 #endif
 
@@ -119,6 +222,11 @@ CGraphicsPort::~CGraphicsPort(void)
   // m_pNxWnd is not deleted.  This is an abstract base class and
   // the caller of the CGraphicsPort instance is responsible for
   // the window destruction.
+
+  if (m_glyph)
+    {
+      delete[] m_glyph;
+    }
 };
 
 /**
@@ -149,6 +257,72 @@ const nxgl_coord_t CGraphicsPort::getY(void) const
   return pos.y;
 };
 
+/**
+ * Limit all subsequent drawing to a region of the window.
+ *
+ * @param rect The window-relative clipping region.  NULL removes
+ *   the clipping region.
+ */
+
+#ifdef CONFIG_NXWIDGETS_DAMAGE
+void CGraphicsPort::setClipRect(FAR const struct nxgl_rect_s *rect)
+{
+  if (rect)
+    {
+      nxgl_rectcopy(&m_clipRect, rect);
+      m_clipped = true;
+    }
+  else
+    {
+      m_clipped = false;
+    }
+}
+#endif
+
+/**
+ * Check if any part of a region lies within the current clipping
+ * region.
+ *
+ * @param x The window-relative x coordinate of the region.
+ * @param y The window-relative y coordinate of the region.
+ * @param width The width of the region.
+ * @param height The height of the region.
+ * @return True if some part of the region would be drawn.
+ */
+
+#ifdef CONFIG_NXWIDGETS_DAMAGE
+bool CGraphicsPort::isVisible(nxgl_coord_t x, nxgl_coord_t y,
+                              nxgl_coord_t width, nxgl_coord_t height) const
+{
+  struct nxgl_rect_s rect;
+  rect.pt1.x = x;
+  rect.pt1.y = y;
+  rect.pt2.x = x + width - 1;
+  rect.pt2.y = y + height - 1;
+
+  return clipRect(&rect);
+}
+#endif
+
+/**
+ * Limit a window-relative rectangle to the current clipping region.
+ *
+ * @param rect The rectangle to clip.  Modified in place.
+ * @return True if anything remains of the rectangle.
+ */
+
+#ifdef CONFIG_NXWIDGETS_DAMAGE
+bool CGraphicsPort::clipRect(FAR struct nxgl_rect_s *rect) const
+{
+  if (m_clipped)
+    {
+      nxgl_rectintersect(rect, rect, &m_clipRect);
+    }
+
+  return !nxgl_nullrect(rect);
+}
+#endif
+
 /**
  * Draw a pixel into the window.
  *
@@ -160,6 +334,13 @@ const nxgl_coord_t CGraphicsPort::getY(void) const
 void CGraphicsPort::drawPixel(nxgl_coord_t x, nxgl_coord_t y,
                               nxgl_mxpixel_t color)
 {
+#ifdef CONFIG_NXWIDGETS_DAMAGE
+  if (!isVisible(x, y, 1, 1))
+    {
+      return;
+    }
+#endif
+
   struct nxgl_point_s pos;
   pos.x = x;
   pos.y = y;
@@ -189,7 +370,7 @@ void CGraphicsPort::drawHorizLine(nxgl_coord_t x, nxgl_coord_t y,
 
   // Draw the line
 
-  if (!m_pNxWnd->fill(&dest, color))
+  if (clipRect(&dest) && !m_pNxWnd->fill(&dest, color))
     {
       gerr("ERROR: INxWindow::fill failed\n");
     }
@@ -219,7 +400,7 @@ void CGraphicsPort::drawVertLine(nxgl_coord_t x, nxgl_coord_t y,
 
   // Draw the line
 
-  if (!m_pNxWnd->fill(&dest, color))
+  if (clipRect(&dest) && !m_pNxWnd->fill(&dest, color))
     {
       gerr("ERROR: INxWindow::fill failed\n");
     }
@@ -248,12 +429,100 @@ void CGraphicsPort::drawLine(nxgl_coord_t x1, nxgl_coord_t y1,
   vector.pt2.x = x2;
   vector.pt2.y = y2;
 
+#ifdef CONFIG_NXWIDGETS_DAMAGE
+  // Break the line up into trapezoids as NX does and clip each of them to
+  // the clipping region.  The caps of a line one pixel wide are empty.
+
+  if (m_clipped)
+    {
+      struct nxgl_trapezoid_s traps[3];
+      struct nxgl_rect_s rect;
+      bool success;
+
+      switch (nxgl_splitline(&vector, traps, &rect, 1))
+        {
+          case 0: // Three trapezoids
+            success =
+              m_pNxWnd->fillTrapezoid(&m_clipRect, &traps[0], color) &&
+              m_pNxWnd->fillTrapezoid(&m_clipRect, &traps[1], color) &&
+              m_pNxWnd->fillTrapezoid(&m_clipRect, &traps[2], color);
+            break;
+
+          case 1: // One trapezoid
+            success =
+              m_pNxWnd->fillTrapezoid(&m_clipRect, &traps[1], color);
+            break;
+
+          case 2: // One rectangle
+            success = !clipRect(&rect) || m_pNxWnd->fill(&rect, color);
+            break;
+
+          default:
+            success = false;
+            break;
+        }
+
+      if (!success)
+        {
+          gerr("ERROR: Failed to draw a clipped line\n");
+        }
+
+      return;
+    }
+#endif
+
   if (!m_pNxWnd->drawLine(&vector, 1, color, caps))
     {
       gerr("ERROR: INxWindow::drawLine failed\n");
     }
 }
 
+/**
+ * Draw a filled circle at the specified position, size, and color.
+ *
+ * @param center The window-relative coordinates of the circle center.
+ * @param radius The radius of the rectangle in pixels.
+ * @param color The color of the rectangle.
+ */
+
+void CGraphicsPort::drawFilledCircle(struct nxgl_point_s *center,
+                                     nxgl_coord_t radius,
+                                     nxgl_mxpixel_t color)
+{
+#ifdef CONFIG_NXWIDGETS_DAMAGE
+  // Break the circle up into trapezoids as NX does and clip each of them
+  // to the clipping region
+
+  if (m_clipped)
+    {
+      if (!isVisible(center->x - radius, center->y - radius,
+                     2 * radius + 1, 2 * radius + 1))
+        {
+          return;
+        }
+
+      struct nxgl_trapezoid_s traps[NCIRCLE_TRAPS];
+      nxgl_circletraps(center, radius, traps);
+
+      for (int i = 0; i < NCIRCLE_TRAPS; i++)
+        {
+          if (!m_pNxWnd->fillTrapezoid(&m_clipRect, &traps[i], color))
+            {
+              gerr("ERROR: INxWindow::fillTrapezoid failed\n");
+              return;
+            }
+        }
+
+      return;
+    }
+#endif
+
+  if (!m_pNxWnd->drawFilledCircle(center, radius, color))
+    {
+      gerr("ERROR: INxWindow::drawFilledCircle failed\n");
+    }
+}
+
 /**
  * Draw a filled rectangle to the bitmap.
  *
@@ -273,7 +542,11 @@ void CGraphicsPort::drawFilledRect(nxgl_coord_t x, nxgl_coord_t y,
   rect.pt1.y = y;
   rect.pt2.x = x + width - 1;
   rect.pt2.y = y + height - 1;
-  m_pNxWnd->fill(&rect, color);
+
+  if (clipRect(&rect))
+    {
+      m_pNxWnd->fill(&rect, color);
+    }
 }
 
 /**
@@ -356,7 +629,11 @@ void CGraphicsPort::drawBitmap(nxgl_coord_t x, nxgl_coord_t y,
 
   // Blit the bitmap
 
-  m_pNxWnd->bitmap(&dest, (FAR const void *)bitmap->data, &origin, bitmap->stride);
+  if (clipRect(&dest))
+    {
+      m_pNxWnd->bitmap(&dest, (FAR const void *)bitmap->data, &origin,
+                       bitmap->stride);
+    }
 }
 
 /**
@@ -381,121 +658,203 @@ void CGraphicsPort::drawBitmap(nxgl_coord_t x, nxgl_coord_t y,
                                int bitmapX, int  bitmapY,
                                nxgl_mxpixel_t transparentColor)
 {
-  // Get the starting position in the image, offset by bitmapX and bitmapY into the image.
+  // dest - The part of the bitmap that is visible on the display
 
-  FAR uint8_t *srcLine = (uint8_t *)bitmap->data +
-                         bitmapY * bitmap->stride +
-                         ((bitmapX * bitmap->bpp + 7) >> 3);
-  FAR nxwidget_pixel_t *srcPtr  = (nxwidget_pixel_t *)srcLine;
+  struct nxgl_rect_s dest;
+  dest.pt1.x = x;
+  dest.pt1.y = y;
+  dest.pt2.x = x + width - 1;
+  dest.pt2.y = y + height - 1;
+
+  if (width <= 0 || height <= 0 || !clipRect(&dest))
+    {
+      return;
+    }
+
+  // Position and size of the visible part within the bitmap
 
-  // Loop until all rows have been displayed
+  int          srcX      = bitmapX + (dest.pt1.x - x);
+  int          srcY      = bitmapY + (dest.pt1.y - y);
+  nxgl_coord_t visWidth  = dest.pt2.x - dest.pt1.x + 1;
+  nxgl_coord_t visHeight = dest.pt2.y - dest.pt1.y + 1;
 
-  nxgl_coord_t firstX = x;
-  nxgl_coord_t lastX  = x + width;
-  nxgl_coord_t lastY  = y + height;
+  FAR const uint32_t *maskBits = (FAR const uint32_t *)NULL;
+  unsigned int        rowWords = 0;
 
-  while (y < lastY)
+#ifdef CONFIG_NXWIDGETS_BITMAPMASK
+  // Get the transparency mask of the bitmap.  Bitmaps without any
+  // transparent pixels are drawn as opaque bitmaps.
+
+  FAR CBitmapMaskCache *cache = g_bitmapMasks;
+  if (cache)
     {
-      // Search for the next non-transparent pixel in the source image
+      cache->lock();
+
+      FAR const struct SBitmapMask *mask =
+        cache->getMask(bitmap, transparentColor);
 
-      while (*srcPtr == transparentColor)
+      if (mask && (mask->empty || mask->opaque))
         {
-          // The pixel is transparent.  Move to the next column
+          bool opaque = mask->opaque;
+          cache->unlock();
 
-          if (++x >= lastX)
+          if (opaque)
             {
-              // We are at the end of the row.  Reset to the next row
+              drawBitmap(x, y, width, height, bitmap, bitmapX, bitmapY);
+            }
 
-              x = firstX;
-              y++;
+          return;
+        }
 
-              // Was that the last row:
+      if (mask)
+        {
+          maskBits = mask->bits;
+          rowWords = mask->rowWords;
+        }
+    }
+#endif
 
-              if (y >= lastY)
-                {
-                  // Yes, then we are finished
+  FAR const uint8_t *srcLine = (FAR const uint8_t *)bitmap->data +
+                               srcY * bitmap->stride;
 
-                  return;
-                }
+#ifndef CONFIG_NX_WRITEONLY
+  // Compose the visible part of the bitmap over the current contents of
+  // the display, a band of rows at a time, so that each band is sent to
+  // the display in a single operation.
 
-              // Update the source data pointers to the beginning of the next
-              // row
+  unsigned int stride   = ((unsigned int)visWidth * CONFIG_NXWIDGETS_BPP + 7) >> 3;
+  nxgl_coord_t bandRows = (nxgl_coord_t)(CONFIG_NXWIDGETS_BLITBUFFER_SIZE / stride);
 
-              srcLine += bitmap->stride;
-              srcPtr   = (nxwidget_pixel_t *)srcLine;
-            }
-          else
-            {
-              // This is another transparent pixel on the same row
+  if (bandRows < 1)
+    {
+      bandRows = 1;
+    }
 
-              srcPtr++;
-            }
-        }
+  if (bandRows > visHeight)
+    {
+      bandRows = visHeight;
+    }
 
-      // srcPtr points to the next non-transparent color.  Save this
-      // as the start of a run that has length of at least one
+  FAR uint8_t *buffer = getGlyphBuffer(stride * bandRows);
+  if (buffer)
+    {
+      struct SBitmap band;
+      band.bpp    = CONFIG_NXWIDGETS_BPP;
+      band.fmt    = CONFIG_NXWIDGETS_FMT;
+      band.width  = visWidth;
+      band.stride = stride;
+      band.data   = (FAR const void *)buffer;
 
-      FAR nxwidget_pixel_t *runPtr   = srcPtr;
-      nxgl_coord_t          runX     = x;
-      nxgl_coord_t          runWidth = 0;
+      struct nxgl_rect_s rect;
+      rect.pt1.x = dest.pt1.x;
+      rect.pt2.x = dest.pt2.x;
 
-      // Now search for the next transparent pixel on the same row.
-      // This will determine the length of the run
+      struct nxgl_point_s origin;
+      origin.x = dest.pt1.x;
 
-      do
+      for (nxgl_coord_t row = 0; row < visHeight; row += bandRows)
         {
-          // This is another non-transparent pixel on the same row
+          nxgl_coord_t nrows = visHeight - row;
+          if (nrows > bandRows)
+            {
+              nrows = bandRows;
+            }
 
-          runWidth++;
-          srcPtr++;
+          // Read the display under the band
 
-          // Move to the next column
+          rect.pt1.y  = dest.pt1.y + row;
+          rect.pt2.y  = rect.pt1.y + nrows - 1;
+          band.height = nrows;
 
-          if (++x >= lastX)
-            {
-              // We are at the end of the row.  Reset to the next row
+          m_pNxWnd->getRectangle(&rect, &band);
 
-              x = firstX;
-              y++;
+          // Copy each run of non-transparent pixels over it
 
-              // Update the source data pointers to the beginning of the next
-              // row
+          for (nxgl_coord_t i = 0; i < nrows; i++)
+            {
+              FAR const nxwidget_pixel_t *srcPtr =
+                (FAR const nxwidget_pixel_t *)srcLine + srcX;
+              FAR nxwidget_pixel_t *destPtr =
+                (FAR nxwidget_pixel_t *)(buffer + i * stride);
+              FAR const uint32_t *maskRow = maskBits ?
+                &maskBits[(srcY + row + i) * rowWords] :
+                (FAR const uint32_t *)NULL;
+
+              unsigned int runStart = 0;
+              unsigned int runEnd;
+
+              while (findRun(srcPtr, maskRow, transparentColor, srcX,
+                             visWidth, runStart, runEnd))
+                {
+                  memcpy(&destPtr[runStart], &srcPtr[runStart],
+                         (runEnd - runStart) * sizeof(nxwidget_pixel_t));
+                  runStart = runEnd;
+                }
 
               srcLine += bitmap->stride;
-              srcPtr   = (nxwidget_pixel_t *)srcLine;
+            }
 
-              // And break out of this loop
+          // Then put the whole band back on the display
 
-              break;
-            }
+          origin.y = rect.pt1.y;
+          m_pNxWnd->bitmap(&rect, (FAR const void *)buffer, &origin,
+                           stride);
         }
-      while (*srcPtr != transparentColor);
 
-      // When we come out of the above loop, either (1) srcPtr points to the
-      // next transparent pixel on the same row, or (2) srcPtr points to the
-      // first pixel in the next row.
+#ifdef CONFIG_NXWIDGETS_BITMAPMASK
+      if (cache)
+        {
+          cache->unlock();
+        }
+#endif
 
-      // origin - The origin of the upper, left-most corner of the full bitmap.
-      //          Both dest and origin are in window coordinates, however, origin
-      //          may lie outside of the display.
+      return;
+    }
+#endif
 
-      struct nxgl_point_s origin;
-      origin.x   = runX;
-      origin.y   = y;
+  // The display cannot be read (or there is no memory to compose in).
+  // Send each run of non-transparent pixels to the display separately.
 
-      // dest - Describes the rectangular on the display that will receive the
-      //        the bit map.
+  for (nxgl_coord_t row = 0; row < visHeight; row++)
+    {
+      FAR const nxwidget_pixel_t *srcPtr =
+        (FAR const nxwidget_pixel_t *)srcLine + srcX;
+      FAR const uint32_t *maskRow = maskBits ?
+        &maskBits[(srcY + row) * rowWords] : (FAR const uint32_t *)NULL;
 
-      struct nxgl_rect_s dest;
-      dest.pt1.x = runX;
-      dest.pt1.y = y;
-      dest.pt2.x = runX + runWidth - 1;
-      dest.pt2.y = y;
+      unsigned int runStart = 0;
+      unsigned int runEnd;
 
-      // Blit the bitmap
+      while (findRun(srcPtr, maskRow, transparentColor, srcX, visWidth,
+                     runStart, runEnd))
+        {
+          // origin - The origin of the run.  The run pointer is used as
+          //          the beginning of the bitmap data.
+
+          struct nxgl_point_s origin;
+          origin.x   = dest.pt1.x + runStart;
+          origin.y   = dest.pt1.y + row;
+
+          struct nxgl_rect_s run;
+          run.pt1.x = origin.x;
+          run.pt1.y = origin.y;
+          run.pt2.x = dest.pt1.x + runEnd - 1;
+          run.pt2.y = origin.y;
+
+          m_pNxWnd->bitmap(&run, (FAR const void *)&srcPtr[runStart],
+                           &origin, bitmap->stride);
+          runStart = runEnd;
+        }
 
-      m_pNxWnd->bitmap(&dest, (FAR const void *)runPtr, &origin, bitmap->stride);
+      srcLine += bitmap->stride;
     }
+
+#ifdef CONFIG_NXWIDGETS_BITMAPMASK
+  if (cache)
+    {
+      cache->unlock();
+    }
+#endif
 }
 
 /**
@@ -569,7 +928,13 @@ void CGraphicsPort::drawBitmapGreyScale(nxgl_coord_t x, nxgl_coord_t y,
 
       // Now blit the single row
 
-      m_pNxWnd->bitmap(&dest, run, &origin, bitmap->stride);
+      struct nxgl_rect_s clipped;
+      nxgl_rectcopy(&clipped, &dest);
+
+      if (clipRect(&clipped))
+        {
+          m_pNxWnd->bitmap(&clipped, run, &origin, bitmap->stride);
+        }
 
        // Setup for the next source row
 
@@ -720,19 +1085,46 @@ void CGraphicsPort::_drawText(struct nxgl_point_s *pos, CRect *bound,
     }
 #endif
 
-  // Allocate a bit of memory to hold the largest rendered font
+  // Get a bit of memory to hold the largest rendered font.  Room is left
+  // for the background fill which works in whole nxwidget_pixel_t units.
 
   unsigned int bmWidth   = ((unsigned int)font->getMaxWidth() * CONFIG_NXWIDGETS_BPP + 7) >> 3;
   unsigned int bmHeight  = (unsigned int)font->getHeight();
+  unsigned int bmPixels  = (unsigned int)font->getMaxWidth() * bmHeight;
 
   unsigned int glyphSize =  bmWidth * bmHeight;
-  FAR uint8_t  *glyph    =  new uint8_t[glyphSize];
+  if (glyphSize < bmPixels * sizeof(nxwidget_pixel_t))
+    {
+      glyphSize = bmPixels * sizeof(nxwidget_pixel_t);
+    }
+
+  FAR uint8_t  *glyph    =  getGlyphBuffer(glyphSize);
+  if (!glyph)
+    {
+      gerr("ERROR: Failed to allocate glyph buffer\n");
+      return;
+    }
+
+#ifdef CONFIG_NXWIDGETS_GLYPHCACHE
+  // Opaque glyphs are taken from the shared glyph cache
+
+  FAR CGlyphCache *cache = transparent ? (FAR CGlyphCache *)NULL : g_glyphCache;
+  if (cache)
+    {
+      cache->lock();
+    }
+#endif
 
   // Get the bounding rectangle in NX form
 
   struct nxgl_rect_s boundingBox;
   bound->getNxRect(&boundingBox);
 
+  // Characters outside of the clipping region are skipped below but the
+  // position is still advanced past them.
+
+  clipRect(&boundingBox);
+
   // Loop setup
 
   struct SBitmap bitmap;
@@ -785,6 +1177,25 @@ void CGraphicsPort::_drawText(struct nxgl_point_s *pos, CRect *bound,
 
           if (!nxgl_nullrect(&intersection))
             {
+#ifdef CONFIG_NXWIDGETS_GLYPHCACHE
+              // Use the cached glyph if there is one.  Otherwise fall back
+              // and render the glyph here.
+
+              struct SBitmap cached;
+              if (cache && cache->getGlyph(font, letter, fontWidth, bmHeight,
+                                           background, &cached))
+                {
+                  if (!m_pNxWnd->bitmap(&intersection, cached.data,
+                                        pos, cached.stride))
+                    {
+                      ginfo("nx_bitmapwindow failed: %d\n", errno);
+                    }
+
+                  pos->x += fontWidth;
+                  continue;
+                }
+#endif
+
               // If we have been given a background color, use it to fill the array.
               // Otherwise initialize the bitmap memory by reading from the display.
               // The font renderer always renders the fonts on a transparent background.
@@ -826,7 +1237,37 @@ void CGraphicsPort::_drawText(struct nxgl_point_s *pos, CRect *bound,
       pos->x += fontWidth;
     }
 
-  delete[] glyph;
+#ifdef CONFIG_NXWIDGETS_GLYPHCACHE
+  if (cache)
+    {
+      cache->unlock();
+    }
+#endif
+}
+
+/**
+ * Return a glyph rendering buffer of at least the requested size.  The
+ * buffer is retained across calls and only reallocated when a larger
+ * font is used.  It is also used to compose transparent bitmaps.
+ *
+ * @param size The required size of the buffer in bytes.
+ * @return The glyph buffer or NULL if it could not be allocated.
+ */
+
+FAR uint8_t *CGraphicsPort::getGlyphBuffer(unsigned int size)
+{
+  if (size > m_glyphSize)
+    {
+      if (m_glyph)
+        {
+          delete[] m_glyph;
+        }
+
+      m_glyph     = new uint8_t[size];
+      m_glyphSize = m_glyph ? size : 0;
+    }
+
+  return m_glyph;
 }
 
 /**
@@ -899,6 +1340,26 @@ void CGraphicsPort::move(nxgl_coord_t x, nxgl_coord_t y,
 void CGraphicsPort::greyScale(nxgl_coord_t x, nxgl_coord_t y,
                               nxgl_coord_t width, nxgl_coord_t height)
 {
+#ifdef CONFIG_NXWIDGETS_DAMAGE
+  // Only modify the part of the region that is inside the clipping region
+
+  struct nxgl_rect_s region;
+  region.pt1.x = x;
+  region.pt1.y = y;
+  region.pt2.x = x + width - 1;
+  region.pt2.y = y + height - 1;
+
+  if (!clipRect(&region))
+    {
+      return;
+    }
+
+  x      = region.pt1.x;
+  y      = region.pt1.y;
+  width  = region.pt2.x - region.pt1.x + 1;
+  height = region.pt2.y - region.pt1.y + 1;
+#endif
+
   // Allocate memory to hold one row of graphics data
 
   unsigned int stride    = ((unsigned int)width * CONFIG_NXWIDGETS_BPP + 7) >> 3;
@@ -982,6 +1443,26 @@ void CGraphicsPort::greyScale(nxgl_coord_t x, nxgl_coord_t y,
 void CGraphicsPort::invert(nxgl_coord_t x, nxgl_coord_t y,
                            nxgl_coord_t width, nxgl_coord_t height)
 {
+#ifdef CONFIG_NXWIDGETS_DAMAGE
+  // Only modify the part of the region that is inside the clipping region
+
+  struct nxgl_rect_s region;
+  region.pt1.x = x;
+  region.pt1.y = y;
+  region.pt2.x = x + width - 1;
+  region.pt2.y = y + height - 1;
+
+  if (!clipRect(&region))
+    {
+      return;
+    }
+
+  x      = region.pt1.x;
+  y      = region.pt1.y;
+  width  = region.pt2.x - region.pt1.x + 1;
+  height = region.pt2.y - region.pt1.y + 1;
+#endif
+
   // Allocate memory to hold one row of graphics data
 
   unsigned int stride    = ((unsigned int)width * CONFIG_NXWIDGETS_BPP + 7) >> 3;
@@ -133,7 +133,7 @@ void CLabel::setTextAlignmentHoriz(TextAlignmentHoriz alignment)
 {
   m_hAlignment = alignment;
   calculateTextPositionHorizontal();
-  redraw();
+  markChanged();
 }
 
 /**
@@ -146,7 +146,7 @@ void CLabel::setTextAlignmentVert(TextAlignmentVert alignment)
 {
   m_vAlignment = alignment;
   calculateTextPositionVertical();
-  redraw();
+  markChanged();
 }
 
 /**
@@ -198,7 +198,7 @@ void CLabel::highlight(bool highlightOn)
   if (highlightOn != m_highlighted)
     {
       m_highlighted = highlightOn;
-      redraw();
+      markChanged();
     }
 }
 
@@ -251,7 +251,7 @@ void CLabel::setFont(CNxFont *font)
 
   calculateTextPositionHorizontal();
   calculateTextPositionVertical();
-  redraw();
+  markChanged();
 }
 
 /**
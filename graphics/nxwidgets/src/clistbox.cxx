@@ -165,6 +165,19 @@ void CListBox::removeAllOptions(void)
   m_options.removeAllItems();
 }
 
+/**
+ * Get the options from a data source instead of from options added to
+ * the list box.
+ *
+ * @param source The data source, or NULL to stop using it.
+ */
+
+void CListBox::setDataSource(FAR IListDataSource *source)
+{
+  allocateRows();
+  m_options.setDataSource(source);
+}
+
 /**
  * Add a new option to the widget.
  *
@@ -374,9 +387,16 @@ void CListBox::getPreferredDimensions(CRect &rect) const
   nxgl_coord_t maxWidth    = 0;
   nxgl_coord_t optionWidth = 0;
 
-  // Locate longest string in options
+  // Locate longest string in options.  Only the options that fit in the
+  // recycled rows are measured if a data source is used.
 
-  for (int i = 0; i < m_options.getItemCount(); ++i)
+  int count = m_options.getItemCount();
+  if (m_options.getDataSource() && count > m_options.getRowCount())
+    {
+      count = m_options.getRowCount();
+    }
+
+  for (int i = 0; i < count; ++i)
     {
       optionWidth = getFont()->getStringWidth(m_options.getItem(i)->getText());
 
@@ -453,6 +473,13 @@ void CListBox::drawContents(CGraphicsPort *port)
 
   nxgl_coord_t optionHeight = getOptionHeight();
 
+  // Make sure that the data source rows cover the visible options
+
+  if (m_options.getDataSource())
+    {
+      allocateRows();
+    }
+
   // Ensure that we subtract 1 from topOption to ensure that the option
   // above is drawn if it is partially visible
 
@@ -650,3 +677,34 @@ void CListBox::setOptionSelected(const int index, bool selected)
 {
   m_options.setItemSelected(index, selected);
 }
+
+/**
+ * Make sure that there are enough recycled rows to hold all of the
+ * options that can be visible at once when a data source is used.
+ */
+
+void CListBox::allocateRows(void)
+{
+  CRect rect;
+  getRect(rect);
+
+  // drawContents() draws one partially visible option above and below
+  // the visible options
+
+  int rows = rect.getHeight() / getOptionHeight() + 4;
+
+  while (m_options.getRowCount() < rows)
+    {
+      CListBoxDataItem *row =
+        new CListBoxDataItem("", 0,
+                             getEnabledTextColor(), getBackgroundColor(),
+                             getSelectedTextColor(),
+                             getSelectedBackgroundColor());
+      if (!row)
+        {
+          return;
+        }
+
+      m_options.addRow(row);
+    }
+}
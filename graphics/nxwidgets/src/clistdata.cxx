@@ -85,6 +85,9 @@ CListData::CListData(void)
 {
   m_allowMultipleSelections = true;
   m_sortInsertedItems      = false;
+  m_source                 = (FAR IListDataSource *)0;
+  m_windowStart            = 0;
+  m_windowCount            = 0;
 }
 
 /**
@@ -94,6 +97,11 @@ CListData::CListData(void)
 CListData::~CListData(void)
 {
   removeAllItems();
+
+  for (int i = 0; i < m_window.size(); i++)
+    {
+      delete m_window[i];
+    }
 }
 
 /**
@@ -119,6 +127,14 @@ void CListData::addItem(const CNxString &text, const uint32_t value)
 
 void CListData::addItem(CListDataItem *item)
 {
+  // Items cannot be added to a data source
+
+  if (m_source)
+    {
+      delete item;
+      return;
+    }
+
   // Determine insert type
 
   if (m_sortInsertedItems)
@@ -147,7 +163,7 @@ void CListData::removeItem(const int index)
 {
   // Bounds check
 
-  if (index < m_items.size())
+  if (!m_source && index < m_items.size())
     {
       // Delete the option
 
@@ -208,6 +224,32 @@ void CListData::removeAllItems(void)
 
 const int CListData::getSelectedIndex(void) const
 {
+  if (m_source)
+    {
+      if (m_selected.size() == 0)
+        {
+          return -1;
+        }
+      else if (m_order.size() == 0)
+        {
+          return m_selected[0];
+        }
+
+      // Find the first selected item in sorted order
+
+      for (int i = 0; i < m_order.size(); i++)
+        {
+          bool found;
+          findSelected(m_order[i], found);
+          if (found)
+            {
+              return i;
+            }
+        }
+
+      return -1;
+    }
+
   // Get the first selected index
 
   for (int i = 0; i < m_items.size(); i++)
@@ -246,7 +288,7 @@ const CListDataItem *CListData::getSelectedItem(void) const
   int index = getSelectedIndex();
   if (index > -1)
     {
-      return m_items[index];
+      return getItem(index);
     }
   return NULL;
 }
@@ -257,7 +299,47 @@ const CListDataItem *CListData::getSelectedItem(void) const
 
 void CListData::sort(void)
 {
-  quickSort(0, m_items.size() - 1);
+  int count = getItemCount();
+
+  if (m_source)
+    {
+      // Only the order of the source indexes is kept
+
+      m_order.clear();
+      m_order.reserve(count);
+
+      for (int i = 0; i < count; i++)
+        {
+          m_order.push_back(i);
+        }
+
+      sortOrder(m_order);
+      m_windowCount = 0;
+    }
+  else if (count > 1)
+    {
+      // Sort the indexes of the items then put the items in that order
+
+      TNxArray<int> order;
+      TNxArray<CListDataItem*> items;
+
+      order.reserve(count);
+      items.reserve(count);
+
+      for (int i = 0; i < count; i++)
+        {
+          order.push_back(i);
+          items.push_back(m_items[i]);
+        }
+
+      sortOrder(order);
+
+      for (int i = 0; i < count; i++)
+        {
+          m_items[i] = items[order[i]];
+        }
+    }
+
   raiseDataChangedEvent();
 }
 
@@ -270,9 +352,29 @@ void CListData::selectAllItems(void)
 {
   if (m_allowMultipleSelections)
     {
-      for (int i = 0; i < m_items.size(); i++)
+      if (m_source)
         {
-          m_items[i]->setSelected(true);
+          int count = m_source->getItemCount();
+
+          m_selected.clear();
+          m_selected.reserve(count);
+
+          for (int i = 0; i < count; i++)
+            {
+              m_selected.push_back(i);
+            }
+
+          for (int i = 0; i < m_windowCount; i++)
+            {
+              m_window[i]->setSelected(true);
+            }
+        }
+      else
+        {
+          for (int i = 0; i < m_items.size(); i++)
+            {
+              m_items[i]->setSelected(true);
+            }
         }
 
       raiseSelectionChangedEvent();
@@ -290,6 +392,12 @@ void CListData::deselectAllItems(void)
       m_items[i]->setSelected(false);
     }
 
+  m_selected.clear();
+  for (int i = 0; i < m_windowCount; i++)
+    {
+      m_window[i]->setSelected(false);
+    }
+
   raiseSelectionChangedEvent();
 }
 
@@ -303,6 +411,13 @@ void CListData::deselectAllItems(void)
 
 void CListData::setItemSelected(const int index, bool selected)
 {
+  if (m_source)
+    {
+      setSourceItemSelected(index, selected);
+      raiseSelectionChangedEvent();
+      return;
+    }
+
   // Deselect old options if we're making an option selected and
   // we're not a multiple list
 
@@ -343,61 +458,324 @@ void CListData::removeListDataEventHandler(IListDataEventHandler *eventHandler)
 }
 
 /**
- * Quick sort the items using their compareTo() methods.
+ * Compare two items for sorting.
  *
- * @param start The index to start sorting at.
- * @param end The index to stop sorting at.
+ * @param index1 The index (in the unsorted list) of the first item.
+ * @param index2 The index (in the unsorted list) of the second item.
+ * @return Less than zero if the first item comes first.
  */
 
-void CListData::quickSort(const int start, const int end)
+int CListData::compareItems(const int index1, const int index2)
 {
-  if (end > start)
+  if (m_source)
     {
-      int left = start;
-      int right = end;
+      return m_source->compareItems(index1, index2);
+    }
 
-      CListDataItem *pivot = m_items[(start + end) >> 1];
+  return m_items[index1]->compareTo(m_items[index2]);
+}
 
-      do
+/**
+ * Sort an array of indexes so that the items that they refer to are
+ * in order.  This is a non-recursive heap sort.
+ *
+ * @param order The indexes to sort.
+ */
+
+void CListData::sortOrder(TNxArray<int> &order)
+{
+  int count = order.size();
+
+  // Arrange the indexes into a heap with the last item at the root
+
+  for (int root = (count >> 1) - 1; root >= 0; root--)
+    {
+      siftDown(order, root, count);
+    }
+
+  // Repeatedly move the root to the end of the array and restore the heap
+
+  for (int end = count - 1; end > 0; end--)
+    {
+      int tmp    = order[0];
+      order[0]   = order[end];
+      order[end] = tmp;
+
+      siftDown(order, 0, end);
+    }
+}
+
+/**
+ * Move an index down a heap until the heap is in order again.
+ *
+ * @param order The heap of indexes.
+ * @param root The position of the index to move.
+ * @param end The number of indexes in the heap.
+ */
+
+void CListData::siftDown(TNxArray<int> &order, int root, const int end)
+{
+  int child;
+
+  while ((child = (root << 1) + 1) < end)
+    {
+      // Select the later of the two children
+
+      if (child + 1 < end && compareItems(order[child], order[child + 1]) < 0)
         {
-          while ((pivot->compareTo(m_items[left]) > 0) && (left < end))
-            {
-              left++;
-            }
+          child++;
+        }
+
+      // Stop if the root is already later than both children
+
+      if (compareItems(order[root], order[child]) >= 0)
+        {
+          return;
+        }
+
+      int tmp      = order[root];
+      order[root]  = order[child];
+      order[child] = tmp;
+      root         = child;
+    }
+}
 
-          while ((pivot->compareTo(m_items[right]) < 0) && (right > start))
+/**
+ * Find a source index in the selection.
+ *
+ * @param sourceIndex The source index to look for.
+ * @param found Set to true if the index is selected.
+ * @return The position of the index in m_selected, or the position
+ *   where it would be inserted.
+ */
+
+const int CListData::findSelected(const int sourceIndex, bool &found) const
+{
+  int bottom = 0;
+  int top    = m_selected.size();
+
+  while (bottom < top)
+    {
+      int mid = (bottom + top) >> 1;
+      if (m_selected[mid] < sourceIndex)
+        {
+          bottom = mid + 1;
+        }
+      else
+        {
+          top = mid;
+        }
+    }
+
+  found = (bottom < m_selected.size() && m_selected[bottom] == sourceIndex);
+  return bottom;
+}
+
+/**
+ * Get an item from the data source.  The window of recycled items
+ * is moved to start at the requested index if it is not already held.
+ *
+ * @param index The index of the item.
+ * @return The item, or NULL if the index is out of range.
+ */
+
+const CListDataItem *CListData::getSourceItem(const int index) const
+{
+  int count = m_source->getItemCount();
+  int rows  = m_window.size();
+
+  if (index < 0 || index >= count || rows == 0)
+    {
+      return (const CListDataItem *)0;
+    }
+
+  if (index >= m_windowStart && index < m_windowStart + m_windowCount)
+    {
+      return m_window[index - m_windowStart];
+    }
+
+  // Move the window to start at the requested index.  Rows that hold
+  // items which are still in the window keep them; the other rows are
+  // re-used for the new items.
+
+  int newCount = count - index < rows ? count - index : rows;
+  int first    = index > m_windowStart ? index : m_windowStart;
+  int last     = m_windowStart + m_windowCount;
+
+  if (last > index + newCount)
+    {
+      last = index + newCount;
+    }
+
+  if (first > last)
+    {
+      first = last = index;
+    }
+
+  m_spare.clear();
+  for (int i = 0; i < rows; i++)
+    {
+      m_spare.push_back((CListDataItem *)0);
+    }
+
+  for (int i = first; i < last; i++)
+    {
+      m_spare[i - index] = m_window[i - m_windowStart];
+      m_window[i - m_windowStart] = (CListDataItem *)0;
+    }
+
+  for (int i = 0, j = 0; i < rows; i++)
+    {
+      if (!m_spare[i])
+        {
+          while (!m_window[j])
             {
-              right--;
+              j++;
             }
 
-          if (left > right)
+          m_spare[i] = m_window[j++];
+        }
+    }
+
+  for (int i = 0; i < rows; i++)
+    {
+      m_window[i] = m_spare[i];
+    }
+
+  m_windowStart = index;
+  m_windowCount = newCount;
+
+  // Fetch the items before and after the rows that were kept
+
+  for (int i = 0; i < newCount; i++)
+    {
+      if (i == first - index)
+        {
+          i = last - index;
+          if (i >= newCount)
             {
               break;
             }
+        }
+
+      // Fetch as many consecutive items as possible at once
 
-         swapItems(left, right);
-         left++;
-         right--;
+      int n = 1;
+      if (m_order.size() == 0)
+        {
+          int end = i < first - index ? first - index : newCount;
+          n = end - i;
         }
-      while (left <= right);
 
-      quickSort(start, right);
-      quickSort(left, end);
+      m_source->getItems(getSourceIndex(index + i), n, &m_window[i]);
+
+      for (int j = i; j < i + n; j++)
+        {
+          bool selected;
+          findSelected(getSourceIndex(index + j), selected);
+          m_window[j]->setSelected(selected);
+        }
+
+      i += n - 1;
     }
+
+  return m_window[0];
 }
 
 /**
- * Swap the locations of two items in the array.
+ * Select or deselect a data source item.
  *
- * @param index1 The index of the first item to swap.
- * @param index2 The index of the second item to swap.
+ * @param index The index of the item.
+ * @param selected True to select the item, false to deselect it.
  */
 
-void CListData::swapItems(const int index1, const int index2)
+void CListData::setSourceItemSelected(const int index, const bool selected)
 {
-  CListDataItem *tmp = m_items[index1];
-  m_items[index1]    = m_items[index2];
-  m_items[index2]    = tmp;
+  // Deselect old items if we're making an item selected and we're not a
+  // multiple list
+
+  if (((!m_allowMultipleSelections) || (index == -1)) && (selected))
+    {
+      m_selected.clear();
+      for (int i = 0; i < m_windowCount; i++)
+        {
+          m_window[i]->setSelected(false);
+        }
+    }
+
+  if (index < 0 || index >= m_source->getItemCount())
+    {
+      return;
+    }
+
+  bool found;
+  int sourceIndex = getSourceIndex(index);
+  int pos = findSelected(sourceIndex, found);
+
+  if (selected && !found)
+    {
+      m_selected.insert(pos, sourceIndex);
+    }
+  else if (!selected && found)
+    {
+      m_selected.erase(pos);
+    }
+
+  // Update the row holding the item
+
+  if (index >= m_windowStart && index < m_windowStart + m_windowCount)
+    {
+      m_window[index - m_windowStart]->setSelected(selected);
+    }
+}
+
+/**
+ * Get the items from a data source instead of from items added to the
+ * list.  Any items held by the list are removed.  Items cannot be added
+ * or removed while a data source is set.  Recycled row items must be
+ * provided with addRow() before items can be retrieved.
+ *
+ * @param source The data source, or NULL to stop using the data source.
+ */
+
+void CListData::setDataSource(FAR IListDataSource *source)
+{
+  for (int i = 0; i < m_items.size(); i++)
+    {
+      delete m_items[i];
+    }
+
+  m_items.clear();
+  m_source = source;
+  dataSourceChanged();
+}
+
+/**
+ * Add a recycled row item used to hold data source items.  The list
+ * becomes the owner of the item.  The number of rows should cover the
+ * largest range of items that is used at once, such as the visible
+ * rows of a list box.
+ *
+ * @param row The item to add.
+ */
+
+void CListData::addRow(CListDataItem *row)
+{
+  m_window.push_back(row);
+  m_windowCount = 0;
+}
+
+/**
+ * Notify the list that the items of the data source have changed.
+ * Cached items, the sort order and the selection are discarded.
+ */
+
+void CListData::dataSourceChanged(void)
+{
+  m_windowCount = 0;
+  m_order.clear();
+  m_selected.clear();
+  raiseDataChangedEvent();
 }
 
 /**
@@ -409,15 +787,27 @@ void CListData::swapItems(const int index1, const int index2)
 
 const int CListData::getSortedInsertionIndex(const CListDataItem *item) const
 {
-  int i = 0;
+  int bottom = 0;
+  int top    = m_items.size();
 
-  // Locate slot where new option should go
+  // Binary search for the first item that does not come before the new
+  // item
 
-  while ((i < m_items.size()) && (item->compareTo(m_items[i]) > 0))
+  while (bottom < top)
     {
-      i++;
+      int mid = (bottom + top) >> 1;
+
+      if (item->compareTo(m_items[mid]) > 0)
+        {
+          bottom = mid + 1;
+        }
+      else
+        {
+          top = mid;
+        }
     }
-  return i;
+
+  return bottom;
 }
 
 /**
@@ -142,6 +142,7 @@ CMultiLineTextBox::CMultiLineTextBox(CWidgetControl *pWidgetControl,
   m_cursorPos            = 0;
   m_showCursor           = SHOW_CURSOR_NEVER;
   m_wrapCursor           = false;
+  m_logMode              = false;
 
   setText(text);
 }
@@ -250,20 +251,45 @@ void CMultiLineTextBox::setText(const CNxString &text)
 
 void CMultiLineTextBox::appendText(const CNxString &text)
 {
-  bool drawingEnabled = m_flags.drawingEnabled;
+  bool drawingEnabled     = m_flags.drawingEnabled;
+  bool redrawing          = isDrawingEnabled();
+  int oldRows             = m_text->getLineCount();
+  int32_t oldCanvasY      = m_canvasY;
+
+  // Erase the cursor while it is still in its old position
+
+  if (redrawing)
+    {
+      drawCursor(m_widgetControl->getGraphicsPort());
+    }
+
   disableDrawing();
 
   m_text->append(text);
 
+  int rows = m_text->getLineCount();
   cullTopLines();
+  int culledRows = rows - m_text->getLineCount();
+
   limitCanvasHeight();
+
+  // Update the scroll position without moving the contents.
+  // redrawChanges() moves the rows that are still visible.
+
+  bool contentScrolled = m_isContentScrolled;
+  m_isContentScrolled  = false;
   jumpToTextBottom();
+  m_isContentScrolled  = contentScrolled;
 
   if (drawingEnabled)
     {
       enableDrawing();
     }
-  redraw();
+
+  if (redrawing)
+    {
+      redrawChanges(oldRows, culledRows, oldCanvasY);
+    }
 
   m_widgetEventHandlers->raiseValueChangeEvent();
 }
@@ -290,21 +316,47 @@ void CMultiLineTextBox::removeText(const unsigned int startIndex)
 void CMultiLineTextBox::removeText(const unsigned int startIndex,
                                    const unsigned int count)
 {
-  bool drawingEnabled = m_flags.drawingEnabled;
+  bool drawingEnabled     = m_flags.drawingEnabled;
+  bool redrawing          = isDrawingEnabled();
+  int oldRows             = m_text->getLineCount();
+  int32_t oldCanvasY      = m_canvasY;
+
+  // Erase the cursor while it is still in its old position
+
+  if (redrawing)
+    {
+      drawCursor(m_widgetControl->getGraphicsPort());
+    }
+
   disableDrawing();
 
   m_text->remove(startIndex, count);
 
   limitCanvasHeight();
+
+  // Update the scroll position without moving the contents.
+  // redrawChanges() moves the rows that are still visible.
+
+  bool contentScrolled = m_isContentScrolled;
+  m_isContentScrolled  = false;
   limitCanvasY();
+  m_isContentScrolled  = contentScrolled;
 
-  moveCursorToPosition(startIndex);
+  // Move the cursor to the start of the removed text.  The cursor is
+  // redrawn by redrawChanges().
+
+  int len     = (int)m_text->getLength();
+  m_cursorPos = len > (int)startIndex ? (int)startIndex : len;
 
   if (drawingEnabled)
     {
       enableDrawing();
     }
-  redraw();
+
+  if (redrawing)
+    {
+      redrawChanges(oldRows, 0, oldCanvasY);
+    }
 
   m_widgetEventHandlers->raiseValueChangeEvent();
 }
@@ -405,21 +457,44 @@ void CMultiLineTextBox::moveCursorToPosition(const int position)
 void CMultiLineTextBox::insertText(const CNxString &text,
                                    const unsigned int index)
 {
-  bool drawingEnabled = m_flags.drawingEnabled;
+  bool drawingEnabled     = m_flags.drawingEnabled;
+  bool redrawing          = isDrawingEnabled();
+  int oldRows             = m_text->getLineCount();
+  int32_t oldCanvasY      = m_canvasY;
+
+  // Erase the cursor while it is still in its old position
+
+  if (redrawing)
+    {
+      drawCursor(m_widgetControl->getGraphicsPort());
+    }
+
   disableDrawing();
 
   m_text->insert(text, index);
 
+  int rows = m_text->getLineCount();
   cullTopLines();
+  int culledRows = rows - m_text->getLineCount();
+
   limitCanvasHeight();
 
-  moveCursorToPosition(index + text.getLength());
+  // Move the cursor to the end of the inserted text.  The cursor is
+  // redrawn by redrawChanges().
+
+  int len     = (int)m_text->getLength();
+  int pos     = index + text.getLength();
+  m_cursorPos = len > pos ? pos : len;
 
   if (drawingEnabled)
     {
       enableDrawing();
     }
-  redraw();
+
+  if (redrawing)
+    {
+      redrawChanges(oldRows, culledRows, oldCanvasY);
+    }
 
   m_widgetEventHandlers->raiseValueChangeEvent();
 }
@@ -490,18 +565,11 @@ void CMultiLineTextBox::getCursorCoordinates(nxgl_coord_t &x, nxgl_coord_t &y) c
 
       uint8_t cursorLineOffset = m_cursorPos - m_text->getLineStartIndex(cursorRow);
 
-      CStringIterator *iterator = m_text->newStringIterator();
-      iterator->moveTo(m_text->getLineStartIndex(cursorRow));
-
       // Sum the width of each char in the row to find the x coordinate
 
-      for (int i = 0; i < cursorLineOffset; ++i)
-        {
-          x += getFont()->getCharWidth(iterator->getChar());
-          iterator->moveToNext();
-        }
-
-      delete iterator;
+      x += getFont()->getStringWidth(*m_text,
+                                     m_text->getLineStartIndex(cursorRow),
+                                     cursorLineOffset);
     }
 
   // Add offset of row to calculated value
@@ -782,7 +850,17 @@ bool CMultiLineTextBox::cullTopLines(void)
 
   if (m_text->getLineCount() > m_maxRows)
     {
-      m_text->stripTopLines(m_text->getLineCount() - m_maxRows);
+      int lines = m_text->getLineCount() - m_maxRows;
+
+      // In log mode, remove extra rows now so that the following appends
+      // do not need to remove any.  Keep enough rows to fill the textbox.
+
+      if (m_logMode && m_maxRows > m_visibleRows)
+        {
+          lines += (m_maxRows - m_visibleRows) >> 1;
+        }
+
+      m_text->stripTopLines(lines);
       return true;
     }
 
@@ -1270,3 +1348,160 @@ void CMultiLineTextBox::drawRow(CGraphicsPort *port, int row)
   port->drawText(&pos, &rect, m_text->getFont(), *m_text,
                  m_text->getLineStartIndex(row), rowLength, textColor);
 }
+
+/**
+ * Redraws the rows that intersect a horizontal band of the textbox.
+ * The rows are redrawn completely.  Only valid when the text fills the
+ * textbox so that the rows are top aligned.
+ *
+ * @param port The CGraphicsPort to draw to.
+ * @param y The y coordinate of the top of the band.
+ * @param height The height of the band.
+ */
+
+void CMultiLineTextBox::drawRows(CGraphicsPort *port, nxgl_coord_t y,
+                                 nxgl_coord_t height)
+{
+  CRect rect;
+  getRect(rect);
+
+  // Clip the band to the client area
+
+  nxgl_coord_t top    = y;
+  nxgl_coord_t bottom = y + height;
+
+  if (top < rect.getY())
+    {
+      top = rect.getY();
+    }
+
+  if (bottom > rect.getY() + rect.getHeight())
+    {
+      bottom = rect.getY() + rect.getHeight();
+    }
+
+  if (top >= bottom)
+    {
+      return;
+    }
+
+  // Extend the band to whole rows
+
+  nxgl_coord_t lineHeight = m_text->getLineHeight();
+  nxgl_coord_t originY    = rect.getY() + m_canvasY;
+
+  int firstRow = (top - originY) / lineHeight;
+  int lastRow  = (bottom - 1 - originY) / lineHeight;
+
+  top    = originY + firstRow * lineHeight;
+  bottom = originY + (lastRow + 1) * lineHeight;
+
+  if (top < rect.getY())
+    {
+      top = rect.getY();
+    }
+
+  if (bottom > rect.getY() + rect.getHeight())
+    {
+      bottom = rect.getY() + rect.getHeight();
+    }
+
+  // Clear the rows and draw the text
+
+  port->drawFilledRect(rect.getX(), top, rect.getWidth(), bottom - top,
+                       getBackgroundColor());
+
+  if (lastRow >= m_text->getLineCount())
+    {
+      lastRow = m_text->getLineCount() - 1;
+    }
+
+  for (int row = firstRow; row <= lastRow; row++)
+    {
+      drawRow(port, row);
+    }
+}
+
+/**
+ * Updates the display after the text has changed.  Rows that are
+ * unchanged are moved to their new position and only the changed
+ * rows are redrawn.  The cursor must have been erased before the text
+ * was changed.
+ *
+ * @param oldRows The number of rows before the change.
+ * @param culledRows The number of rows removed from the top of the
+ *   text by the change.
+ * @param oldCanvasY The canvas y coordinate before the change.
+ */
+
+void CMultiLineTextBox::redrawChanges(int oldRows, int culledRows,
+                                      int32_t oldCanvasY)
+{
+  int rows = m_text->getLineCount();
+
+  // Rows are only at fixed positions if the text fills the textbox both
+  // before and after the change.  Otherwise the alignment may have moved
+  // every row.
+
+  if (oldRows < m_visibleRows || rows < m_visibleRows)
+    {
+      redraw();
+      return;
+    }
+
+  CGraphicsPort *port = m_widgetControl->getGraphicsPort();
+
+  CRect rect;
+  getRect(rect);
+
+  // Move the unchanged rows by the distance that the text has scrolled
+
+  nxgl_coord_t lineHeight = m_text->getLineHeight();
+  nxgl_coord_t height     = rect.getHeight();
+  nxgl_coord_t dy         = m_canvasY - oldCanvasY - culledRows * lineHeight;
+
+  if (dy >= height || -dy >= height)
+    {
+      redraw();
+      return;
+    }
+
+  if (dy < 0)
+    {
+      port->move(rect.getX(), rect.getY() - dy, 0, dy,
+                 rect.getWidth(), height + dy);
+      drawRows(port, rect.getY() + height + dy, -dy);
+    }
+  else if (dy > 0)
+    {
+      port->move(rect.getX(), rect.getY(), 0, dy,
+                 rect.getWidth(), height - dy);
+      drawRows(port, rect.getY(), dy);
+    }
+
+  // Redraw the re-wrapped rows.  If the number of rows changed, the
+  // following rows have moved too so everything below is redrawn.
+
+  int firstRow = m_text->getFirstChangedLine();
+  int lastRow  = m_text->getLastChangedLine();
+  nxgl_coord_t top;
+  nxgl_coord_t bottom;
+
+  top = getRowY(firstRow) + m_canvasY + rect.getY();
+
+  if (rows != oldRows - culledRows)
+    {
+      bottom = rect.getY() + height;
+    }
+  else
+    {
+      bottom = getRowY(lastRow + 1) + m_canvasY + rect.getY();
+    }
+
+  if (bottom > top)
+    {
+      drawRows(port, top, bottom - top);
+    }
+
+  drawCursor(port);
+}
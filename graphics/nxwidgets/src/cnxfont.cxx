@@ -36,7 +36,6 @@
 
 #include "graphics/nxwidgets/nxconfig.hxx"
 #include "graphics/nxwidgets/cnxstring.hxx"
-#include "graphics/nxwidgets/cstringiterator.hxx"
 #include "graphics/nxwidgets/cnxfont.hxx"
 #include "graphics/nxwidgets/cbitmap.hxx"
 
@@ -67,6 +66,15 @@ CNxFont::CNxFont(enum nx_fontid_e fontid, nxgl_mxpixel_t fontColor,
   m_pFontSet         = nxf_getfontset(m_fontHandle);
   m_fontColor        = fontColor;
   m_transparentColor = transparentColor;
+
+#ifdef CONFIG_NXWIDGETS_FONTWIDTHS
+  // Character widths are looked up when first needed
+
+  memset(m_widths, NXFONT_NOWIDTH, sizeof(m_widths));
+#if CONFIG_NXWIDGETS_SIZEOFCHAR == 2
+  memset(m_sparseChar, 0, sizeof(m_sparseChar));
+#endif
+#endif
 }
 
 /**
@@ -128,32 +136,7 @@ void CNxFont::drawChar(FAR SBitmap *bitmap, nxwidget_char_t letter)
 
 nxgl_coord_t CNxFont::getStringWidth(const CNxString &text) const
 {
-  CStringIterator *iter = text.newStringIterator();
-
-  // Get the width of the string of characters
-  // Move to the first character
-
-  unsigned int width = 0;
-  if (iter->moveToFirst())
-    {
-      // moveToFirst returns true if there is at least one character
-
-      do
-        {
-          // Add the width of the font bitmap for this character and
-          // move the the next character
-
-          nxwidget_char_t ch = iter->getChar();
-
-          width += getCharWidth(ch);
-        }
-      while (iter->moveToNext());
-    }
-
-  // Return the total width
-
-  delete iter;
-  return width;
+  return getStringWidth(text.getCharArray(), text.getLength());
 }
 
 /**
@@ -169,31 +152,41 @@ nxgl_coord_t CNxFont::getStringWidth(const CNxString &text) const
 nxgl_coord_t CNxFont::getStringWidth(const CNxString &text,
                                      int startIndex, int length) const
 {
-  CStringIterator *iter = text.newStringIterator();
-
-  // Get the width of the string of characters
+  // Clip the substring to the string
 
-  iter->moveTo(startIndex);
-  unsigned int width = 0;
+  int stringLength = text.getLength();
+  if (startIndex < 0 || startIndex >= stringLength)
+    {
+      return 0;
+    }
 
-  while (length-- > 0)
+  if (length > stringLength - startIndex)
     {
-      // Add the width of the font bitmap for this character
+      length = stringLength - startIndex;
+    }
 
-      nxwidget_char_t ch = iter->getChar();
-      width += getCharWidth(ch);
+  return getStringWidth(&text.getCharArray()[startIndex], length);
+}
 
-      // Position to the next character in the string
+/**
+ * Get the width of an array of characters in pixels when drawn with
+ * this font.
+ *
+ * @param text The characters to check.
+ * @param length The number of characters.
+ * @return The width of the characters in pixels.
+ */
 
-      if (!iter->moveToNext())
-        {
-          break;
-        }
-    }
+nxgl_coord_t CNxFont::getStringWidth(FAR const nxwidget_char_t *text,
+                                     int length) const
+{
+  unsigned int width = 0;
 
-  // Return the total width
+  for (int i = 0; i < length; i++)
+    {
+      width += getCharWidth(text[i]);
+    }
 
-  delete iter;
   return width;
 }
 
@@ -232,14 +225,26 @@ void CNxFont::getCharMetrics(nxwidget_char_t letter,
 }
 
 /**
- * Get the width of an individual character.
+ * Look up the width of a character in the font and remember it in the
+ * width tables.
  *
  * @param letter The character to get the width of.
  * @return The width of the character in pixels.
  */
 
-nxgl_coord_t CNxFont::getCharWidth(nxwidget_char_t letter) const
+nxgl_coord_t CNxFont::lookupCharWidth(nxwidget_char_t letter) const
 {
+#if defined(CONFIG_NXWIDGETS_FONTWIDTHS) && CONFIG_NXWIDGETS_SIZEOFCHAR == 2
+  // Check the table of wide characters
+
+  unsigned int slot = (unsigned int)letter % CONFIG_NXWIDGETS_FONTWIDTHS_NSPARSE;
+  if ((unsigned int)letter >= NXFONT_NDENSEWIDTHS &&
+      m_sparseChar[slot] == letter)
+    {
+      return m_sparseWidth[slot];
+    }
+#endif
+
   FAR const struct nx_fontbitmap_s *fbm;
   nxgl_coord_t width;
 
@@ -259,5 +264,24 @@ nxgl_coord_t CNxFont::getCharWidth(nxwidget_char_t letter) const
      width = m_pFontSet->spwidth;
     }
 
+#ifdef CONFIG_NXWIDGETS_FONTWIDTHS
+  /* Remember the width for next time */
+
+  if (width < NXFONT_NOWIDTH)
+    {
+      if ((unsigned int)letter < NXFONT_NDENSEWIDTHS)
+        {
+          m_widths[letter] = (uint8_t)width;
+        }
+#if CONFIG_NXWIDGETS_SIZEOFCHAR == 2
+      else
+        {
+          m_sparseChar[slot]  = letter;
+          m_sparseWidth[slot] = (uint8_t)width;
+        }
+#endif
+    }
+#endif
+
   return width;
 }
@@ -475,6 +475,16 @@ void CNxWidget::redraw(void)
 
       CGraphicsPort *port = m_widgetControl->getGraphicsPort();
 
+#ifdef CONFIG_NXWIDGETS_DAMAGE
+      // Skip the widget and its children if it lies entirely outside of
+      // the region being repainted
+
+      if (!port->isVisible(getX(), getY(), getWidth(), getHeight()))
+        {
+          return;
+        }
+#endif
+
       // Draw the Widget
 
       drawBorder(port);
@@ -490,6 +500,40 @@ void CNxWidget::redraw(void)
     }
 }
 
+/**
+ * Mark the widget as needing to be redrawn.  It is repainted at the end of
+ * the current poll, or right away if no poll is running.
+ */
+
+#ifdef CONFIG_NXWIDGETS_DAMAGE
+void CNxWidget::invalidate(void)
+{
+  struct nxgl_rect_s rect;
+  rect.pt1.x = getX();
+  rect.pt1.y = getY();
+  rect.pt2.x = rect.pt1.x + getWidth() - 1;
+  rect.pt2.y = rect.pt1.y + getHeight() - 1;
+
+  m_widgetControl->markDamaged(&rect);
+}
+#endif
+
+/**
+ * Repaint the widget after a change to its state.
+ */
+
+void CNxWidget::markChanged(void)
+{
+#ifdef CONFIG_NXWIDGETS_DAMAGE
+  if (isDrawingEnabled())
+    {
+      invalidate();
+    }
+#else
+  redraw();
+#endif
+}
+
 /**
  * Enables the widget.
  *
@@ -502,7 +546,7 @@ bool CNxWidget::enable(void)
     {
       m_flags.enabled = true;
       onEnable();
-      redraw();
+      markChanged();
       m_widgetEventHandlers->raiseEnableEvent();
       return true;
     }
@@ -522,7 +566,7 @@ bool CNxWidget::disable(void)
     {
       m_flags.enabled = false;
       onDisable();
-      redraw();
+      markChanged();
       m_widgetEventHandlers->raiseDisableEvent();
       return true;
     }
@@ -576,7 +620,7 @@ bool CNxWidget::show(void)
       m_flags.hidden = false;
 
       m_widgetEventHandlers->raiseShowEvent();
-      redraw();
+      markChanged();
       return true;
     }
 
@@ -89,9 +89,39 @@ CRlePaletteBitmap::CRlePaletteBitmap(const struct SRlePaletteBitmap *bitmap)
 {
   m_bitmap      = bitmap;
   m_lut         = bitmap->lut[0];
+  m_rowIndex    = bitmap->rowIndex;
+  m_rowInterval = bitmap->rowInterval;
+  m_ownIndex    = false;
+
+  if (m_rowInterval == 0)
+    {
+      m_rowIndex = (FAR const struct SRlePaletteRowIndex *)NULL;
+    }
+
+#if CONFIG_NXWIDGETS_RLEROWINDEX_INTERVAL > 0
+  // Build our own index if the bitmap does not provide one
+
+  if (!m_rowIndex && bitmap->height > CONFIG_NXWIDGETS_RLEROWINDEX_INTERVAL)
+    {
+      buildRowIndex();
+    }
+#endif
+
   startOfImage();
 }
 
+/**
+ * Destructor.
+ */
+
+CRlePaletteBitmap::~CRlePaletteBitmap(void)
+{
+  if (m_ownIndex)
+    {
+      delete[] m_rowIndex;
+    }
+}
+
 /**
  * Get the bitmap's color format.
  *
@@ -182,21 +212,34 @@ bool CRlePaletteBitmap::getRun(nxgl_coord_t x, nxgl_coord_t y, nxgl_coord_t widt
   if (((unsigned int)x           <  (unsigned int)m_bitmap->width) &&
       ((unsigned int)(x + width) <= (unsigned int)m_bitmap->width))
     {
-      // Seek to the requested row
+      // If the run lies further along the current row (as when a row is
+      // read in several pieces), just skip ahead from here.
 
-      if (!seekRow(y))
+      if (y == m_row && x >= m_col)
         {
-          return false;
+          if (x > m_col && !skipPixels(x - m_col))
+            {
+              return false;
+            }
         }
-
-      // Offset to the starting X position
-
-      if (x > 0)
+      else
         {
-          if (!skipPixels(x))
+          // Seek to the requested row
+
+          if (!seekRow(y))
             {
               return false;
             }
+
+          // Offset to the starting X position
+
+          if (x > 0)
+            {
+              if (!skipPixels(x))
+                {
+                  return false;
+                }
+            }
         }
 
       // Then copy the requested number of pixels
@@ -219,6 +262,53 @@ void CRlePaletteBitmap::startOfImage(void)
   m_remaining   = m_rle->npixels;
 }
 
+/**
+ * Build a row index by decoding the image once.  Used when the bitmap
+ * was not generated with a row index.
+ */
+
+#if CONFIG_NXWIDGETS_RLEROWINDEX_INTERVAL > 0
+void CRlePaletteBitmap::buildRowIndex(void)
+{
+  unsigned int nentries = (m_bitmap->height +
+                           CONFIG_NXWIDGETS_RLEROWINDEX_INTERVAL - 1) /
+                          CONFIG_NXWIDGETS_RLEROWINDEX_INTERVAL;
+
+  FAR struct SRlePaletteRowIndex *index =
+    new struct SRlePaletteRowIndex[nentries];
+
+  if (!index)
+    {
+      return;
+    }
+
+  // Walk the image and record the decoder state at each indexed row
+
+  startOfImage();
+  for (unsigned int i = 0; i < nentries; i++)
+    {
+      nxgl_coord_t row = i * CONFIG_NXWIDGETS_RLEROWINDEX_INTERVAL;
+      while (m_row < row)
+        {
+          if (!nextRow())
+            {
+              // Corrupted image.  Do without the index.
+
+              delete[] index;
+              return;
+            }
+        }
+
+      index[i].offset    = (uint32_t)(m_rle - m_bitmap->data);
+      index[i].remaining = m_remaining;
+    }
+
+  m_rowIndex    = index;
+  m_rowInterval = CONFIG_NXWIDGETS_RLEROWINDEX_INTERVAL;
+  m_ownIndex    = true;
+}
+#endif
+
 /**
  * Advance position data ahead.  Called after npixels have
  * have been consume.
@@ -310,9 +400,33 @@ bool CRlePaletteBitmap::nextRow(void)
 
 bool CRlePaletteBitmap::seekRow(nxgl_coord_t row)
 {
+  if (m_rowIndex)
+    {
+      // Jump to the closest indexed row at or before the requested row
+      // unless the current position is already closer.
+
+      nxgl_coord_t indexRow = row - (row % m_rowInterval);
+
+      if (row < m_row || (row == m_row && m_col != 0) || indexRow > m_row)
+        {
+          if ((unsigned int)row >= (unsigned int)m_bitmap->height)
+            {
+              return false;
+            }
+
+          FAR const struct SRlePaletteRowIndex *entry =
+            &m_rowIndex[row / m_rowInterval];
+
+          m_row       = indexRow;
+          m_col       = 0;
+          m_rle       = &m_bitmap->data[entry->offset];
+          m_remaining = entry->remaining;
+        }
+    }
+
   // Is the current position already past the requested position?
 
-  if (row < m_row || (row == m_row && m_col != 0))
+  else if (row < m_row || (row == m_row && m_col != 0))
     {
       // Yes.. rewind to the beginning of the image
 
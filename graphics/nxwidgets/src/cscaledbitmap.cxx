@@ -39,6 +39,84 @@
  * Pre-Processor Definitions
  ****************************************************************************/
 
+/* Scaled rows are held as packed 0x00RRGGBB values.  This bit marks pixels
+ * that came from a transparent source pixel.
+ */
+
+#define SCALED_TRANSPARENT (1 << 24)
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/**
+ * Get one pixel from an unscaled row as a packed 0x00RRGGBB value.
+ *
+ * @param row - The unscaled row in the bitmap color format
+ * @param col - The column of the pixel
+ */
+
+static inline uint32_t unpackPixel(FAR const uint8_t *row, unsigned int col)
+{
+  uint32_t rgb;
+
+#if CONFIG_NXWIDGETS_FMT == FB_FMT_RGB8_332
+  uint8_t color = row[col];
+  rgb = RGBTO24(RGB8RED(color), RGB8GREEN(color), RGB8BLUE(color));
+
+#elif CONFIG_NXWIDGETS_FMT == FB_FMT_RGB16_565
+  uint16_t color = ((FAR const uint16_t *)row)[col];
+  rgb = RGBTO24(RGB16RED(color), RGB16GREEN(color), RGB16BLUE(color));
+
+#elif CONFIG_NXWIDGETS_FMT == FB_FMT_RGB24
+  FAR const uint8_t *ptr = &row[3 * col];
+  uint32_t color = RGBTO24(ptr[2], ptr[1], ptr[0]);
+  rgb = color;
+
+#elif CONFIG_NXWIDGETS_FMT == FB_FMT_RGB32
+  uint32_t color = ((FAR const uint32_t *)row)[col];
+  rgb = color & 0x00ffffff;
+
+#else
+#  error Unsupported, invalid, or undefined color format
+#endif
+
+  if (color == CONFIG_NXWIDGETS_TRANSPARENT_COLOR)
+    {
+      rgb |= SCALED_TRANSPARENT;
+    }
+
+  return rgb;
+}
+
+/**
+ * Interpolate between two packed colors.  Red and blue are interpolated
+ * together in one 32-bit multiply, then green.  A transparent color is not
+ * interpolated; the closer of the two colors is returned instead.
+ *
+ * @param rgb1 - The first packed color
+ * @param rgb2 - The second packed color
+ * @param weight - The weight of the second color (0-255)
+ */
+
+static inline uint32_t blendPixel(uint32_t rgb1, uint32_t rgb2,
+                                  unsigned int weight)
+{
+  if (((rgb1 | rgb2) & SCALED_TRANSPARENT) != 0)
+    {
+      return weight < 128 ? rgb1 : rgb2;
+    }
+
+  unsigned int remainder = 256 - weight;
+
+  uint32_t rb = ((rgb1 & 0x00ff00ff) * remainder +
+                 (rgb2 & 0x00ff00ff) * weight) >> 8;
+  uint32_t g  = ((rgb1 & 0x0000ff00) * remainder +
+                 (rgb2 & 0x0000ff00) * weight) >> 8;
+
+  return (rb & 0x00ff00ff) | (g & 0x0000ff00);
+}
+
 /****************************************************************************
  * Method Implementations
  ****************************************************************************/
@@ -49,12 +127,20 @@ using namespace NXWidgets;
  * Constructor.
  *
  * @param bitmap The bitmap structure being scaled.
- * @newSize The new, scaled size of the image
+ * @param newSize The new, scaled size of the image
+ * @param mode The scaling mode.
  */
 
-CScaledBitmap::CScaledBitmap(IBitmap *bitmap, struct nxgl_size_s &newSize)
+CScaledBitmap::CScaledBitmap(IBitmap *bitmap, struct nxgl_size_s &newSize,
+                             enum EScaleMode mode)
 : m_bitmap(bitmap), m_size(newSize)
 {
+  m_mode         = (uint8_t)mode;
+  m_rowCache[0]  = (FAR uint8_t *)0;
+  m_rowCache[1]  = (FAR uint8_t *)0;
+  m_scaledRow[0] = (FAR uint32_t *)0;
+  m_scaledRow[1] = (FAR uint32_t *)0;
+
   // xScale will be used to convert a request X position to an X position
   // in the contained bitmap:
   //
@@ -71,12 +157,63 @@ CScaledBitmap::CScaledBitmap(IBitmap *bitmap, struct nxgl_size_s &newSize)
 
   m_yScale = itob16((uint32_t)m_bitmap->getHeight()) / newSize.h;
 
+  // Pre-compute the source column and weight for each scaled column so
+  // that no per-pixel fixed-point arithmetic is needed later.
+
+  nxgl_coord_t bitmapWidth = m_bitmap->getWidth();
+
+  m_colIndex  = new uint16_t[newSize.w];
+  m_colWeight = new uint8_t[newSize.w];
+
+  if (m_colIndex && m_colWeight)
+    {
+      for (nxgl_coord_t x = 0; x < newSize.w; x++)
+        {
+          b16_t column = x * m_xScale;
+          unsigned int col;
+          uint8_t weight;
+
+          if (m_mode == SCALE_NEAREST)
+            {
+              col    = b16toi(column + b16HALF);
+              weight = 0;
+            }
+          else
+            {
+              col    = b16toi(column);
+              weight = (uint8_t)(b16frac(column) >> 8);
+            }
+
+          // There is no column to the right of the last one to blend
+          // with.
+
+          if (col >= (unsigned int)bitmapWidth)
+            {
+              col    = bitmapWidth - 1;
+              weight = 0;
+            }
+          else if (col + 1 >= (unsigned int)bitmapWidth)
+            {
+              weight = 0;
+            }
+
+          m_colIndex[x]  = (uint16_t)col;
+          m_colWeight[x] = weight;
+        }
+    }
+
   // Allocate and initialize the row cache
 
   size_t stride = bitmap->getStride();
   m_rowCache[0] = new uint8_t[stride];
   m_rowCache[1] = new uint8_t[stride];
 
+  if (m_mode == SCALE_BILINEAR)
+    {
+      m_scaledRow[0] = new uint32_t[newSize.w];
+      m_scaledRow[1] = new uint32_t[newSize.w];
+    }
+
   // Read the first two rows into the cache
 
   m_row = m_bitmap->getWidth(); // Set to an impossible value
@@ -91,15 +228,30 @@ CScaledBitmap::~CScaledBitmap(void)
 {
   // Delete the allocated row cache memory
 
-  if (m_rowCache[0])
+  for (int i = 0; i < 2; i++)
     {
-      delete m_rowCache[0];
+      if (m_rowCache[i])
+        {
+          delete[] m_rowCache[i];
+        }
+
+      if (m_scaledRow[i])
+        {
+          delete[] m_scaledRow[i];
+        }
     }
 
-  if (m_rowCache[1])
+  // And the column tables
+
+  if (m_colIndex)
     {
-      delete m_rowCache[1];
-   }
+      delete[] m_colIndex;
+    }
+
+  if (m_colWeight)
+    {
+      delete[] m_colWeight;
+    }
 
   // We are also responsible for deleting the contained IBitmap
 
@@ -185,21 +337,12 @@ const size_t CScaledBitmap::getStride(void) const
 bool CScaledBitmap::getRun(nxgl_coord_t x, nxgl_coord_t y,
                            nxgl_coord_t width, FAR void *data)
 {
-#if CONFIG_NXWIDGETS_FMT == FB_FMT_RGB8_332 || CONFIG_NXWIDGETS_FMT == FB_FMT_RGB24
-  FAR uint8_t  *dest = (FAR uint8_t *)data;
-#elif CONFIG_NXWIDGETS_FMT == FB_FMT_RGB16_565
-  FAR uint16_t *dest = (FAR uint16_t *)data;
-#elif CONFIG_NXWIDGETS_FMT == FB_FMT_RGB32
-  FAR uint32_t *dest = (FAR uint32_t *)data;
-#else
-#  error Unsupported, invalid, or undefined color format
-#endif
-
   // Check ranges.  Casts to unsigned int are ugly but permit one-sided comparisons
 
-  if (((unsigned int)x           >=  (unsigned int)m_size.w) &&
-      ((unsigned int)(x + width) > (unsigned int)m_size.w) &&
-      ((unsigned int)y           <= (unsigned int)m_size.h))
+  if (((unsigned int)x           >= (unsigned int)m_size.w) ||
+      ((unsigned int)(x + width) >  (unsigned int)m_size.w) ||
+      ((unsigned int)y           >= (unsigned int)m_size.h) ||
+      !m_colIndex || !m_colWeight)
     {
       return false;
     }
@@ -208,134 +351,112 @@ bool CScaledBitmap::getRun(nxgl_coord_t x, nxgl_coord_t y,
   // requested y position.  This must be either the exact row or the
   // closest row just before the requested position
 
-  b16_t row16      = y * m_yScale;
-  nxgl_coord_t row = b16toi(row16);
-
-  // Get that row and the one after it into the row cache. We know that
-  // the pixel value that we want is one between the two rows.  This
-  // may seem wasteful to read two entire rows.  However, in normal usage
-  // we will be traversal each image from top-left to bottom-right in
-  // order.  In that case, the caching is most efficient.
+  b16_t row16 = y * m_yScale;
 
-  if (!cacheRows(row))
+  if (m_mode == SCALE_NEAREST)
     {
-      return false;
-    }
-
-  // Now scale and copy the data from the cached row data
-
-  for (int i = 0; i < width; i++, x++)
-    {
-      // Get the column number in the unscaled row corresponding to the
-      // requested x position.  This must be either the exact column or the
-      // closest column just before the requested position
-
-      b16_t column = x * m_xScale;
-
-      // Get the color at the position on the first row
-
-      struct rgbcolor_s color1;
-      if (!rowColor(m_rowCache[0], column, color1))
+      nxgl_coord_t row = b16toi(row16 + b16HALF);
+      if (row >= m_bitmap->getHeight())
         {
-          gerr("ERROR: rowColor failed for the first row\n");
-          return false;
+          row = m_bitmap->getHeight() - 1;
         }
 
-      // Get the color at the position on the first row
-
-      struct rgbcolor_s color2;
-      if (!rowColor(m_rowCache[1], column, color2))
+      if (!cacheRows(row))
         {
-          gerr("ERROR: rowColor failed for the second row\n");
           return false;
         }
 
-      // Check for transparent colors
+      // Copy the closest source pixel of each column
 
-      bool transparent1;
-      bool transparent2;
+      FAR const uint8_t *src = m_rowCache[0];
 
 #if CONFIG_NXWIDGETS_FMT == FB_FMT_RGB8_332
-      uint8_t color = RGBTO8(color1.r, color1.g, color1.b);
-      transparent1 = (color == CONFIG_NXWIDGETS_TRANSPARENT_COLOR);
-
-      color = RGBTO8(color2.r, color2.g, color2.b);
-      transparent2 = (color == CONFIG_NXWIDGETS_TRANSPARENT_COLOR);
+      FAR uint8_t *dest = (FAR uint8_t *)data;
+      for (int i = 0; i < width; i++)
+        {
+          dest[i] = src[m_colIndex[x + i]];
+        }
 
 #elif CONFIG_NXWIDGETS_FMT == FB_FMT_RGB16_565
-      uint16_t color = RGBTO16(color1.r, color1.g, color1.b);
-      transparent1 = (color == CONFIG_NXWIDGETS_TRANSPARENT_COLOR);
-
-      color = RGBTO16(color2.r, color2.g, color2.b);
-      transparent2 = (color == CONFIG_NXWIDGETS_TRANSPARENT_COLOR);
+      FAR uint16_t *dest = (FAR uint16_t *)data;
+      FAR const uint16_t *src16 = (FAR const uint16_t *)src;
+      for (int i = 0; i < width; i++)
+        {
+          dest[i] = src16[m_colIndex[x + i]];
+        }
 
-#elif CONFIG_NXWIDGETS_FMT == FB_FMT_RGB24 || CONFIG_NXWIDGETS_FMT == FB_FMT_RGB32
-      uint32_t color = RGBTO24(color1.r, color1.g, color1.b);
-      transparent1 = (color == CONFIG_NXWIDGETS_TRANSPARENT_COLOR);
+#elif CONFIG_NXWIDGETS_FMT == FB_FMT_RGB24
+      FAR uint8_t *dest = (FAR uint8_t *)data;
+      for (int i = 0; i < width; i++)
+        {
+          FAR const uint8_t *ptr = &src[3 * m_colIndex[x + i]];
+          *dest++ = ptr[0];
+          *dest++ = ptr[1];
+          *dest++ = ptr[2];
+        }
 
-      color = RGBTO24(color2.r, color2.g, color2.b);
-      transparent2 = (color == CONFIG_NXWIDGETS_TRANSPARENT_COLOR);
+#elif CONFIG_NXWIDGETS_FMT == FB_FMT_RGB32
+      FAR uint32_t *dest = (FAR uint32_t *)data;
+      FAR const uint32_t *src32 = (FAR const uint32_t *)src;
+      for (int i = 0; i < width; i++)
+        {
+          dest[i] = src32[m_colIndex[x + i]];
+        }
 
 #else
 #  error Unsupported, invalid, or undefined color format
 #endif
 
-      // Is one of the colors transparent?
+      return true;
+    }
 
-      struct rgbcolor_s scaledColor;
-      b16_t fraction b16frac(row16);
+  // Get that row and the one after it into the row cache. We know that
+  // the pixel value that we want is one between the two rows.  This
+  // may seem wasteful to read two entire rows.  However, in normal usage
+  // we will be traversal each image from top-left to bottom-right in
+  // order.  In that case, the caching is most efficient.
 
-      if (transparent1 || transparent2)
-        {
-          // Yes.. don't interpolate within transparent regions or
-          // between transparent and opaque regions.
+  if (!cacheRows(b16toi(row16)))
+    {
+      return false;
+    }
 
-          // Get the color closest to the requested position
+  // The cached rows are already scaled horizontally.  Interpolate between
+  // them and convert back to the bitmap color format.
 
-          if (fraction < b16HALF)
-            {
-              scaledColor.r = color1.r;
-              scaledColor.g = color1.g;
-              scaledColor.b = color1.b;
-            }
-          else
-            {
-              scaledColor.r = color2.r;
-              scaledColor.g = color2.g;
-              scaledColor.b = color2.b;
-            }
-        }
-      else
-        {
-          // No.. both colors are opaque
+  unsigned int weight      = (unsigned int)(b16frac(row16) >> 8);
+  FAR const uint32_t *row1 = &m_scaledRow[0][x];
+  FAR const uint32_t *row2 = &m_scaledRow[1][x];
 
-          if (!scaleColor(color1, color2, fraction, scaledColor))
-            {
-              return false;
-            }
-        }
+#if CONFIG_NXWIDGETS_FMT == FB_FMT_RGB8_332
+  FAR uint8_t  *dest = (FAR uint8_t *)data;
+#elif CONFIG_NXWIDGETS_FMT == FB_FMT_RGB16_565
+  FAR uint16_t *dest = (FAR uint16_t *)data;
+#elif CONFIG_NXWIDGETS_FMT == FB_FMT_RGB24
+  FAR uint8_t  *dest = (FAR uint8_t *)data;
+#elif CONFIG_NXWIDGETS_FMT == FB_FMT_RGB32
+  FAR uint32_t *dest = (FAR uint32_t *)data;
+#else
+#  error Unsupported, invalid, or undefined color format
+#endif
 
-      // Write the interpolated data to the user buffer
+  for (int i = 0; i < width; i++)
+    {
+      uint32_t rgb = blendPixel(row1[i], row2[i], weight);
 
 #if CONFIG_NXWIDGETS_FMT == FB_FMT_RGB8_332
-      color = RGBTO8(scaledColor.r, scaledColor.g, scaledColor.b);
-      *dest++ = color;
+      *dest++ = RGBTO8(RGB24RED(rgb), RGB24GREEN(rgb), RGB24BLUE(rgb));
 
 #elif CONFIG_NXWIDGETS_FMT == FB_FMT_RGB16_565
-      color = RGBTO16(scaledColor.r, scaledColor.g, scaledColor.b);
-      *dest++ = color;
+      *dest++ = RGBTO16(RGB24RED(rgb), RGB24GREEN(rgb), RGB24BLUE(rgb));
 
 #elif CONFIG_NXWIDGETS_FMT == FB_FMT_RGB24
-      *dest++ = color2.b;
-      *dest++ = color2.r;
-      *dest++ = color2.g;
+      *dest++ = RGB24BLUE(rgb);
+      *dest++ = RGB24GREEN(rgb);
+      *dest++ = RGB24RED(rgb);
 
 #elif CONFIG_NXWIDGETS_FMT == FB_FMT_RGB32
-      color = RGBTO24(scaledColor.r, scaledColor.g, scaledColor.b);
-      *dest++ = color;
-
-#else
-#  error Unsupported, invalid, or undefined color format
+      *dest++ = rgb & 0x00ffffff;
 #endif
     }
 
@@ -350,7 +471,6 @@ bool CScaledBitmap::getRun(nxgl_coord_t x, nxgl_coord_t y,
 
 bool CScaledBitmap::cacheRows(unsigned int row)
 {
-  nxgl_coord_t bitmapWidth  = m_bitmap->getWidth();
   nxgl_coord_t bitmapHeight = m_bitmap->getHeight();
 
   // A common case is to advance by one row.  In this case, we only
@@ -364,6 +484,10 @@ bool CScaledBitmap::cacheRows(unsigned int row)
       m_rowCache[0] = m_rowCache[1];
       m_rowCache[1] = saveRow;
 
+      FAR uint32_t *saveScaled = m_scaledRow[0];
+      m_scaledRow[0] = m_scaledRow[1];
+      m_scaledRow[1] = saveScaled;
+
       // Save number of the first row that we have in the cache
 
       m_row = row;
@@ -375,9 +499,8 @@ bool CScaledBitmap::cacheRows(unsigned int row)
           row = bitmapHeight - 1;
         }
 
-      if (!m_bitmap->getRun(0, row, bitmapWidth, m_rowCache[1]))
+      if (!readRow(row, 1))
         {
-          gerr("ERROR: Failed to read bitmap row %d\n", row);
           return false;
         }
     }
@@ -394,9 +517,8 @@ bool CScaledBitmap::cacheRows(unsigned int row)
           row = bitmapHeight - 1;
         }
 
-      if (!m_bitmap->getRun(0, row, bitmapWidth, m_rowCache[0]))
+      if (!readRow(row, 0))
         {
-          gerr("ERROR: Failed to read bitmap row %d\n", row);
           return false;
         }
 
@@ -411,9 +533,8 @@ bool CScaledBitmap::cacheRows(unsigned int row)
           row = bitmapHeight - 1;
         }
 
-      if (!m_bitmap->getRun(0, row, bitmapWidth, m_rowCache[1]))
+      if (!readRow(row, 1))
         {
-          gerr("ERROR: Failed to read bitmap row %d\n", row);
           return false;
         }
     }
@@ -422,180 +543,55 @@ bool CScaledBitmap::cacheRows(unsigned int row)
 }
 
 /**
- * Given an two RGB colors and a fractional value, return the scaled
- * value between the two colors.
+ * Read one row of the unscaled image into a row cache entry and, in
+ * bilinear mode, scale it horizontally.
  *
- * @param incolor1 - The first color to be used
- * @param incolor2 - The second color to be used
- * @param fraction - The fractional value
- * @param outcolor - The returned, scaled color
+ * @param row - The row number to read
+ * @param index - The row cache entry (0 or 1)
  */
 
-bool CScaledBitmap::scaleColor(FAR const struct rgbcolor_s &incolor1,
-                               FAR const struct rgbcolor_s &incolor2,
-                               b16_t fraction, FAR struct rgbcolor_s &outcolor)
+bool CScaledBitmap::readRow(unsigned int row, int index)
 {
-  uint32_t component;
-  b16_t red;
-  b16_t green;
-  b16_t blue;
-
-  // A fraction of < 0.5 would mean to use use mostly color1; a fraction
-  // greater than 0.5 would men to use mostly color2
-
-  b16_t remainder = b16ONE - fraction;
-
-  // Interpolate each color value  (converting to b15)
-
-  red   = (b16_t)incolor1.r * remainder + (b16_t)incolor2.r * fraction;
-  green = (b16_t)incolor1.g * remainder + (b16_t)incolor2.g * fraction;
-  blue  = (b16_t)incolor1.b * remainder + (b16_t)incolor2.b * fraction;
-
-  // Return the integer, interpolated values, clipping to the range of
-  // uint8_t
+  if (!m_rowCache[index] ||
+      !m_bitmap->getRun(0, row, m_bitmap->getWidth(), m_rowCache[index]))
+    {
+      gerr("ERROR: Failed to read bitmap row %d\n", row);
+      return false;
+    }
 
-  component  = b16toi(red);
-  outcolor.r = component < 256 ? component : 255;
+  if (m_mode == SCALE_BILINEAR)
+    {
+      if (!m_scaledRow[index] || !m_colIndex || !m_colWeight)
+        {
+          return false;
+        }
 
-  component  = b16toi(green);
-  outcolor.g = component < 256 ? component : 255;
+      scaleRow(m_rowCache[index], m_scaledRow[index]);
+    }
 
-  component  = b16toi(blue);
-  outcolor.b = component < 256 ? component : 255;
   return true;
 }
 
 /**
- * Given an image row and a non-integer column offset, return the
- * interpolated RGB color value corresponding to that position
- *
- * @param row - The pointer to the row in the row cache to use
- * @param column - The non-integer column offset
- * @param outcolor - The returned, interpolated color
+ * Scale one unscaled image row horizontally using the pre-computed
+ * column tables.
  *
+ * @param src - The unscaled row in the bitmap color format
+ * @param dest - The scaled row in packed 0x00RRGGBB form
  */
 
-bool CScaledBitmap::rowColor(FAR uint8_t *row, b16_t column,
-                             FAR struct rgbcolor_s &outcolor)
+void CScaledBitmap::scaleRow(FAR const uint8_t *src, FAR uint32_t *dest)
 {
-  // This is the col at or just before the pixel of interest
-
-  nxgl_coord_t col1 = b16toi(column);
-  nxgl_coord_t col2 = col1 + 1;
-
-  nxgl_coord_t bitmapWidth  = m_bitmap->getWidth();
-  if (col2 >= bitmapWidth)
-    {
-      col2 = bitmapWidth - 1;
-    }
-
-  b16_t fraction = b16frac(column);
-
-  struct rgbcolor_s color1;
-  struct rgbcolor_s color2;
-
-  bool transparent1;
-  bool transparent2;
-
-#if CONFIG_NXWIDGETS_FMT == FB_FMT_RGB8_332
-  uint8_t color = row[col1];
-  color1.r = RGB8RED(color);
-  color1.g = RGB8GREEN(color);
-  color1.b = RGB8BLUE(color);
-
-  transparent1 = (color == CONFIG_NXWIDGETS_TRANSPARENT_COLOR);
-
-  color = row[col2];
-  color2.r = RGB8RED(color);
-  color2.g = RGB8GREEN(color);
-  color2.b = RGB8BLUE(color);
-
-  transparent2 = (color == CONFIG_NXWIDGETS_TRANSPARENT_COLOR);
-
-#elif CONFIG_NXWIDGETS_FMT == FB_FMT_RGB16_565
-  FAR uint16_t *row16 = (FAR uint16_t*)row;
-  uint16_t color = row16[col1];
-  color1.r = RGB16RED(color);
-  color1.g = RGB16GREEN(color);
-  color1.b = RGB16BLUE(color);
-
-  transparent1 = (color == CONFIG_NXWIDGETS_TRANSPARENT_COLOR);
-
-  color = row16[col2];
-  color2.r = RGB16RED(color);
-  color2.g = RGB16GREEN(color);
-  color2.b = RGB16BLUE(color);
-
-  transparent2 = (color == CONFIG_NXWIDGETS_TRANSPARENT_COLOR);
+  // Any column without a right-hand neighbour has a weight of zero, so
+  // col + 1 is never read past the end of the row.
 
-#elif CONFIG_NXWIDGETS_FMT == FB_FMT_RGB24
-  unsigned int ndx = 3*col1;
-  color1.r = row[ndx+2];
-  color1.g = row[ndx+1];
-  color1.b = row[ndx];
-
-  uint32_t color = RGBTO24(color1.r, color1.g, color1.b);
-  transparent1 = (color == CONFIG_NXWIDGETS_TRANSPARENT_COLOR);
-
-  ndx      = 3*col2;
-  color2.r = row[ndx+2];
-  color2.g = row[ndx+1];
-  color2.b = row[ndx];
-
-  color = RGBTO24(color2.r, color2.g, color2.b);
-  transparent2 = (color == CONFIG_NXWIDGETS_TRANSPARENT_COLOR);
-
-#elif CONFIG_NXWIDGETS_FMT == FB_FMT_RGB32
-  FAR uint32_t *row32 = (FAR uint32_t*)row;
-  uint32_t color = row32[col1];
-  color1.r = RGB24RED(color);
-  color1.g = RGB24GREEN(color);
-  color1.b = RGB24BLUE(color);
-
-  transparent1 = (color == CONFIG_NXWIDGETS_TRANSPARENT_COLOR);
-
-  color    = row32[col2];
-  color2.r = RGB24RED(color);
-  color2.g = RGB24GREEN(color);
-  color2.b = RGB24BLUE(color);
-
-  transparent2 = (color == CONFIG_NXWIDGETS_TRANSPARENT_COLOR);
-
-#else
-#  error Unsupported, invalid, or undefined color format
-#endif
-
-  // Is one of the colors transparent?
-
-  if (transparent1 || transparent2)
-    {
-      // Yes.. don't interpolate within transparent regions or
-      // between transparent and opaque regions.
-
-      // Return the color closest to the requested position
-      //
-      // A fraction of < 0.5 would mean to use use mostly color1; a fraction
-      // greater than 0.5 would men to use mostly color2
-
-      if (fraction < b16HALF)
-        {
-          outcolor.r = color1.r;
-          outcolor.g = color1.b;
-          outcolor.g = color1.g;
-        }
-      else
-        {
-          outcolor.r = color2.r;
-          outcolor.g = color2.b;
-          outcolor.g = color2.g;
-        }
-
-      return true;
-    }
-  else
+  for (nxgl_coord_t x = 0; x < m_size.w; x++)
     {
-      // No.. both colors are opaque
+      unsigned int col    = m_colIndex[x];
+      unsigned int weight = m_colWeight[x];
+      uint32_t     rgb1   = unpackPixel(src, col);
 
-      return scaleColor(color1, color2, fraction, outcolor);
+      dest[x] = weight == 0 ? rgb1 :
+                blendPixel(rgb1, unpackPixel(src, col + 1), weight);
     }
 }
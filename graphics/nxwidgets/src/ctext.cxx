@@ -64,7 +64,6 @@
 #include <stdbool.h>
 
 #include "graphics/nxwidgets/ctext.hxx"
-#include "graphics/nxwidgets/cstringiterator.hxx"
 
 /****************************************************************************
  * Pre-Processor Definitions
@@ -87,9 +86,13 @@ using namespace NXWidgets;
 CText::CText(CNxFont *font, const CNxString &text, nxgl_coord_t width)
 : CNxString(text)
 {
-  m_font        = font;
-  m_width       = width;
-  m_lineSpacing = 1;
+  m_font             = font;
+  m_width            = width;
+  m_lineSpacing      = 1;
+  m_textPixelWidth   = 0;
+  m_textPixelHeight  = 0;
+  m_firstChangedLine = 0;
+  m_lastChangedLine  = -1;
   wrap();
 }
 
@@ -137,8 +140,9 @@ void CText::setText(const nxwidget_char_t text)
 
 void CText::append(const CNxString &text)
 {
+  int index = getLength();
   CNxString::append(text);
-  wrap(getLength() - 1);
+  reflow(index, getLength() - index, true);
 }
 
 /**
@@ -150,8 +154,9 @@ void CText::append(const CNxString &text)
 
 void CText::insert(const CNxString &text, const int index)
 {
+  int length = getLength();
   CNxString::insert(text, index);
-  wrap(index);
+  reflow(index, getLength() - length, true);
 }
 
 /**
@@ -162,8 +167,9 @@ void CText::insert(const CNxString &text, const int index)
 
 void CText::remove(const int startIndex)
 {
+  int length = getLength();
   CNxString::remove(startIndex);
-  wrap(startIndex);
+  reflow(startIndex, getLength() - length, true);
 }
 
 /**
@@ -175,8 +181,9 @@ void CText::remove(const int startIndex)
 
 void CText::remove(const int startIndex, const int count)
 {
+  int length = getLength();
   CNxString::remove(startIndex, count);
-  wrap(startIndex);
+  reflow(startIndex, getLength() - length, true);
 }
 
 
@@ -244,34 +251,18 @@ const int CText::getLineLength(const int lineNumber) const
 
 const int CText::getLineTrimmedLength(const int lineNumber) const
 {
-  nxgl_coord_t length = getLineLength(lineNumber);
+  int length = getLineLength(lineNumber);
 
-  // Loop through string until the end
+  // Work back from the end of the line until a non-blank char is found
 
-  CStringIterator *iterator = newStringIterator();
+  FAR const nxwidget_char_t *text = &getCharArray()[m_linePositions[lineNumber]];
 
-  // Get char at the end of the line
-
-  if (iterator->moveTo(m_linePositions[lineNumber] + length - 1))
+  while (length > 0 && m_font->isCharBlank(text[length - 1]))
     {
-      do
-        {
-          if (!m_font->isCharBlank(iterator->getChar()))
-            {
-              break;
-            }
-          length--;
-        }
-      while (iterator->moveToPrevious() && (length > 0));
-
-      delete iterator;
-      return length;
+      length--;
     }
 
-  // May occur if data has been horribly corrupted somewhere
-
-  delete iterator;
-  return 0;
+  return length;
 }
 
 /**
@@ -320,22 +311,58 @@ CNxFont *CText::getFont(void) const
 
 void CText::stripTopLines(const int lines)
 {
-  // Get the start point of the text we want to keep
+  if (lines <= 0)
+    {
+      return;
+    }
+
+  // Removing every line is the same as removing all of the text
+
+  if (lines >= getLineCount())
+    {
+      CNxString::remove(0);
+      wrap();
+      return;
+    }
+
+  // Remove the characters from the start of the string to the start of
+  // the first line that we want to keep
 
-  nxgl_coord_t textStart = 0;
+  int textStart = m_linePositions[lines];
+  CNxString::remove(0, textStart);
+
+  // The remaining lines still wrap in the same places.  Move their line
+  // data to the front of the arrays rather than re-wrapping them.
+
+  int lineCount = getLineCount() - lines;
+
+  for (int i = 0; i < lineCount; i++)
+    {
+      m_linePositions[i] = m_linePositions[i + lines] - textStart;
+      m_lineWidths[i]    = m_lineWidths[i + lines];
+    }
+
+  // Copy the end of text marker
+
+  m_linePositions[lineCount] = m_linePositions[lineCount + lines] - textStart;
 
   for (int i = 0; i < lines; i++)
     {
-      textStart += getLineLength(i);
+      m_linePositions.pop_back();
+      m_lineWidths.pop_back();
     }
 
-  // Remove the characters from the start of the string to the found location
+  // Renumber the changed lines
 
-  remove(0, textStart);
+  m_firstChangedLine -= lines;
+  m_lastChangedLine  -= lines;
 
-  // Rewrap the text
+  if (m_firstChangedLine < 0)
+    {
+      m_firstChangedLine = 0;
+    }
 
-  wrap();
+  updateSize(true);
 }
 
 /**
@@ -344,7 +371,7 @@ void CText::stripTopLines(const int lines)
 
 void CText::wrap(void)
 {
-  wrap(0);
+  reflow(0, 0, false);
 }
 
 /**
@@ -356,222 +383,297 @@ void CText::wrap(void)
 
 void CText::wrap(int charIndex)
 {
-  // Declare vars in advance of loop
+  reflow(charIndex, 0, false);
+}
 
-  int pos = 0;
-  int lineWidth;
-  int breakIndex;
-  bool endReached = false;
+/**
+ * Find the end of a single wrapped line.
+ *
+ * @param pos The char index of the start of the line.
+ * @param lineWidth Returns the pixel width of the line.
+ * @return The char index of the start of the following line, or -1 if
+ * the line runs to the end of the text.
+ */
 
-  if (m_linePositions.size() == 0)
-    {
-      charIndex = 0;
-    }
+int CText::wrapLine(int pos, nxgl_coord_t &lineWidth) const
+{
+  FAR const nxwidget_char_t *text = getCharArray();
+  int length     = getLength();
+  int index      = pos;
+  int breakIndex = -1;
 
-  // If we're wrapping from an offset in the text, ensure that any existing data
-  // after the offset gets removed
+  lineWidth = 0;
 
-  if (charIndex > 0)
+  if (pos >= length)
     {
-      // Remove wrapping data past this point
-
-      // Get the index of the line in which the char index appears
+      return -1;
+    }
 
-      int lineIndex = getLineContainingCharIndex(charIndex);
+  // Search for line breaks and valid breakpoints until we exceed the width
+  // of the text field or we run out of string to process
 
-      // Remove any longest line records that occur from the line index onwards
+  for (; ; )
+    {
+      nxwidget_char_t ch = text[index];
+      nxgl_coord_t charWidth = m_font->getCharWidth(ch);
 
-      while ((m_longestLines.size() > 0) &&
-             (m_longestLines[m_longestLines.size() - 1].index >= lineIndex))
+      if (lineWidth + charWidth > m_width)
         {
-          m_longestLines.pop_back();
+          break;
         }
 
-      // If there are any longest line records remaining, update the text pixel width
-      // The last longest line record will always be the last valid longest line as
-      // the vector is sorted by length
+      lineWidth += charWidth;
+
+      // Check for line return
 
-      if (m_longestLines.size() > 0)
+      if (ch == '\n')
         {
-          m_textPixelWidth = m_longestLines[m_longestLines.size() - 1].width;
+          // Remember this breakpoint
+
+          breakIndex = index;
+          break;
         }
-      else
+      else if (ch == ' ' || ch == ',' || ch == '.' || ch == '-' ||
+               ch == ':' || ch == ';' || ch == '?' || ch == '!' ||
+               ch == '+' || ch == '=' || ch == '/' || ch == '\0')
         {
-          m_textPixelWidth = 0;
-        }
+          // Remember the most recent breakpoint
 
-      // Remove any wrapping data from after this line index onwards
-
-      while ((m_linePositions.size() > 0) &&
-             (m_linePositions.size() - 1 > (int)lineIndex))
-       {
-          m_linePositions.pop_back();
+          breakIndex = index;
         }
 
-      // Adjust start position of wrapping loop so that it starts with
-      // the current line index
+      // Move to the next character
 
-      if (m_linePositions.size() > 0)
+      if (++index >= length)
         {
-          pos = m_linePositions[m_linePositions.size() - 1];
+          // No more text; the line runs to the end of the text
+
+          return -1;
         }
     }
-  else
+
+  // If not even the first character fits, it gets a row of its own
+
+  if (index == pos)
     {
-      // Remove all wrapping data
+      return pos + 1;
+    }
 
-      // Wipe the width variable
+  // If we didn't find a breakpoint split at the current position
 
-      m_textPixelWidth = 0;
+  if (breakIndex < 0)
+    {
+      breakIndex = index - 1;
+    }
 
-      // Empty existing longest lines
+  // Trim blank space from the start of the next line
 
-      m_longestLines.clear();
+  while (breakIndex + 2 < length && text[breakIndex + 1] == ' ')
+    {
+      breakIndex++;
+    }
 
-      // Empty existing line positions
+  return breakIndex + 1;
+}
 
-      m_linePositions.clear();
+/**
+ * Re-wrap the text after a change.  Wrapping starts with the line
+ * before the one containing the changed char index.  If resync is
+ * true, wrapping stops as soon as a line starts at the same place
+ * (shifted by delta) as it did before the change; the rest of the old
+ * layout is kept.
+ *
+ * @param charIndex The index of the first changed char.
+ * @param delta The number of chars inserted (positive) or removed
+ * (negative) at charIndex.
+ * @param resync True to stop once the wrapping matches the old layout.
+ */
+
+void CText::reflow(int charIndex, int delta, bool resync)
+{
+  int oldCount  = m_linePositions.size() - 1;
+  int startLine = 0;
 
-      // Push first line start into vector
+  if (oldCount < 1)
+    {
+      // There is no existing layout
 
+      m_linePositions.clear();
+      m_lineWidths.clear();
       m_linePositions.push_back(0);
+
+      oldCount = 0;
+      resync   = false;
     }
+  else if (charIndex > 0)
+    {
+      // Line starts before charIndex are not affected by the change.
+      // Start with the previous line because removing text may allow the
+      // start of the changed line to move up onto it.
 
-  // Loop through string until the end
+      startLine = getLineContainingCharIndex(charIndex);
+      if (startLine > 0)
+        {
+          startLine--;
+        }
+    }
+
+  // Chars in the old text at or after oldEditEnd are unchanged by the edit
+
+  int oldEditEnd = charIndex + (delta < 0 ? -delta : 0);
+  int oldLine    = startLine + 1;
+  int resyncLine = -1;
+  int pos        = m_linePositions[startLine];
 
-  CStringIterator *iterator = newStringIterator();
+  TNxArray<int>          newPositions;
+  TNxArray<nxgl_coord_t> newWidths;
 
-  while (!endReached)
+  for (; ; )
     {
-      breakIndex = 0;
-      lineWidth = 0;
+      nxgl_coord_t lineWidth;
+      int next = wrapLine(pos, lineWidth);
+      newWidths.push_back(lineWidth);
 
-      if (iterator->moveTo(pos))
+      if (next < 0)
         {
-          // Search for line breaks and valid breakpoints until we
-          // exceed the width of the text field or we run out of
-          // string to process
+          break;
+        }
+
+      if (resync)
+        {
+          // Does an unchanged line of the old layout start here?  If so,
+          // all of the following lines wrap as they did before.
+
+          while (oldLine < oldCount && m_linePositions[oldLine] + delta < next)
+            {
+              oldLine++;
+            }
 
-          while (lineWidth + m_font->getCharWidth(iterator->getChar()) <= m_width)
+          if (oldLine < oldCount && m_linePositions[oldLine] + delta == next &&
+              m_linePositions[oldLine] >= oldEditEnd)
             {
-              lineWidth += m_font->getCharWidth(iterator->getChar());
-
-              // Check for line return
-
-              if (iterator->getChar() == '\n')
-                {
-                  // Remember this breakpoint
-
-                  breakIndex = iterator->getIndex();
-                  break;
-                }
-              else if ((iterator->getChar() == ' ') ||
-                       (iterator->getChar() == ',') ||
-                       (iterator->getChar() == '.') ||
-                       (iterator->getChar() == '-') ||
-                       (iterator->getChar() == ':') ||
-                       (iterator->getChar() == ';') ||
-                       (iterator->getChar() == '?') ||
-                       (iterator->getChar() == '!') ||
-                       (iterator->getChar() == '+') ||
-                       (iterator->getChar() == '=') ||
-                       (iterator->getChar() == '/') ||
-                       (iterator->getChar() == '\0'))
-                {
-                  // Remember the most recent breakpoint
-
-                  breakIndex = iterator->getIndex();
-                }
-
-              // Move to the next character
-
-              if (!iterator->moveToNext())
-                {
-                  // No more text; abort loop
-
-                  endReached = true;
-                  break;
-                }
+              resyncLine = oldLine;
+              break;
             }
         }
-      else
+
+      newPositions.push_back(next);
+      pos = next;
+    }
+
+  // Replace the line data of the re-wrapped lines.  If the wrapping did not
+  // re-synchronise, the end of text marker is replaced too.
+
+  int endLine = resyncLine >= 0 ? resyncLine : oldCount;
+  int nNew    = newPositions.size();
+  int nOld    = endLine - startLine - 1;
+  bool rescan = false;
+
+  for (int i = startLine; i < endLine; i++)
+    {
+      if (m_lineWidths[i] >= m_textPixelWidth)
         {
-          endReached = true;
+          rescan = true;
         }
+    }
+
+  if (resyncLine < 0)
+    {
+      // Discard everything after the start line and append the new lines
 
-      if ((!endReached) && (iterator->getIndex() > pos))
+      while (m_linePositions.size() > startLine + 1)
         {
-          // Process any found data
+          m_linePositions.pop_back();
+        }
 
-          // If we didn't find a breakpoint split at the current position
+      while (m_lineWidths.size() > startLine)
+        {
+          m_lineWidths.pop_back();
+        }
 
-          if (breakIndex == 0)
-            {
-              breakIndex = iterator->getIndex() - 1;
-            }
+      for (int i = 0; i < nNew; i++)
+        {
+          m_linePositions.push_back(newPositions[i]);
+        }
 
-          // Trim blank space from the start of the next line
+      for (int i = 0; i <= nNew; i++)
+        {
+          m_lineWidths.push_back(newWidths[i]);
+        }
 
-          CStringIterator *breakIterator = newStringIterator();
+      m_linePositions.push_back(getLength());
+    }
+  else
+    {
+      // Overwrite the lines that exist in both layouts, then insert or
+      // remove the difference
 
-          if (breakIterator->moveTo(breakIndex + 1))
-            {
-              while (breakIterator->getChar() == ' ')
-                {
-                  if (breakIterator->moveToNext())
-                    {
-                      breakIndex++;
-                    }
-                  else
-                    {
-                      break;
-                    }
-                }
-            }
+      int common = nNew < nOld ? nNew : nOld;
 
-          delete breakIterator;
+      m_lineWidths[startLine] = newWidths[0];
+      for (int i = 0; i < common; i++)
+        {
+          m_linePositions[startLine + 1 + i] = newPositions[i];
+          m_lineWidths[startLine + 1 + i]    = newWidths[i + 1];
+        }
 
-          // Add the start of the next line to the vector
+      for (int i = common; i < nNew; i++)
+        {
+          m_linePositions.insert(startLine + 1 + i, newPositions[i]);
+          m_lineWidths.insert(startLine + 1 + i, newWidths[i + 1]);
+        }
 
-          pos = breakIndex + 1;
-          m_linePositions.push_back(pos);
+      for (int i = common; i < nOld; i++)
+        {
+          m_linePositions.erase(startLine + 1 + nNew);
+          m_lineWidths.erase(startLine + 1 + nNew);
+        }
 
-          // Is this the longest line observed so far?
+      // The following lines, and the end of text marker, only move
 
-          if (lineWidth > m_textPixelWidth)
+      if (delta != 0)
+        {
+          for (int i = startLine + 1 + nNew; i < m_linePositions.size(); i++)
             {
-              m_textPixelWidth = lineWidth;
-
-              // Push the description of the line into the longest lines
-              // vector (note that we store the index in m_linePositions that
-              // refers to the start of the line, *not* the position of the
-              // line in the char array)
-
-              LongestLine line;
-              line.index = m_linePositions.size() - 2;
-              line.width = lineWidth;
-              m_longestLines.push_back(line);
+              m_linePositions[i] += delta;
             }
         }
-      else if (!endReached)
-        {
-          // Add a blank row if we're not at the end of the string
+    }
+
+  m_firstChangedLine = startLine;
+  m_lastChangedLine  = startLine + nNew;
 
-          pos++;
-          m_linePositions.push_back(pos);
+  for (int i = 0; i <= nNew; i++)
+    {
+      if (newWidths[i] > m_textPixelWidth)
+        {
+          m_textPixelWidth = newWidths[i];
         }
     }
 
-  // Add marker indicating end of text
-  // If we reached the end of the text, append the stopping point
+  updateSize(rescan);
+}
+
+/**
+ * Recalculate the height of the text and, if needed, its width.
+ *
+ * @param rescan True if the widest line may have been removed.
+ */
 
-  if ((unsigned int)m_linePositions[m_linePositions.size() - 1] != getLength() + 1)
+void CText::updateSize(bool rescan)
+{
+  if (rescan)
     {
-      m_linePositions.push_back(getLength());
+      m_textPixelWidth = 0;
+      for (int i = 0; i < m_lineWidths.size(); i++)
+        {
+          if (m_lineWidths[i] > m_textPixelWidth)
+            {
+              m_textPixelWidth = m_lineWidths[i];
+            }
+        }
     }
 
-  delete iterator;
-
   // Calculate the total height of the text
 
   m_textPixelHeight = getLineCount() * (m_font->getHeight() + m_lineSpacing);
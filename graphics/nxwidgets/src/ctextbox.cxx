@@ -537,18 +537,7 @@ const nxgl_coord_t CTextBox::getCursorXPos(void) const
 {
   // Calculate position of cursor
 
-  nxgl_coord_t cursorX = 0;
-
-  CStringIterator *iterator = m_text.newStringIterator();
-
-  for (nxgl_coord_t i = 0; i < m_cursorPos; i++)
-    {
-      cursorX += getFont()->getCharWidth(iterator->getChar());
-      iterator->moveToNext();
-    }
-
-  delete iterator;
-  return cursorX;
+  return getFont()->getStringWidth(m_text, 0, m_cursorPos);
 }
 
 /**
@@ -30,6 +30,7 @@
 #include <cstdbool>
 #include <cstring>
 #include <cerrno>
+#include <climits>
 
 #include <debug.h>
 #include <sched.h>
@@ -48,6 +49,13 @@
  * Pre-Processor Definitions
  ****************************************************************************/
 
+/* The input queues are written by the NX listener thread and read by the
+ * thread that calls pollEvents().  The barrier orders the accesses to the
+ * queue entries and the head and tail indices.
+ */
+
+#define INPUT_BARRIER() __sync_synchronize()
+
 /****************************************************************************
  * Global Static Data
  ****************************************************************************/
@@ -92,9 +100,20 @@ CWidgetControl::CWidgetControl(FAR const CWidgetStyle *style)
 
 #ifdef CONFIG_NX_XYINPUT
   memset(&m_xyinput, 0, sizeof(struct SXYInput));
+  m_mouseHead          = 0;
+  m_mouseTail          = 0;
+  m_mouseButtons       = 0;
 #endif
-  m_nCh                = 0;
+  m_kbdHead            = 0;
+  m_kbdTail            = 0;
+  m_droppedEvents      = 0;
+  m_coalescedEvents    = 0;
   m_nCc                = 0;
+#ifdef CONFIG_NXWIDGETS_DAMAGE
+  m_nDamage            = 0;
+  m_nPolls             = 0;
+  m_painting           = false;
+#endif
 
   // Initialize semaphores:
   //
@@ -220,6 +239,7 @@ void CWidgetControl::postWindowEvent(void)
  *   pollMouseEvents(widget)
  *   pollKeyboardEvents()
  *   pollCursorControlEvents()
+ *   redrawDamage()
  *
  * @param widget.  Specific widget to poll.  Use NULL to run the
  *    all widgets in the window.
@@ -228,6 +248,15 @@ void CWidgetControl::postWindowEvent(void)
 
 bool CWidgetControl::pollEvents(CNxWidget *widget)
 {
+#ifdef CONFIG_NXWIDGETS_DAMAGE
+  // Damage reported while the events are handled is repainted in one pass
+  // at the end of the poll
+
+  sched_lock();
+  m_nPolls++;
+  sched_unlock();
+#endif
+
   // Delete any queued widgets
 
   processDeleteQueue();
@@ -243,8 +272,222 @@ bool CWidgetControl::pollEvents(CNxWidget *widget)
   // Handle cursor control input
 
   bool cursorControlEvent = pollCursorControlEvents();
+
+#ifdef CONFIG_NXWIDGETS_DAMAGE
+  // Repaint everything that was damaged by the events above (or by NX)
+  // in a single pass.  If another thread is already repainting, it picks
+  // up this damage as well.
+
+  bool redrawEvent = false;
+
+  sched_lock();
+  m_nPolls--;
+  bool paint = !m_painting;
+  m_painting = true;
+  sched_unlock();
+
+  if (paint)
+    {
+      redrawEvent = paintDamage();
+    }
+
+  return mouseEvent || keyboardEvent || cursorControlEvent || redrawEvent;
+#else
   return mouseEvent || keyboardEvent || cursorControlEvent;
+#endif
+}
+
+/**
+ * Mark a region of the window as needing to be redrawn.  Overlapping
+ * regions are merged.  While pollEvents() is running the region is left
+ * for the single repaint pass at the end of the poll.  Otherwise nothing
+ * would poll again until the next input event, so the region is
+ * repainted before this method returns.  This method may be called from
+ * the NX listener thread.
+ *
+ * @param rect The window-relative region to be redrawn.
+ */
+
+#ifdef CONFIG_NXWIDGETS_DAMAGE
+void CWidgetControl::markDamaged(FAR const struct nxgl_rect_s *rect)
+{
+  if (nxgl_nullrect(rect))
+    {
+      return;
+    }
+
+  struct nxgl_rect_s damage;
+  nxgl_rectcopy(&damage, rect);
+
+  // Disable pre-emption; the damage list is shared with the NX listener
+  // thread
+
+  sched_lock();
+
+  // Absorb every region that overlaps the new one.  The grown region may
+  // now overlap regions that were already checked so start over after
+  // each merge.
+
+  int i = 0;
+  while (i < m_nDamage)
+    {
+      if (nxgl_rectoverlap(&m_damage[i], &damage))
+        {
+          nxgl_rectunion(&damage, &damage, &m_damage[i]);
+          m_nDamage--;
+          nxgl_rectcopy(&m_damage[i], &m_damage[m_nDamage]);
+          i = 0;
+        }
+      else
+        {
+          i++;
+        }
+    }
+
+  if (m_nDamage < CONFIG_NXWIDGETS_DAMAGE_NRECTS)
+    {
+      nxgl_rectcopy(&m_damage[m_nDamage], &damage);
+      m_nDamage++;
+    }
+  else
+    {
+      // The list is full.  Merge into the region that grows the least.
+
+      int  best     = 0;
+      long bestArea = LONG_MAX;
+
+      for (i = 0; i < m_nDamage; i++)
+        {
+          struct nxgl_rect_s merged;
+          nxgl_rectunion(&merged, &m_damage[i], &damage);
+
+          long area = (long)(merged.pt2.x - merged.pt1.x + 1) *
+                      (long)(merged.pt2.y - merged.pt1.y + 1);
+          if (area < bestArea)
+            {
+              best     = i;
+              bestArea = area;
+            }
+        }
+
+      nxgl_rectunion(&m_damage[best], &m_damage[best], &damage);
+    }
+
+  // Repaint now unless a poll or another repaint will pick this up
+
+  bool paint = m_nPolls == 0 && !m_painting;
+  if (paint)
+    {
+      m_painting = true;
+    }
+
+  sched_unlock();
+
+  if (paint)
+    {
+      paintDamage();
+    }
+}
+#endif
+
+/**
+ * Repaint damaged regions until none are left.  The caller must have set
+ * m_painting; it is cleared when the damage list is empty.  Damage that
+ * is reported while painting, by this or another thread, is then painted
+ * here too, and only one thread paints at a time.
+ *
+ * @return True if any region was redrawn.
+ */
+
+#ifdef CONFIG_NXWIDGETS_DAMAGE
+bool CWidgetControl::paintDamage(void)
+{
+  bool redrawn = false;
+
+  for (; ; )
+    {
+      if (redrawDamage())
+        {
+          redrawn = true;
+        }
+
+      sched_lock();
+      if (m_nDamage == 0)
+        {
+          m_painting = false;
+          sched_unlock();
+          break;
+        }
+
+      sched_unlock();
+    }
+
+  return redrawn;
+}
+#endif
+
+/**
+ * Repaint all damaged regions.  For each region, drawing is clipped to
+ * the region and only the widgets that intersect it are redrawn.  The
+ * window redraw event is then raised once for each region so that the
+ * event handlers can repaint anything that is not a widget.
+ *
+ * @return True if any region was redrawn.
+ */
+
+#ifdef CONFIG_NXWIDGETS_DAMAGE
+bool CWidgetControl::redrawDamage(void)
+{
+  struct nxgl_rect_s damage[CONFIG_NXWIDGETS_DAMAGE_NRECTS];
+
+  // Take the current damage list so that new damage can be reported
+  // while we are drawing
+
+  sched_lock();
+  int nDamage = m_nDamage;
+  for (int i = 0; i < nDamage; i++)
+    {
+      nxgl_rectcopy(&damage[i], &m_damage[i]);
+    }
+
+  m_nDamage = 0;
+  sched_unlock();
+
+  if (nDamage == 0)
+    {
+      return false;
+    }
+
+  if (m_port != NULL)
+    {
+      for (int i = 0; i < nDamage; i++)
+        {
+          m_port->setClipRect(&damage[i]);
+
+          // Redraw each top-level widget.  The widgets redraw their
+          // children and skip everything outside of the clipping region.
+
+          for (int j = 0; j < m_widgets.size(); j++)
+            {
+              CNxWidget *widget = m_widgets[j];
+              if (widget->getParent() == NULL)
+                {
+                  widget->redraw();
+                }
+            }
+        }
+
+      m_port->setClipRect((FAR const struct nxgl_rect_s *)NULL);
+    }
+
+  for (int i = 0; i < nDamage; i++)
+    {
+      m_eventHandlers.raiseRedrawEvent(&damage[i], i + 1 < nDamage);
+    }
+
+  return true;
 }
+#endif
 
 /**
  * Get the index of the specified controlled widget.
@@ -423,7 +666,14 @@ void CWidgetControl::geometryEvent(NXHANDLE hWindow,
 
 void CWidgetControl::redrawEvent(FAR const struct nxgl_rect_s *nxRect, bool more)
 {
+#ifdef CONFIG_NXWIDGETS_DAMAGE
+  // Queue the exposed region.  It is repainted, and the redraw event
+  // raised, at the end of the current poll or else right away.
+
+  markDamaged(nxRect);
+#else
   m_eventHandlers.raiseRedrawEvent(nxRect, more);
+#endif
 }
 
 /**
@@ -431,6 +681,10 @@ void CWidgetControl::redrawEvent(FAR const struct nxgl_rect_s *nxRect, bool more
  * certain NX-server related events. This event, in particular, means that
  * new mouse data is available for the window.
  *
+ * The event is only queued here; it is handled on the next call to
+ * pollEvents().  This runs on the NX listener thread and is the only
+ * writer of m_mouseHead, so no lock is needed.
+ *
  * @param pos The (x,y) position of the mouse.
  * @param buttons See NX_MOUSE_* definitions.
  */
@@ -438,123 +692,29 @@ void CWidgetControl::redrawEvent(FAR const struct nxgl_rect_s *nxRect, bool more
 #ifdef CONFIG_NX_XYINPUT
 void CWidgetControl::newMouseEvent(FAR const struct nxgl_point_s *pos, uint8_t buttons)
 {
-  // Save the mouse X/Y position
-
-  m_xyinput.x = pos->x;
-  m_xyinput.y = pos->y;
+  uint8_t head = m_mouseHead;
 
-  // Update button press states
-
-  clearMouseEvents();
-
-  if ((buttons & NX_MOUSE_LEFTBUTTON) != 0)
+  if ((uint8_t)(head - m_mouseTail) >= CONFIG_NXWIDGETS_MOUSEBUFFER_SIZE)
     {
-      // Handle left button press events.  leftHeld means that the left mouse
-      // button was pressed on the previous sample as well.
-
-      if (m_xyinput.leftHeld)
-        {
-          m_xyinput.leftDrag = 1;
-        }
-      else
-        {
-          // New left button press
-
-          m_xyinput.leftPressed = 1;
-
-          clock_gettime(CLOCK_REALTIME, &m_xyinput.leftPressTime);
-
-          // Check for double click event
-
-          if (elapsedTime(&m_xyinput.leftReleaseTime) <= CONFIG_NXWIDGETS_DOUBLECLICK_TIME)
-            {
-              m_xyinput.doubleClick = 1;
-            }
-        }
+      // The queue is full.  The event is lost.
 
-      m_xyinput.leftHeld = 1;
+      m_droppedEvents++;
     }
   else
     {
-      // Handle left button release events
+      FAR struct SMouseSample *sample =
+        &m_mouseQueue[head & (CONFIG_NXWIDGETS_MOUSEBUFFER_SIZE - 1)];
 
-      if (m_xyinput.leftHeld)
-        {
-          // New left button release
+      sample->x       = pos->x;
+      sample->y       = pos->y;
+      sample->buttons = buttons;
 
-          m_xyinput.leftReleased  = 1;
-          clock_gettime(CLOCK_REALTIME, &m_xyinput.leftReleaseTime);
-        }
+      // Make sure that the event is written before it is published
 
-      m_xyinput.leftHeld = 0;
+      INPUT_BARRIER();
+      m_mouseHead = head + 1;
     }
 
-#if 0 // Center and right buttons not used
-  if ((buttons & NX_MOUSE_CENTERBUTTON) != 0)
-    {
-      // Handle center button press events.  centerHeld means that the center mouse
-      // button was pressed on the previous sample as well.
-
-      if (m_xyinput.centerHeld)
-        {
-          m_xyinput.centerDrag = 1;
-        }
-      else
-        {
-          // New center button press
-
-          m_xyinput.centerPressed = 1;
-        }
-
-      m_xyinput.centerHeld = 1;
-    }
-  else
-    {
-      // Handle center button release events
-
-      if (m_xyinput.centerHeld)
-        {
-          // New center button release
-
-          m_xyinput.centerReleased = 1;
-        }
-
-      m_xyinput.centerHeld = 0;
-    }
-
-  if ((buttons & NX_MOUSE_RIGHTBUTTON) != 0)
-    {
-      // Handle right button press events.  rightHeld means that the right mouse
-      // button was pressed on the previous sample as well.
-
-      if (m_xyinput.rightHeld)
-        {
-          m_xyinput.rightDrag = 1;
-        }
-      else
-        {
-          // New right button press
-
-          m_xyinput.rightPressed = 1;
-        }
-
-      m_xyinput.rightHeld = 1;
-    }
-  else
-    {
-      // Handle right button release events
-
-      if (m_xyinput.rightHeld)
-        {
-          // New right button release
-
-          m_xyinput.rightReleased = 1;
-        }
-
-      m_xyinput.rightHeld = 0;
-    }
-#endif
-
   // Notify any external logic that a mouse event has occurred
 
   m_eventHandlers.raiseMouseEvent(pos, buttons);
@@ -579,17 +739,36 @@ void CWidgetControl::newMouseEvent(FAR const struct nxgl_point_s *pos, uint8_t b
 #ifdef CONFIG_NX_KBD
 void CWidgetControl::newKeyboardEvent(uint8_t nCh, FAR const uint8_t *pStr)
 {
-  FAR uint8_t *buffer = &m_kbdbuf[m_nCh];
+  uint8_t head = m_kbdHead;
 
-  // Append each new character to keyboard character buffer
+  // Append each new character to the keyboard character queue.  This runs
+  // on the NX listener thread and is the only writer of m_kbdHead.
 
-  for (uint8_t i = 0;
-       i < nCh && m_nCh < CONFIG_NXWIDGETS_KBDBUFFER_SIZE;
-       i++, m_nCh++)
+  for (uint8_t i = 0; i < nCh; i++)
     {
-      *buffer++ = *pStr++;
+      uint8_t next = head + 1;
+      if (next > CONFIG_NXWIDGETS_KBDBUFFER_SIZE)
+        {
+          next = 0;
+        }
+
+      if (next == m_kbdTail)
+        {
+          // The queue is full.  The remaining characters are lost.
+
+          m_droppedEvents += nCh - i;
+          break;
+        }
+
+      m_kbdbuf[head] = pStr[i];
+      head           = next;
     }
 
+  // Make sure that the characters are written before they are published
+
+  INPUT_BARRIER();
+  m_kbdHead = head;
+
   // Notify any external logic that a keyboard event has occurred
 
   m_eventHandlers.raiseKeyboardEvent();
@@ -775,6 +954,13 @@ void CWidgetControl::processDeleteQueue(void)
 /**
  * Process mouse/touchscreen events and send throughout the hierarchy.
  *
+ * Events are taken from the queue filled by newMouseEvent().  An event
+ * that presses or releases a button is always handled on its own, at its
+ * own position, so that clicks and the start of drags land where they
+ * happened.  Consecutive motion events with an unchanged button state are
+ * coalesced so that only the latest position is sent; a drag costs one
+ * redraw per poll no matter how fast the input device reports.
+ *
  * @param widget. Specific widget to poll.  Use NULL to run the
  *    all widgets in the window.
  * @return True means an interesting mouse event occurred
@@ -783,55 +969,59 @@ void CWidgetControl::processDeleteQueue(void)
 bool CWidgetControl::pollMouseEvents(CNxWidget *widget)
 {
 #ifdef CONFIG_NX_XYINPUT
-  bool mouseEvent = false;  // Assume that no interesting mouse event occurred
-
-  // Left click event for all widgets
+  bool    mouseEvent = false;  // Assume that no interesting mouse event occurred
+  uint8_t tail       = m_mouseTail;
 
-  if (m_xyinput.leftPressed)
+  for (; ; )
     {
-       // Handle a new left button press event
+      uint8_t head = m_mouseHead;
+      if (tail == head)
+        {
+          break;
+        }
 
-       if (handleLeftClick(m_xyinput.x, m_xyinput.y, widget))
-         {
-           mouseEvent = true;
-         }
-    }
+      // Make sure that the events are read after the head was read
 
-  // Drag event for the clicked widget
+      INPUT_BARRIER();
 
-  if (!mouseEvent && m_xyinput.leftDrag)
-    {
-      // The left button is still being held down
+      struct SMouseSample sample =
+        m_mouseQueue[tail++ & (CONFIG_NXWIDGETS_MOUSEBUFFER_SIZE - 1)];
 
-      if (m_clickedWidget != NULL)
-        {
-          // Handle a mouse drag event
+      // If this is motion with no change in button state, skip to the last
+      // of the following events that have the same button state
 
-          m_clickedWidget->drag(m_xyinput.x, m_xyinput.y,
-                                m_xyinput.x - m_xyinput.lastX,
-                                m_xyinput.y - m_xyinput.lastY);
-          mouseEvent = true;
-        }
-    }
+      if (sample.buttons == m_mouseButtons)
+        {
+          while (tail != head)
+            {
+              FAR const struct SMouseSample *next =
+                &m_mouseQueue[tail & (CONFIG_NXWIDGETS_MOUSEBUFFER_SIZE - 1)];
 
-  // Check for release event on the clicked widget
+              if (next->buttons != sample.buttons)
+                {
+                  break;
+                }
 
-  if (!mouseEvent && m_clickedWidget != NULL)
-    {
-      // Mouse left button release event
+              sample = *next;
+              tail++;
+              m_coalescedEvents++;
+            }
+        }
 
-      m_clickedWidget->release(m_xyinput.x, m_xyinput.y);
-      mouseEvent = true;
-    }
+      m_mouseButtons = sample.buttons;
 
-  // Clear all press and release events once they have been processed
+      // Release the queue entries before handling the event
 
-  clearMouseEvents();
+      INPUT_BARRIER();
+      m_mouseTail = tail;
 
-  // Save the mouse position for the next poll
+      updateMouseState(&sample);
+      if (dispatchMouseState(widget))
+        {
+          mouseEvent = true;
+        }
+    }
 
-  m_xyinput.lastX = m_xyinput.x;
-  m_xyinput.lastY = m_xyinput.y;
   return mouseEvent;
 #else
   return false;
@@ -846,7 +1036,13 @@ bool CWidgetControl::pollMouseEvents(CNxWidget *widget)
 
 bool CWidgetControl::pollKeyboardEvents(void)
 {
-  bool keyboardEvent = false;  // Assume no interesting keyboard events
+  bool    keyboardEvent = false;  // Assume no interesting keyboard events
+  uint8_t tail          = m_kbdTail;
+  uint8_t head          = m_kbdHead;
+
+  // Make sure that the characters are read after the head was read
+
+  INPUT_BARRIER();
 
   // Keyboard presses with no focused widget is not an interesting
   // event
@@ -855,16 +1051,22 @@ bool CWidgetControl::pollKeyboardEvents(void)
     {
       // Forward each character to the widget with the focus
 
-      for (uint8_t i = 0; i < m_nCh; i++)
+      for (uint8_t i = tail; i != head; )
         {
           m_focusedWidget->keyPress((nxwidget_char_t)m_kbdbuf[i]);
           keyboardEvent = true;
+
+          if (++i > CONFIG_NXWIDGETS_KBDBUFFER_SIZE)
+            {
+              i = 0;
+            }
         }
     }
 
-  // All of the buffered characters have been consumed
+  // All of the queued characters have been consumed
 
-  m_nCh = 0;
+  INPUT_BARRIER();
+  m_kbdTail = head;
   return keyboardEvent;
 }
 
@@ -992,4 +1194,192 @@ void CWidgetControl::clearMouseEvents(void)
 
   m_xyinput.doubleClick    = 0;
 }
+
+/**
+ * Update the mouse/touchscreen state with a queued event.
+ *
+ * @param sample The event.
+ */
+
+void CWidgetControl::updateMouseState(FAR const struct SMouseSample *sample)
+{
+  // Save the mouse X/Y position
+
+  m_xyinput.x = sample->x;
+  m_xyinput.y = sample->y;
+
+  // Update button press states
+
+  clearMouseEvents();
+
+  if ((sample->buttons & NX_MOUSE_LEFTBUTTON) != 0)
+    {
+      // Handle left button press events.  leftHeld means that the left mouse
+      // button was pressed on the previous sample as well.
+
+      if (m_xyinput.leftHeld)
+        {
+          m_xyinput.leftDrag = 1;
+        }
+      else
+        {
+          // New left button press
+
+          m_xyinput.leftPressed = 1;
+
+          clock_gettime(CLOCK_REALTIME, &m_xyinput.leftPressTime);
+
+          // Check for double click event
+
+          if (elapsedTime(&m_xyinput.leftReleaseTime) <= CONFIG_NXWIDGETS_DOUBLECLICK_TIME)
+            {
+              m_xyinput.doubleClick = 1;
+            }
+        }
+
+      m_xyinput.leftHeld = 1;
+    }
+  else
+    {
+      // Handle left button release events
+
+      if (m_xyinput.leftHeld)
+        {
+          // New left button release
+
+          m_xyinput.leftReleased  = 1;
+          clock_gettime(CLOCK_REALTIME, &m_xyinput.leftReleaseTime);
+        }
+
+      m_xyinput.leftHeld = 0;
+    }
+
+#if 0 // Center and right buttons not used
+  if ((sample->buttons & NX_MOUSE_CENTERBUTTON) != 0)
+    {
+      // Handle center button press events.  centerHeld means that the center mouse
+      // button was pressed on the previous sample as well.
+
+      if (m_xyinput.centerHeld)
+        {
+          m_xyinput.centerDrag = 1;
+        }
+      else
+        {
+          // New center button press
+
+          m_xyinput.centerPressed = 1;
+        }
+
+      m_xyinput.centerHeld = 1;
+    }
+  else
+    {
+      // Handle center button release events
+
+      if (m_xyinput.centerHeld)
+        {
+          // New center button release
+
+          m_xyinput.centerReleased = 1;
+        }
+
+      m_xyinput.centerHeld = 0;
+    }
+
+  if ((sample->buttons & NX_MOUSE_RIGHTBUTTON) != 0)
+    {
+      // Handle right button press events.  rightHeld means that the right mouse
+      // button was pressed on the previous sample as well.
+
+      if (m_xyinput.rightHeld)
+        {
+          m_xyinput.rightDrag = 1;
+        }
+      else
+        {
+          // New right button press
+
+          m_xyinput.rightPressed = 1;
+        }
+
+      m_xyinput.rightHeld = 1;
+    }
+  else
+    {
+      // Handle right button release events
+
+      if (m_xyinput.rightHeld)
+        {
+          // New right button release
+
+          m_xyinput.rightReleased = 1;
+        }
+
+      m_xyinput.rightHeld = 0;
+    }
+#endif
+}
+
+/**
+ * Send the current mouse/touchscreen state throughout the hierarchy.
+ *
+ * @param widget.  Specific widget to poll.  Use NULL to run the
+ *    all widgets in the window.
+ * @return True means an interesting mouse event occurred
+ */
+
+bool CWidgetControl::dispatchMouseState(CNxWidget *widget)
+{
+  bool mouseEvent = false;  // Assume that no interesting mouse event occurred
+
+  // Left click event for all widgets
+
+  if (m_xyinput.leftPressed)
+    {
+       // Handle a new left button press event
+
+       if (handleLeftClick(m_xyinput.x, m_xyinput.y, widget))
+         {
+           mouseEvent = true;
+         }
+    }
+
+  // Drag event for the clicked widget
+
+  if (!mouseEvent && m_xyinput.leftDrag)
+    {
+      // The left button is still being held down
+
+      if (m_clickedWidget != NULL)
+        {
+          // Handle a mouse drag event
+
+          m_clickedWidget->drag(m_xyinput.x, m_xyinput.y,
+                                m_xyinput.x - m_xyinput.lastX,
+                                m_xyinput.y - m_xyinput.lastY);
+          mouseEvent = true;
+        }
+    }
+
+  // Check for release event on the clicked widget
+
+  if (!mouseEvent && m_clickedWidget != NULL)
+    {
+      // Mouse left button release event
+
+      m_clickedWidget->release(m_xyinput.x, m_xyinput.y);
+      mouseEvent = true;
+    }
+
+  // Clear all press and release events once they have been processed
+
+  clearMouseEvents();
+
+  // Save the mouse position for the next poll
+
+  m_xyinput.lastX = m_xyinput.x;
+  m_xyinput.lastY = m_xyinput.y;
+  return mouseEvent;
+}
 #endif
@@ -71,6 +71,8 @@
 #include "graphics/nxwidgets/cnxstring.hxx"
 #include "graphics/nxwidgets/cwidgetstyle.hxx"
 #include "graphics/nxwidgets/cnxfont.hxx"
+#include "graphics/nxwidgets/cglyphcache.hxx"
+#include "graphics/nxwidgets/cbitmapmask.hxx"
 #include "graphics/nxwidgets/singletons.hxx"
 
 /****************************************************************************
@@ -86,6 +88,12 @@ using namespace NXWidgets;
 CWidgetStyle        *NXWidgets::g_defaultWidgetStyle; /**< The default widget style */
 CNxString           *NXWidgets::g_nullString;         /**< The reusable empty string */
 TNxArray<CNxTimer*> *NXWidgets::g_nxTimers;           /**< An array of all timers */
+#ifdef CONFIG_NXWIDGETS_GLYPHCACHE
+CGlyphCache         *NXWidgets::g_glyphCache;         /**< Shared rendered glyph cache */
+#endif
+#ifdef CONFIG_NXWIDGETS_BITMAPMASK
+CBitmapMaskCache    *NXWidgets::g_bitmapMasks;        /**< Shared bitmap mask cache */
+#endif
 
 /****************************************************************************
  * Method Implementations
@@ -147,6 +155,24 @@ void NXWidgets::instantiateSingletons(void)
       g_nxTimers = new TNxArray<CNxTimer*>();
     }
 
+#ifdef CONFIG_NXWIDGETS_GLYPHCACHE
+  // Create the glyph cache that is shared by all graphics ports
+
+  if (!g_glyphCache)
+    {
+      g_glyphCache = new CGlyphCache();
+    }
+#endif
+
+#ifdef CONFIG_NXWIDGETS_BITMAPMASK
+  // Create the transparency mask cache that is shared by all graphics ports
+
+  if (!g_bitmapMasks)
+    {
+      g_bitmapMasks = new CBitmapMaskCache();
+    }
+#endif
+
   sched_unlock();
 }
 
@@ -185,4 +211,23 @@ void NXWidgets::freeSingletons(void)
       g_nxTimers = NULL;
     }
 
+#ifdef CONFIG_NXWIDGETS_GLYPHCACHE
+  // Free the glyph cache
+
+  if (g_glyphCache)
+    {
+      delete g_glyphCache;
+      g_glyphCache = NULL;
+    }
+#endif
+
+#ifdef CONFIG_NXWIDGETS_BITMAPMASK
+  // Free the bitmap mask cache
+
+  if (g_bitmapMasks)
+    {
+      delete g_bitmapMasks;
+      g_bitmapMasks = NULL;
+    }
+#endif
 }
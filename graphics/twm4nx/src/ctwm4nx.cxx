@@ -46,9 +46,11 @@
 #include <cstring>
 #include <cassert>
 #include <cerrno>
+#include <ctime>
 
 #include <fcntl.h>
 #include <semaphore.h>
+#include <syslog.h>
 
 #include <nuttx/semaphore.h>
 #include <nuttx/nx/nx.h>
@@ -79,6 +81,29 @@ using namespace Twm4Nx;
 
 const char Twm4Nx::GNoName[] = "Untitled";  // Name if no name is specified
 
+/////////////////////////////////////////////////////////////////////////////
+// Private Functions
+/////////////////////////////////////////////////////////////////////////////
+
+#if CONFIG_TWM4NX_MOVE_MAXFPS > 0 || defined(CONFIG_TWM4NX_EVENTSTATS)
+/**
+ * Return the time in microseconds from one time to a later time.
+ *
+ * @param start.  The earlier time.
+ * @param end.  The later time.
+ * @return The elapsed time in microseconds.
+ */
+
+static uint32_t elapsedUsec(FAR const struct timespec *start,
+                            FAR const struct timespec *end)
+{
+  int64_t usec = (int64_t)(end->tv_sec - start->tv_sec) * 1000000 +
+                 (end->tv_nsec - start->tv_nsec) / 1000;
+
+  return usec < 0 ? 0 : (uint32_t)usec;
+}
+#endif
+
 /////////////////////////////////////////////////////////////////////////////
 // CTwm4Nx Implementation
 /////////////////////////////////////////////////////////////////////////////
@@ -104,6 +129,18 @@ CTwm4Nx::CTwm4Nx(int display)
 #if !defined(CONFIG_TWM4NX_NOKEYBOARD) || !defined(CONFIG_TWM4NX_NOMOUSE)
   m_input                = (FAR CInput *)0;
 #endif
+
+#if CONFIG_TWM4NX_MOVE_MAXFPS > 0
+  m_movePending          = false;
+  m_lastMove.tv_sec      = 0;
+  m_lastMove.tv_nsec     = 0;
+#endif
+
+#ifdef CONFIG_TWM4NX_EVENTSTATS
+  std::memset(m_stats, 0, sizeof(m_stats));
+  m_maxBacklog           = 0;
+  clock_gettime(CLOCK_REALTIME, &m_statsTime);
+#endif
 }
 
 /**
@@ -307,43 +344,70 @@ bool CTwm4Nx::initialize(void)
 
 bool CTwm4Nx::eventLoop(void)
 {
+  union UEventMsg batch[CONFIG_TWM4NX_EVENT_BATCH];
+
   // Enter the event loop
 
   twminfo("Entering event loop\n");
   for (; ; )
     {
-      // Wait for the next NxWidget event
-
-      union
-      {
-        struct SEventMsg eventmsg;
-        char buffer[MAX_EVENT_MSGSIZE];
-      } u;
+      // Wait for the next NxWidget event and collect any others that are
+      // already queued
 
-      int ret = mq_receive(m_eventq, u.buffer, MAX_EVENT_MSGSIZE,
-                           (FAR unsigned int *)0);
-      if (ret < 0)
+      int nmsgs = receiveEvents(batch);
+      if (nmsgs < 0)
         {
-          twmerr("ERROR: mq_receive failed: %d\n", errno);
           cleanup();
           return false;
         }
 
-      // If we are resizing, then drop all non-critical events (of course,
-      // all resizing events must be critical)
-
-      if (!m_resize->resizing() || EVENT_ISCRITICAL(u.eventmsg.eventID))
+      for (int i = 0; i < nmsgs; i++)
         {
-          // Dispatch the new event
+          FAR struct SEventMsg *eventmsg = &batch[i].eventmsg;
+
+          // A move is superseded by a following move of the same object.
+          // The handlers track the previous position themselves, so only
+          // the last one needs to be handled.
 
-          if (!dispatchEvent(&u.eventmsg))
+          if (i + 1 < nmsgs && isMergeableEvent(eventmsg->eventID) &&
+              batch[i + 1].eventmsg.eventID == eventmsg->eventID &&
+              batch[i + 1].eventmsg.obj == eventmsg->obj)
+            {
+#ifdef CONFIG_TWM4NX_EVENTSTATS
+              m_stats[EVENT_RECIPIENT(eventmsg->eventID) >> 12].merged++;
+#endif
+              continue;
+            }
+
+          if (!handleEvent(eventmsg))
             {
               twmerr("ERROR: dispatchEvent() failed, eventID=%u\n",
-                     u.eventmsg.eventID);
+                     eventmsg->eventID);
+              cleanup();
+              return false;
+            }
+        }
+
+#if CONFIG_TWM4NX_MOVE_MAXFPS > 0
+      // Perform a held back move if it is now due
+
+      if (m_movePending)
+        {
+          struct timespec now;
+          clock_gettime(CLOCK_REALTIME, &now);
+
+          if (elapsedUsec(&m_lastMove, &now) >=
+              1000000 / CONFIG_TWM4NX_MOVE_MAXFPS && !flushMove())
+            {
               cleanup();
               return false;
             }
         }
+#endif
+
+#ifdef CONFIG_TWM4NX_EVENTSTATS
+      reportStats();
+#endif
     }
 
   return true;  // Not reachable
@@ -504,6 +568,256 @@ bool CTwm4Nx::dispatchEvent(FAR struct SEventMsg *eventmsg)
   return ret;
 }
 
+/**
+ * Wait for the next event then read all other events that are already
+ * queued, up to CONFIG_TWM4NX_EVENT_BATCH events, without blocking.  If a
+ * move is being held back by the rate limit, wait only until it is due.
+ *
+ * @param batch.  The buffer to receive the events.
+ * @return The number of events received (possibly zero) or a negative
+ *   value on any failure.
+ */
+
+int CTwm4Nx::receiveEvents(FAR union UEventMsg *batch)
+{
+  int ret;
+
+#if CONFIG_TWM4NX_MOVE_MAXFPS > 0
+  if (m_movePending)
+    {
+      // Wait no longer than the time when the held back move is due
+
+      struct timespec deadline;
+      deadline.tv_sec  = m_lastMove.tv_sec;
+      deadline.tv_nsec = m_lastMove.tv_nsec +
+                         1000000000 / CONFIG_TWM4NX_MOVE_MAXFPS;
+
+      if (deadline.tv_nsec >= 1000000000)
+        {
+          deadline.tv_sec++;
+          deadline.tv_nsec -= 1000000000;
+        }
+
+      ret = mq_timedreceive(m_eventq, batch[0].buffer, MAX_EVENT_MSGSIZE,
+                            (FAR unsigned int *)0, &deadline);
+      if (ret < 0 && errno == ETIMEDOUT)
+        {
+          return 0;
+        }
+    }
+  else
+#endif
+    {
+      ret = mq_receive(m_eventq, batch[0].buffer, MAX_EVENT_MSGSIZE,
+                       (FAR unsigned int *)0);
+    }
+
+  if (ret < 0)
+    {
+      twmerr("ERROR: mq_receive failed: %d\n", errno);
+      return ret;
+    }
+
+  // Twm4Nx is the only reader of the queue, so receiving the events that
+  // are already queued will not block
+
+  int nmsgs = 1;
+
+  struct mq_attr attr;
+  if (mq_getattr(m_eventq, &attr) == 0)
+    {
+      long queued = attr.mq_curmsgs;
+
+#ifdef CONFIG_TWM4NX_EVENTSTATS
+      if ((unsigned int)queued + 1 > m_maxBacklog)
+        {
+          m_maxBacklog = (unsigned int)queued + 1;
+        }
+#endif
+
+      for (; queued > 0 && nmsgs < CONFIG_TWM4NX_EVENT_BATCH; queued--)
+        {
+          ret = mq_receive(m_eventq, batch[nmsgs].buffer, MAX_EVENT_MSGSIZE,
+                           (FAR unsigned int *)0);
+          if (ret < 0)
+            {
+              break;
+            }
+
+          nmsgs++;
+        }
+    }
+
+  return nmsgs;
+}
+
+/**
+ * Handle one event received by the event loop.  Events that are not
+ * critical are dropped during a resize operation and moves are held back
+ * if they arrive faster than CONFIG_TWM4NX_MOVE_MAXFPS.
+ *
+ * @param eventmsg.  The received NxWidget event message.
+ * @return True if the message was properly handled.  false is
+ *   return on any failure.
+ */
+
+bool CTwm4Nx::handleEvent(FAR struct SEventMsg *eventmsg)
+{
+  // If we are resizing, then drop all non-critical events (of course,
+  // all resizing events must be critical)
+
+  if (m_resize->resizing() && !EVENT_ISCRITICAL(eventmsg->eventID))
+    {
+      return true;
+    }
+
+#if CONFIG_TWM4NX_MOVE_MAXFPS > 0
+  if (isMergeableEvent(eventmsg->eventID))
+    {
+      // A held back move of another object must be performed first
+
+      if (m_movePending &&
+          (m_pendingMove.eventID != eventmsg->eventID ||
+           m_pendingMove.obj != eventmsg->obj) &&
+          !flushMove())
+        {
+          return false;
+        }
+
+      struct timespec now;
+      clock_gettime(CLOCK_REALTIME, &now);
+
+      if (elapsedUsec(&m_lastMove, &now) < 1000000 / CONFIG_TWM4NX_MOVE_MAXFPS)
+        {
+          // Too soon.  Hold the move back, replacing any older one.
+
+#ifdef CONFIG_TWM4NX_EVENTSTATS
+          if (m_movePending)
+            {
+              m_stats[EVENT_RECIPIENT(eventmsg->eventID) >> 12].merged++;
+            }
+#endif
+
+          m_pendingMove = *eventmsg;
+          m_movePending = true;
+          return true;
+        }
+
+      m_movePending = false;
+      m_lastMove    = now;
+    }
+  else if (!flushMove())
+    {
+      // Any held back move must be performed before the event that
+      // follows it (such as the release that ends the drag)
+
+      return false;
+    }
+#endif
+
+  return timedDispatch(eventmsg);
+}
+
+/**
+ * Dispatch an event and, if enabled, account for its dispatch time.
+ *
+ * @param eventmsg.  The received NxWidget event message.
+ * @return True if the message was properly dispatched.  false is
+ *   return on any failure.
+ */
+
+bool CTwm4Nx::timedDispatch(FAR struct SEventMsg *eventmsg)
+{
+#ifdef CONFIG_TWM4NX_EVENTSTATS
+  struct timespec start;
+  struct timespec end;
+
+  clock_gettime(CLOCK_REALTIME, &start);
+  bool ret = dispatchEvent(eventmsg);
+  clock_gettime(CLOCK_REALTIME, &end);
+
+  FAR struct SEventStats *stats =
+    &m_stats[EVENT_RECIPIENT(eventmsg->eventID) >> 12];
+  uint32_t usec = elapsedUsec(&start, &end);
+
+  stats->count++;
+  stats->totalUsec += usec;
+  if (usec > stats->maxUsec)
+    {
+      stats->maxUsec = usec;
+    }
+
+  return ret;
+#else
+  return dispatchEvent(eventmsg);
+#endif
+}
+
+#if CONFIG_TWM4NX_MOVE_MAXFPS > 0
+/**
+ * Dispatch the move held back by the rate limit, if any.
+ *
+ * @return True if there was no move or it was properly dispatched.
+ */
+
+bool CTwm4Nx::flushMove(void)
+{
+  if (!m_movePending)
+    {
+      return true;
+    }
+
+  m_movePending = false;
+  clock_gettime(CLOCK_REALTIME, &m_lastMove);
+
+  // The event is copied because the handler may queue new events
+
+  struct SEventMsg eventmsg = m_pendingMove;
+  return timedDispatch(&eventmsg);
+}
+#endif
+
+#ifdef CONFIG_TWM4NX_EVENTSTATS
+/**
+ * Report and reset the event loop statistics if the report interval has
+ * elapsed.
+ */
+
+void CTwm4Nx::reportStats(void)
+{
+  struct timespec now;
+  clock_gettime(CLOCK_REALTIME, &now);
+
+  if (now.tv_sec - m_statsTime.tv_sec < CONFIG_TWM4NX_EVENTSTATS_INTERVAL)
+    {
+      return;
+    }
+
+  syslog(LOG_INFO, "Twm4Nx events: max backlog %u\n", m_maxBacklog);
+
+  for (int i = 0; i < 16; i++)
+    {
+      FAR struct SEventStats *stats = &m_stats[i];
+
+      if (stats->count > 0 || stats->merged > 0)
+        {
+          syslog(LOG_INFO,
+                 "  recipient %x: %lu dispatched, %lu merged, "
+                 "avg %lu usec, max %lu usec\n",
+                 i, (unsigned long)stats->count,
+                 (unsigned long)stats->merged,
+                 (unsigned long)(stats->count > 0 ?
+                                 stats->totalUsec / stats->count : 0),
+                 (unsigned long)stats->maxUsec);
+        }
+    }
+
+  std::memset(m_stats, 0, sizeof(m_stats));
+  m_maxBacklog = 0;
+  m_statsTime  = now;
+}
+#endif
+
 /**
  * Cleanup and exit Twm4Nx abnormally.
  */
@@ -81,6 +81,26 @@ extern "C"
 int exec_builtin(FAR const char *appname, FAR char * const *argv,
                  FAR const struct nsh_param_s *param);
 
+/****************************************************************************
+ * Name: builtin_find
+ *
+ * Description:
+ *   Find a builtin application by name.  This is equivalent to
+ *   builtin_isavail() but uses a binary search of the builtin list, which
+ *   the build sorts by application name.
+ *
+ * Input Parameter:
+ *   appname - The name of the application
+ *
+ * Returned Value:
+ *   The index of the application that can be passed to
+ *   builtin_for_index() on success; -ENOENT if there is no application
+ *   with that name.
+ *
+ ****************************************************************************/
+
+int builtin_find(FAR const char *appname);
+
 #undef EXTERN
 #if defined(__cplusplus)
 }
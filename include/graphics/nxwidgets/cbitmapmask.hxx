@@ -0,0 +1,204 @@
+/****************************************************************************
+ * apps/include/graphics/nxwidgets/cbitmapmask.hxx
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.  The
+ * ASF licenses this file to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance with the
+ * License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ *
+ ****************************************************************************/
+
+#ifndef __APPS_INCLUDE_GRAPHICS_NXWIDGETS_CBITMAPMASK_HXX
+#define __APPS_INCLUDE_GRAPHICS_NXWIDGETS_CBITMAPMASK_HXX
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <semaphore.h>
+
+#include <nuttx/nx/nxglib.h>
+
+#include "graphics/nxwidgets/nxconfig.hxx"
+
+#ifdef CONFIG_NXWIDGETS_BITMAPMASK
+
+/****************************************************************************
+ * Implementation Classes
+ ****************************************************************************/
+
+#if defined(__cplusplus)
+
+namespace NXWidgets
+{
+  struct SBitmap;
+
+  /**
+   * A 1 bit-per-pixel mask of the non-transparent pixels of a bitmap.  Bit
+   * (x & 31) of word (y * rowWords + (x >> 5)) is set if the pixel at x,y
+   * is not the transparent color.  Bits beyond the width of the bitmap are
+   * clear.
+   */
+
+  struct SBitmapMask
+  {
+    FAR const void *data;        /**< Pixel data the mask was built from */
+    nxgl_mxpixel_t  transparent; /**< Transparent color */
+    nxgl_coord_t    width;       /**< Width of the bitmap in pixels */
+    nxgl_coord_t    height;      /**< Height of the bitmap in rows */
+    uint16_t        stride;      /**< Width of the bitmap in bytes */
+    uint16_t        rowWords;    /**< Width of one mask row in words */
+    uint32_t        age;         /**< Time of the last use */
+    FAR uint32_t   *bits;        /**< The mask */
+    unsigned int    nbits;       /**< Size of the mask allocation in words */
+    bool            opaque;      /**< True: No pixel is transparent */
+    bool            empty;       /**< True: Every pixel is transparent */
+  };
+
+  /**
+   * CBitmapMaskCache holds the transparency masks of recently drawn
+   * bitmaps so that CGraphicsPort::drawBitmap() does not need to compare
+   * every pixel against the transparent color each time an icon is drawn.
+   * Masks are identified by the address of the pixel data, the size of the
+   * bitmap and the transparent color.  When the cache is full, the least
+   * recently used mask is replaced.
+   *
+   * The pixel data is not checked when a mask is found, so a bitmap whose
+   * pixels are modified, or whose memory is freed and may be reused, must
+   * be removed with invalidate().
+   */
+
+  class CBitmapMaskCache
+  {
+  private:
+    struct SBitmapMask m_masks[CONFIG_NXWIDGETS_BITMAPMASK_NENTRIES]; /**< Masks */
+    sem_t    m_exclsem;                 /**< Mutual exclusion */
+    uint32_t m_clock;                   /**< Incremented on each lookup */
+    uint32_t m_hits;                    /**< Masks found in cache */
+    uint32_t m_misses;                  /**< Masks built */
+
+    /**
+     * Build the mask of a bitmap into a mask entry.
+     *
+     * @param mask The entry to build into.
+     * @param bitmap The bitmap.
+     * @param transparentColor The transparent color of the bitmap.
+     * @return True if the mask was built; false if memory could not be
+     *   allocated.
+     */
+
+    bool buildMask(FAR struct SBitmapMask *mask,
+                   FAR const struct SBitmap *bitmap,
+                   nxgl_mxpixel_t transparentColor);
+
+    /**
+     * Copy constructor is private to prevent usage.
+     */
+
+    inline CBitmapMaskCache(const CBitmapMaskCache &cache) { }
+
+  public:
+
+    /**
+     * Constructor.
+     */
+
+    CBitmapMaskCache(void);
+
+    /**
+     * Destructor.
+     */
+
+    ~CBitmapMaskCache(void);
+
+    /**
+     * Lock the cache.  The mask returned by getMask() remains valid only
+     * until the cache is unlocked.
+     */
+
+    inline void lock(void)
+    {
+      while (sem_wait(&m_exclsem) < 0);
+    }
+
+    /**
+     * Unlock the cache.
+     */
+
+    inline void unlock(void)
+    {
+      sem_post(&m_exclsem);
+    }
+
+    /**
+     * Get the transparency mask of a bitmap.  If the mask is not in the
+     * cache, it is built in place of the least recently used mask.  The
+     * cache must be locked.
+     *
+     * @param bitmap The bitmap.
+     * @param transparentColor The transparent color of the bitmap.
+     * @return The mask or NULL if memory could not be allocated.
+     */
+
+    FAR const struct SBitmapMask *getMask(FAR const struct SBitmap *bitmap,
+                                          nxgl_mxpixel_t transparentColor);
+
+    /**
+     * Discard the masks of bitmaps that use the given pixel data.  This
+     * must be called when the pixel data of a drawn bitmap is modified or
+     * freed.  The cache must not be locked.
+     *
+     * @param data The pixel data of the bitmap.
+     */
+
+    void invalidate(FAR const void *data);
+
+    /**
+     * Discard all cached masks.  The cache must not be locked.
+     */
+
+    void flush(void);
+
+    /**
+     * Get the number of masks found in the cache.
+     *
+     * @return The number of cache hits.
+     */
+
+    inline uint32_t getHits(void) const
+    {
+      return m_hits;
+    }
+
+    /**
+     * Get the number of masks that had to be built.
+     *
+     * @return The number of cache misses.
+     */
+
+    inline uint32_t getMisses(void) const
+    {
+      return m_misses;
+    }
+  };
+}
+
+#endif // __cplusplus
+#endif // CONFIG_NXWIDGETS_BITMAPMASK
+#endif // __APPS_INCLUDE_GRAPHICS_NXWIDGETS_CBITMAPMASK_HXX
@@ -206,10 +206,12 @@ namespace NXWidgets
                  CWidgetStyle *style = NULL);
 
     /**
-     * Destructor.
+     * Destructor.  The glyphs belong to the caller, so any transparency
+     * masks cached for them are discarded before their memory can be
+     * reused.
      */
 
-    virtual inline ~CGlyphButton(void) { }
+    virtual ~CGlyphButton(void);
 
     /**
      * Insert the dimensions that this widget wants to have into the rect
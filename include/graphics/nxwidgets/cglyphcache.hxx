@@ -0,0 +1,283 @@
+/****************************************************************************
+ * apps/include/graphics/nxwidgets/cglyphcache.hxx
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.  The
+ * ASF licenses this file to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance with the
+ * License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ *
+ ****************************************************************************/
+
+#ifndef __APPS_INCLUDE_GRAPHICS_NXWIDGETS_CGLYPHCACHE_HXX
+#define __APPS_INCLUDE_GRAPHICS_NXWIDGETS_CGLYPHCACHE_HXX
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <semaphore.h>
+
+#include <nuttx/nx/nxglib.h>
+#include <nuttx/nx/nxfonts.h>
+
+#include "graphics/nxwidgets/nxconfig.hxx"
+
+#ifdef CONFIG_NXWIDGETS_GLYPHCACHE
+
+/****************************************************************************
+ * Pre-Processor Definitions
+ ****************************************************************************/
+
+/**
+ * Number of glyph slots that fit in the configured memory budget.
+ */
+
+#define GLYPHCACHE_NSLOTS \
+  (CONFIG_NXWIDGETS_GLYPHCACHE_SIZE / CONFIG_NXWIDGETS_GLYPHCACHE_SLOTSIZE)
+
+/**
+ * Slot index used to terminate the LRU and hash chains.
+ */
+
+#define GLYPHCACHE_NONE   0xffff
+
+#if GLYPHCACHE_NSLOTS < 1
+#  error "CONFIG_NXWIDGETS_GLYPHCACHE_SIZE is smaller than one slot"
+#endif
+
+#if GLYPHCACHE_NSLOTS >= GLYPHCACHE_NONE
+#  error "Too many glyph cache slots"
+#endif
+
+/****************************************************************************
+ * Implementation Classes
+ ****************************************************************************/
+
+#if defined(__cplusplus)
+
+namespace NXWidgets
+{
+  class  CNxFont;
+  struct SBitmap;
+
+  /**
+   * CGlyphCache holds pre-rendered, opaque glyph bitmaps so that redrawing
+   * the same text reduces to a sequence of blits.  Glyphs are stored in a
+   * fixed pool of equally sized slots.  Each slot is identified by the font
+   * ID, the character, the foreground color and the background color.  When
+   * the pool is full, the least recently used glyph is replaced.
+   *
+   * Glyphs drawn transparently cannot be cached because their background
+   * comes from the display.
+   */
+
+  class CGlyphCache
+  {
+  private:
+    /**
+     * Describes one cached glyph.
+     */
+
+    struct SGlyphSlot
+    {
+      nxgl_mxpixel_t   color;      /**< Foreground (font) color */
+      nxgl_mxpixel_t   background; /**< Background color */
+      enum nx_fontid_e fontId;     /**< Font the glyph was rendered from */
+      nxwidget_char_t  letter;     /**< The character */
+      uint16_t         prev;       /**< Next more recently used slot */
+      uint16_t         next;       /**< Next less recently used slot */
+      uint16_t         hnext;      /**< Next slot in the same hash bucket */
+      uint16_t         stride;     /**< Width of the glyph in bytes */
+      nxgl_coord_t     width;      /**< Width of the glyph in pixels */
+      nxgl_coord_t     height;     /**< Height of the glyph in rows */
+      bool             inuse;      /**< True: Slot holds a valid glyph */
+    };
+
+    struct SGlyphSlot m_slots[GLYPHCACHE_NSLOTS];  /**< Slot descriptors */
+    uint16_t  m_hash[GLYPHCACHE_NSLOTS];           /**< Hash bucket heads */
+    FAR uint8_t *m_pool;                           /**< Glyph memory */
+    uint16_t  m_head;                              /**< Most recently used */
+    uint16_t  m_tail;                              /**< Least recently used */
+    sem_t     m_exclsem;                           /**< Mutual exclusion */
+    uint32_t  m_hits;                              /**< Glyphs found in cache */
+    uint32_t  m_misses;                            /**< Glyphs rendered */
+    uint32_t  m_evictions;                         /**< Glyphs replaced */
+
+    /**
+     * Compute the hash bucket for a glyph.
+     */
+
+    static inline unsigned int hash(enum nx_fontid_e fontId,
+                                    nxwidget_char_t letter,
+                                    nxgl_mxpixel_t color,
+                                    nxgl_mxpixel_t background)
+    {
+      uint32_t key = ((uint32_t)fontId << 16) ^ (uint32_t)letter;
+      key ^= (uint32_t)color * 2654435761u;
+      key ^= (uint32_t)background * 40503u;
+      return (unsigned int)(key % GLYPHCACHE_NSLOTS);
+    }
+
+    /**
+     * Remove a slot from the LRU list.
+     *
+     * @param index The slot to remove.
+     */
+
+    void unlinkLru(uint16_t index);
+
+    /**
+     * Insert a slot at the most-recently-used end of the LRU list.
+     *
+     * @param index The slot to insert.
+     */
+
+    void linkLru(uint16_t index);
+
+    /**
+     * Remove a slot from its hash bucket.
+     *
+     * @param index The slot to remove.
+     */
+
+    void unlinkHash(uint16_t index);
+
+    /**
+     * Return a pointer to the glyph memory of a slot.
+     */
+
+    inline FAR uint8_t *slotData(uint16_t index) const
+    {
+      return &m_pool[(size_t)index * CONFIG_NXWIDGETS_GLYPHCACHE_SLOTSIZE];
+    }
+
+    /**
+     * Copy constructor is private to prevent usage.
+     */
+
+    inline CGlyphCache(const CGlyphCache &cache) { }
+
+  public:
+
+    /**
+     * Constructor.  Allocates the glyph pool.
+     */
+
+    CGlyphCache(void);
+
+    /**
+     * Destructor.
+     */
+
+    ~CGlyphCache(void);
+
+    /**
+     * Lock the cache.  The bitmap returned by getGlyph() remains valid
+     * only until the cache is unlocked.
+     */
+
+    inline void lock(void)
+    {
+      while (sem_wait(&m_exclsem) < 0);
+    }
+
+    /**
+     * Unlock the cache.
+     */
+
+    inline void unlock(void)
+    {
+      sem_post(&m_exclsem);
+    }
+
+    /**
+     * Get an opaque, rendered glyph.  If the glyph is not in the cache, it
+     * is rendered into a free (or the least recently used) slot.  The cache
+     * must be locked.
+     *
+     * @param font The font to render with.  The current font color is used
+     *   as the foreground color.
+     * @param letter The character to render.
+     * @param width The width of the glyph in pixels (including xoffset).
+     * @param height The height of the glyph in rows.
+     * @param background The background color of the glyph.
+     * @param bitmap Location to return the glyph bitmap.
+     * @return True if the bitmap was returned; false if the glyph is too
+     *   large to fit in a cache slot.
+     */
+
+    bool getGlyph(FAR CNxFont *font, nxwidget_char_t letter,
+                  nxgl_coord_t width, nxgl_coord_t height,
+                  nxgl_mxpixel_t background, FAR struct SBitmap *bitmap);
+
+    /**
+     * Discard all cached glyphs.
+     */
+
+    void flush(void);
+
+    /**
+     * Get the number of glyphs found in the cache.
+     *
+     * @return The number of cache hits.
+     */
+
+    inline uint32_t getHits(void) const
+    {
+      return m_hits;
+    }
+
+    /**
+     * Get the number of glyphs that had to be rendered.
+     *
+     * @return The number of cache misses.
+     */
+
+    inline uint32_t getMisses(void) const
+    {
+      return m_misses;
+    }
+
+    /**
+     * Get the number of glyphs that were replaced to make room for another.
+     *
+     * @return The number of evictions.
+     */
+
+    inline uint32_t getEvictions(void) const
+    {
+      return m_evictions;
+    }
+
+    /**
+     * Reset the hit, miss and eviction counters.
+     */
+
+    inline void resetStatistics(void)
+    {
+      m_hits      = 0;
+      m_misses    = 0;
+      m_evictions = 0;
+    }
+  };
+}
+
+#endif // __cplusplus
+#endif // CONFIG_NXWIDGETS_GLYPHCACHE
+#endif // __APPS_INCLUDE_GRAPHICS_NXWIDGETS_CGLYPHCACHE_HXX
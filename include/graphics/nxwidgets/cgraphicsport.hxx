@@ -99,6 +99,39 @@ namespace NXWidgets
 #ifdef CONFIG_NX_WRITEONLY
     nxgl_mxpixel_t m_backColor;  /**< The background color to use */
 #endif
+    FAR uint8_t   *m_glyph;      /**< Glyph rendering buffer */
+    unsigned int   m_glyphSize;  /**< Size of the glyph buffer in bytes */
+#ifdef CONFIG_NXWIDGETS_DAMAGE
+    struct nxgl_rect_s m_clipRect; /**< Region that drawing is limited to */
+    bool           m_clipped;    /**< True: Drawing is limited to m_clipRect */
+#endif
+
+    /**
+     * Limit a window-relative rectangle to the current clipping region.
+     *
+     * @param rect The rectangle to clip.  Modified in place.
+     * @return True if anything remains of the rectangle.
+     */
+
+#ifdef CONFIG_NXWIDGETS_DAMAGE
+    bool clipRect(FAR struct nxgl_rect_s *rect) const;
+#else
+    inline bool clipRect(FAR struct nxgl_rect_s *rect) const
+    {
+      return true;
+    }
+#endif
+
+    /**
+     * Return a glyph rendering buffer of at least the requested size.  The
+     * buffer is retained across calls and only reallocated when a larger
+     * font is used.  It is also used to compose transparent bitmaps.
+     *
+     * @param size The required size of the buffer in bytes.
+     * @return The glyph buffer or NULL if it could not be allocated.
+     */
+
+    FAR uint8_t *getGlyphBuffer(unsigned int size);
 
     /**
      * The underlying implementation for drawText functions
@@ -187,6 +220,33 @@ namespace NXWidgets
     }
 #endif
 
+#ifdef CONFIG_NXWIDGETS_DAMAGE
+    /**
+     * Limit all subsequent drawing to a region of the window.  This is used
+     * when repainting damaged regions so that only the damaged pixels are
+     * sent to the display.
+     *
+     * @param rect The window-relative clipping region.  NULL removes
+     *   the clipping region.
+     */
+
+    void setClipRect(FAR const struct nxgl_rect_s *rect);
+
+    /**
+     * Check if any part of a region lies within the current clipping
+     * region.
+     *
+     * @param x The window-relative x coordinate of the region.
+     * @param y The window-relative y coordinate of the region.
+     * @param width The width of the region.
+     * @param height The height of the region.
+     * @return True if some part of the region would be drawn.
+     */
+
+    bool isVisible(nxgl_coord_t x, nxgl_coord_t y,
+                   nxgl_coord_t width, nxgl_coord_t height) const;
+#endif
+
     /**
      * Draw a pixel into the window.
      *
@@ -290,11 +350,8 @@ namespace NXWidgets
      * @param color The color of the rectangle.
      */
 
-    inline void drawFilledCircle(struct nxgl_point_s *center, nxgl_coord_t radius,
-                                 nxgl_mxpixel_t color)
-    {
-      m_pNxWnd->drawFilledCircle(center, radius, color);
-    }
+    void drawFilledCircle(struct nxgl_point_s *center, nxgl_coord_t radius,
+                          nxgl_mxpixel_t color);
 
     /**
      * Draw a string to the window.
@@ -387,6 +444,11 @@ namespace NXWidgets
      * @param bitmapY The window-relative y coordinate within the supplied bitmap to use as
      * the origin.
      * @param transparentColor The transparent color used in the bitmap.
+     *
+     * If the display can be read, the visible part of the bitmap is
+     * composed over the display contents and sent back in bands of up to
+     * CONFIG_NXWIDGETS_BLITBUFFER_SIZE bytes.  Otherwise each run of
+     * non-transparent pixels is sent separately.
      */
 
     void drawBitmap(nxgl_coord_t x, nxgl_coord_t y,
@@ -157,6 +157,13 @@ namespace NXWidgets
 
     virtual void setOptionSelected(const int index, const bool selected);
 
+    /**
+     * Make sure that there are enough recycled rows to hold all of the
+     * options that can be visible at once when a data source is used.
+     */
+
+    void allocateRows(void);
+
     /**
      * Copy constructor is protected to prevent usage.
      */
@@ -221,6 +228,27 @@ namespace NXWidgets
 
     virtual void removeAllOptions(void);
 
+    /**
+     * Get the options from a data source instead of from options added to
+     * the list box.  Options that were added are removed.  Only the
+     * options that are visible are fetched from the source, so the list
+     * box can show very long lists without holding them in memory.
+     *
+     * @param source The data source, or NULL to stop using it.
+     */
+
+    void setDataSource(FAR IListDataSource *source);
+
+    /**
+     * Notify the list box that the options in the data source have
+     * changed.  The selection is cleared and the list box is redrawn.
+     */
+
+    inline void dataSourceChanged(void)
+    {
+      m_options.dataSourceChanged();
+    }
+
     /**
      * Add a new option to the widget.
      *
@@ -72,6 +72,7 @@
 
 #include "graphics/nxwidgets/tnxarray.hxx"
 #include "graphics/nxwidgets/ilistdataeventhandler.hxx"
+#include "graphics/nxwidgets/ilistdatasource.hxx"
 #include "graphics/nxwidgets/clistdataitem.hxx"
 #include "graphics/nxwidgets/cnxstring.hxx"
 
@@ -91,6 +92,12 @@ namespace NXWidgets
    * Class representing a list of items.  Designed to be used by the
    * CListBox class, etc, to store its data.  Fires events to notify
    * listeners when the list changes or a new selection is made.
+   *
+   * The items are either owned by the list or, if a data source is set,
+   * fetched from an IListDataSource.  In the latter case, only a window of
+   * items around the most recently requested index is held in a set of
+   * recycled row items; the list only stores the sort order and the
+   * indexes of the selected items.
    */
 
   class CListData
@@ -102,24 +109,92 @@ namespace NXWidgets
                                            be selected. */
     bool m_sortInsertedItems;         /**< Automatically sorts items on
                                            insertion if true. */
+    FAR IListDataSource *m_source;    /**< Source of the items, or NULL if
+                                           the items are held in m_items. */
+    mutable TNxArray<CListDataItem*> m_window; /**< Recycled items holding
+                                           the window of source items, in
+                                           index order. */
+    mutable TNxArray<CListDataItem*> m_spare;  /**< Used when moving the
+                                           window. */
+    mutable int m_windowStart;        /**< Index of the first item in the
+                                           window. */
+    mutable int m_windowCount;        /**< Number of valid items in the
+                                           window. */
+    TNxArray<int> m_order;            /**< Source index of each item after
+                                           sorting.  Empty if not sorted. */
+    TNxArray<int> m_selected;         /**< Sorted source indexes of the
+                                           selected source items. */
 
     /**
-     * Quick sort the items using their compareTo() methods.
+     * Compare two items for sorting.
      *
-     * @param start The index to start sorting at.
-     * @param end The index to stop sorting at.
+     * @param index1 The index (in the unsorted list) of the first item.
+     * @param index2 The index (in the unsorted list) of the second item.
+     * @return Less than zero if the first item comes first.
      */
 
-    virtual void quickSort(const int start, const int end);
+    virtual int compareItems(const int index1, const int index2);
 
     /**
-     * Swap the locations of two items in the array.
+     * Sort an array of indexes so that the items that they refer to are
+     * in order.  This is a non-recursive heap sort.
      *
-     * @param index1 The index of the first item to swap.
-     * @param index2 The index of the second item to swap.
+     * @param order The indexes to sort.
      */
 
-    virtual void swapItems(const int index1, const int index2);
+    void sortOrder(TNxArray<int> &order);
+
+    /**
+     * Move an index down a heap until the heap is in order again.
+     *
+     * @param order The heap of indexes.
+     * @param root The position of the index to move.
+     * @param end The number of indexes in the heap.
+     */
+
+    void siftDown(TNxArray<int> &order, int root, const int end);
+
+    /**
+     * Get the source index of an item.
+     *
+     * @param index The index of the item in the (possibly sorted) list.
+     * @return The index of the item in the data source.
+     */
+
+    inline const int getSourceIndex(const int index) const
+    {
+      return m_order.size() > 0 ? m_order[index] : index;
+    }
+
+    /**
+     * Find a source index in the selection.
+     *
+     * @param sourceIndex The source index to look for.
+     * @param found Set to true if the index is selected.
+     * @return The position of the index in m_selected, or the position
+     *   where it would be inserted.
+     */
+
+    const int findSelected(const int sourceIndex, bool &found) const;
+
+    /**
+     * Get an item from the data source.  The window of recycled items
+     * is moved to start at the requested index if it is not already held.
+     *
+     * @param index The index of the item.
+     * @return The item, or NULL if the index is out of range.
+     */
+
+    const CListDataItem *getSourceItem(const int index) const;
+
+    /**
+     * Select or deselect a data source item.
+     *
+     * @param index The index of the item.
+     * @param selected True to select the item, false to deselect it.
+     */
+
+    void setSourceItemSelected(const int index, const bool selected);
 
     /**
      * Return the index that an item should be inserted at to maintain a sorted list of data.
@@ -248,7 +323,11 @@ namespace NXWidgets
 
     virtual inline const CListDataItem *getItem(const int index) const
     {
-      if (index < 0 || index >= m_items.size())
+      if (m_source)
+        {
+          return getSourceItem(index);
+        }
+      else if (index < 0 || index >= m_items.size())
         {
           return (const CListDataItem *)0;
         }
@@ -272,7 +351,7 @@ namespace NXWidgets
 
     virtual inline const int getItemCount(void) const
     {
-      return m_items.size();
+      return m_source ? m_source->getItemCount() : m_items.size();
     }
 
     /**
@@ -339,6 +418,57 @@ namespace NXWidgets
      */
 
     void removeListDataEventHandler(IListDataEventHandler *eventHandler);
+
+    /**
+     * Get the items from a data source instead of from items added to the
+     * list.  Any items held by the list are removed.  Items cannot be added
+     * or removed while a data source is set.  Recycled row items must be
+     * provided with addRow() before items can be retrieved.
+     *
+     * @param source The data source, or NULL to stop using the data source.
+     */
+
+    void setDataSource(FAR IListDataSource *source);
+
+    /**
+     * Get the data source.
+     *
+     * @return The data source, or NULL if the list holds its own items.
+     */
+
+    inline FAR IListDataSource *getDataSource(void) const
+    {
+      return m_source;
+    }
+
+    /**
+     * Add a recycled row item used to hold data source items.  The list
+     * becomes the owner of the item.  The number of rows should cover the
+     * largest range of items that is used at once, such as the visible
+     * rows of a list box.
+     *
+     * @param row The item to add.
+     */
+
+    void addRow(CListDataItem *row);
+
+    /**
+     * Get the number of recycled row items.
+     *
+     * @return The number of rows.
+     */
+
+    inline const int getRowCount(void) const
+    {
+      return m_window.size();
+    }
+
+    /**
+     * Notify the list that the items of the data source have changed.
+     * Cached items, the sort order and the selection are discarded.
+     */
+
+    void dataSourceChanged(void);
   };
 }
 
@@ -124,6 +124,17 @@ namespace NXWidgets
       return m_text;
     }
 
+    /**
+     * Set the item's text.
+     *
+     * @param text The new text.
+     */
+
+    inline void setText(const CNxString &text)
+    {
+      m_text.setText(text);
+    }
+
     /**
      * Get the item's value.
      *
@@ -135,6 +146,17 @@ namespace NXWidgets
       return m_value;
     }
 
+    /**
+     * Set the item's value.
+     *
+     * @param value The new value.
+     */
+
+    inline void setValue(const uint32_t value)
+    {
+      m_value = value;
+    }
+
     /**
      * Get the item's selection state.
      *
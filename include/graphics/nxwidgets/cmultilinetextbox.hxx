@@ -142,6 +142,7 @@ namespace NXWidgets
                                            the string. */
     uint8_t            m_showCursor;  /**< Cursor visibility. */
     bool               m_wrapCursor;  /**< True wrap cursor at the ends of the text */
+    bool               m_logMode;     /**< True if used as an append-only log */
 
     /**
      * Get the coordinates of the cursor relative to the text.
@@ -379,6 +380,32 @@ namespace NXWidgets
 
     void drawRow(CGraphicsPort *port, int row);
 
+    /**
+     * Redraws the rows that intersect a horizontal band of the textbox.
+     * The rows are redrawn completely.  Only valid when the text fills the
+     * textbox so that the rows are top aligned.
+     *
+     * @param port The CGraphicsPort to draw to.
+     * @param y The y coordinate of the top of the band.
+     * @param height The height of the band.
+     */
+
+    void drawRows(CGraphicsPort *port, nxgl_coord_t y, nxgl_coord_t height);
+
+    /**
+     * Updates the display after the text has changed.  Rows that are
+     * unchanged are moved to their new position and only the changed
+     * rows are redrawn.  The cursor must have been erased before the text
+     * was changed.
+     *
+     * @param oldRows The number of rows before the change.
+     * @param culledRows The number of rows removed from the top of the
+     *   text by the change.
+     * @param oldCanvasY The canvas y coordinate before the change.
+     */
+
+    void redrawChanges(int oldRows, int culledRows, int32_t oldCanvasY);
+
     /**
      * Destructor.
      */
@@ -613,6 +640,32 @@ namespace NXWidgets
      */
 
     virtual void insertTextAtCursor(const CNxString & ext);
+
+    /**
+     * Use the textbox as an append-only log viewer.  In log mode, once the
+     * maximum number of rows is exceeded, rows are removed from the top in
+     * batches of up to half of the off-screen rows.  The cost of removing
+     * rows is then shared by many appends instead of moving the whole
+     * buffer on every append.
+     *
+     * @param logMode True to enable log mode.
+     */
+
+    inline void setLogMode(bool logMode)
+    {
+      m_logMode = logMode;
+    }
+
+    /**
+     * Check if the textbox is in log mode.
+     *
+     * @return True if the textbox is in log mode.
+     */
+
+    inline bool isLogMode(void) const
+    {
+      return m_logMode;
+    }
   };
 }
 
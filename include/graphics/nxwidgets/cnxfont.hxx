@@ -41,6 +41,20 @@
  * Pre-Processor Definitions
  ****************************************************************************/
 
+#ifdef CONFIG_NXWIDGETS_FONTWIDTHS
+/**
+ * Number of characters held in the dense width table.
+ */
+
+#  define NXFONT_NDENSEWIDTHS  256
+
+/**
+ * Marks a width table entry that has not been filled in yet.
+ */
+
+#  define NXFONT_NOWIDTH       0xff
+#endif
+
 /****************************************************************************
  * Implementation Classes
  ****************************************************************************/
@@ -64,6 +78,23 @@ namespace NXWidgets
     FAR const struct nx_font_s *m_pFontSet; /** < The font set metrics */
     nxgl_mxpixel_t m_fontColor;             /**< Color to draw the font with when rendering. */
     nxgl_mxpixel_t m_transparentColor;      /**< Background color that should not be rendered. */
+#ifdef CONFIG_NXWIDGETS_FONTWIDTHS
+    mutable uint8_t m_widths[NXFONT_NDENSEWIDTHS];  /**< Widths of the first 256 characters */
+#if CONFIG_NXWIDGETS_SIZEOFCHAR == 2
+    mutable nxwidget_char_t m_sparseChar[CONFIG_NXWIDGETS_FONTWIDTHS_NSPARSE];  /**< Cached wide characters */
+    mutable uint8_t m_sparseWidth[CONFIG_NXWIDGETS_FONTWIDTHS_NSPARSE];         /**< Their widths */
+#endif
+#endif
+
+    /**
+     * Look up the width of a character in the font and remember it in the
+     * width tables.
+     *
+     * @param letter The character to get the width of.
+     * @return The width of the character in pixels.
+     */
+
+    nxgl_coord_t lookupCharWidth(nxwidget_char_t letter) const;
 
   public:
 
@@ -85,6 +116,17 @@ namespace NXWidgets
 
     ~CNxFont() { }
 
+    /**
+     * Get the font ID.
+     *
+     * @return The font ID used to create this font.
+     */
+
+    inline enum nx_fontid_e getFontId(void) const
+    {
+      return m_fontId;
+    }
+
     /**
      * Checks if supplied character is blank in the current font.
      *
@@ -161,6 +203,18 @@ namespace NXWidgets
       return getStringWidth(*text);
     }
 
+    /**
+     * Get the width of an array of characters in pixels when drawn with
+     * this font.
+     *
+     * @param text The characters to check.
+     * @param length The number of characters.
+     * @return The width of the characters in pixels.
+     */
+
+    nxgl_coord_t getStringWidth(FAR const nxwidget_char_t *text,
+                                int length) const;
+
     /**
      * Get the width of a portion of a string in pixels when drawn with this
      * font.
@@ -198,7 +252,18 @@ namespace NXWidgets
      * @return The width of the character in pixels.
      */
 
-    nxgl_coord_t getCharWidth(nxwidget_char_t letter) const;
+    inline nxgl_coord_t getCharWidth(nxwidget_char_t letter) const
+    {
+#ifdef CONFIG_NXWIDGETS_FONTWIDTHS
+      if ((unsigned int)letter < NXFONT_NDENSEWIDTHS &&
+          m_widths[letter] != NXFONT_NOWIDTH)
+        {
+          return m_widths[letter];
+        }
+#endif
+
+      return lookupCharWidth(letter);
+    }
 
     /**
      * Get the height of an individual character.
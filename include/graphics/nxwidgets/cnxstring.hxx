@@ -110,6 +110,7 @@ namespace NXWidgets
   {
   private:
     friend class CStringIterator;
+    friend class CNxFont;
 
     int m_stringLength;  /**< Number of characters in the string */
     int m_allocatedSize; /**< Number of bytes allocated for this string */
@@ -1007,6 +1007,26 @@ namespace NXWidgets
 
     void redraw(void);
 
+#ifdef CONFIG_NXWIDGETS_DAMAGE
+    /**
+     * Mark the widget as needing to be redrawn.  Its area is added to the
+     * damage list of the widget control.  During a call to
+     * CWidgetControl::pollEvents() it is repainted along with all other
+     * damage at the end of the poll; otherwise it is repainted right away.
+     */
+
+    void invalidate(void);
+#endif
+
+    /**
+     * Repaint the widget after a change to its state.  With damage
+     * tracking, the widget is marked with invalidate() so that all
+     * changes made while handling a poll are painted together.
+     * Otherwise it is redrawn immediately.
+     */
+
+    void markChanged(void);
+
     /**
      * Enables the widget.
      *
@@ -59,6 +59,19 @@ namespace NXWidgets
     uint8_t          lookup;  /**< Pixel RGB lookup index */
   };
 
+  /**
+   * One row index entry.  Describes the RLE decoder state at the beginning
+   * of an indexed row.
+   */
+
+  struct SRlePaletteRowIndex
+  {
+    uint32_t         offset;    /**< Index of the RLE entry holding the first
+                                 *   pixel of the row */
+    uint8_t          remaining; /**< Number of pixels of that entry that
+                                 *   remain at the beginning of the row */
+  };
+
   /**
    * Run-Length Encoded (RLE), Paletted Bitmap Structure
    */
@@ -77,6 +90,14 @@ namespace NXWidgets
      */
 
     FAR const struct SRlePaletteBitmapEntry *data;
+
+    /**
+     * Optional row index (may be NULL).  Entry n describes row
+     * n * rowInterval.  This is normally generated by bitmap_converter.py.
+     */
+
+    FAR const struct SRlePaletteRowIndex *rowIndex;
+    uint8_t         rowInterval; /**< Number of rows between index entries */
   };
 
   /**
@@ -102,12 +123,29 @@ namespace NXWidgets
     FAR const void  *m_lut;       /**< The selected LUT */
     FAR const struct SRlePaletteBitmapEntry *m_rle; /**< RLE entry being processed */
 
+    /**
+     * Row index
+     */
+
+    FAR const struct SRlePaletteRowIndex *m_rowIndex; /**< Row index (may be NULL) */
+    uint8_t          m_rowInterval; /**< Rows between index entries */
+    bool             m_ownIndex;    /**< True: m_rowIndex was allocated here */
+
     /**
      * Reset to the beginning of the image
      */
 
     void startOfImage(void);
 
+#if CONFIG_NXWIDGETS_RLEROWINDEX_INTERVAL > 0
+    /**
+     * Build a row index by decoding the image once.  Used when the bitmap
+     * was not generated with a row index.
+     */
+
+    void buildRowIndex(void);
+#endif
+
     /**
      * Advance position data ahead.  Called after npixels have
      * have been consume.
@@ -181,7 +219,7 @@ namespace NXWidgets
      * Destructor.
      */
 
-    inline ~CRlePaletteBitmap(void) {}
+    ~CRlePaletteBitmap(void);
 
     /**
      * Get the bitmap's color format.
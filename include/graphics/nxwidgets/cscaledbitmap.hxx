@@ -53,18 +53,38 @@
 namespace NXWidgets
 {
   /**
-   * Class for scaling layer for any bitmap that inherits from IBitMap
+   * Class for scaling layer for any bitmap that inherits from IBitMap.
+   *
+   * The source column and interpolation weight of each scaled column are
+   * computed once at construction.  In bilinear mode, each cached source
+   * row is also scaled horizontally once so that producing a scaled row
+   * only requires interpolating between the two cached rows.
    */
 
   class CScaledBitmap : public IBitmap
   {
+  public:
+    /**
+     * Scaling modes
+     */
+
+    enum EScaleMode
+    {
+      SCALE_NEAREST = 0,              /**< Use the closest source pixel */
+      SCALE_BILINEAR                  /**< Interpolate between source pixels */
+    };
+
   protected:
     FAR IBitmap       *m_bitmap;      /**< The bitmap that is being scaled */
     struct nxgl_size_s m_size;        /**< Scaled size of the image */
     FAR uint8_t       *m_rowCache[2]; /**< Two cached rows of the image */
+    FAR uint32_t      *m_scaledRow[2]; /**< The cached rows scaled horizontally */
+    FAR uint16_t      *m_colIndex;    /**< Source column of each scaled column */
+    FAR uint8_t       *m_colWeight;   /**< Weight of the following source column */
     unsigned int       m_row;         /**< Row number of the first cached row */
     b16_t              m_xScale;      /**< X scale factor */
     b16_t              m_yScale;      /**< Y scale factor */
+    uint8_t            m_mode;        /**< See enum EScaleMode */
 
     /**
      * Read two rows into the row cache
@@ -75,31 +95,24 @@ namespace NXWidgets
     bool cacheRows(unsigned int row);
 
     /**
-     * Given an two RGB colors and a fractional value, return the scaled
-     * value between the two colors.
+     * Read one row of the unscaled image into a row cache entry and, in
+     * bilinear mode, scale it horizontally.
      *
-     * @param incolor1 - The first color to be used
-     * @param incolor2 - The second color to be used
-     * @param fraction - The fractional value
-     * @param outcolor - The returned, scaled color
+     * @param row - The row number to read
+     * @param index - The row cache entry (0 or 1)
      */
 
-    bool scaleColor(FAR const struct rgbcolor_s &incolor1,
-                    FAR const struct rgbcolor_s &incolor2,
-                    b16_t fraction, FAR struct rgbcolor_s &outcolor);
+    bool readRow(unsigned int row, int index);
 
     /**
-     * Given an image row and a non-integer column offset, return the
-     * interpolated RGB color value corresponding to that position
-     *
-     * @param row - The pointer to the row in the row cache to use
-     * @param column - The non-integer column offset
-     * @param outcolor - The returned, interpolated color
+     * Scale one unscaled image row horizontally using the pre-computed
+     * column tables.
      *
+     * @param src - The unscaled row in the bitmap color format
+     * @param dest - The scaled row in packed 0x00RRGGBB form
      */
 
-    bool rowColor(FAR uint8_t *row, b16_t column,
-                  FAR struct rgbcolor_s &outcolor);
+    void scaleRow(FAR const uint8_t *src, FAR uint32_t *dest);
 
     /**
      * Copy constructor is protected to prevent usage.
@@ -113,10 +126,12 @@ namespace NXWidgets
      * Constructor.
      *
      * @param bitmap The bitmap structure being scaled.
-     * @newSize The new, scaled size of the image
+     * @param newSize The new, scaled size of the image
+     * @param mode The scaling mode.  Default: SCALE_BILINEAR
      */
 
-    CScaledBitmap(IBitmap *bitmap, struct nxgl_size_s &newSize);
+    CScaledBitmap(IBitmap *bitmap, struct nxgl_size_s &newSize,
+                  enum EScaleMode mode = SCALE_BILINEAR);
 
     /**
      * Destructor.
@@ -97,31 +97,56 @@ namespace NXWidgets
   class CText : public CNxString
   {
   private:
-
-    /**
-     * Struct defining the position and length of a longest line within
-     * the m_linePositions array.
-     */
-
-    typedef struct
-    {
-      int     index;
-      uint8_t width;
-    } LongestLine;
-
     CNxFont              *m_font;            /**< Font to be used for output */
     TNxArray<int>         m_linePositions;   /**< Array containing start indexes
                                                   of each wrapped line */
-    TNxArray<LongestLine> m_longestLines;    /**< Array containing data describing
-                                                  successively longer wrapped
-                                                  lines */
+    TNxArray<nxgl_coord_t> m_lineWidths;     /**< Array containing the pixel
+                                                  width of each wrapped line */
     nxgl_coord_t          m_lineSpacing;     /**< Spacing between lines of text */
     int32_t               m_textPixelHeight; /**< Total height of the wrapped
                                                   text in pixels */
-    uint8_t               m_textPixelWidth;  /**< Total width of the wrapped text
+    nxgl_coord_t          m_textPixelWidth;  /**< Total width of the wrapped text
                                                   in pixels */
     nxgl_coord_t          m_width;           /**< Width in pixels available t
                                                   the text */
+    int                   m_firstChangedLine; /**< First line re-wrapped by the
+                                                   last change */
+    int                   m_lastChangedLine; /**< Last line re-wrapped by the
+                                                  last change */
+
+    /**
+     * Find the end of a single wrapped line.
+     *
+     * @param pos The char index of the start of the line.
+     * @param lineWidth Returns the pixel width of the line.
+     * @return The char index of the start of the following line, or -1 if
+     * the line runs to the end of the text.
+     */
+
+    int wrapLine(int pos, nxgl_coord_t &lineWidth) const;
+
+    /**
+     * Re-wrap the text after a change.  Wrapping starts with the line
+     * before the one containing the changed char index.  If resync is
+     * true, wrapping stops as soon as a line starts at the same place
+     * (shifted by delta) as it did before the change; the rest of the old
+     * layout is kept.
+     *
+     * @param charIndex The index of the first changed char.
+     * @param delta The number of chars inserted (positive) or removed
+     * (negative) at charIndex.
+     * @param resync True to stop once the wrapping matches the old layout.
+     */
+
+    void reflow(int charIndex, int delta, bool resync);
+
+    /**
+     * Recalculate the height of the text and, if needed, its width.
+     *
+     * @param rescan True if the widest line may have been removed.
+     */
+
+    void updateSize(bool rescan);
 
   public:
 
@@ -279,7 +304,7 @@ namespace NXWidgets
      * @return The width of the longest line.
      */
 
-    inline const uint8_t getPixelWidth(void) const
+    inline const nxgl_coord_t getPixelWidth(void) const
     {
       return m_textPixelWidth;
     }
@@ -318,6 +343,32 @@ namespace NXWidgets
       return m_linePositions.size() - 1;
     }
 
+    /**
+     * Get the first line that was re-wrapped by the most recent change to
+     * the text.  Lines after getLastChangedLine() have the same contents
+     * as before the change but may have been renumbered.
+     *
+     * @return The first changed line.
+     */
+
+    inline const int getFirstChangedLine(void) const
+    {
+      return m_firstChangedLine;
+    }
+
+    /**
+     * Get the last line that was re-wrapped by the most recent change to
+     * the text.
+     *
+     * @return The last changed line.  This is less than
+     * getFirstChangedLine() if no line was re-wrapped.
+     */
+
+    inline const int getLastChangedLine(void) const
+    {
+      return m_lastChangedLine;
+    }
+
     /**
      * Get a pointer to the CText object's font.
      *
@@ -327,7 +378,8 @@ namespace NXWidgets
     CNxFont *getFont(void) const;
 
     /**
-     * Removes lines of text from the start of the text buffer.
+     * Removes lines of text from the start of the text buffer.  The
+     * remaining lines are not re-wrapped.
      *
      * @param lines Number of lines to remove
      */
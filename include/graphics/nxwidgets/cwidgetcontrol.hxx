@@ -145,6 +145,17 @@ namespace NXWidgets
       struct timespec leftReleaseTime;       /**< Time the left button was
                                                   released */
     };
+
+    /**
+     * One queued mouse/touchscreen event
+     */
+
+    struct SMouseSample
+    {
+      nxgl_coord_t    x;                     /**< X coordinate */
+      nxgl_coord_t    y;                     /**< Y coordinate */
+      uint8_t         buttons;               /**< See NX_MOUSE_* definitions */
+    };
 #endif
 
     /**
@@ -174,18 +185,45 @@ namespace NXWidgets
 #ifdef CONFIG_NX_XYINPUT
     struct SXYInput             m_xyinput;        /**< Current XY input
                                                        device state */
+    struct SMouseSample         m_mouseQueue[CONFIG_NXWIDGETS_MOUSEBUFFER_SIZE];
+    volatile uint8_t            m_mouseHead;      /**< Next mouse event to be
+                                                       written (NX listener) */
+    volatile uint8_t            m_mouseTail;      /**< Next mouse event to be
+                                                       read (poll thread) */
+    uint8_t                     m_mouseButtons;   /**< Button state of the
+                                                       last event handled */
 #endif
     CNxWidget                  *m_clickedWidget;  /**< Pointer to the widget
                                                        that is clicked. */
     CNxWidget                  *m_focusedWidget;  /**< Pointer to the widget
                                                        that received keyboard
                                                        input. */
-    uint8_t                     m_kbdbuf[CONFIG_NXWIDGETS_KBDBUFFER_SIZE];
-    uint8_t                     m_nCh;            /**< Number of buffered
-                                                       keyboard characters */
+    uint8_t                     m_kbdbuf[CONFIG_NXWIDGETS_KBDBUFFER_SIZE + 1];
+    volatile uint8_t            m_kbdHead;        /**< Next keyboard character
+                                                       to be written */
+    volatile uint8_t            m_kbdTail;        /**< Next keyboard character
+                                                       to be read */
+    uint32_t                    m_droppedEvents;  /**< Input events lost
+                                                       because a queue was
+                                                       full */
+    uint32_t                    m_coalescedEvents; /**< Mouse events merged
+                                                       into a later event */
     uint8_t                     m_controls[CONFIG_NXWIDGETS_CURSORCONTROL_SIZE];
     uint8_t                     m_nCc;            /**< Number of buffered
                                                        cursor controls */
+#ifdef CONFIG_NXWIDGETS_DAMAGE
+    /**
+     * Damaged regions awaiting redraw
+     */
+
+    struct nxgl_rect_s          m_damage[CONFIG_NXWIDGETS_DAMAGE_NRECTS];
+    uint8_t                     m_nDamage;        /**< Number of damaged
+                                                       regions */
+    uint8_t                     m_nPolls;         /**< Nesting depth of
+                                                       pollEvents() */
+    bool                        m_painting;       /**< Damage is being
+                                                       repainted */
+#endif
     /**
      * The following were picked off from the position callback.
      */
@@ -278,6 +316,17 @@ namespace NXWidgets
 
     bool pollCursorControlEvents(void);
 
+#ifdef CONFIG_NXWIDGETS_DAMAGE
+    /**
+     * Repaint damaged regions until none are left.  The caller must have
+     * set m_painting; it is cleared when the damage list is empty.
+     *
+     * @return True if any region was redrawn.
+     */
+
+    bool paintDamage(void);
+#endif
+
 #ifdef CONFIG_NXWIDGET_EVENTWAIT
     /**
      * Wake up and external logic that is waiting for a window event.
@@ -342,6 +391,24 @@ namespace NXWidgets
      */
 
     void clearMouseEvents(void);
+
+    /**
+     * Update the mouse/touchscreen state with a queued event.
+     *
+     * @param sample The event.
+     */
+
+    void updateMouseState(FAR const struct SMouseSample *sample);
+
+    /**
+     * Send the current mouse/touchscreen state throughout the hierarchy.
+     *
+     * @param widget.  Specific widget to poll.  Use NULL to run the
+     *    all widgets in the window.
+     * @return True means an interesting mouse event occurred
+     */
+
+    bool dispatchMouseState(CNxWidget *widget);
 #endif
 
   public:
@@ -424,6 +491,41 @@ namespace NXWidgets
 
     bool pollEvents(CNxWidget *widget = NULL);
 
+#ifdef CONFIG_NXWIDGETS_DAMAGE
+    /**
+     * Mark a region of the window as needing to be redrawn.  Overlapping
+     * regions are merged.  While pollEvents() is running the region is
+     * left for the single repaint pass at the end of the poll; otherwise
+     * it is repainted before this method returns.  This method may be
+     * called from the NX listener thread.
+     *
+     * @param rect The window-relative region to be redrawn.
+     */
+
+    void markDamaged(FAR const struct nxgl_rect_s *rect);
+
+    /**
+     * Check if there are damaged regions awaiting redraw.
+     *
+     * @return True if redrawDamage() has work to do.
+     */
+
+    inline bool isDamaged(void) const
+    {
+      return m_nDamage > 0;
+    }
+
+    /**
+     * Repaint all damaged regions.  For each region, drawing is clipped to
+     * the region and only the widgets that intersect it are redrawn.  The
+     * window redraw event is then raised once for each region.
+     *
+     * @return True if any region was redrawn.
+     */
+
+    bool redrawDamage(void);
+#endif
+
     /**
      * Swaps the depth of the supplied widget.
      * This function presumes that all child widgets are screens.
@@ -541,6 +643,30 @@ namespace NXWidgets
 #endif
     }
 
+    /**
+     * Get the number of mouse and keyboard events that were lost because
+     * they arrived while the input queue was full.
+     *
+     * @return The number of dropped events.
+     */
+
+    inline uint32_t getDroppedEvents(void) const
+    {
+      return m_droppedEvents;
+    }
+
+    /**
+     * Get the number of mouse events that were merged into a later event
+     * with the same button state.
+     *
+     * @return The number of coalesced events.
+     */
+
+    inline uint32_t getCoalescedEvents(void) const
+    {
+      return m_coalescedEvents;
+    }
+
     /**
      * Get the default widget style for this window.
      *
@@ -0,0 +1,104 @@
+/****************************************************************************
+ * apps/include/graphics/nxwidgets/ilistdatasource.hxx
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.  The
+ * ASF licenses this file to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance with the
+ * License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ *
+ ****************************************************************************/
+
+#ifndef __APPS_INCLUDE_GRAPHICS_NXWIDGETS_ILISTDATASOURCE_HXX
+#define __APPS_INCLUDE_GRAPHICS_NXWIDGETS_ILISTDATASOURCE_HXX
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+/****************************************************************************
+ * Pre-Processor Definitions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Implementation Classes
+ ****************************************************************************/
+
+#if defined(__cplusplus)
+
+namespace NXWidgets
+{
+  class CListDataItem;
+
+  /**
+   * Interface to a source of list items that are not held in memory by
+   * CListData.  CListData only asks for the items that are being displayed
+   * and copies them into a small set of recycled CListDataItem objects, so
+   * the memory used does not depend on the number of items.
+   */
+
+  class IListDataSource
+  {
+  public:
+    /**
+     * A virtual destructor is required in order to override the
+     * IListDataSource destructor.
+     */
+
+    virtual ~IListDataSource(void) { }
+
+    /**
+     * Get the total number of items.
+     *
+     * @return The number of items.
+     */
+
+    virtual const int getItemCount(void) const = 0;
+
+    /**
+     * Copy the text and value of a range of consecutive items into the
+     * supplied items using CListDataItem::setText() and setValue().  The
+     * items belong to the caller and are re-used for other indexes.
+     *
+     * @param index The index of the first item.
+     * @param count The number of items.
+     * @param items The items to fill in.
+     */
+
+    virtual void getItems(const int index, const int count,
+                          CListDataItem **items) = 0;
+
+    /**
+     * Compare two items for sorting.  The default implementation leaves
+     * the items in their original order.
+     *
+     * @param index1 The index of the first item.
+     * @param index2 The index of the second item.
+     * @return Less than zero if the first item comes first, zero if the
+     *   items are equal, or greater than zero if the second item comes
+     *   first.
+     */
+
+    virtual int compareItems(const int index1, const int index2)
+    {
+      return 0;
+    }
+  };
+}
+
+#endif // __cplusplus
+
+#endif // __APPS_INCLUDE_GRAPHICS_NXWIDGETS_ILISTDATASOURCE_HXX
@@ -73,6 +73,24 @@
  *   The smallest BPP configuration supported by NX.
  * CONFIG_NXWIDGETS_SIZEOFCHAR - Size of character {1 or 2 bytes}.  Default
  *   Determined by CONFIG_NXWIDGETS_SIZEOFCHAR
+ * CONFIG_NXWIDGETS_GLYPHCACHE - Cache rendered, opaque glyphs.  Default: n
+ * CONFIG_NXWIDGETS_GLYPHCACHE_SIZE - Total glyph cache memory in bytes.
+ *   Default: 8192
+ * CONFIG_NXWIDGETS_GLYPHCACHE_SLOTSIZE - Size of one glyph cache slot in
+ *   bytes.  Default: 512
+ * CONFIG_NXWIDGETS_DAMAGE - Track damaged regions and repaint them once
+ *   per poll.  Default: n
+ * CONFIG_NXWIDGETS_DAMAGE_NRECTS - Maximum number of damaged regions per
+ *   window.  Default: 8
+ * CONFIG_NXWIDGETS_RLEROWINDEX_INTERVAL - Rows between the entries of the
+ *   row index built for RLE bitmaps without one.  Zero disables.  Default: 0
+ * CONFIG_NXWIDGETS_FONTWIDTHS - Cache character widths in each CNxFont.
+ * CONFIG_NXWIDGETS_FONTWIDTHS_NSPARSE - Number of cached widths of
+ *   characters beyond the first 256.  Default: 16
+ * CONFIG_NXWIDGETS_BITMAPMASK - Cache transparency masks of bitmaps.
+ * CONFIG_NXWIDGETS_BITMAPMASK_NENTRIES - Number of cached masks.  Default: 8
+ * CONFIG_NXWIDGETS_BLITBUFFER_SIZE - Size of the buffer used to compose
+ *   transparent bitmaps.  Default: 4096
  *
  * NXWidget Default Values
  *
@@ -114,6 +132,8 @@
  * CONFIG_NXWIDGETS_CURSORCONTROL_SIZE - Size of incoming cursor control
  *   buffer, i.e., the maximum number of cursor controls that can between
  *   entered by NX polling cycles without losing data.  Default: 4
+ * CONFIG_NXWIDGETS_MOUSEBUFFER_SIZE - Size of the incoming mouse/touchscreen
+ *   event queue.  Must be a power of two no larger than 128.  Default: 16
  */
 
 /* Prerequisites ************************************************************/
@@ -285,6 +305,61 @@
 #  error "Unsupported character width (CONFIG_NXWIDGETS_SIZEOFCHAR)"
 #endif
 
+/**
+ * Glyph cache
+ */
+
+#ifdef CONFIG_NXWIDGETS_GLYPHCACHE
+#  ifndef CONFIG_NXWIDGETS_GLYPHCACHE_SIZE
+#    define CONFIG_NXWIDGETS_GLYPHCACHE_SIZE 8192
+#  endif
+#  ifndef CONFIG_NXWIDGETS_GLYPHCACHE_SLOTSIZE
+#    define CONFIG_NXWIDGETS_GLYPHCACHE_SLOTSIZE 512
+#  endif
+#endif
+
+/**
+ * Damage region tracking
+ */
+
+#ifdef CONFIG_NXWIDGETS_DAMAGE
+#  ifndef CONFIG_NXWIDGETS_DAMAGE_NRECTS
+#    define CONFIG_NXWIDGETS_DAMAGE_NRECTS 8
+#  endif
+#endif
+
+/**
+ * RLE bitmap row index
+ */
+
+#ifndef CONFIG_NXWIDGETS_RLEROWINDEX_INTERVAL
+#  define CONFIG_NXWIDGETS_RLEROWINDEX_INTERVAL 0
+#endif
+
+/**
+ * Character width cache
+ */
+
+#ifdef CONFIG_NXWIDGETS_FONTWIDTHS
+#  ifndef CONFIG_NXWIDGETS_FONTWIDTHS_NSPARSE
+#    define CONFIG_NXWIDGETS_FONTWIDTHS_NSPARSE 16
+#  endif
+#endif
+
+/**
+ * Transparent bitmaps
+ */
+
+#ifdef CONFIG_NXWIDGETS_BITMAPMASK
+#  ifndef CONFIG_NXWIDGETS_BITMAPMASK_NENTRIES
+#    define CONFIG_NXWIDGETS_BITMAPMASK_NENTRIES 8
+#  endif
+#endif
+
+#ifndef CONFIG_NXWIDGETS_BLITBUFFER_SIZE
+#  define CONFIG_NXWIDGETS_BLITBUFFER_SIZE 4096
+#endif
+
 /* NXWidget Default Values **************************************************/
 /**
  * Default font ID
@@ -419,6 +494,20 @@
 #  define CONFIG_NXWIDGETS_CURSORCONTROL_SIZE 4
 #endif
 
+/**
+ * Size of the incoming mouse/touchscreen event queue.  The queue indices
+ * are free-running 8-bit counters so the size must be a power of two.
+ */
+
+#ifndef CONFIG_NXWIDGETS_MOUSEBUFFER_SIZE
+#  define CONFIG_NXWIDGETS_MOUSEBUFFER_SIZE 16
+#endif
+
+#if CONFIG_NXWIDGETS_MOUSEBUFFER_SIZE > 128 || \
+    (CONFIG_NXWIDGETS_MOUSEBUFFER_SIZE & (CONFIG_NXWIDGETS_MOUSEBUFFER_SIZE - 1)) != 0
+#  error "CONFIG_NXWIDGETS_MOUSEBUFFER_SIZE must be a power of two <= 128"
+#endif
+
 /****************************************************************************
  * Public Types
  ****************************************************************************/
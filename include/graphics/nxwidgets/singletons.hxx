@@ -69,6 +69,8 @@
 #include <stdbool.h>
 
 #include "graphics/nxwidgets/cnxtimer.hxx"
+#include "graphics/nxwidgets/cglyphcache.hxx"
+#include "graphics/nxwidgets/cbitmapmask.hxx"
 
 /****************************************************************************
  * Pre-Processor Definitions
@@ -96,6 +98,12 @@ namespace NXWidgets
   extern CWidgetStyle        *g_defaultWidgetStyle; /**< The default widget style */
   extern CNxString           *g_nullString;         /**< The reusable empty string */
   extern TNxArray<CNxTimer*> *g_nxTimers;           /**< An array of all timers */
+#ifdef CONFIG_NXWIDGETS_GLYPHCACHE
+  extern CGlyphCache         *g_glyphCache;         /**< Shared rendered glyph cache */
+#endif
+#ifdef CONFIG_NXWIDGETS_BITMAPMASK
+  extern CBitmapMaskCache    *g_bitmapMasks;        /**< Shared bitmap mask cache */
+#endif
 
   /**
    * Setup misc singleton instances.
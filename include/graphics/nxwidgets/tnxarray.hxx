@@ -150,6 +150,15 @@ public:
 
   void preallocate(void);
 
+  /**
+   * Make sure that the array can hold at least the specified number of
+   * items without being re-allocated.
+   *
+   * @param size The number of items.
+   */
+
+  inline void reserve(const int size);
+
   /**
    * Get the size of the array.
    *
@@ -246,6 +255,12 @@ TNxArray<T>::~TNxArray()
     }
 }
 
+template <class T>
+void TNxArray<T>::reserve(const int size)
+{
+  reallocate(size);
+}
+
 template <class T>
 const int TNxArray<T>::size(void) const
 {
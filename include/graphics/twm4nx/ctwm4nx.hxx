@@ -39,6 +39,7 @@
 #include <nuttx/config.h>
 
 #include <cstdlib>
+#include <ctime>
 #include <semaphore.h>
 #include <mqueue.h>
 
@@ -105,6 +106,30 @@ namespace Twm4Nx
       FAR struct nxgl_size_s       m_displaySize; /**< Size of the display */
       FAR struct nxgl_size_s       m_maxWindow;   /**< Maximum size of a window */
 
+#if CONFIG_TWM4NX_MOVE_MAXFPS > 0
+      /* Move rate limiting */
+
+      struct SEventMsg             m_pendingMove; /**< Move held back by the rate limit */
+      bool                         m_movePending; /**< True: m_pendingMove is valid */
+      struct timespec              m_lastMove;    /**< Time of the last move */
+#endif
+
+#ifdef CONFIG_TWM4NX_EVENTSTATS
+      /* Event loop statistics, one entry per event recipient */
+
+      struct SEventStats
+      {
+        uint32_t count;                           /**< Events dispatched */
+        uint32_t merged;                          /**< Events merged into a later event */
+        uint32_t totalUsec;                       /**< Total dispatch time */
+        uint32_t maxUsec;                         /**< Longest dispatch time */
+      };
+
+      struct SEventStats           m_stats[16];   /**< Statistics per recipient */
+      unsigned int                 m_maxBacklog;  /**< Most events found queued */
+      struct timespec              m_statsTime;   /**< Time of the last report */
+#endif
+
       /**
        * Connect to the NX server
        *
@@ -131,6 +156,60 @@ namespace Twm4Nx
 
       inline bool systemEvent(FAR struct SEventMsg *eventmsg);
 
+      /**
+       * Wait for the next event then read all other events that are
+       * already queued, up to CONFIG_TWM4NX_EVENT_BATCH events, without
+       * blocking.  If a move is being held back by the rate limit, wait only
+       * until it is due.
+       *
+       * @param batch.  The buffer to receive the events.
+       * @return The number of events received (possibly zero) or a negative
+       *   value on any failure.
+       */
+
+      int receiveEvents(FAR union UEventMsg *batch);
+
+      /**
+       * Handle one event received by the event loop.  Events that are not
+       * critical are dropped during a resize operation and moves are held
+       * back if they arrive faster than CONFIG_TWM4NX_MOVE_MAXFPS.
+       *
+       * @param eventmsg.  The received NxWidget event message.
+       * @return True if the message was properly handled.  false is
+       *   return on any failure.
+       */
+
+      bool handleEvent(FAR struct SEventMsg *eventmsg);
+
+      /**
+       * Dispatch an event and, if enabled, account for its dispatch time.
+       *
+       * @param eventmsg.  The received NxWidget event message.
+       * @return True if the message was properly dispatched.  false is
+       *   return on any failure.
+       */
+
+      bool timedDispatch(FAR struct SEventMsg *eventmsg);
+
+#if CONFIG_TWM4NX_MOVE_MAXFPS > 0
+      /**
+       * Dispatch the move held back by the rate limit, if any.
+       *
+       * @return True if there was no move or it was properly dispatched.
+       */
+
+      bool flushMove(void);
+#endif
+
+#ifdef CONFIG_TWM4NX_EVENTSTATS
+      /**
+       * Report and reset the event loop statistics if the report interval
+       * has elapsed.
+       */
+
+      void reportStats(void);
+#endif
+
       /**
        * Cleanup in preparation for termination.
        */
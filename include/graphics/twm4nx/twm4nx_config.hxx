@@ -516,4 +516,36 @@
 #  define CONFIG_TWM4NX_KEYBOARD_BUFSIZE 6
 #endif
 
+// Event Loop ////////////////////////////////////////////////////////////////
+
+/**
+ * Event loop settings
+ *
+ * CONFIG_TWM4NX_EVENT_BATCH - The maximum number of queued events that are
+ *   read from the event queue at once.  Consecutive window drag, icon drag
+ *   and resize events in one batch are merged.  Default: 8
+ * CONFIG_TWM4NX_MOVE_MAXFPS - The maximum rate (per second) at which
+ *   windows and icons are moved or resized.  Zero means no limit.
+ *   Default: 0
+ * CONFIG_TWM4NX_EVENTSTATS - Collect and periodically report event loop
+ *   statistics.
+ * CONFIG_TWM4NX_EVENTSTATS_INTERVAL - Seconds between reports.  Default: 10
+ */
+
+#ifndef CONFIG_TWM4NX_EVENT_BATCH
+#  define CONFIG_TWM4NX_EVENT_BATCH 8
+#endif
+
+#if CONFIG_TWM4NX_EVENT_BATCH < 1
+#  error "CONFIG_TWM4NX_EVENT_BATCH must be at least 1"
+#endif
+
+#ifndef CONFIG_TWM4NX_MOVE_MAXFPS
+#  define CONFIG_TWM4NX_MOVE_MAXFPS 0
+#endif
+
+#ifndef CONFIG_TWM4NX_EVENTSTATS_INTERVAL
+#  define CONFIG_TWM4NX_EVENTSTATS_INTERVAL 10
+#endif
+
 #endif // __APPS_INCLUDE_GRAPHICS_TWM4NX_TWM4NX_CONFIG_HXX
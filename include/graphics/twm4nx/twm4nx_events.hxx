@@ -262,6 +262,32 @@ namespace Twm4Nx
 
     FAR CWindowEvent *instance;         /**< X/Y position */
   };
+
+  /**
+   * A buffer that can hold any event message
+   */
+
+  union UEventMsg
+  {
+    struct SEventMsg eventmsg;          /**< The common event fields */
+    char buffer[MAX_EVENT_MSGSIZE];     /**< Raw message buffer */
+  };
+
+  /**
+   * Check if an event only reports a new position that supersedes the
+   * position in an earlier event of the same kind for the same object.
+   * Handlers of these events keep track of the last position themselves so
+   * such events can be merged.
+   *
+   * @param eventID.  The event ID.
+   * @return True if the event can be merged.
+   */
+
+  inline bool isMergeableEvent(uint16_t eventID)
+  {
+    return eventID == EVENT_WINDOW_DRAG || eventID == EVENT_ICONWIDGET_DRAG ||
+           eventID == EVENT_RESIZE_MOVE;
+  }
 }
 
 #endif // __APPS_INCLUDE_GRAPHICS_TWM4NX_TWM4NX_EVENTS_HXX
@@ -56,6 +56,12 @@
  *     transfers.  Default: 512 bytes.
  *   CONFIG_FTPD_WORKERSTACKSIZE - The stacksize to allocate for each
  *     FTP daemon worker thread.  Default:  2048 bytes.
+ *   CONFIG_FTPD_NWORKERS - The number of preallocated sessions and worker
+ *     threads.  Zero starts a new thread for each session.  Default: 0.
+ *   CONFIG_FTPD_STORBUFFERSIZE - The size of each of the two upload
+ *     buffers.  Zero disables double buffering of uploads.  Default: 0.
+ *   CONFIG_FTPD_WRITERSTACKSIZE - The stacksize of the upload writer
+ *     thread.  Default:  2048 bytes.
  */
 
 #ifdef CONFIG_DISABLE_PTHREAD
@@ -82,6 +88,18 @@
 #  define CONFIG_FTPD_WORKERSTACKSIZE 2048
 #endif
 
+#ifndef CONFIG_FTPD_NWORKERS
+#  define CONFIG_FTPD_NWORKERS 0
+#endif
+
+#ifndef CONFIG_FTPD_STORBUFFERSIZE
+#  define CONFIG_FTPD_STORBUFFERSIZE 0
+#endif
+
+#ifndef CONFIG_FTPD_WRITERSTACKSIZE
+#  define CONFIG_FTPD_WRITERSTACKSIZE 2048
+#endif
+
 /* Interface definitions ****************************************************/
 
 #define FTPD_ACCOUNTFLAG_NONE    (0)
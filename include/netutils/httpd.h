@@ -87,7 +87,7 @@
  */
 
 #define HTTPD_MAX_CONTENTLEN  32
-#define HTTPD_MAX_HEADERLEN   220
+#define HTTPD_MAX_HEADERLEN   256
 #define HTTPD_MAX_CHUNKEDLEN  16
 
 /****************************************************************************
@@ -116,6 +116,10 @@ struct httpd_state
 #endif
 #if defined(CONFIG_NETUTILS_HTTPD_ENABLE_CHUNKED_ENCODING)
   bool ht_chunked;                      /* Server uses chunked encoding for tx */
+#endif
+#ifdef CONFIG_NETUTILS_HTTPD_GZIP
+  bool ht_acceptgzip;                   /* Accept-Encoding includes gzip */
+  bool ht_gzip;                         /* Sending a precompressed file */
 #endif
   struct httpd_fs_file ht_file;         /* Fake file data to send */
   int ht_sockfd;                        /* The socket descriptor from accept() */
@@ -116,6 +116,26 @@
  */
 #define WEBCLIENT_FLAG_TUNNEL 2U
 
+/* WEBCLIENT_FLAG_KEEPALIVE: Reuse the connection
+ *
+ * If CONFIG_WEBCLIENT_KEEPALIVE is enabled and this flag is set, an
+ * HTTP/1.1 request takes an idle connection to the same scheme, host and
+ * port from the connection pool when there is one, and returns the
+ * connection to the pool after a complete response the server allows
+ * to be reused.
+ *
+ * The flag is ignored for WEBCLIENT_FLAG_NON_BLOCKING, tunnel, proxy and
+ * AF_LOCAL requests.
+ *
+ * A pooled https connection keeps using the tls_ops and tls_ctx of the
+ * request that opened it, and only requests with the same tls_ops and
+ * tls_ctx reuse it.  The application must close those connections with
+ * webclient_pool_flush_tls() (or webclient_pool_flush()) before it frees
+ * or reuses the TLS context.
+ */
+
+#define WEBCLIENT_FLAG_KEEPALIVE 4U
+
 /* The following WEBCLIENT_FLAG_xxx constants are for
  * webclient_poll_info::flags.
  */
@@ -504,6 +524,40 @@ struct webclient_conn_s
   FAR void *tls_ctx;
 };
 
+#ifdef CONFIG_WEBCLIENT_RANGES
+/* webclient_range_s: one part of a ranged download
+ *
+ *   start - The file offset of the first byte of the range
+ *   end   - The file offset of the end+1 of the range
+ *   done  - The number of bytes of the range already in the file
+ */
+
+struct webclient_range_s
+{
+  off_t start;
+  off_t end;
+  off_t done;
+};
+
+/* webclient_range_callback_t: callback to report ranged download progress
+ *
+ * This is called each time a range has received
+ * CONFIG_WEBCLIENT_RANGES_CHECKPOINT more bytes, and once more when the
+ * range finishes.  The calls are made from the download threads, one at
+ * a time.
+ *
+ * Input Parameters:
+ *   index - The index of the range.
+ *   range - The range.
+ *   arg   - User argument passed to webclient_get_ranges().
+ */
+
+typedef CODE void (*webclient_range_callback_t)(
+    unsigned int index,
+    FAR const struct webclient_range_s *range,
+    FAR void *arg);
+#endif
+
 /****************************************************************************
  * Public Function Prototypes
  ****************************************************************************/
@@ -572,6 +626,50 @@ ssize_t webclient_conn_recv(FAR struct webclient_conn_s *conn,
 void webclient_conn_close(FAR struct webclient_conn_s *conn);
 void webclient_conn_free(FAR struct webclient_conn_s *conn);
 
+#ifdef CONFIG_WEBCLIENT_KEEPALIVE
+int webclient_perform_pipelined(FAR struct webclient_context **ctxs,
+                                unsigned int nctxs);
+void webclient_pool_flush(void);
+void webclient_pool_flush_tls(FAR void *tls_ctx);
+#endif
+
+#ifdef CONFIG_WEBCLIENT_RANGES
+/****************************************************************************
+ * Name: webclient_get_ranges
+ *
+ * Description:
+ *   Download a file to a local path with up to nranges concurrent GET
+ *   requests, each for a Range of the file written into its own region of
+ *   the preallocated local file.  If the server does not support ranges,
+ *   the file is downloaded with a single request.
+ *
+ *   The progress of each range is kept in "<path>.range" until the
+ *   download completes.  If resume is true, an interrupted download
+ *   continues from there.  An existing file without a ".range" file is
+ *   taken to hold the beginning of the download.
+ *
+ * Input Parameters
+ *   ctx      - The request template.  The url, proxy, headers,
+ *              timeout_sec, tls_ops, tls_ctx, buflen and protocol_version
+ *              fields are used.  Each range uses a buffer of buflen bytes
+ *              of its own.
+ *   path     - The local file.
+ *   nranges  - The number of ranges, up to CONFIG_WEBCLIENT_RANGES_MAX.
+ *   resume   - Continue an interrupted download.
+ *   callback - Progress callback, may be NULL.
+ *   arg      - User argument passed to callback.
+ *
+ * Returned Value:
+ *   0 on success; a negated errno value on failure.
+ *
+ ****************************************************************************/
+
+int webclient_get_ranges(FAR const struct webclient_context *ctx,
+                         FAR const char *path, unsigned int nranges,
+                         bool resume, webclient_range_callback_t callback,
+                         FAR void *arg);
+#endif
+
 #undef EXTERN
 #ifdef __cplusplus
 }
@@ -44,8 +44,12 @@
 
 #include <sys/socket.h>
 #include <sys/stat.h>
+#ifdef CONFIG_FTPD_SENDFILE
+#  include <sys/sendfile.h>
+#endif
 
 #include <stdint.h>
+#include <inttypes.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <unistd.h>
@@ -57,6 +61,7 @@
 #include <libgen.h>
 #include <assert.h>
 #include <errno.h>
+#include <time.h>
 #include <debug.h>
 
 #include <arpa/inet.h>
@@ -69,6 +74,18 @@
 
 #include "ftpd.h"
 
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+/* Largest chunk passed to one sendfile() call */
+
+#define FTPD_SENDFILE_CHUNK 16384
+
+/****************************************************************************
+ * Private Types
+ ****************************************************************************/
+
 /****************************************************************************
  * Private Function Prototypes
  ****************************************************************************/
@@ -134,6 +151,21 @@ static int ftpd_getpath(FAR struct ftpd_session_s *session,
 static int ftpd_changedir(FAR struct ftpd_session_s *session,
                           FAR const char *rempath);
 static off_t ftpd_offsatoi(FAR const char *filename, off_t offset);
+static uint32_t ftpd_elapsed(FAR const struct timespec *start);
+#ifdef CONFIG_FTPD_SENDFILE
+static int ftpd_sendfile(FAR struct ftpd_session_s *session,
+                         FAR uint64_t *nbytes);
+#endif
+#if CONFIG_FTPD_STORBUFFERSIZE > 0 || CONFIG_FTPD_NWORKERS > 0
+static int ftpd_semwait(FAR sem_t *sem);
+#endif
+#if CONFIG_FTPD_STORBUFFERSIZE > 0
+static FAR void *ftpd_writer(FAR void *arg);
+static int ftpd_startwriter(FAR struct ftpd_session_s *session);
+static void ftpd_stopwriter(FAR struct ftpd_session_s *session);
+static int ftpd_recvfile(FAR struct ftpd_session_s *session,
+                         FAR uint64_t *nbytes);
+#endif
 static int ftpd_stream(FAR struct ftpd_session_s *session, int cmdtype);
 static uint8_t ftpd_listoption(FAR char **param);
 static int ftpd_listbuffer(FAR struct ftpd_session_s *session,
@@ -185,11 +217,24 @@ static int ftpd_command(FAR struct ftpd_session_s *session);
 
 /* Worker thread */
 
+#if CONFIG_FTPD_NWORKERS == 0
 static int ftpd_startworker(pthread_startroutine_t handler, FAR void *arg,
                             size_t stacksize);
+#endif
+static FAR struct ftpd_session_s *
+ftpd_allocsession(FAR struct ftpd_server_s *server);
+static void ftpd_resetsession(FAR struct ftpd_session_s *session);
 static void ftpd_freesession(FAR struct ftpd_session_s *session);
 static void ftpd_workersetup(FAR struct ftpd_session_s *session);
+static void ftpd_serve(FAR struct ftpd_session_s *session);
+#if CONFIG_FTPD_NWORKERS == 0
 static FAR void *ftpd_worker(FAR void *arg);
+#else
+static FAR void *ftpd_poolworker(FAR void *arg);
+static int ftpd_startpool(FAR struct ftpd_server_s *server);
+static void ftpd_stoppool(FAR struct ftpd_server_s *server);
+static int ftpd_dispatch(FAR struct ftpd_server_s *server, int timeout);
+#endif
 
 /****************************************************************************
  * Private Data
@@ -265,7 +310,7 @@ static const char *g_ftpdhelp[] =
   "NOOP    FEAT*   OPTS    AUTH*   CCC*    CONF*   ENC*    MIC*",
   "PBSZ*   PROT*   TYPE    STRU*   MODE*   RETR    STOR    STOU*",
   "APPE    REST    ABOR    USER    PASS    ACCT*   REIN*   LIST",
-  "NLST    STAT*   SITE*   MLSD*   MLST*",
+  "NLST    STAT*   SITE    MLSD*   MLST*",
   "Direct comments to " CONFIG_FTPD_VENDORID,
   NULL
 };
@@ -1755,6 +1800,354 @@ static off_t ftpd_offsatoi(FAR const char *filename, off_t offset)
   return ret;
 }
 
+/****************************************************************************
+ * Name: ftpd_elapsed
+ *
+ * Description:
+ *   Return the milliseconds elapsed since start.
+ *
+ ****************************************************************************/
+
+static uint32_t ftpd_elapsed(FAR const struct timespec *start)
+{
+  struct timespec now;
+
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return (uint32_t)((now.tv_sec - start->tv_sec) * 1000 +
+                    (now.tv_nsec - start->tv_nsec) / 1000000);
+}
+
+/****************************************************************************
+ * Name: ftpd_sendfile
+ *
+ * Description:
+ *   Send the rest of a binary mode download from the current file position
+ *   with sendfile(), so the data is not copied through the data buffer.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_FTPD_SENDFILE
+static int ftpd_sendfile(FAR struct ftpd_session_s *session,
+                         FAR uint64_t *nbytes)
+{
+  ssize_t nsent;
+  int errval;
+  int ret;
+
+  for (; ; )
+    {
+      if (session->txtimeout >= 0)
+        {
+          ret = ftpd_txpoll(session->data.sd, session->txtimeout);
+          if (ret < 0)
+            {
+              errval = -ret;
+              break;
+            }
+        }
+
+      /* A NULL offset sends from, and advances, the file position set up
+       * by any REST command.
+       */
+
+      nsent = sendfile(session->data.sd, session->fd, NULL,
+                       FTPD_SENDFILE_CHUNK);
+      if (nsent < 0)
+        {
+          errval = errno;
+          break;
+        }
+
+      if (nsent == 0)
+        {
+          ftpd_response(session->cmd.sd, session->txtimeout,
+                        g_respfmt1, 226, ' ', "Transfer complete");
+          return OK;
+        }
+
+      *nbytes += nsent;
+    }
+
+  nerr("ERROR: sendfile failed: %d\n", errval);
+  ftpd_response(session->cmd.sd, session->txtimeout,
+                g_respfmt1, 550, ' ', "Data send error !");
+  return -errval;
+}
+#endif
+
+/****************************************************************************
+ * Name: ftpd_semwait
+ *
+ * Description:
+ *   Wait for a semaphore, retrying if the wait is interrupted by a signal.
+ *   Returns a negated errno value if the wait fails for any other reason.
+ *
+ ****************************************************************************/
+
+#if CONFIG_FTPD_STORBUFFERSIZE > 0 || CONFIG_FTPD_NWORKERS > 0
+static int ftpd_semwait(FAR sem_t *sem)
+{
+  while (sem_wait(sem) < 0)
+    {
+      int errval = errno;
+      if (errval != EINTR)
+        {
+          nerr("ERROR: sem_wait() failed: %d\n", errval);
+          return -errval;
+        }
+    }
+
+  return OK;
+}
+#endif
+
+/****************************************************************************
+ * Name: ftpd_writer
+ *
+ * Description:
+ *   Upload writer thread of a session.  Writes each buffer filled by
+ *   ftpd_recvfile() to the file and hands it back.  A zero length buffer
+ *   ends the upload; after a write error, the remaining buffers of the
+ *   upload are discarded.  The thread then waits for the next upload until
+ *   ftpd_stopwriter() asks it to exit.
+ *
+ ****************************************************************************/
+
+#if CONFIG_FTPD_STORBUFFERSIZE > 0
+static FAR void *ftpd_writer(FAR void *arg)
+{
+  FAR struct ftpd_writer_s *writer = (FAR struct ftpd_writer_s *)arg;
+  FAR const char *next;
+  size_t remaining;
+  ssize_t nwritten;
+  int i = 0;
+
+  while (ftpd_semwait(&writer->full) == OK && !writer->exit)
+    {
+      if (writer->len[i] == 0)
+        {
+          /* End of the upload.  The next one starts with buffer 0. */
+
+          sem_post(&writer->empty);
+          sem_post(&writer->done);
+          i = 0;
+          continue;
+        }
+
+      next      = writer->buffer[i];
+      remaining = writer->len[i];
+
+      while (writer->errval == 0 && remaining > 0)
+        {
+          nwritten = write(writer->fd, next, remaining);
+          if (nwritten < 0)
+            {
+              writer->errval = errno;
+              nerr("ERROR: write() failed: %d\n", writer->errval);
+              break;
+            }
+
+          remaining -= nwritten;
+          next      += nwritten;
+        }
+
+      sem_post(&writer->empty);
+      i ^= 1;
+    }
+
+  return NULL;
+}
+
+/****************************************************************************
+ * Name: ftpd_startwriter
+ *
+ * Description:
+ *   Start the upload writer thread of a session if it is not running.
+ *
+ ****************************************************************************/
+
+static int ftpd_startwriter(FAR struct ftpd_session_s *session)
+{
+  FAR struct ftpd_writer_s *writer = &session->writer;
+  pthread_attr_t attr;
+  int ret;
+
+  if (writer->started)
+    {
+      return OK;
+    }
+
+  writer->exit = false;
+
+  pthread_attr_init(&attr);
+  pthread_attr_setstacksize(&attr, CONFIG_FTPD_WRITERSTACKSIZE);
+  ret = pthread_create(&writer->thread, &attr, ftpd_writer, writer);
+  pthread_attr_destroy(&attr);
+  if (ret != 0)
+    {
+      nerr("ERROR: pthread_create() failed: %d\n", ret);
+      return -ret;
+    }
+
+  writer->started = true;
+  return OK;
+}
+
+/****************************************************************************
+ * Name: ftpd_stopwriter
+ *
+ * Description:
+ *   Stop the upload writer thread of a session and return the buffers to
+ *   their initial state.
+ *
+ ****************************************************************************/
+
+static void ftpd_stopwriter(FAR struct ftpd_session_s *session)
+{
+  FAR struct ftpd_writer_s *writer = &session->writer;
+
+  if (writer->started)
+    {
+      writer->exit = true;
+      sem_post(&writer->full);
+      pthread_join(writer->thread, NULL);
+      writer->started = false;
+    }
+
+  sem_destroy(&writer->done);
+  sem_destroy(&writer->full);
+  sem_destroy(&writer->empty);
+
+  sem_init(&writer->empty, 0, 2);
+  sem_init(&writer->full, 0, 0);
+  sem_init(&writer->done, 0, 0);
+}
+
+/****************************************************************************
+ * Name: ftpd_recvfile
+ *
+ * Description:
+ *   Receive a binary mode upload into two large buffers in turn while the
+ *   writer thread of the session writes the other one to the file, so that
+ *   the network receive overlaps slow flash writes.
+ *
+ ****************************************************************************/
+
+static int ftpd_recvfile(FAR struct ftpd_session_s *session,
+                         FAR uint64_t *nbytes)
+{
+  FAR struct ftpd_writer_s *writer = &session->writer;
+  ssize_t rdbytes = 1;
+  size_t len;
+  int errval = 0;
+  int ret;
+  int i = 0;
+
+  ret = ftpd_startwriter(session);
+  if (ret < 0)
+    {
+      ftpd_response(session->cmd.sd, session->txtimeout,
+                    g_respfmt1, 550, ' ', "Data send error !");
+      return ret;
+    }
+
+  writer->fd     = session->fd;
+  writer->errval = 0;
+
+  for (; ; )
+    {
+      ret = ftpd_semwait(&writer->empty);
+      if (ret < 0)
+        {
+          goto errout_with_writer;
+        }
+
+      /* Fill the whole buffer so that the file sees large writes.  Stop
+       * receiving once the writer has failed.
+       */
+
+      len = 0;
+      while (writer->errval == 0 && rdbytes > 0 &&
+             len < CONFIG_FTPD_STORBUFFERSIZE)
+        {
+          rdbytes = ftpd_recv(session->data.sd, writer->buffer[i] + len,
+                              CONFIG_FTPD_STORBUFFERSIZE - len,
+                              session->rxtimeout);
+          if (rdbytes < 0)
+            {
+              errval = -rdbytes;
+              nerr("ERROR: ftpd_recv failed: %d\n", errval);
+            }
+          else
+            {
+              len += rdbytes;
+            }
+        }
+
+      *nbytes       += len;
+      writer->len[i] = len;
+      sem_post(&writer->full);
+      i ^= 1;
+
+      if (len == 0)
+        {
+          break;
+        }
+
+      if (rdbytes <= 0 || writer->errval != 0)
+        {
+          /* Queue the end marker behind the last buffer */
+
+          ret = ftpd_semwait(&writer->empty);
+          if (ret < 0)
+            {
+              goto errout_with_writer;
+            }
+
+          writer->len[i] = 0;
+          sem_post(&writer->full);
+          break;
+        }
+    }
+
+  /* Wait until the writer has written everything */
+
+  ret = ftpd_semwait(&writer->done);
+  if (ret < 0)
+    {
+      goto errout_with_writer;
+    }
+
+  if (errval != 0)
+    {
+      ftpd_response(session->cmd.sd, session->txtimeout,
+                    g_respfmt1, 550, ' ', "Data read error !");
+      return -errval;
+    }
+  else if (writer->errval != 0)
+    {
+      ftpd_response(session->cmd.sd, session->txtimeout,
+                    g_respfmt1, 550, ' ', "Data send error !");
+      return -writer->errval;
+    }
+
+  ftpd_response(session->cmd.sd, session->txtimeout,
+                g_respfmt1, 226, ' ', "Transfer complete");
+  return OK;
+
+errout_with_writer:
+
+  /* The buffers are in an unknown state.  Restart the writer with the
+   * next upload.
+   */
+
+  ftpd_stopwriter(session);
+  ftpd_response(session->cmd.sd, session->txtimeout,
+                g_respfmt1, 550, ' ', "Data send error !");
+  return ret;
+}
+#endif
+
 /****************************************************************************
  * Name: ftpd_stream
  ****************************************************************************/
@@ -1770,6 +2163,9 @@ static int ftpd_stream(FAR struct ftpd_session_s *session, int cmdtype)
   size_t wantsize;
   ssize_t rdbytes;
   ssize_t wrbytes;
+  struct timespec start;
+  uint64_t nbytes = 0;
+  uint32_t msec;
   int errval = 0;
   int ret;
 
@@ -1910,6 +2306,24 @@ static int ftpd_stream(FAR struct ftpd_session_s *session, int cmdtype)
       goto errout_with_session;
     }
 
+  clock_gettime(CLOCK_MONOTONIC, &start);
+
+  /* Binary transfers may bypass the data buffer */
+
+#ifdef CONFIG_FTPD_SENDFILE
+  if (cmdtype == 0 && session->type != FTPD_SESSIONTYPE_A)
+    {
+      ret = ftpd_sendfile(session, &nbytes);
+    }
+  else
+#endif
+#if CONFIG_FTPD_STORBUFFERSIZE > 0
+  if (cmdtype != 0 && session->type != FTPD_SESSIONTYPE_A)
+    {
+      ret = ftpd_recvfile(session, &nbytes);
+    }
+  else
+#endif
   for (; ; )
     {
       /* Read from the source (file or TCP connection) */
@@ -2060,6 +2474,33 @@ static int ftpd_stream(FAR struct ftpd_session_s *session, int cmdtype)
           ret = -errval;
           break;
         }
+
+      nbytes += rdbytes;
+    }
+
+  /* Update the session statistics */
+
+  msec = ftpd_elapsed(&start);
+  session->stats.lastbytes = nbytes;
+  session->stats.lastmsec  = msec;
+
+  if (cmdtype == 0)
+    {
+      session->stats.txbytes += nbytes;
+      session->stats.txmsec  += msec;
+      if (ret >= 0)
+        {
+          session->stats.ntx++;
+        }
+    }
+  else
+    {
+      session->stats.rxbytes += nbytes;
+      session->stats.rxmsec  += msec;
+      if (ret >= 0)
+        {
+          session->stats.nrx++;
+        }
     }
 
 errout_with_session:;
@@ -3879,24 +4320,76 @@ static int ftpd_command_opts(FAR struct ftpd_session_s *session)
 
 static int ftpd_command_site(FAR struct ftpd_session_s *session)
 {
-  return ftpd_response(session->cmd.sd, session->txtimeout,
-                       g_respfmt1, 502, ' ',
-                       "SITE command not implemented !");
-}
-
-/****************************************************************************
- * Name: ftpd_command_help
- ****************************************************************************/
-
-static int ftpd_command_help(FAR struct ftpd_session_s *session)
-{
-  int index;
+  FAR const struct ftpd_stats_s *stats = &session->stats;
+  uint64_t rate;
   int ret;
 
-  index = 0;
-  while (g_ftpdhelp[index] != NULL)
+  if (strcasecmp(session->param, "STATS") != 0)
     {
-      if (index == 0 || g_ftpdhelp[index + 1] == NULL)
+      return ftpd_response(session->cmd.sd, session->txtimeout,
+                           g_respfmt1, 502, ' ',
+                           "SITE command not implemented !");
+    }
+
+  /* Report the transfer counters of this session.  Rates are in bytes
+   * per second.
+   */
+
+  ret = ftpd_response(session->cmd.sd, session->txtimeout,
+                      g_respfmt1, 200, '-', "Session statistics");
+  if (ret < 0)
+    {
+      return ret;
+    }
+
+  rate = stats->txmsec > 0 ? stats->txbytes * 1000 / stats->txmsec : 0;
+  ret  = ftpd_response(session->cmd.sd, session->txtimeout,
+                       " RETR: %" PRIu32 " files, %" PRIu64 " bytes, %"
+                       PRIu32 " ms, %" PRIu64 " B/s\r\n",
+                       stats->ntx, stats->txbytes, stats->txmsec, rate);
+  if (ret < 0)
+    {
+      return ret;
+    }
+
+  rate = stats->rxmsec > 0 ? stats->rxbytes * 1000 / stats->rxmsec : 0;
+  ret  = ftpd_response(session->cmd.sd, session->txtimeout,
+                       " STOR: %" PRIu32 " files, %" PRIu64 " bytes, %"
+                       PRIu32 " ms, %" PRIu64 " B/s\r\n",
+                       stats->nrx, stats->rxbytes, stats->rxmsec, rate);
+  if (ret < 0)
+    {
+      return ret;
+    }
+
+  rate = stats->lastmsec > 0 ?
+         stats->lastbytes * 1000 / stats->lastmsec : 0;
+  ret  = ftpd_response(session->cmd.sd, session->txtimeout,
+                       " Last: %" PRIu64 " bytes, %" PRIu32 " ms, %"
+                       PRIu64 " B/s\r\n",
+                       stats->lastbytes, stats->lastmsec, rate);
+  if (ret < 0)
+    {
+      return ret;
+    }
+
+  return ftpd_response(session->cmd.sd, session->txtimeout,
+                       g_respfmt1, 200, ' ', "End of statistics");
+}
+
+/****************************************************************************
+ * Name: ftpd_command_help
+ ****************************************************************************/
+
+static int ftpd_command_help(FAR struct ftpd_session_s *session)
+{
+  int index;
+  int ret;
+
+  index = 0;
+  while (g_ftpdhelp[index] != NULL)
+    {
+      if (index == 0 || g_ftpdhelp[index + 1] == NULL)
         {
           ret = ftpd_response(session->cmd.sd, session->txtimeout,
                               g_respfmt1, 214,
@@ -3982,6 +4475,8 @@ static int ftpd_command(FAR struct ftpd_session_s *session)
  * Name: ftpd_startworker
  ****************************************************************************/
 
+#if CONFIG_FTPD_NWORKERS == 0
+
 static int ftpd_startworker(pthread_startroutine_t handler, FAR void *arg,
                             size_t stacksize)
 {
@@ -4029,55 +4524,196 @@ errout_with_attr:
 errout:
   return -ret;
 }
+#endif
 
 /****************************************************************************
- * Name: ftpd_freesession
+ * Name: ftpd_allocsession
+ *
+ * Description:
+ *   Allocate a session and its buffers.  The session has no connection
+ *   yet.
+ *
  ****************************************************************************/
 
-static void ftpd_freesession(FAR struct ftpd_session_s *session)
+static FAR struct ftpd_session_s *
+ftpd_allocsession(FAR struct ftpd_server_s *server)
+{
+  FAR struct ftpd_session_s *session;
+
+  session = (FAR struct ftpd_session_s *)
+    zalloc(sizeof(struct ftpd_session_s));
+  if (session == NULL)
+    {
+      nerr("ERROR: Failed to allocate session\n");
+      return NULL;
+    }
+
+  /* Initialize the session */
+
+  session->server       = server;
+  session->head         = server->head;
+  session->loggedin     = false;
+  session->flags        = 0;
+  session->txtimeout    = -1;
+  session->rxtimeout    = -1;
+  session->cmd.sd       = -1;
+  session->cmd.addrlen  = sizeof(session->cmd.addr);
+  session->cmd.buflen   = CONFIG_FTPD_CMDBUFFERSIZE;
+  session->cmd.buffer   = NULL;
+  session->command      = NULL;
+  session->param        = NULL;
+  session->data.sd      = -1;
+  session->data.addrlen = sizeof(session->data.addr);
+  session->data.buflen  = CONFIG_FTPD_DATABUFFERSIZE;
+  session->data.buffer  = NULL;
+  session->restartpos   = 0;
+  session->fd           = -1;
+  session->user         = NULL;
+  session->type         = FTPD_SESSIONTYPE_NONE;
+  session->home         = NULL;
+  session->work         = NULL;
+  session->renamefrom   = NULL;
+
+#if CONFIG_FTPD_STORBUFFERSIZE > 0
+  /* The writer thread is started by the first binary upload */
+
+  sem_init(&session->writer.empty, 0, 2);
+  sem_init(&session->writer.full, 0, 0);
+  sem_init(&session->writer.done, 0, 0);
+#endif
+
+  /* Allocate a command buffer */
+
+  session->cmd.buffer = (FAR char *)malloc(session->cmd.buflen);
+  if (session->cmd.buffer == NULL)
+    {
+      nerr("ERROR: Failed to allocate command buffer\n");
+      goto errout_with_session;
+    }
+
+  /* Allocate a data buffer */
+
+  session->data.buffer = (FAR char *)malloc(session->data.buflen);
+  if (session->data.buffer == NULL)
+    {
+      nerr("ERROR: Failed to allocate data buffer\n");
+      goto errout_with_session;
+    }
+
+#if CONFIG_FTPD_STORBUFFERSIZE > 0
+  /* Allocate the two upload buffers */
+
+  session->storbuf = (FAR char *)malloc(2 * CONFIG_FTPD_STORBUFFERSIZE);
+  if (session->storbuf == NULL)
+    {
+      nerr("ERROR: Failed to allocate upload buffers\n");
+      goto errout_with_session;
+    }
+
+  session->writer.buffer[0] = session->storbuf;
+  session->writer.buffer[1] = session->storbuf + CONFIG_FTPD_STORBUFFERSIZE;
+#endif
+
+  return session;
+
+errout_with_session:
+  ftpd_freesession(session);
+  return NULL;
+}
+
+/****************************************************************************
+ * Name: ftpd_resetsession
+ *
+ * Description:
+ *   Close the connections of a session and free the state of the logged in
+ *   user, keeping the buffers so that the session can be reused.
+ *
+ ****************************************************************************/
+
+static void ftpd_resetsession(FAR struct ftpd_session_s *session)
 {
   /* Free resources */
 
   if (session->renamefrom != NULL)
     {
       free(session->renamefrom);
+      session->renamefrom = NULL;
     }
 
   if (session->work != NULL)
     {
       free(session->work);
+      session->work = NULL;
     }
 
   if (session->home != NULL)
     {
       free(session->home);
+      session->home = NULL;
     }
 
   if (session->user != NULL)
     {
       free(session->user);
+      session->user = NULL;
     }
 
   if (session->fd >= 0)
     {
       close(session->fd);
+      session->fd = -1;
     }
 
-  if (session->data.buffer != NULL)
+  ftpd_dataclose(session);
+
+  if (session->cmd.sd >= 0)
     {
-      free(session->data.buffer);
+      close(session->cmd.sd);
+      session->cmd.sd = -1;
     }
 
-  ftpd_dataclose(session);
+  /* Return to the initial state */
 
-  if (session->cmd.buffer != NULL)
+  session->loggedin     = false;
+  session->flags        = 0;
+  session->cmd.addrlen  = sizeof(session->cmd.addr);
+  session->command      = NULL;
+  session->param        = NULL;
+  session->data.addrlen = sizeof(session->data.addr);
+  session->restartpos   = 0;
+  session->type         = FTPD_SESSIONTYPE_NONE;
+
+  memset(&session->stats, 0, sizeof(session->stats));
+}
+
+/****************************************************************************
+ * Name: ftpd_freesession
+ ****************************************************************************/
+
+static void ftpd_freesession(FAR struct ftpd_session_s *session)
+{
+  ftpd_resetsession(session);
+
+#if CONFIG_FTPD_STORBUFFERSIZE > 0
+  ftpd_stopwriter(session);
+  sem_destroy(&session->writer.done);
+  sem_destroy(&session->writer.full);
+  sem_destroy(&session->writer.empty);
+
+  if (session->storbuf != NULL)
     {
-      free(session->cmd.buffer);
+      free(session->storbuf);
     }
+#endif
 
-  if (session->cmd.sd >= 0)
+  if (session->data.buffer != NULL)
     {
-      close(session->cmd.sd);
+      free(session->data.buffer);
+    }
+
+  if (session->cmd.buffer != NULL)
+    {
+      free(session->cmd.buffer);
     }
 
   free(session);
@@ -4117,18 +4753,20 @@ static void ftpd_workersetup(FAR struct ftpd_session_s *session)
 }
 
 /****************************************************************************
- * Name: ftpd_worker
+ * Name: ftpd_serve
+ *
+ * Description:
+ *   Process the FTP commands of a connected session until it disconnects.
+ *
  ****************************************************************************/
 
-static FAR void *ftpd_worker(FAR void *arg)
+static void ftpd_serve(FAR struct ftpd_session_s *session)
 {
-  FAR struct ftpd_session_s *session = (FAR struct ftpd_session_s *)arg;
   ssize_t recvbytes;
   size_t offset;
   uint8_t ch;
   int ret;
 
-  ninfo("Worker started\n");
   DEBUGASSERT(session);
 
   /* Configure the session sockets */
@@ -4142,8 +4780,7 @@ static FAR void *ftpd_worker(FAR void *arg)
   if (ret < 0)
     {
       nerr("ERROR: ftpd_response() failed: %d\n", ret);
-      ftpd_freesession(session);
-      return NULL;
+      return;
     }
 
   /* Then loop processing FTP commands */
@@ -4238,11 +4875,273 @@ static FAR void *ftpd_worker(FAR void *arg)
           break;
         }
     }
+}
 
+/****************************************************************************
+ * Name: ftpd_worker
+ *
+ * Description:
+ *   Thread created for one session when there is no worker pool.
+ *
+ ****************************************************************************/
+
+#if CONFIG_FTPD_NWORKERS == 0
+
+static FAR void *ftpd_worker(FAR void *arg)
+{
+  FAR struct ftpd_session_s *session = (FAR struct ftpd_session_s *)arg;
+
+  ninfo("Worker started\n");
+
+  ftpd_serve(session);
   ftpd_freesession(session);
   return NULL;
 }
 
+#else
+/****************************************************************************
+ * Name: ftpd_poolworker
+ *
+ * Description:
+ *   Pool worker thread.  Serves each session that ftpd_dispatch() assigns
+ *   to its preallocated session, then resets the session for reuse.
+ *
+ ****************************************************************************/
+
+static FAR void *ftpd_poolworker(FAR void *arg)
+{
+  FAR struct ftpd_worker_s *worker = (FAR struct ftpd_worker_s *)arg;
+  FAR struct ftpd_session_s *session = worker->session;
+  FAR struct ftpd_server_s *server =
+    (FAR struct ftpd_server_s *)session->server;
+
+  ninfo("Pool worker started\n");
+
+  for (; ; )
+    {
+      if (ftpd_semwait(&worker->sem) < 0)
+        {
+          /* Make sure that no session is handed to this worker again */
+
+          pthread_mutex_lock(&server->lock);
+          worker->busy = true;
+          pthread_mutex_unlock(&server->lock);
+          break;
+        }
+
+      if (server->stop)
+        {
+          break;
+        }
+
+      ftpd_serve(session);
+
+      /* The connection is closed under the lock so that ftpd_stoppool()
+       * never shuts down a descriptor that has been reused.
+       */
+
+      pthread_mutex_lock(&server->lock);
+      ftpd_resetsession(session);
+      worker->busy = false;
+      pthread_mutex_unlock(&server->lock);
+    }
+
+  return NULL;
+}
+
+/****************************************************************************
+ * Name: ftpd_startpool
+ *
+ * Description:
+ *   Preallocate CONFIG_FTPD_NWORKERS sessions and start their threads.
+ *
+ ****************************************************************************/
+
+static int ftpd_startpool(FAR struct ftpd_server_s *server)
+{
+  FAR struct ftpd_worker_s *worker;
+  pthread_attr_t attr;
+  int ret = OK;
+  int i;
+
+  server->workers = (FAR struct ftpd_worker_s *)
+    zalloc(CONFIG_FTPD_NWORKERS * sizeof(struct ftpd_worker_s));
+  if (server->workers == NULL)
+    {
+      nerr("ERROR: Failed to allocate workers\n");
+      return -ENOMEM;
+    }
+
+  pthread_mutex_init(&server->lock, NULL);
+  server->stop = false;
+
+  pthread_attr_init(&attr);
+  pthread_attr_setstacksize(&attr, CONFIG_FTPD_WORKERSTACKSIZE);
+
+  for (i = 0; i < CONFIG_FTPD_NWORKERS; i++)
+    {
+      worker = &server->workers[i];
+      worker->session = ftpd_allocsession(server);
+      if (worker->session == NULL)
+        {
+          ret = -ENOMEM;
+          break;
+        }
+
+#if CONFIG_FTPD_STORBUFFERSIZE > 0
+      /* Each worker keeps its upload writer thread for its lifetime */
+
+      ret = ftpd_startwriter(worker->session);
+      if (ret < 0)
+        {
+          ftpd_freesession(worker->session);
+          worker->session = NULL;
+          break;
+        }
+#endif
+
+      sem_init(&worker->sem, 0, 0);
+      ret = pthread_create(&worker->thread, &attr, ftpd_poolworker,
+                           worker);
+      if (ret != 0)
+        {
+          nerr("ERROR: pthread_create() failed: %d\n", ret);
+          sem_destroy(&worker->sem);
+          ftpd_freesession(worker->session);
+          worker->session = NULL;
+          ret = -ret;
+          break;
+        }
+    }
+
+  pthread_attr_destroy(&attr);
+
+  if (ret < 0)
+    {
+      ftpd_stoppool(server);
+    }
+
+  return ret;
+}
+
+/****************************************************************************
+ * Name: ftpd_stoppool
+ *
+ * Description:
+ *   Disconnect any active sessions, then stop and free the workers.  A
+ *   transfer in progress completes before its worker sees the disconnect.
+ *   Does nothing if the pool was never started, as when ftpd_openserver()
+ *   fails.
+ *
+ ****************************************************************************/
+
+static void ftpd_stoppool(FAR struct ftpd_server_s *server)
+{
+  FAR struct ftpd_worker_s *worker;
+  int i;
+
+  if (server->workers == NULL)
+    {
+      return;
+    }
+
+  pthread_mutex_lock(&server->lock);
+  server->stop = true;
+
+  for (i = 0; i < CONFIG_FTPD_NWORKERS; i++)
+    {
+      worker = &server->workers[i];
+      if (worker->session != NULL && worker->busy)
+        {
+          shutdown(worker->session->cmd.sd, SHUT_RDWR);
+        }
+    }
+
+  pthread_mutex_unlock(&server->lock);
+
+  for (i = 0; i < CONFIG_FTPD_NWORKERS; i++)
+    {
+      worker = &server->workers[i];
+      if (worker->session != NULL)
+        {
+          sem_post(&worker->sem);
+          pthread_join(worker->thread, NULL);
+          sem_destroy(&worker->sem);
+          ftpd_freesession(worker->session);
+        }
+    }
+
+  pthread_mutex_destroy(&server->lock);
+  free(server->workers);
+  server->workers = NULL;
+}
+
+/****************************************************************************
+ * Name: ftpd_dispatch
+ *
+ * Description:
+ *   Accept a connection and hand it to an idle pool worker.  The
+ *   connection is refused with a 421 reply if every worker is busy.
+ *
+ ****************************************************************************/
+
+static int ftpd_dispatch(FAR struct ftpd_server_s *server, int timeout)
+{
+  FAR struct ftpd_worker_s *worker = NULL;
+  FAR struct ftpd_session_s *session;
+  union ftpd_sockaddr_u addr;
+  socklen_t addrlen = sizeof(addr);
+  int sd;
+  int i;
+
+  sd = ftpd_accept(server->sd, (FAR void *)&addr, &addrlen, timeout);
+  if (sd < 0)
+    {
+#ifdef CONFIG_DEBUG_NET
+      if (sd != -ETIMEDOUT)
+        {
+          nerr("ERROR: ftpd_accept() failed: %d\n", sd);
+        }
+#endif
+
+      return sd;
+    }
+
+  pthread_mutex_lock(&server->lock);
+  for (i = 0; i < CONFIG_FTPD_NWORKERS; i++)
+    {
+      if (!server->workers[i].busy)
+        {
+          worker       = &server->workers[i];
+          worker->busy = true;
+          break;
+        }
+    }
+
+  pthread_mutex_unlock(&server->lock);
+
+  if (worker == NULL)
+    {
+      nwarn("WARNING: All %d workers busy\n", CONFIG_FTPD_NWORKERS);
+      ftpd_response(sd, 1000, g_respfmt1, 421, ' ',
+                    "Too many users, try again later");
+      close(sd);
+      return -EBUSY;
+    }
+
+  /* Accounts may have been added since the session was allocated */
+
+  session              = worker->session;
+  session->head        = server->head;
+  session->cmd.sd      = sd;
+  session->cmd.addrlen = addrlen;
+  memcpy(&session->cmd.addr, &addr, addrlen);
+
+  sem_post(&worker->sem);
+  return OK;
+}
+#endif
+
 /****************************************************************************
  * Public Functions
  ****************************************************************************/
@@ -4271,6 +5170,15 @@ FTPD_SESSION ftpd_open(int port, sa_family_t family)
 
   server = ftpd_openserver(port, family);
 
+#if CONFIG_FTPD_NWORKERS > 0
+  if (server != NULL && ftpd_startpool(server) < 0)
+    {
+      close(server->sd);
+      free(server);
+      server = NULL;
+    }
+#endif
+
   return (FTPD_SESSION)server;
 }
 
@@ -4370,70 +5278,29 @@ errout:
 int ftpd_session(FTPD_SESSION handle, int timeout)
 {
   FAR struct ftpd_server_s  *server;
+#if CONFIG_FTPD_NWORKERS == 0
   FAR struct ftpd_session_s *session;
   int ret;
+#endif
 
   DEBUGASSERT(handle);
 
   server = (FAR struct ftpd_server_s *)handle;
 
+#if CONFIG_FTPD_NWORKERS > 0
+  /* Hand the connection to a preallocated session */
+
+  return ftpd_dispatch(server, timeout);
+#else
   /* Allocate a session */
 
-  session = (FAR struct ftpd_session_s *)
-    zalloc(sizeof(struct ftpd_session_s));
+  session = ftpd_allocsession(server);
   if (session == NULL)
     {
-      nerr("ERROR: Failed to allocate session\n");
       ret = -ENOMEM;
       goto errout;
     }
 
-  /* Initialize the session */
-
-  session->server       = server;
-  session->head         = server->head;
-  session->loggedin     = false;
-  session->flags        = 0;
-  session->txtimeout    = -1;
-  session->rxtimeout    = -1;
-  session->cmd.sd       = -1;
-  session->cmd.addrlen  = sizeof(session->cmd.addr);
-  session->cmd.buflen   = CONFIG_FTPD_CMDBUFFERSIZE;
-  session->cmd.buffer   = NULL;
-  session->command      = NULL;
-  session->param        = NULL;
-  session->data.sd      = -1;
-  session->data.addrlen = sizeof(session->data.addr);
-  session->data.buflen  = CONFIG_FTPD_DATABUFFERSIZE;
-  session->data.buffer  = NULL;
-  session->restartpos   = 0;
-  session->fd           = -1;
-  session->user         = NULL;
-  session->type         = FTPD_SESSIONTYPE_NONE;
-  session->home         = NULL;
-  session->work         = NULL;
-  session->renamefrom   = NULL;
-
-  /* Allocate a command buffer */
-
-  session->cmd.buffer = (FAR char *)malloc(session->cmd.buflen);
-  if (session->cmd.buffer == NULL)
-    {
-      nerr("ERROR: Failed to allocate command buffer\n");
-      ret = -ENOMEM;
-      goto errout_with_session;
-    }
-
-  /* Allocate a data buffer */
-
-  session->data.buffer = (FAR char *)malloc(session->data.buflen);
-  if (session->data.buffer == NULL)
-    {
-      nerr("ERROR: Failed to allocate data buffer\n");
-      ret = -ENOMEM;
-      goto errout_with_session;
-    }
-
   /* Accept a connection */
 
   session->cmd.sd = ftpd_accept(server->sd, (FAR void *)&session->cmd.addr,
@@ -4473,6 +5340,7 @@ errout_with_session:
   ftpd_freesession(session);
 errout:
   return ret;
+#endif
 }
 
 /****************************************************************************
@@ -4495,6 +5363,11 @@ void ftpd_close(FTPD_SESSION handle)
   DEBUGASSERT(handle);
 
   server = (struct ftpd_server_s *)handle;
+
+#if CONFIG_FTPD_NWORKERS > 0
+  ftpd_stoppool(server);
+#endif
+
   if (server->head != NULL)
     {
       ftpd_account_free(server->head);
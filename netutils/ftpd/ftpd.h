@@ -31,6 +31,9 @@
 
 #include <sys/types.h>
 #include <stdbool.h>
+#include <stdint.h>
+#include <pthread.h>
+#include <semaphore.h>
 
 #include <netinet/in.h>
 
@@ -107,6 +110,11 @@ struct ftpd_server_s
   union ftpd_sockaddr_u      addr;   /* Listen address */
   FAR struct ftpd_account_s *head;   /* Head of a list of accounts */
   FAR struct ftpd_account_s *tail;   /* Tail of a list of accounts */
+#if CONFIG_FTPD_NWORKERS > 0
+  pthread_mutex_t            lock;   /* Protects the worker busy flags */
+  bool                       stop;   /* Workers should exit */
+  FAR struct ftpd_worker_s  *workers; /* Pool of session workers */
+#endif
 };
 
 struct ftpd_stream_s
@@ -118,6 +126,40 @@ struct ftpd_stream_s
   char                      *buffer;  /* Pointer to the buffer */
 };
 
+/* Transfer counters of one session, reported by SITE STATS */
+
+struct ftpd_stats_s
+{
+  uint64_t                   txbytes;   /* Bytes sent by RETR */
+  uint64_t                   rxbytes;   /* Bytes received by STOR/APPE */
+  uint32_t                   ntx;       /* Completed downloads */
+  uint32_t                   nrx;       /* Completed uploads */
+  uint32_t                   txmsec;    /* Time spent in downloads */
+  uint32_t                   rxmsec;    /* Time spent in uploads */
+  uint64_t                   lastbytes; /* Size of the last transfer */
+  uint32_t                   lastmsec;  /* Duration of the last transfer */
+};
+
+#if CONFIG_FTPD_STORBUFFERSIZE > 0
+/* Shared between a session receiving an upload and its writer thread.  The
+ * thread is started once and serves every binary upload of the session.
+ */
+
+struct ftpd_writer_s
+{
+  pthread_t                  thread;    /* Writer thread */
+  bool                       started;   /* The thread is running */
+  bool                       exit;      /* Ask the thread to exit */
+  int                        fd;        /* File being written */
+  sem_t                      empty;     /* Counts buffers free to receive */
+  sem_t                      full;      /* Counts buffers ready to write */
+  sem_t                      done;      /* Posted when an upload is written */
+  FAR char                  *buffer[2]; /* The two upload buffers */
+  size_t                     len[2];    /* Data in each, zero ends it */
+  int                        errval;    /* First write error */
+};
+#endif
+
 struct ftpd_session_s
 {
   FAR const struct ftpd_server_s  *server;
@@ -141,6 +183,14 @@ struct ftpd_session_s
   /* File */
 
   int fd;
+#if CONFIG_FTPD_STORBUFFERSIZE > 0
+  FAR char                  *storbuf; /* Two upload buffers */
+  struct ftpd_writer_s       writer;  /* Upload writer thread */
+#endif
+
+  /* Statistics */
+
+  struct ftpd_stats_s        stats;
 
   /* Current user */
 
@@ -151,6 +201,18 @@ struct ftpd_session_s
   FAR char                  *renamefrom;
 };
 
+#if CONFIG_FTPD_NWORKERS > 0
+/* One preallocated session and the thread that serves it */
+
+struct ftpd_worker_s
+{
+  pthread_t                  thread;  /* Worker thread */
+  sem_t                      sem;     /* Posted when a session is assigned */
+  bool                       busy;    /* Serving a session */
+  FAR struct ftpd_session_s *session; /* The preallocated session */
+};
+#endif
+
 typedef int (*ftpd_cmdhandler_t)(FAR struct ftpd_session_s *);
 
 struct ftpd_cmd_s
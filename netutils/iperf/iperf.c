@@ -26,15 +26,22 @@
 
 #include <arpa/inet.h>
 #include <assert.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <inttypes.h>
 #include <net/if.h>
 #include <netinet/in.h>
 #include <netpacket/rpmsg.h>
+#include <poll.h>
 #include <pthread.h>
 #include <sched.h>
 #include <stdbool.h>
+#include <sys/param.h>
 #include <sys/prctl.h>
+#include <sys/sendfile.h>
 #include <sys/socket.h>
 #include <sys/time.h>
+#include <sys/uio.h>
 #include <sys/un.h>
 #include <unistd.h>
 
@@ -47,6 +54,7 @@
 #define IPERF_TRAFFIC_TASK_NAME      "iperf_traffic"
 #define IPERF_TRAFFIC_TASK_PRIORITY  100
 #define IPERF_TRAFFIC_TASK_STACK     4096
+#define IPERF_STREAM_TASK_NAME       "iperf_stream"
 #define IPERF_REPORT_TASK_NAME       "iperf_report"
 #define IPERF_REPORT_TASK_PRIORITY   100
 #define IPERF_REPORT_TASK_STACK      4096
@@ -58,20 +66,81 @@
 
 #define IPERF_MAX_DELAY              64
 #define IPERF_SOCKET_RX_TIMEOUT      10
+#define IPERF_ACCEPT_POLL_MS         500
+
+/* UDP transit times are kept in a histogram with four buckets per power of
+ * two, so percentiles are reported to within 25%.
+ */
+
+#define IPERF_LAT_SUBBITS            2
+#define IPERF_LAT_NBUCKETS           (32 << IPERF_LAT_SUBBITS)
+
+#ifndef MSG_WAITFORONE
+#  define MSG_WAITFORONE             0
+#endif
 
 /****************************************************************************
  * Private Types
  ****************************************************************************/
 
+struct iperf_ctrl_t;
+struct iperf_stream_t;
+
+typedef CODE int (*iperf_client_func_t)(FAR struct iperf_stream_t *stream,
+                                        FAR struct sockaddr *addr,
+                                        socklen_t addrlen);
+typedef CODE int (*iperf_server_func_t)(FAR struct iperf_ctrl_t *ctrl,
+                                        FAR struct sockaddr *addr,
+                                        socklen_t addrlen,
+                                        FAR struct sockaddr *remote_addr);
+
+/* Receive statistics of one UDP stream */
+
+struct iperf_udp_stats_t
+{
+  int32_t last_id;              /* Highest datagram id seen */
+  uint32_t packets;             /* Datagrams received */
+  uint32_t lost;                /* Gaps in the id sequence */
+  uint32_t outoforder;          /* Datagrams older than last_id */
+  int64_t last_transit;         /* Transit time of the last datagram (us) */
+  double jitter;                /* Smoothed transit variation (us) */
+  uint32_t max_transit;         /* Largest transit time (us) */
+  FAR uint32_t *hist;           /* Transit time histogram */
+};
+
+/* One connection, or one sender as seen by the udp server */
+
+struct iperf_stream_t
+{
+  FAR struct iperf_ctrl_t *ctrl;
+  int id;                       /* Stream number, from 1 */
+  int sockfd;
+  pthread_t thread;
+  bool has_thread;              /* thread must be joined */
+  bool started;                 /* Counted in the reports */
+  bool done;                    /* The connection has ended */
+  uintmax_t total_len;
+  uintmax_t last_len;           /* total_len at the previous report */
+  FAR uint8_t *buffer;
+  iperf_client_func_t func;     /* Client streams only */
+  FAR struct sockaddr *addr;
+  socklen_t addrlen;
+  struct sockaddr_storage peer; /* Sender, udp server only */
+  socklen_t peerlen;
+  struct iperf_udp_stats_t udp;
+  uint32_t last_packets;        /* udp.packets at the previous report */
+  uint32_t last_lost;           /* Highest udp.lost reported so far */
+};
+
 struct iperf_ctrl_t
 {
   FAR struct iperf_ctrl_t *flink;
   struct iperf_cfg_t cfg;
   bool finish;
-  uintmax_t total_len;
   uint32_t buffer_len;
-  FAR uint8_t *buffer;
-  uint32_t sockfd;
+  FAR struct iperf_stream_t *streams;
+  pthread_t report_thread;
+  bool reporting;
 };
 
 struct iperf_udp_pkt_t
@@ -81,13 +150,29 @@ struct iperf_udp_pkt_t
   uint32_t usec;
 };
 
-typedef CODE int (*iperf_client_func_t)(FAR struct iperf_ctrl_t *ctrl,
-                                        FAR struct sockaddr *addr,
-                                        socklen_t addrlen);
-typedef CODE int (*iperf_server_func_t)(FAR struct iperf_ctrl_t *ctrl,
-                                        FAR struct sockaddr *addr,
-                                        socklen_t addrlen,
-                                        FAR struct sockaddr *remote_addr);
+#ifdef CONFIG_NETUTILS_IPERF_MMSG
+/* Message headers for one batched udp send or receive */
+
+struct iperf_batch_t
+{
+  struct mmsghdr msgs[IPERF_MAX_BATCH];
+  struct iovec iov[IPERF_MAX_BATCH];
+  struct sockaddr_storage names[IPERF_MAX_BATCH];
+};
+#endif
+
+/* One line of a report */
+
+struct iperf_sample_t
+{
+  int id;                       /* Stream number, 0 for the sum */
+  double start;
+  double end;
+  uintmax_t bytes;
+  FAR const struct iperf_udp_stats_t *udp; /* udp server streams only */
+  uint32_t packets;
+  uint32_t lost;
+};
 
 /****************************************************************************
  * Private Data
@@ -275,6 +360,357 @@ static double ts_diff(const struct timespec *a, const struct timespec *b)
   return ts_sec(a) - ts_sec(b);
 }
 
+/****************************************************************************
+ * Name: iperf_lat_bucket
+ *
+ * Description:
+ *   Return the histogram bucket of a transit time in microseconds.
+ *
+ ****************************************************************************/
+
+static int iperf_lat_bucket(uint32_t us)
+{
+  int msb = IPERF_LAT_SUBBITS;
+
+  if (us < (1 << IPERF_LAT_SUBBITS))
+    {
+      return us;
+    }
+
+  while ((us >> (msb + 1)) != 0)
+    {
+      msb++;
+    }
+
+  return ((msb - IPERF_LAT_SUBBITS + 1) << IPERF_LAT_SUBBITS) +
+         ((us >> (msb - IPERF_LAT_SUBBITS)) &
+          ((1 << IPERF_LAT_SUBBITS) - 1));
+}
+
+/****************************************************************************
+ * Name: iperf_lat_value
+ *
+ * Description:
+ *   Return the largest transit time in microseconds counted in a bucket.
+ *
+ ****************************************************************************/
+
+static uint32_t iperf_lat_value(int bucket)
+{
+  int shift = (bucket >> IPERF_LAT_SUBBITS) - 1;
+  uint64_t sub = bucket & ((1 << IPERF_LAT_SUBBITS) - 1);
+
+  if (shift < 0)
+    {
+      return bucket;
+    }
+
+  return MIN((((1 << IPERF_LAT_SUBBITS) + sub + 1) << shift) - 1,
+             UINT32_MAX);
+}
+
+/****************************************************************************
+ * Name: iperf_lat_percentile
+ *
+ * Description:
+ *   Return the transit time in microseconds below which pct percent of the
+ *   datagrams of a stream arrived.
+ *
+ ****************************************************************************/
+
+static uint32_t iperf_lat_percentile(FAR const struct iperf_udp_stats_t *udp,
+                                     uint32_t pct)
+{
+  uint64_t want = ((uint64_t)udp->packets * pct + 99) / 100;
+  uint64_t seen = 0;
+  int i;
+
+  for (i = 0; i < IPERF_LAT_NBUCKETS; i++)
+    {
+      seen += udp->hist[i];
+      if (seen >= want && seen > 0)
+        {
+          return MIN(iperf_lat_value(i), udp->max_transit);
+        }
+    }
+
+  return udp->max_transit;
+}
+
+/****************************************************************************
+ * Name: iperf_udp_account
+ *
+ * Description:
+ *   Update the statistics of a udp stream with one received datagram.
+ *   Transit times are only meaningful if the clocks of both ends are
+ *   synchronized, but jitter is not affected by a constant offset.
+ *
+ ****************************************************************************/
+
+static void iperf_udp_account(FAR struct iperf_stream_t *stream,
+                              FAR const uint8_t *data, ssize_t len,
+                              FAR const struct timespec *now)
+{
+  FAR const struct iperf_udp_pkt_t *udp =
+    (FAR const struct iperf_udp_pkt_t *)data;
+  FAR struct iperf_udp_stats_t *stats = &stream->udp;
+  int64_t transit;
+  int64_t delta;
+  int32_t id;
+
+  stream->total_len += len;
+  if (len < sizeof(*udp))
+    {
+      return;
+    }
+
+  /* A negative id marks the end of an iperf 2 test */
+
+  id = ntohl(udp->id);
+  if (id < 0)
+    {
+      return;
+    }
+
+  transit = ((int64_t)now->tv_sec - (int64_t)ntohl(udp->sec)) * 1000000 +
+            now->tv_nsec / 1000 - (int64_t)ntohl(udp->usec);
+
+  if (stats->packets > 0)
+    {
+      /* RFC 3550 interarrival jitter */
+
+      delta = transit - stats->last_transit;
+      if (delta < 0)
+        {
+          delta = -delta;
+        }
+
+      stats->jitter += ((double)delta - stats->jitter) / 16.0;
+    }
+
+  stats->last_transit = transit;
+  stats->packets++;
+
+  if (id > stats->last_id + 1)
+    {
+      stats->lost += id - stats->last_id - 1;
+    }
+  else if (id <= stats->last_id)
+    {
+      /* A late datagram was already counted as lost */
+
+      stats->outoforder++;
+      if (stats->lost > 0)
+        {
+          stats->lost--;
+        }
+    }
+
+  if (id > stats->last_id)
+    {
+      stats->last_id = id;
+    }
+
+  if (transit < 0)
+    {
+      transit = 0;
+    }
+  else if (transit > UINT32_MAX)
+    {
+      transit = UINT32_MAX;
+    }
+
+  if ((uint32_t)transit > stats->max_transit)
+    {
+      stats->max_transit = transit;
+    }
+
+  if (stats->hist != NULL)
+    {
+      stats->hist[iperf_lat_bucket(transit)]++;
+    }
+}
+
+/****************************************************************************
+ * Name: iperf_print_sample
+ *
+ * Description:
+ *   Print one line of a report, as text or as a JSON object.
+ *
+ ****************************************************************************/
+
+static void iperf_print_sample(FAR struct iperf_ctrl_t *ctrl,
+                               FAR const struct iperf_sample_t *sample,
+                               bool multi, bool summary)
+{
+  double mbps = 0.0;
+  uint32_t total = sample->packets + sample->lost;
+
+  if (sample->end > sample->start)
+    {
+      mbps = ((sample->bytes * 8) / 1000000.0) /
+             (sample->end - sample->start);
+    }
+
+  if (ctrl->cfg.flag & IPERF_FLAG_JSON)
+    {
+      printf("{\"event\":\"%s\",\"stream\":%d,\"start\":%.2f,"
+             "\"end\":%.2f,\"bytes\":%ju,\"bits_per_second\":%.0f",
+             summary ? "summary" : "interval", sample->id,
+             sample->start, sample->end, sample->bytes, mbps * 1000000.0);
+
+      if (sample->udp != NULL)
+        {
+          printf(",\"jitter_ms\":%.3f,\"lost_packets\":%" PRIu32
+                 ",\"packets\":%" PRIu32,
+                 sample->udp->jitter / 1000.0, sample->lost, total);
+
+          if (summary && sample->udp->hist != NULL)
+            {
+              printf(",\"out_of_order\":%" PRIu32 ",\"latency_us\":"
+                     "{\"p50\":%" PRIu32 ",\"p90\":%" PRIu32
+                     ",\"p99\":%" PRIu32 ",\"max\":%" PRIu32 "}",
+                     sample->udp->outoforder,
+                     iperf_lat_percentile(sample->udp, 50),
+                     iperf_lat_percentile(sample->udp, 90),
+                     iperf_lat_percentile(sample->udp, 99),
+                     sample->udp->max_transit);
+            }
+        }
+
+      printf("}\n");
+      return;
+    }
+
+  if (multi && sample->id > 0)
+    {
+      printf("[%3d] ", sample->id);
+    }
+  else if (multi)
+    {
+      printf("[SUM] ");
+    }
+
+  printf("%7.2lf-%7.2lf sec %10ju Bytes %7.2f Mbits/sec",
+         sample->start, sample->end, sample->bytes, mbps);
+
+  if (sample->udp != NULL)
+    {
+      printf(" %7.3f ms %5" PRIu32 "/%5" PRIu32 " (%.2g%%)",
+             sample->udp->jitter / 1000.0, sample->lost, total,
+             total > 0 ? 100.0 * sample->lost / total : 0.0);
+    }
+
+  printf("\n");
+
+  if (summary && sample->udp != NULL && sample->udp->hist != NULL &&
+      sample->udp->packets > 0)
+    {
+      printf("%s      latency p50/p90/p99/max %" PRIu32 "/%" PRIu32
+             "/%" PRIu32 "/%" PRIu32 " us, %" PRIu32 " out of order\n",
+             multi ? "      " : "",
+             iperf_lat_percentile(sample->udp, 50),
+             iperf_lat_percentile(sample->udp, 90),
+             iperf_lat_percentile(sample->udp, 99),
+             sample->udp->max_transit, sample->udp->outoforder);
+    }
+}
+
+/****************************************************************************
+ * Name: iperf_print_report
+ *
+ * Description:
+ *   Print one line per started stream, and their sum if there are several.
+ *
+ ****************************************************************************/
+
+static void iperf_print_report(FAR struct iperf_ctrl_t *ctrl,
+                               double start, double end, bool summary)
+{
+  FAR struct iperf_stream_t *stream;
+  struct iperf_sample_t sample;
+  struct iperf_sample_t sum;
+  int nstarted = 0;
+  int i;
+
+  for (i = 0; i < ctrl->cfg.nstreams; i++)
+    {
+      nstarted += ctrl->streams[i].started;
+    }
+
+  memset(&sum, 0, sizeof(sum));
+  sum.start = start;
+  sum.end   = end;
+
+  for (i = 0; i < ctrl->cfg.nstreams; i++)
+    {
+      uintmax_t total_len;
+      uint32_t packets;
+      uint32_t lost;
+
+      stream = &ctrl->streams[i];
+      if (!stream->started)
+        {
+          continue;
+        }
+
+      total_len = stream->total_len;
+      packets   = stream->udp.packets;
+      lost      = stream->udp.lost;
+
+      memset(&sample, 0, sizeof(sample));
+      sample.id    = stream->id;
+      sample.start = start;
+      sample.end   = end;
+
+      if (summary)
+        {
+          sample.bytes   = total_len;
+          sample.packets = packets;
+          sample.lost    = lost;
+        }
+      else
+        {
+          sample.bytes   = total_len - stream->last_len;
+          sample.packets = packets - stream->last_packets;
+          stream->last_len     = total_len;
+          stream->last_packets = packets;
+
+          /* A late datagram takes back a loss counted in an earlier
+           * interval.  Report no loss then and keep the high mark, so
+           * that the correction offsets the next gaps instead.
+           */
+
+          if (lost > stream->last_lost)
+            {
+              sample.lost       = lost - stream->last_lost;
+              stream->last_lost = lost;
+            }
+        }
+
+      if (iperf_is_udp_server(ctrl))
+        {
+          sample.udp = &stream->udp;
+        }
+
+      if (nstarted > 1)
+        {
+          iperf_print_sample(ctrl, &sample, true, summary);
+        }
+
+      sum.bytes   += sample.bytes;
+      sum.packets += sample.packets;
+      sum.lost    += sample.lost;
+      if (nstarted == 1)
+        {
+          sum.udp = sample.udp;
+          sum.id  = sample.id;
+        }
+    }
+
+  iperf_print_sample(ctrl, &sum, nstarted > 1, summary);
+}
+
 /****************************************************************************
  * Name: iperf_report_task
  *
@@ -290,12 +726,10 @@ static void iperf_report_task(FAR void *arg)
   uint32_t time = ctrl->cfg.time;
   struct timespec now;
   struct timespec start;
-  uintmax_t now_len;
   int ret;
 
   prctl(PR_SET_NAME, IPERF_REPORT_TASK_NAME);
 
-  now_len = ctrl->total_len;
   ret = clock_gettime(CLOCK_MONOTONIC, &now);
   if (ret != 0)
     {
@@ -304,16 +738,23 @@ static void iperf_report_task(FAR void *arg)
     }
 
   start = now;
-  printf("\n%19s %16s %18s\n", "Interval", "Transfer", "Bandwidth\n");
+  if ((ctrl->cfg.flag & IPERF_FLAG_JSON) == 0)
+    {
+      printf("\n%19s %16s %18s", "Interval", "Transfer", "Bandwidth");
+      if (iperf_is_udp_server(ctrl))
+        {
+          printf(" %12s %16s", "Jitter", "Lost/Total");
+        }
+
+      printf("\n\n");
+    }
+
   while (!ctrl->finish)
     {
-      uintmax_t last_len;
       struct timespec last;
 
       sleep(interval);
-      last_len = now_len;
       last = now;
-      now_len = ctrl->total_len;
       ret = clock_gettime(CLOCK_MONOTONIC, &now);
       if (ret != 0)
         {
@@ -321,13 +762,8 @@ static void iperf_report_task(FAR void *arg)
           exit(EXIT_FAILURE);
         }
 
-      printf("%7.2lf-%7.2lf sec %10ju Bytes %7.2f Mbits/sec\n",
-             ts_diff(&last, &start),
-             ts_diff(&now, &start),
-             now_len -last_len,
-             (((now_len - last_len) * 8) / 1000000.0) /
-             ts_diff(&now, &last)
-             );
+      iperf_print_report(ctrl, ts_diff(&last, &start),
+                         ts_diff(&now, &start), false);
       if (time != 0 && ts_diff(&now, &start) >= time)
         {
           break;
@@ -336,13 +772,7 @@ static void iperf_report_task(FAR void *arg)
 
   if (ts_diff(&now, &start) > 0)
     {
-      printf("%7.2lf-%7.2lf sec %10ju Bytes %7.2f Mbits/sec\n",
-             ts_diff(&start, &start),
-             ts_diff(&now, &start),
-             now_len,
-             ((now_len * 8) / 1000000.0) /
-             ts_diff(&now, &start)
-             );
+      iperf_print_report(ctrl, 0.0, ts_diff(&now, &start), true);
     }
 
   ctrl->finish = true;
@@ -350,11 +780,47 @@ static void iperf_report_task(FAR void *arg)
   pthread_exit(NULL);
 }
 
+/****************************************************************************
+ * Name: iperf_create_thread
+ *
+ * Description:
+ *   Create a traffic thread, pinned to a CPU if requested.  Stream n runs
+ *   on the n-th CPU after the configured one.
+ *
+ ****************************************************************************/
+
+static int iperf_create_thread(FAR struct iperf_ctrl_t *ctrl,
+                               FAR pthread_t *thread, FAR void *entry,
+                               FAR void *arg, int index)
+{
+  struct sched_param param;
+  pthread_attr_t attr;
+#ifdef CONFIG_SMP
+  cpu_set_t cpuset;
+#endif
+
+  pthread_attr_init(&attr);
+  param.sched_priority = IPERF_TRAFFIC_TASK_PRIORITY;
+  pthread_attr_setschedparam(&attr, &param);
+  pthread_attr_setstacksize(&attr, IPERF_TRAFFIC_TASK_STACK);
+
+#ifdef CONFIG_SMP
+  if (ctrl->cfg.affinity >= 0)
+    {
+      CPU_ZERO(&cpuset);
+      CPU_SET((ctrl->cfg.affinity + index) % CONFIG_SMP_NCPUS, &cpuset);
+      pthread_attr_setaffinity_np(&attr, sizeof(cpu_set_t), &cpuset);
+    }
+#endif
+
+  return pthread_create(thread, &attr, entry, arg);
+}
+
 /****************************************************************************
  * Name: iperf_start_report
  *
  * Description:
- *   Start iperf report
+ *   Start iperf report, once, when the first stream starts
  *
  ****************************************************************************/
 
@@ -362,26 +828,102 @@ static int iperf_start_report(FAR struct iperf_ctrl_t *ctrl)
 {
   struct sched_param param;
   pthread_attr_t attr;
-  pthread_t thread;
-  int ret;
+  int ret = 0;
+
+  pthread_mutex_lock(&g_iperf_ctrl_mutex);
+  if (ctrl->reporting)
+    {
+      goto out;
+    }
 
   pthread_attr_init(&attr);
   param.sched_priority = IPERF_REPORT_TASK_PRIORITY;
   pthread_attr_setschedparam(&attr, &param);
   pthread_attr_setstacksize(&attr, IPERF_REPORT_TASK_STACK);
 
-  ret = pthread_create(&thread, &attr, (FAR void *)iperf_report_task,
-                       ctrl);
+  ret = pthread_create(&ctrl->report_thread, &attr,
+                       (FAR void *)iperf_report_task, ctrl);
   if (ret != 0)
     {
       printf("iperf_thread: pthread_create failed: %d, %s\n",
              ret, IPERF_REPORT_TASK_NAME);
-      return -1;
+      ret = -1;
+      goto out;
     }
 
-  pthread_detach(thread);
+  ctrl->reporting = true;
 
-  return 0;
+out:
+  pthread_mutex_unlock(&g_iperf_ctrl_mutex);
+  return ret;
+}
+
+/****************************************************************************
+ * Name: iperf_task_stream
+ *
+ * Description:
+ *   Run one client stream, or one connection accepted by the tcp server.
+ *
+ ****************************************************************************/
+
+static void iperf_task_stream(FAR void *arg)
+{
+  FAR struct iperf_stream_t *stream = arg;
+
+  prctl(PR_SET_NAME, IPERF_STREAM_TASK_NAME);
+
+  stream->func(stream, stream->addr, stream->addrlen);
+
+  pthread_exit(NULL);
+}
+
+/****************************************************************************
+ * Name: iperf_join_streams
+ *
+ * Description:
+ *   Wait for the stream threads.  Their buffers and statistics are kept
+ *   for the final report.
+ *
+ ****************************************************************************/
+
+static void iperf_join_streams(FAR struct iperf_ctrl_t *ctrl)
+{
+  FAR struct iperf_stream_t *stream;
+  FAR void *retval;
+  int i;
+
+  for (i = 0; i < ctrl->cfg.nstreams; i++)
+    {
+      stream = &ctrl->streams[i];
+      if (stream->has_thread)
+        {
+          pthread_join(stream->thread, &retval);
+          stream->has_thread = false;
+        }
+    }
+}
+
+/****************************************************************************
+ * Name: iperf_streams_done
+ *
+ * Description:
+ *   Check if the first n streams have all ended.
+ *
+ ****************************************************************************/
+
+static bool iperf_streams_done(FAR struct iperf_ctrl_t *ctrl, int n)
+{
+  int i;
+
+  for (i = 0; i < n; i++)
+    {
+      if (!ctrl->streams[i].done)
+        {
+          return false;
+        }
+    }
+
+  return true;
 }
 
 /****************************************************************************
@@ -415,21 +957,67 @@ static int iperf_run_server(FAR struct iperf_ctrl_t *ctrl,
       strlcpy(addr.rp_cpu, ctrl->cfg.host, sizeof(addr.rp_cpu));
       strlcpy(addr.rp_name, ctrl->cfg.path, sizeof(addr.rp_name));
 
-      return server_func(ctrl, (FAR struct sockaddr *)&addr, sizeof(addr),
-                               (FAR struct sockaddr *)&remote_addr);
-    }
-  else
+      return server_func(ctrl, (FAR struct sockaddr *)&addr, sizeof(addr),
+                               (FAR struct sockaddr *)&remote_addr);
+    }
+  else
+    {
+      struct sockaddr_in addr;
+      struct sockaddr_in remote_addr;
+
+      addr.sin_family = AF_INET;
+      addr.sin_port = htons(ctrl->cfg.sport);
+      addr.sin_addr.s_addr = ctrl->cfg.sip;
+
+      return server_func(ctrl, (FAR struct sockaddr *)&addr, sizeof(addr),
+                               (FAR struct sockaddr *)&remote_addr);
+    }
+}
+
+/****************************************************************************
+ * Name: iperf_run_streams
+ *
+ * Description:
+ *   Run all client streams.  The first one runs in the traffic thread and
+ *   each of the others in a thread of its own.
+ *
+ ****************************************************************************/
+
+static int iperf_run_streams(FAR struct iperf_ctrl_t *ctrl,
+                             iperf_client_func_t client_func,
+                             FAR struct sockaddr *addr, socklen_t addrlen)
+{
+  FAR struct iperf_stream_t *stream;
+  int ret;
+  int i;
+
+  for (i = 0; i < ctrl->cfg.nstreams; i++)
     {
-      struct sockaddr_in addr;
-      struct sockaddr_in remote_addr;
+      stream          = &ctrl->streams[i];
+      stream->func    = client_func;
+      stream->addr    = addr;
+      stream->addrlen = addrlen;
+    }
 
-      addr.sin_family = AF_INET;
-      addr.sin_port = htons(ctrl->cfg.sport);
-      addr.sin_addr.s_addr = ctrl->cfg.sip;
+  for (i = 1; i < ctrl->cfg.nstreams; i++)
+    {
+      stream = &ctrl->streams[i];
+      ret = iperf_create_thread(ctrl, &stream->thread,
+                                (FAR void *)iperf_task_stream, stream, i);
+      if (ret != 0)
+        {
+          printf("iperf_task_stream: create task failed: %d\n", ret);
+          ctrl->finish = true;
+          break;
+        }
 
-      return server_func(ctrl, (FAR struct sockaddr *)&addr, sizeof(addr),
-                               (FAR struct sockaddr *)&remote_addr);
+      stream->has_thread = true;
     }
+
+  ret = client_func(&ctrl->streams[0], addr, addrlen);
+
+  iperf_join_streams(ctrl);
+  return ret;
 }
 
 /****************************************************************************
@@ -450,7 +1038,8 @@ static int iperf_run_client(FAR struct iperf_ctrl_t *ctrl,
       addr.sun_family = AF_LOCAL;
       strlcpy(addr.sun_path, ctrl->cfg.path, sizeof(addr.sun_path));
 
-      return client_func(ctrl, (FAR struct sockaddr *)&addr, sizeof(addr));
+      return iperf_run_streams(ctrl, client_func,
+                               (FAR struct sockaddr *)&addr, sizeof(addr));
     }
   else if (ctrl->cfg.flag & IPERF_FLAG_RPMSG)
     {
@@ -460,7 +1049,8 @@ static int iperf_run_client(FAR struct iperf_ctrl_t *ctrl,
       strlcpy(addr.rp_cpu, ctrl->cfg.host, sizeof(addr.rp_cpu));
       strlcpy(addr.rp_name, ctrl->cfg.path, sizeof(addr.rp_name));
 
-      return client_func(ctrl, (FAR struct sockaddr *)&addr, sizeof(addr));
+      return iperf_run_streams(ctrl, client_func,
+                               (FAR struct sockaddr *)&addr, sizeof(addr));
     }
   else
     {
@@ -470,15 +1060,59 @@ static int iperf_run_client(FAR struct iperf_ctrl_t *ctrl,
       addr.sin_port = htons(ctrl->cfg.dport);
       addr.sin_addr.s_addr = ctrl->cfg.dip;
 
-      return client_func(ctrl, (FAR struct sockaddr *)&addr, sizeof(addr));
+      return iperf_run_streams(ctrl, client_func,
+                               (FAR struct sockaddr *)&addr, sizeof(addr));
+    }
+}
+
+/****************************************************************************
+ * Name: iperf_tcp_recv
+ *
+ * Description:
+ *   Receive on one connection accepted by the tcp server
+ *
+ ****************************************************************************/
+
+static int iperf_tcp_recv(FAR struct iperf_stream_t *stream,
+                          FAR struct sockaddr *addr, socklen_t addrlen)
+{
+  FAR struct iperf_ctrl_t *ctrl = stream->ctrl;
+  int actual_recv = 0;
+  int want_recv = ctrl->buffer_len;
+
+  while (!ctrl->finish)
+    {
+      actual_recv = recv(stream->sockfd, stream->buffer, want_recv, 0);
+      if (actual_recv == 0)
+        {
+          iperf_print_addr("closed by the peer", addr);
+          break;
+        }
+      else if (actual_recv < 0)
+        {
+          iperf_show_socket_error_reason("tcp server recv",
+                                         stream->sockfd);
+          break;
+        }
+      else
+        {
+          stream->total_len += actual_recv;
+        }
     }
+
+  close(stream->sockfd);
+  stream->done = true;
+
+  return 0;
 }
 
 /****************************************************************************
  * Name: iperf_tcp_server
  *
  * Description:
- *   The main tcp server logic
+ *   The main tcp server logic.  Each accepted connection is received in a
+ *   thread of its own.  Unlike the original iperf, this implementation
+ *   exits once all of the connections accepted so far have been closed.
  *
  ****************************************************************************/
 
@@ -486,13 +1120,15 @@ static int iperf_tcp_server(FAR struct iperf_ctrl_t *ctrl,
                             FAR struct sockaddr *addr, socklen_t addrlen,
                             FAR struct sockaddr *remote_addr)
 {
-  int actual_recv = 0;
-  int want_recv = 0;
-  FAR uint8_t *buffer;
+  FAR struct iperf_stream_t *stream;
+  socklen_t remote_len = addrlen;
+  struct pollfd pfd;
   int listen_socket;
   struct timeval t;
+  int naccepted = 0;
   int sockfd;
   int opt;
+  int ret;
 
   listen_socket = socket(addr->sa_family, SOCK_STREAM, IPPROTO_TCP);
   if (listen_socket < 0)
@@ -516,61 +1152,84 @@ static int iperf_tcp_server(FAR struct iperf_ctrl_t *ctrl,
       return -1;
     }
 
-  buffer = ctrl->buffer;
-  want_recv = ctrl->buffer_len;
   while (!ctrl->finish)
     {
-      /* TODO need to change to non-block mode */
+      /* Finish once every accepted connection has ended */
+
+      if (naccepted > 0 && iperf_streams_done(ctrl, naccepted))
+        {
+          break;
+        }
+
+      pfd.fd      = listen_socket;
+      pfd.events  = POLLIN;
+      pfd.revents = 0;
+
+      ret = poll(&pfd, 1, IPERF_ACCEPT_POLL_MS);
+      if (ret <= 0)
+        {
+          continue;
+        }
 
+      addrlen = remote_len;
       sockfd = accept4(listen_socket, remote_addr, &addrlen, SOCK_CLOEXEC);
       if (sockfd < 0)
         {
           iperf_show_socket_error_reason("tcp server listen", listen_socket);
-          close(listen_socket);
-          return -1;
+          break;
         }
-      else
-        {
-          iperf_print_addr("accept", remote_addr);
-          iperf_start_report(ctrl);
 
-          t.tv_sec = IPERF_SOCKET_RX_TIMEOUT;
-          t.tv_usec = 0;
-          setsockopt(sockfd, SOL_SOCKET, SO_RCVTIMEO, &t, sizeof(t));
+      iperf_print_addr("accept", remote_addr);
+      if (naccepted >= ctrl->cfg.nstreams)
+        {
+          printf("too many streams, closing\n");
+          close(sockfd);
+          continue;
         }
 
-      while (!ctrl->finish)
+      stream = &ctrl->streams[naccepted];
+      stream->buffer = malloc(ctrl->buffer_len);
+      if (stream->buffer == NULL)
         {
-          actual_recv = recv(sockfd, buffer, want_recv, 0);
-          if (actual_recv == 0)
-            {
-              iperf_print_addr("closed by the peer", remote_addr);
+          printf("create buffer: not enough memory\n");
+          close(sockfd);
+          continue;
+        }
 
-              /* Note: unlike the original iperf, this implementation
-               * exits after finishing a single connection.
-               */
+      t.tv_sec = IPERF_SOCKET_RX_TIMEOUT;
+      t.tv_usec = 0;
+      setsockopt(sockfd, SOL_SOCKET, SO_RCVTIMEO, &t, sizeof(t));
 
-              ctrl->finish = true;
-              break;
-            }
-          else if (actual_recv < 0)
-            {
-              iperf_show_socket_error_reason("tcp server recv",
-                                             listen_socket);
-              ctrl->finish = true;
-              break;
-            }
-          else
-            {
-              ctrl->total_len += actual_recv;
-            }
+      /* The stream keeps its own copy of the peer address */
+
+      memcpy(&stream->peer, remote_addr, MIN(addrlen, sizeof(stream->peer)));
+      stream->peerlen = addrlen;
+      stream->sockfd  = sockfd;
+      stream->func    = iperf_tcp_recv;
+      stream->addr    = (FAR struct sockaddr *)&stream->peer;
+      stream->addrlen = stream->peerlen;
+
+      ret = iperf_create_thread(ctrl, &stream->thread,
+                                (FAR void *)iperf_task_stream, stream,
+                                naccepted);
+      if (ret != 0)
+        {
+          printf("iperf_task_stream: create task failed: %d\n", ret);
+          free(stream->buffer);
+          stream->buffer = NULL;
+          close(sockfd);
+          continue;
         }
 
-      close(sockfd);
+      stream->has_thread = true;
+      stream->started    = true;
+      naccepted++;
+      iperf_start_report(ctrl);
     }
 
   ctrl->finish = true;
   close(listen_socket);
+  iperf_join_streams(ctrl);
 
   return 0;
 }
@@ -588,11 +1247,60 @@ static int iperf_run_tcp_server(FAR struct iperf_ctrl_t *ctrl)
   return iperf_run_server(ctrl, iperf_tcp_server);
 }
 
+/****************************************************************************
+ * Name: iperf_udp_stream
+ *
+ * Description:
+ *   Find the stream of the sender of a datagram, starting a new one for a
+ *   new sender.  Returns NULL if all streams are in use.
+ *
+ ****************************************************************************/
+
+static FAR struct iperf_stream_t *
+iperf_udp_stream(FAR struct iperf_ctrl_t *ctrl,
+                 FAR struct sockaddr *remote_addr, socklen_t addrlen)
+{
+  FAR struct iperf_stream_t *stream;
+  int i;
+
+  addrlen = MIN(addrlen, sizeof(stream->peer));
+  for (i = 0; i < ctrl->cfg.nstreams; i++)
+    {
+      stream = &ctrl->streams[i];
+      if (!stream->started)
+        {
+          break;
+        }
+
+      if (stream->peerlen == addrlen &&
+          memcmp(&stream->peer, remote_addr, addrlen) == 0)
+        {
+          return stream;
+        }
+    }
+
+  if (i == ctrl->cfg.nstreams)
+    {
+      return NULL;
+    }
+
+  iperf_print_addr("accept", remote_addr);
+
+  memcpy(&stream->peer, remote_addr, addrlen);
+  stream->peerlen  = addrlen;
+  stream->udp.hist = calloc(IPERF_LAT_NBUCKETS, sizeof(uint32_t));
+  stream->started  = true;
+
+  iperf_start_report(ctrl);
+  return stream;
+}
+
 /****************************************************************************
  * Name: iperf_udp_server
  *
  * Description:
- *   The main udp server logic
+ *   The main udp server logic.  Datagrams are accounted to a stream per
+ *   sender.
  *
  ****************************************************************************/
 
@@ -600,13 +1308,21 @@ static int iperf_udp_server(FAR struct iperf_ctrl_t *ctrl,
                             FAR struct sockaddr *addr, socklen_t addrlen,
                             FAR struct sockaddr *remote_addr)
 {
+  FAR struct iperf_stream_t *stream;
+#ifdef CONFIG_NETUTILS_IPERF_MMSG
+  FAR struct iperf_batch_t *batch = NULL;
+#endif
+  socklen_t remote_len = addrlen;
   int actual_recv = 0;
+  struct timespec now;
   struct timeval t;
   int want_recv = 0;
   FAR uint8_t *buffer;
   int sockfd;
   int opt;
-  bool udp_recv_start = true;
+#ifdef CONFIG_NETUTILS_IPERF_MMSG
+  int i;
+#endif
 
   sockfd = socket(addr->sa_family, SOCK_DGRAM, IPPROTO_UDP);
   if (sockfd < 0)
@@ -620,19 +1336,87 @@ static int iperf_udp_server(FAR struct iperf_ctrl_t *ctrl,
   if (bind(sockfd, addr, addrlen) != 0)
     {
       iperf_show_socket_error_reason("udp server bind", sockfd);
+      close(sockfd);
       return -1;
     }
 
-  buffer = ctrl->buffer;
+  /* All senders share the receive buffer of the first stream */
+
   want_recv = ctrl->buffer_len;
+  buffer = malloc(want_recv * ctrl->cfg.batch);
+  if (buffer == NULL)
+    {
+      printf("create buffer: not enough memory\n");
+      close(sockfd);
+      return -1;
+    }
+
+  ctrl->streams[0].buffer = buffer;
   printf("want recv=%d\n", want_recv);
 
+#ifdef CONFIG_NETUTILS_IPERF_MMSG
+  if (ctrl->cfg.batch > 1)
+    {
+      batch = malloc(sizeof(*batch));
+      if (batch == NULL)
+        {
+          printf("create batch: not enough memory\n");
+          close(sockfd);
+          return -1;
+        }
+
+      for (i = 0; i < ctrl->cfg.batch; i++)
+        {
+          batch->iov[i].iov_base = buffer + i * want_recv;
+          batch->iov[i].iov_len  = want_recv;
+        }
+    }
+#endif
+
   t.tv_sec = IPERF_SOCKET_RX_TIMEOUT;
   t.tv_usec = 0;
   setsockopt(sockfd, SOL_SOCKET, SO_RCVTIMEO, &t, sizeof(t));
 
   while (!ctrl->finish)
     {
+#ifdef CONFIG_NETUTILS_IPERF_MMSG
+      if (batch != NULL)
+        {
+          memset(batch->msgs, 0, sizeof(batch->msgs));
+          for (i = 0; i < ctrl->cfg.batch; i++)
+            {
+              batch->msgs[i].msg_hdr.msg_name    = &batch->names[i];
+              batch->msgs[i].msg_hdr.msg_namelen = sizeof(batch->names[i]);
+              batch->msgs[i].msg_hdr.msg_iov     = &batch->iov[i];
+              batch->msgs[i].msg_hdr.msg_iovlen  = 1;
+            }
+
+          actual_recv = recvmmsg(sockfd, batch->msgs, ctrl->cfg.batch,
+                                 MSG_WAITFORONE, NULL);
+          if (actual_recv < 0)
+            {
+              iperf_show_socket_error_reason("udp server recv", sockfd);
+              continue;
+            }
+
+          clock_gettime(CLOCK_REALTIME, &now);
+          for (i = 0; i < actual_recv; i++)
+            {
+              stream = iperf_udp_stream(ctrl,
+                          (FAR struct sockaddr *)&batch->names[i],
+                          batch->msgs[i].msg_hdr.msg_namelen);
+              if (stream != NULL)
+                {
+                  iperf_udp_account(stream, batch->iov[i].iov_base,
+                                    batch->msgs[i].msg_len, &now);
+                }
+            }
+
+          continue;
+        }
+#endif
+
+      addrlen = remote_len;
       actual_recv = recvfrom(sockfd, buffer, want_recv, 0,
                              remote_addr, &addrlen);
       if (actual_recv < 0)
@@ -641,19 +1425,20 @@ static int iperf_udp_server(FAR struct iperf_ctrl_t *ctrl,
         }
       else
         {
-          if (udp_recv_start == true)
+          clock_gettime(CLOCK_REALTIME, &now);
+          stream = iperf_udp_stream(ctrl, remote_addr, addrlen);
+          if (stream != NULL)
             {
-              iperf_print_addr("accept", remote_addr);
-              iperf_start_report(ctrl);
-              udp_recv_start = false;
+              iperf_udp_account(stream, buffer, actual_recv, &now);
             }
-
-          ctrl->total_len += actual_recv;
         }
     }
 
   ctrl->finish = true;
   close(sockfd);
+#ifdef CONFIG_NETUTILS_IPERF_MMSG
+  free(batch);
+#endif
 
   return 0;
 }
@@ -675,55 +1460,121 @@ static int iperf_run_udp_server(FAR struct iperf_ctrl_t *ctrl)
  * Name: iperf_udp_client
  *
  * Description:
- *   The main udp client logic
+ *   The main udp client logic.  Each datagram carries an id and the time it
+ *   was sent, so that the server can report loss, jitter and latency.
  *
  ****************************************************************************/
 
-static int iperf_udp_client(FAR struct iperf_ctrl_t *ctrl,
+static int iperf_udp_client(FAR struct iperf_stream_t *stream,
                             FAR struct sockaddr *addr, socklen_t addrlen)
 {
+  FAR struct iperf_ctrl_t *ctrl = stream->ctrl;
   FAR struct iperf_udp_pkt_t *udp;
+#ifdef CONFIG_NETUTILS_IPERF_MMSG
+  FAR struct iperf_batch_t *batch = NULL;
+#endif
+  struct timespec now;
   int actual_send = 0;
-  bool retry = false;
   uint32_t delay = 1;
   int want_send = 0;
+  int nbatch = ctrl->cfg.batch;
   uint8_t *buffer;
   int sockfd;
   int opt;
   int err;
   int id;
+  int i;
+
+  want_send = ctrl->buffer_len;
+  buffer = malloc(want_send * nbatch);
+  if (buffer == NULL)
+    {
+      printf("create buffer: not enough memory\n");
+      ctrl->finish = true;
+      return -1;
+    }
+
+  memset(buffer, 0, want_send * nbatch);
+  stream->buffer = buffer;
 
   sockfd = socket(addr->sa_family, SOCK_DGRAM, IPPROTO_UDP);
   if (sockfd < 0)
     {
       iperf_show_socket_error_reason("udp client create", sockfd);
+      ctrl->finish = true;
       return -1;
     }
 
   setsockopt(sockfd, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt));
 
+#ifdef CONFIG_NETUTILS_IPERF_MMSG
+  if (nbatch > 1)
+    {
+      batch = malloc(sizeof(*batch));
+      if (batch == NULL)
+        {
+          printf("create batch: not enough memory\n");
+          close(sockfd);
+          ctrl->finish = true;
+          return -1;
+        }
+
+      memset(batch->msgs, 0, sizeof(batch->msgs));
+      for (i = 0; i < nbatch; i++)
+        {
+          batch->iov[i].iov_base = buffer + i * want_send;
+          batch->iov[i].iov_len  = want_send;
+          batch->msgs[i].msg_hdr.msg_name    = addr;
+          batch->msgs[i].msg_hdr.msg_namelen = addrlen;
+          batch->msgs[i].msg_hdr.msg_iov     = &batch->iov[i];
+          batch->msgs[i].msg_hdr.msg_iovlen  = 1;
+        }
+    }
+#endif
+
+  stream->started = true;
   iperf_start_report(ctrl);
-  buffer = ctrl->buffer;
-  udp = (FAR struct iperf_udp_pkt_t *)buffer;
-  want_send = ctrl->buffer_len;
   id = 0;
 
   while (!ctrl->finish)
     {
-      if (false == retry)
+      /* Datagrams that could not be sent are sent again with the same id,
+       * so only datagrams lost on the way show up as gaps.
+       */
+
+      clock_gettime(CLOCK_REALTIME, &now);
+      for (i = 0; i < nbatch; i++)
         {
-          id++;
-          udp->id = htonl(id);
-          delay = 1;
+          udp       = (FAR struct iperf_udp_pkt_t *)(buffer + i * want_send);
+          udp->id   = htonl(id + 1 + i);
+          udp->sec  = htonl(now.tv_sec);
+          udp->usec = htonl(now.tv_nsec / 1000);
         }
 
-      retry = false;
-      actual_send = sendto(sockfd, buffer, want_send, 0, addr, addrlen);
+#ifdef CONFIG_NETUTILS_IPERF_MMSG
+      if (batch != NULL)
+        {
+          actual_send = sendmmsg(sockfd, batch->msgs, nbatch, 0);
+        }
+      else
+#endif
+        {
+          actual_send = sendto(sockfd, buffer, want_send, 0, addr, addrlen);
+          if (actual_send == want_send)
+            {
+              actual_send = 1;
+            }
+          else if (actual_send >= 0)
+            {
+              errno = EMSGSIZE;
+              actual_send = -1;
+            }
+        }
 
-      if (actual_send != want_send)
+      if (actual_send <= 0)
         {
           err = iperf_get_socket_error_code(sockfd);
-          if (err == ENOMEM)
+          if (actual_send == 0 || err == ENOMEM)
             {
               usleep(delay * 10000);
               if (delay < IPERF_MAX_DELAY)
@@ -731,7 +1582,6 @@ static int iperf_udp_client(FAR struct iperf_ctrl_t *ctrl,
                   delay <<= 1;
                 }
 
-              retry = true;
               continue;
             }
           else
@@ -742,12 +1592,17 @@ static int iperf_udp_client(FAR struct iperf_ctrl_t *ctrl,
         }
       else
         {
-          ctrl->total_len += actual_send;
+          id += actual_send;
+          delay = 1;
+          stream->total_len += (uintmax_t)actual_send * want_send;
         }
     }
 
   ctrl->finish = true;
   close(sockfd);
+#ifdef CONFIG_NETUTILS_IPERF_MMSG
+  free(batch);
+#endif
 
   return 0;
 }
@@ -765,6 +1620,55 @@ static int iperf_run_udp_client(FAR struct iperf_ctrl_t *ctrl)
   return iperf_run_client(ctrl, iperf_udp_client);
 }
 
+/****************************************************************************
+ * Name: iperf_tcp_sendfile
+ *
+ * Description:
+ *   Send the configured file over and over with sendfile(), so that the
+ *   data does not pass through a user buffer.
+ *
+ ****************************************************************************/
+
+static int iperf_tcp_sendfile(FAR struct iperf_stream_t *stream)
+{
+  FAR struct iperf_ctrl_t *ctrl = stream->ctrl;
+  ssize_t actual_send;
+  off_t offset = 0;
+  int fd;
+
+  fd = open(ctrl->cfg.file, O_RDONLY | O_CLOEXEC);
+  if (fd < 0)
+    {
+      printf("open %s failed: %d\n", ctrl->cfg.file, errno);
+      return -1;
+    }
+
+  while (!ctrl->finish)
+    {
+      actual_send = sendfile(stream->sockfd, fd, &offset,
+                             ctrl->buffer_len);
+      if (actual_send == 0 && offset > 0)
+        {
+          /* Start over at the end of the file */
+
+          offset = 0;
+        }
+      else if (actual_send <= 0)
+        {
+          iperf_show_socket_error_reason("tcp client sendfile",
+                                         stream->sockfd);
+          break;
+        }
+      else
+        {
+          stream->total_len += actual_send;
+        }
+    }
+
+  close(fd);
+  return 0;
+}
+
 /****************************************************************************
  * Name: iperf_tcp_client
  *
@@ -773,42 +1677,68 @@ static int iperf_run_udp_client(FAR struct iperf_ctrl_t *ctrl)
  *
  ****************************************************************************/
 
-static int iperf_tcp_client(FAR struct iperf_ctrl_t *ctrl,
+static int iperf_tcp_client(FAR struct iperf_stream_t *stream,
                             FAR struct sockaddr *addr, socklen_t addrlen)
 {
-  FAR uint8_t *buffer;
+  FAR struct iperf_ctrl_t *ctrl = stream->ctrl;
+  FAR uint8_t *buffer = NULL;
   int actual_send = 0;
   int want_send = 0;
   int sockfd;
 
+  if (ctrl->cfg.file == NULL)
+    {
+      buffer = malloc(ctrl->buffer_len);
+      if (buffer == NULL)
+        {
+          printf("create buffer: not enough memory\n");
+          ctrl->finish = true;
+          return -1;
+        }
+
+      memset(buffer, 0, ctrl->buffer_len);
+      stream->buffer = buffer;
+    }
+
   sockfd = socket(addr->sa_family, SOCK_STREAM, IPPROTO_TCP);
   if (sockfd < 0)
     {
       iperf_show_socket_error_reason("tcp client create", sockfd);
+      ctrl->finish = true;
       return -1;
     }
 
   if (connect(sockfd, addr, addrlen) < 0)
     {
       iperf_show_socket_error_reason("tcp client connect", sockfd);
+      close(sockfd);
+      ctrl->finish = true;
       return -1;
     }
 
+  stream->sockfd  = sockfd;
+  stream->started = true;
   iperf_start_report(ctrl);
-  buffer = ctrl->buffer;
-  want_send = ctrl->buffer_len;
 
-  while (!ctrl->finish)
+  if (buffer == NULL)
     {
-      actual_send = send(sockfd, buffer, want_send, 0);
-      if (actual_send <= 0)
-        {
-          iperf_show_socket_error_reason("tcp client send", sockfd);
-          break;
-        }
-      else
+      iperf_tcp_sendfile(stream);
+    }
+  else
+    {
+      want_send = ctrl->buffer_len;
+      while (!ctrl->finish)
         {
-          ctrl->total_len += actual_send;
+          actual_send = send(sockfd, buffer, want_send, 0);
+          if (actual_send <= 0)
+            {
+              iperf_show_socket_error_reason("tcp client send", sockfd);
+              break;
+            }
+          else
+            {
+              stream->total_len += actual_send;
+            }
         }
     }
 
@@ -868,11 +1798,7 @@ static void iperf_task_traffic(FAR void *arg)
       assert(false);
     }
 
-  if (ctrl->buffer)
-    {
-      free(ctrl->buffer);
-      ctrl->buffer = NULL;
-    }
+  iperf_join_streams(ctrl);
 
   printf("iperf exit\n");
 
@@ -916,11 +1842,10 @@ static uint32_t iperf_get_buffer_len(FAR struct iperf_ctrl_t *ctrl)
 int iperf_start(FAR struct iperf_cfg_t *cfg)
 {
   struct iperf_ctrl_t ctrl;
-  struct sched_param param;
-  pthread_attr_t attr;
   pthread_t thread;
   FAR void *retval;
   int ret;
+  int i;
 
   if (!cfg)
     {
@@ -931,26 +1856,46 @@ int iperf_start(FAR struct iperf_cfg_t *cfg)
   memcpy(&ctrl.cfg, cfg, sizeof(*cfg));
   ctrl.finish = false;
   ctrl.buffer_len = iperf_get_buffer_len(&ctrl);
-  ctrl.buffer = (FAR uint8_t *)malloc(ctrl.buffer_len);
-  if (ctrl.buffer == NULL)
+
+  if (ctrl.cfg.nstreams == 0)
     {
-      printf("create buffer: not enough memory\n");
+      ctrl.cfg.nstreams = 1;
+    }
+
+  if (ctrl.cfg.batch == 0)
+    {
+      ctrl.cfg.batch = 1;
+    }
+
+  /* Batched receives need a buffer per datagram.  Size them for the
+   * datagrams the client sends rather than for the largest possible.
+   */
+
+  if (iperf_is_udp_server(&ctrl) && ctrl.cfg.batch > 1)
+    {
+      ctrl.buffer_len = IPERF_UDP_TX_LEN;
+    }
+
+  ctrl.streams = calloc(ctrl.cfg.nstreams, sizeof(struct iperf_stream_t));
+  if (ctrl.streams == NULL)
+    {
+      printf("create streams: not enough memory\n");
       return -1;
     }
 
-  memset(ctrl.buffer, 0, ctrl.buffer_len);
-  pthread_attr_init(&attr);
-  param.sched_priority = IPERF_TRAFFIC_TASK_PRIORITY;
-  pthread_attr_setschedparam(&attr, &param);
-  pthread_attr_setstacksize(&attr, IPERF_TRAFFIC_TASK_STACK);
-  ret = pthread_create(&thread, &attr, (FAR void *)iperf_task_traffic,
-                       &ctrl);
+  for (i = 0; i < ctrl.cfg.nstreams; i++)
+    {
+      ctrl.streams[i].ctrl   = &ctrl;
+      ctrl.streams[i].id     = i + 1;
+      ctrl.streams[i].sockfd = -1;
+    }
 
+  ret = iperf_create_thread(&ctrl, &thread, (FAR void *)iperf_task_traffic,
+                            &ctrl, 0);
   if (ret != 0)
     {
       printf("iperf_task_traffic: create task failed: %d\n", ret);
-      free(ctrl.buffer);
-      ctrl.buffer = NULL;
+      free(ctrl.streams);
       return -1;
     }
 
@@ -964,6 +1909,20 @@ int iperf_start(FAR struct iperf_cfg_t *cfg)
   sq_rem((FAR sq_entry_t *)&ctrl, &g_iperf_ctrl_list);
   pthread_mutex_unlock(&g_iperf_ctrl_mutex);
 
+  /* The report task prints the summary once it sees finish */
+
+  if (ctrl.reporting)
+    {
+      pthread_join(ctrl.report_thread, &retval);
+    }
+
+  for (i = 0; i < ctrl.cfg.nstreams; i++)
+    {
+      free(ctrl.streams[i].buffer);
+      free(ctrl.streams[i].udp.hist);
+    }
+
+  free(ctrl.streams);
   return 0;
 }
 
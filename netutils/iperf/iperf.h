@@ -52,6 +52,14 @@ extern "C"
 #define IPERF_FLAG_UDP    (1 << 3)
 #define IPERF_FLAG_LOCAL  (1 << 4)
 #define IPERF_FLAG_RPMSG  (1 << 5)
+#define IPERF_FLAG_JSON   (1 << 6)
+
+/* Limits on the number of parallel streams and on the number of datagrams
+ * moved by one sendmmsg()/recvmmsg() call.
+ */
+
+#define IPERF_MAX_STREAMS 8
+#define IPERF_MAX_BATCH   16
 
 /****************************************************************************
  * Public Types
@@ -68,6 +76,10 @@ struct iperf_cfg_t
   uint32_t time;
   FAR const char *host; /* host name (dip) or rpmsg cpu */
   FAR const char *path; /* local path or rpmsg name */
+  FAR const char *file; /* tcp client: send this file with sendfile() */
+  uint16_t nstreams;    /* client: streams to open, server: most accepted */
+  uint16_t batch;       /* udp: datagrams per sendmmsg()/recvmmsg() */
+  int16_t affinity;     /* CPU of the first stream, -1 for no pinning */
 };
 
 /****************************************************************************
@@ -64,6 +64,13 @@ struct wifi_iperf_t
   FAR struct arg_int *port;
   FAR struct arg_int *interval;
   FAR struct arg_int *time;
+  FAR struct arg_int *parallel;
+  FAR struct arg_int *affinity;
+  FAR struct arg_str *file;
+#ifdef CONFIG_NETUTILS_IPERF_MMSG
+  FAR struct arg_int *batch;
+#endif
+  FAR struct arg_lit *json;
   FAR struct arg_lit *abort;
   FAR struct arg_end *end;
 };
@@ -83,8 +90,9 @@ struct wifi_iperf_t
 static void iperf_showusage(FAR const char *progname,
                             FAR struct wifi_iperf_t *args, int exitcode)
 {
-  printf("USAGE: %s [-sua] [-c <ip|cpu>] [-p <port>] [-i <interval>] "
-         "[-t <time>] [--local <path>] [--rpmsg <name>]\n", progname);
+  printf("USAGE: %s [-suaJ] [-c <ip|cpu>] [-p <port>] [-i <interval>] "
+         "[-t <time>] [-P <n>] [-A <cpu>] [-F <file>] [--local <path>] "
+         "[--rpmsg <name>]\n", progname);
   printf("iperf command:\n");
   arg_print_glossary(stdout, (FAR void **)args, NULL);
 
@@ -126,8 +134,8 @@ static void iperf_printcfg(FAR struct iperf_cfg_t *cfg)
              (cfg->dip >> 16) & 0xff, (cfg->dip >> 24) & 0xff, cfg->dport);
     }
 
-  printf("interval=%" PRId32 ", time=%" PRId32 "\n",
-         cfg->interval, cfg->time);
+  printf("interval=%" PRId32 ", time=%" PRId32 ", streams=%d\n",
+         cfg->interval, cfg->time, cfg->nstreams);
 }
 
 /****************************************************************************
@@ -158,6 +166,17 @@ int main(int argc, FAR char *argv[])
                             "seconds between periodic bandwidth reports");
   iperf_args.time = arg_int0("t", "time", "<time>",
                         "time in seconds to transmit for (default 10 secs)");
+  iperf_args.parallel = arg_int0("P", "parallel", "<n>",
+                        "client: streams to run, server: most to accept");
+  iperf_args.affinity = arg_int0("A", "affinity", "<cpu>",
+                        "pin stream n to CPU <cpu> + n");
+  iperf_args.file = arg_str0("F", "file", "<file>",
+                        "tcp client: send <file> with sendfile()");
+#ifdef CONFIG_NETUTILS_IPERF_MMSG
+  iperf_args.batch = arg_int0(NULL, "batch", "<n>",
+                        "udp: datagrams per sendmmsg()/recvmmsg()");
+#endif
+  iperf_args.json = arg_lit0("J", "json", "report as JSON, one per line");
   iperf_args.abort = arg_lit0("a", "abort", "abort running iperf");
   iperf_args.end = arg_end(1);
 
@@ -313,6 +332,56 @@ int main(int argc, FAR char *argv[])
         }
     }
 
+  if (iperf_args.parallel->count == 0)
+    {
+      cfg.nstreams = (cfg.flag & IPERF_FLAG_SERVER) ? IPERF_MAX_STREAMS : 1;
+    }
+  else
+    {
+      cfg.nstreams = iperf_args.parallel->ival[0];
+      if (cfg.nstreams < 1 || cfg.nstreams > IPERF_MAX_STREAMS)
+        {
+          printf("ERROR: streams should be 1 to %d\n", IPERF_MAX_STREAMS);
+          goto out;
+        }
+    }
+
+  cfg.affinity = -1;
+  if (iperf_args.affinity->count != 0)
+    {
+      cfg.affinity = iperf_args.affinity->ival[0];
+    }
+
+  if (iperf_args.file->count != 0)
+    {
+      if ((cfg.flag & IPERF_FLAG_CLIENT) == 0 ||
+          (cfg.flag & IPERF_FLAG_TCP) == 0)
+        {
+          printf("ERROR: sending a file needs a tcp client\n");
+          goto out;
+        }
+
+      cfg.file = iperf_args.file->sval[0];
+    }
+
+  cfg.batch = 1;
+#ifdef CONFIG_NETUTILS_IPERF_MMSG
+  if (iperf_args.batch->count != 0)
+    {
+      cfg.batch = iperf_args.batch->ival[0];
+      if (cfg.batch < 1 || cfg.batch > IPERF_MAX_BATCH)
+        {
+          printf("ERROR: batch should be 1 to %d\n", IPERF_MAX_BATCH);
+          goto out;
+        }
+    }
+#endif
+
+  if (iperf_args.json->count != 0)
+    {
+      cfg.flag |= IPERF_FLAG_JSON;
+    }
+
   iperf_printcfg(&cfg);
   iperf_start(&cfg);
 
@@ -215,6 +215,33 @@
 #    define CONFIG_THTTPD_IDLE_SEND_LIMIT_SEC 300
 #  endif
 
+/* The maximum number of bytes sent to one connection each time it becomes
+ * writable.
+ */
+
+#  ifndef CONFIG_THTTPD_SEND_QUANTUM
+#    define CONFIG_THTTPD_SEND_QUANTUM 4096
+#  endif
+
+/* The in-memory file cache bypasses the per-request filename expansion,
+ * authentication and referer checks, so it cannot be used with virtual
+ * hosts, authentication files or URL patterns.
+ */
+
+#  if defined(CONFIG_THTTPD_VHOST) || defined(CONFIG_THTTPD_AUTH_FILE) || \
+      defined(CONFIG_THTTPD_URLPATTERN)
+#    undef CONFIG_THTTPD_CACHE
+#  endif
+
+#  ifdef CONFIG_THTTPD_CACHE
+#    ifndef CONFIG_THTTPD_CACHE_SIZE
+#      define CONFIG_THTTPD_CACHE_SIZE 32768
+#    endif
+#    ifndef CONFIG_THTTPD_CACHE_MAXFILE
+#      define CONFIG_THTTPD_CACHE_MAXFILE 8192
+#    endif
+#  endif
+
 /* Memory debug instrumentation depends on other debug options
  */
 
@@ -38,6 +38,7 @@
 
 #include <stdint.h>
 #include <stdlib.h>
+#include <string.h>
 #include <sys/param.h>
 #include <debug.h>
 #include <poll.h>
@@ -64,6 +65,18 @@
 #  define fwinfo   _none
 #endif
 
+/* Marks an unused entry in the fd -> poll index map */
+
+#define FDW_NOINDEX 0xff
+
+/* Allocation granule of the fd -> poll index map (a power of two) */
+
+#define FDW_NDXINCR 16
+
+/* The events that make a watched descriptor ready */
+
+#define FDW_EVENTS  (POLLIN | POLLOUT | POLLERR | POLLHUP | POLLNVAL)
+
 /****************************************************************************
  * Private Data
  ****************************************************************************/
@@ -104,21 +117,42 @@ static int fdwatch_pollndx(FAR struct fdwatch_s *fw, int fd)
 {
   int pollndx;
 
-  /* Get the index associated with the fd */
+  /* Get the index associated with the fd from the fd -> index map */
 
-  for (pollndx = 0; pollndx < fw->nwatched; pollndx++)
+  if (fd >= 0 && fd < fw->nfdndx && fw->fdndx[fd] != FDW_NOINDEX)
     {
-      if (fw->pollfds[pollndx].fd == fd)
-        {
-          fwinfo("pollndx: %d\n", pollndx);
-          return pollndx;
-        }
+      pollndx = fw->fdndx[fd];
+      fwinfo("pollndx: %d\n", pollndx);
+      return pollndx;
     }
 
   fwerr("ERROR: No poll index for fd %d\n", fd);
   return -1;
 }
 
+static int fdwatch_growndx(FAR struct fdwatch_s *fw, int fd)
+{
+  FAR uint8_t *fdndx;
+  int nfdndx;
+
+  /* Descriptor numbers are small and dense, so the map is sized to the
+   * largest fd seen so far, rounded up to limit the number of reallocations.
+   */
+
+  nfdndx = (fd + FDW_NDXINCR) & ~(FDW_NDXINCR - 1);
+  fdndx  = RENEW(fw->fdndx, uint8_t, fw->nfdndx, nfdndx);
+  if (!fdndx)
+    {
+      fwerr("ERROR: Failed to grow the fd map to %d\n", nfdndx);
+      return -1;
+    }
+
+  memset(&fdndx[fw->nfdndx], FDW_NOINDEX, nfdndx - fw->nfdndx);
+  fw->fdndx  = fdndx;
+  fw->nfdndx = nfdndx;
+  return 0;
+}
+
 /****************************************************************************
  * Public Functions
  ****************************************************************************/
@@ -160,6 +194,11 @@ struct fdwatch_s *fdwatch_initialize(int nfds)
       goto errout_with_allocations;
     }
 
+  if (fdwatch_growndx(fw, nfds) < 0)
+    {
+      goto errout_with_allocations;
+    }
+
   fdwatch_dump("Initial state:", fw);
   return fw;
 
@@ -190,15 +229,21 @@ void fdwatch_uninitialize(struct fdwatch_s *fw)
           httpd_free(fw->ready);
         }
 
+      if (fw->fdndx)
+        {
+          httpd_free(fw->fdndx);
+        }
+
       httpd_free(fw);
     }
 }
 
 /* Add a descriptor to the watch list. rw is either FDW_READ or FDW_WRITE. */
 
-void fdwatch_add_fd(struct fdwatch_s *fw, int fd, void *client_data)
+void fdwatch_add_fd(struct fdwatch_s *fw, int fd, void *client_data,
+                    int rw)
 {
-  fwinfo("fd: %d client_data: %p\n", fd, client_data);
+  fwinfo("fd: %d client_data: %p rw: %d\n", fd, client_data, rw);
   fdwatch_dump("Before adding:", fw);
 
   if (fw->nwatched >= fw->nfds)
@@ -207,11 +252,21 @@ void fdwatch_add_fd(struct fdwatch_s *fw, int fd, void *client_data)
       return;
     }
 
-  /* Save the new fd at the end of the list */
+  if (fd < 0 || (fd >= fw->nfdndx && fdwatch_growndx(fw, fd) < 0))
+    {
+      return;
+    }
+
+  /* Save the new fd at the end of the list.  Clear revents so that a
+   * descriptor re-added while the ready list is being processed is not
+   * reported with the stale events of the entry that used this slot.
+   */
 
-  fw->pollfds[fw->nwatched].fd     = fd;
-  fw->pollfds[fw->nwatched].events = POLLIN;
-  fw->client[fw->nwatched]         = client_data;
+  fw->pollfds[fw->nwatched].fd      = fd;
+  fw->pollfds[fw->nwatched].events  = rw == FDW_WRITE ? POLLOUT : POLLIN;
+  fw->pollfds[fw->nwatched].revents = 0;
+  fw->client[fw->nwatched]          = client_data;
+  fw->fdndx[fd]                     = fw->nwatched;
 
   /* Increment the count of watched descriptors */
 
@@ -236,6 +291,7 @@ void fdwatch_del_fd(struct fdwatch_s *fw, int fd)
       /* Decrement the number of fds in the poll table */
 
       fw->nwatched--;
+      fw->fdndx[fd] = FDW_NOINDEX;
 
       /* Replace the deleted one with the one at the end
        * of the list.
@@ -245,6 +301,7 @@ void fdwatch_del_fd(struct fdwatch_s *fw, int fd)
         {
           fw->pollfds[pollndx] = fw->pollfds[fw->nwatched];
           fw->client[pollndx]  = fw->client[fw->nwatched];
+          fw->fdndx[fw->pollfds[pollndx].fd] = pollndx;
         }
     }
 
@@ -283,8 +340,7 @@ int fdwatch(struct fdwatch_s *fw, long timeout_msecs)
         {
           /* Is there activity on this descriptor? */
 
-          if (fw->pollfds[i].revents &
-              (POLLIN | POLLERR | POLLHUP | POLLNVAL))
+          if (fw->pollfds[i].revents & FDW_EVENTS)
             {
               /* Yes... save it in a shorter list */
 
@@ -321,26 +377,40 @@ int fdwatch_check_fd(struct fdwatch_s *fw, int fd)
   /* Get the index associated with the fd */
 
   pollndx = fdwatch_pollndx(fw, fd);
-  if (pollndx >= 0 && (fw->pollfds[pollndx].revents & POLLERR) == 0)
+  if (pollndx < 0)
     {
-      return fw->pollfds[pollndx].revents & (POLLIN | POLLHUP | POLLNVAL);
+      return 0;
     }
 
-  fwinfo("POLLERR fd: %d\n", fd);
-  return 0;
+  /* POLLERR is reported as activity too:  The handler will then see the
+   * error from its read() or write() and close the connection, rather than
+   * poll() returning immediately until the idle timer fires.
+   */
+
+  return fw->pollfds[pollndx].revents & FDW_EVENTS;
 }
 
+/* Get the client data for the next descriptor with activity.  Descriptors
+ * removed by an earlier handler in the same pass are skipped.
+ */
+
 void *fdwatch_get_next_client_data(struct fdwatch_s *fw)
 {
+  int pollndx;
+
   fdwatch_dump("Before getting client data:", fw);
-  if (fw->next >= fw->nwatched)
+  while (fw->next < fw->nactive)
     {
-      fwinfo("All client data returned: %d\n", fw->next);
-      return (void *)(uintptr_t)-1;
+      pollndx = fdwatch_pollndx(fw, fw->ready[fw->next++]);
+      if (pollndx >= 0)
+        {
+          fwinfo("client_data[%d]: %p\n", pollndx, fw->client[pollndx]);
+          return fw->client[pollndx];
+        }
     }
 
-  fwinfo("client_data[%d]: %p\n", fw->next, fw->client[fw->next]);
-  return fw->client[fw->next++];
+  fwinfo("All client data returned: %d\n", fw->next);
+  return (void *)(uintptr_t)-1;
 }
 
 #endif /* CONFIG_THTTPD */
@@ -52,6 +52,11 @@
 #  define INFTIM -1
 #endif
 
+/* Interest values for fdwatch_add_fd() */
+
+#define FDW_READ  0
+#define FDW_WRITE 1
+
 /****************************************************************************
  * Public Types
  ****************************************************************************/
@@ -61,6 +66,8 @@ struct fdwatch_s
   struct pollfd *pollfds;          /* Poll data (allocated) */
   void         **client;           /* Client data (allocated) */
   uint8_t       *ready;            /* The list of fds with activity (allocated) */
+  uint8_t       *fdndx;            /* fd -> poll index map (allocated) */
+  int            nfdndx;           /* The number of entries in fdndx */
   uint8_t        nfds;             /* The configured maximum number of fds */
   uint8_t        nwatched;         /* The number of fds currently watched */
   uint8_t        nactive;          /* The number of fds with activity */
@@ -79,9 +86,10 @@ extern struct fdwatch_s *fdwatch_initialize(int nfds);
 
 extern void fdwatch_uninitialize(struct fdwatch_s *fw);
 
-/* Add a descriptor to the watch list */
+/* Add a descriptor to the watch list.  rw is either FDW_READ or FDW_WRITE. */
 
-extern void fdwatch_add_fd(struct fdwatch_s *fw, int fd, void *client_data);
+extern void fdwatch_add_fd(struct fdwatch_s *fw, int fd, void *client_data,
+                           int rw);
 
 /* Delete a descriptor from the watch list. */
 
@@ -67,6 +67,7 @@
 #include "timers.h"
 #include "libhttpd.h"
 #include "thttpd_alloc.h"
+#include "thttpd_cache.h"
 #include "thttpd_strings.h"
 #include "thttpd_cgi.h"
 #include "tdate_parse.h"
@@ -126,6 +127,12 @@ static void send_response(httpd_conn *hc, int status, const char *title,
                           const char *extraheads, const char *form,
                           const char *arg);
 static void send_response_tail(httpd_conn *hc);
+#ifdef CONFIG_THTTPD_CACHE
+static size_t cache_headers(httpd_conn *hc, char *hdrs, size_t size);
+static void send_cached_mime(httpd_conn *hc);
+static int  cache_start_request(httpd_conn *hc);
+static void cache_file(httpd_conn *hc);
+#endif
 static void defang(const char *str, char *dfstr, int dfsize);
 #ifdef CONFIG_THTTPD_ERROR_DIRECTORY
 static int  send_err_file(httpd_conn *hc, int status, char *title,
@@ -414,6 +421,86 @@ static void send_mime(httpd_conn *hc, int status, const char *title,
     }
 }
 
+#ifdef CONFIG_THTTPD_CACHE
+/* Build the header lines of a complete 200 response that do not change from
+ * one request for the file to the next.  Returns 0 if they do not fit.
+ */
+
+static size_t cache_headers(httpd_conn *hc, char *hdrs, size_t size)
+{
+  char fixed_type[72];
+  char tmbuf[72];
+  size_t len;
+
+  snprintf(fixed_type, sizeof(fixed_type), hc->type, CONFIG_THTTPD_CHARSET);
+  strftime(tmbuf, sizeof(tmbuf), rfc1123fmtstring,
+           gmtime(&hc->sb.st_mtime));
+
+  len = snprintf(hdrs, size,
+                 "Content-Type: %s\r\n"
+                 "Last-Modified: %s\r\n"
+                 "Accept-Ranges: bytes\r\n"
+                 "Connection: close\r\n",
+                 fixed_type, tmbuf);
+
+  if (len < size && hc->encodings[0] != '\0')
+    {
+      len += snprintf(&hdrs[len], size - len,
+                      "Content-Encoding: %s\r\n", hc->encodings);
+    }
+
+  if (len < size)
+    {
+      len += snprintf(&hdrs[len], size - len,
+                      "Content-Length: %ld\r\n", (long)hc->sb.st_size);
+    }
+
+#ifdef CONFIG_THTTPD_P3P
+  if (len < size)
+    {
+      len += snprintf(&hdrs[len], size - len, "P3P: %s\r\n",
+                      CONFIG_THTTPD_P3P);
+    }
+#endif
+
+  return len < size ? len : 0;
+}
+
+/* The equivalent of send_mime() for a complete 200 response to a cached
+ * file:  Only the status line and the dated headers are formatted.
+ */
+
+static void send_cached_mime(httpd_conn *hc)
+{
+  struct timeval now;
+  char tmbuf[72];
+  char buf[128];
+#ifdef CONFIG_THTTPD_MAXAGE
+  time_t expires;
+#endif
+
+  hc->bytes_to_send = hc->cache->size;
+  gettimeofday(&now, NULL);
+
+  strftime(tmbuf, sizeof(tmbuf), rfc1123fmtstring, gmtime(&now.tv_sec));
+  snprintf(buf, sizeof(buf), "%.20s %d %s\r\nServer: %s\r\nDate: %s\r\n",
+           hc->protocol, 200, ok200title, "thttpd", tmbuf);
+  add_response(hc, buf);
+  add_response(hc, hc->cache->hdrs);
+
+#ifdef CONFIG_THTTPD_MAXAGE
+  expires = now.tv_sec + CONFIG_THTTPD_MAXAGE;
+  strftime(tmbuf, sizeof(tmbuf), rfc1123fmtstring, gmtime(&expires));
+  snprintf(buf, sizeof(buf),
+           "Cache-Control: max-age=%d\r\nExpires: %s\r\n",
+           CONFIG_THTTPD_MAXAGE, tmbuf);
+  add_response(hc, buf);
+#endif
+
+  add_response(hc, "\r\n");
+}
+#endif /* CONFIG_THTTPD_CACHE */
+
 static void send_response(httpd_conn *hc, int status, const char *title,
                           const char *extraheads, const char *form,
                           const char *arg)
@@ -2127,6 +2214,101 @@ static size_t sockaddr_len(httpd_sockaddr *sap)
   return 0;
 }
 
+#ifdef CONFIG_THTTPD_CACHE
+/* Start the response to a request for a file found in the cache.  Returns
+ * -1 if the file or its permissions changed since it was cached; the entry
+ * is then dropped and the request is served from the file system, which
+ * repeats the world-readable check.
+ */
+
+static int cache_start_request(httpd_conn *hc)
+{
+  FAR struct httpd_cache_s *entry = hc->cache;
+
+  if (stat(entry->path, &hc->sb) < 0 ||
+      hc->sb.st_mtime != entry->mtime || hc->sb.st_size != entry->size ||
+      hc->sb.st_mode != entry->mode)
+    {
+      ninfo("Cached %s has changed\n", entry->path);
+      httpd_cache_remove(entry);
+      httpd_cache_release(entry);
+      hc->cache = NULL;
+      return -1;
+    }
+
+  hc->type = (char *)entry->type;
+  httpd_realloc_str(&hc->encodings, &hc->maxencodings,
+                    strlen(entry->encodings));
+  strlcpy(hc->encodings, entry->encodings, hc->maxencodings + 1);
+
+  /* Fill in range_end, if necessary. */
+
+  if (hc->got_range &&
+      (hc->range_end == -1 || hc->range_end >= entry->size))
+    {
+      hc->range_end = entry->size - 1;
+    }
+
+  if (hc->method != METHOD_HEAD &&
+      hc->if_modified_since != (time_t) - 1 &&
+      hc->if_modified_since >= entry->mtime)
+    {
+      send_mime(hc, 304, err304title, hc->encodings, "",
+                hc->type, (off_t) - 1, entry->mtime);
+    }
+  else if (hc->got_range || !hc->mime_flag)
+    {
+      send_mime(hc, 200, ok200title, hc->encodings, "", hc->type,
+                entry->size, entry->mtime);
+    }
+  else
+    {
+      send_cached_mime(hc);
+    }
+
+  /* Keep the entry only if its contents are to be sent */
+
+  if (hc->method == METHOD_HEAD || hc->bytes_to_send < 0)
+    {
+      httpd_cache_release(entry);
+      hc->cache = NULL;
+    }
+
+  return 0;
+}
+
+/* Offer a file just opened for a 200 response to the cache.  If it is
+ * cached, the response is sent from the cached copy and the file is closed.
+ */
+
+static void cache_file(httpd_conn *hc)
+{
+  char hdrs[256];
+  size_t hdrlen;
+
+  if (hc->origfilename[0] == '~' ||
+      hc->sb.st_size > CONFIG_THTTPD_CACHE_MAXFILE)
+    {
+      return;
+    }
+
+  hdrlen = cache_headers(hc, hdrs, sizeof(hdrs));
+  if (hdrlen == 0)
+    {
+      return;
+    }
+
+  hc->cache = httpd_cache_add(hc->origfilename, hc->expnfilename, hc->type,
+                              hc->encodings, hdrs, hdrlen, hc->file_fd,
+                              &hc->sb);
+  if (hc->cache != NULL)
+    {
+      close(hc->file_fd);
+      hc->file_fd = -1;
+    }
+}
+#endif /* CONFIG_THTTPD_CACHE */
+
 /****************************************************************************
  * Public Functions
  ****************************************************************************/
@@ -2427,6 +2609,9 @@ int httpd_get_conn(httpd_server *hs, int listen_fd, httpd_conn *hc)
   hc->keep_alive        = false;
   hc->should_linger     = false;
   hc->file_fd           = -1;
+#ifdef CONFIG_THTTPD_CACHE
+  hc->cache             = NULL;
+#endif
 
   ninfo("New connection accepted on %d\n", hc->conn_fd);
   return GC_OK;
@@ -3062,6 +3247,26 @@ int httpd_parse_request(httpd_conn *hc)
    * the entire request.
    */
 
+#ifdef CONFIG_THTTPD_CACHE
+  /* A cached file was resolved and checked when it was first served, so
+   * skip the filename expansion.  httpd_start_request() revalidates it.
+   */
+
+  if (hc->origfilename[0] != '~')
+    {
+      hc->cache = httpd_cache_lookup(hc->origfilename);
+      if (hc->cache != NULL)
+        {
+          httpd_realloc_str(&hc->expnfilename, &hc->maxexpnfilename,
+                            strlen(hc->cache->path));
+          strlcpy(hc->expnfilename, hc->cache->path,
+                  hc->maxexpnfilename + 1);
+          hc->pathinfo[0] = '\0';
+          return 0;
+        }
+    }
+#endif
+
   /* Copy original filename to expanded filename. */
 
   httpd_realloc_str(&hc->expnfilename, &hc->maxexpnfilename,
@@ -3174,6 +3379,14 @@ void httpd_close_conn(httpd_conn *hc)
       hc->file_fd = -1;
     }
 
+#ifdef CONFIG_THTTPD_CACHE
+  if (hc->cache != NULL)
+    {
+      httpd_cache_release(hc->cache);
+      hc->cache = NULL;
+    }
+#endif
+
   if (hc->conn_fd >= 0)
     {
       close(hc->conn_fd);
@@ -3230,6 +3443,13 @@ int httpd_start_request(httpd_conn *hc, struct timeval *nowp)
       return -1;
     }
 
+#ifdef CONFIG_THTTPD_CACHE
+  if (hc->cache != NULL && cache_start_request(hc) == 0)
+    {
+      return 0;
+    }
+#endif
+
   /* Stat the file. */
 
   if (stat(hc->expnfilename, &hc->sb) < 0)
@@ -3530,6 +3750,9 @@ int httpd_start_request(httpd_conn *hc, struct timeval *nowp)
 
       send_mime(hc, 200, ok200title, hc->encodings, "", hc->type,
                 hc->sb.st_size, hc->sb.st_mtime);
+#ifdef CONFIG_THTTPD_CACHE
+      cache_file(hc);
+#endif
     }
 
   return 0;
@@ -168,6 +168,8 @@ typedef struct
 
 /* A connection. */
 
+struct httpd_cache_s;
+
 typedef struct
 {
   int initialized;
@@ -235,6 +237,9 @@ typedef struct
   off_t range_start;           /* File range start from Range= */
   off_t range_end;             /* File range end from Range= */
   struct stat sb;
+#ifdef CONFIG_THTTPD_CACHE
+  FAR struct httpd_cache_s *cache; /* Cached file being sent, if any */
+#endif
 
   /* This is the I/O buffer that is used to buffer portions of
    * outgoing files
@@ -40,6 +40,9 @@
 #include <sys/types.h>
 #include <sys/stat.h>
 #include <sys/time.h>
+#ifdef CONFIG_THTTPD_SENDFILE
+#  include <sys/sendfile.h>
+#endif
 
 #include <stdbool.h>
 #include <stdint.h>
@@ -61,6 +64,7 @@
 #include "fdwatch.h"
 #include "libhttpd.h"
 #include "thttpd_alloc.h"
+#include "thttpd_cache.h"
 #include "thttpd_strings.h"
 #include "timers.h"
 
@@ -81,6 +85,14 @@
 #define CNST_SENDING   2
 #define CNST_LINGERING 3
 
+/* True if the response body is sent from the response cache */
+
+#ifdef CONFIG_THTTPD_CACHE
+#  define CACHED(hc)   ((hc)->cache != NULL)
+#else
+#  define CACHED(hc)   false
+#endif
+
 #define SPARE_FDS      2
 #define AVAILABLE_FDS  (CONFIG_THTTPD_NFILE_DESCRIPTORS - SPARE_FDS)
 
@@ -98,6 +110,7 @@ struct connect_s
   timer *linger_timer;
   off_t end_offset;            /* The final offset+1 of the file to send */
   off_t offset;                /* The current offset into the file to send */
+  uint16_t wroff;              /* First unsent byte in hc->buffer */
   bool eof;                    /* Set true when length==0 read from file */
 };
 
@@ -250,7 +263,7 @@ static int handle_newconnect(FAR struct timeval *tv, int listen_fd)
       /* Set the connection file descriptor to no-delay mode */
 
       httpd_set_ndelay(conn->hc->conn_fd);
-      fdwatch_add_fd(fw, conn->hc->conn_fd, conn);
+      fdwatch_add_fd(fw, conn->hc->conn_fd, conn, FDW_READ);
     }
 }
 
@@ -335,6 +348,7 @@ static void handle_read(struct connect_s *conn, struct timeval *tv)
   /* Set up the file offsets to read */
 
   conn->eof            = false;
+  conn->wroff          = 0;
   if (hc->got_range)
     {
       conn->offset     = hc->range_start;
@@ -355,7 +369,7 @@ static void handle_read(struct connect_s *conn, struct timeval *tv)
 
   /* Check if it's already handled */
 
-  if (hc->file_fd < 0)
+  if (hc->file_fd < 0 && !CACHED(hc))
     {
       /* No file descriptor means someone else is handling it */
 
@@ -372,19 +386,25 @@ static void handle_read(struct connect_s *conn, struct timeval *tv)
 
   /* Seek to the offset of the next byte to send */
 
-  actual = lseek(hc->file_fd, conn->offset, SEEK_SET);
-  if (actual != conn->offset)
+  if (hc->file_fd >= 0)
     {
-       nerr("ERROR: fseek to %jd failed: offset=%jd errno=%d\n",
-            (intmax_t)conn->offset, (intmax_t)actual, errno);
-       BADREQUEST("lseek");
-       goto errout_with_400;
+      actual = lseek(hc->file_fd, conn->offset, SEEK_SET);
+      if (actual != conn->offset)
+        {
+          nerr("ERROR: fseek to %jd failed: offset=%jd errno=%d\n",
+               (intmax_t)conn->offset, (intmax_t)actual, errno);
+          BADREQUEST("lseek");
+          goto errout_with_400;
+        }
     }
 
-  /* We have a valid connection and a file to send to it */
+  /* We have a valid connection and a file to send to it.  From now on the
+   * connection is serviced when the socket becomes writable.
+   */
 
   conn->conn_state = CNST_SENDING;
   fdwatch_del_fd(fw, hc->conn_fd);
+  fdwatch_add_fd(fw, hc->conn_fd, conn, FDW_WRITE);
   return;
 
 errout_with_400:
@@ -395,15 +415,24 @@ errout_with_connection:
   finish_connection(conn, tv);
 }
 
+#ifndef CONFIG_THTTPD_SENDFILE
 static inline int read_buffer(struct connect_s *conn)
 {
   httpd_conn *hc = conn->hc;
   ssize_t nread = 0;
+  size_t nbytes;
 
   if (hc->buflen < CONFIG_THTTPD_IOBUFFERSIZE && !conn->eof)
     {
-      nread = read(hc->file_fd, &hc->buffer[hc->buflen],
-                   CONFIG_THTTPD_IOBUFFERSIZE - hc->buflen);
+      /* Never read beyond the end of the requested range */
+
+      nbytes = CONFIG_THTTPD_IOBUFFERSIZE - hc->buflen;
+      if (nbytes > conn->end_offset - conn->offset)
+        {
+          nbytes = conn->end_offset - conn->offset;
+        }
+
+      nread = read(hc->file_fd, &hc->buffer[hc->buflen], nbytes);
       if (nread == 0)
         {
           /* Reading zero bytes means we are at the end of file */
@@ -414,77 +443,163 @@ static inline int read_buffer(struct connect_s *conn)
       else if (nread > 0)
         {
           hc->buflen      += nread;
+          conn->offset    += nread;
         }
     }
 
   return nread;
 }
+#endif
 
 static void handle_send(struct connect_s *conn, struct timeval *tv)
 {
   httpd_conn *hc = conn->hc;
-  int nwritten;
+  ssize_t nwritten;
+  size_t quantum = 0;
+#if defined(CONFIG_THTTPD_SENDFILE) || defined(CONFIG_THTTPD_CACHE)
+  size_t nbytes;
+#endif
+#ifndef CONFIG_THTTPD_SENDFILE
   int nread;
+#endif
 
-  /* Read until the entire file is sent -- this could take awhile!! */
+  /* The socket is nonblocking.  Send until the file is complete, until the
+   * socket would block, or until this connection has used its quantum.  In
+   * the last two cases, sending resumes where it left off when fdwatch next
+   * reports the socket writable.
+   */
 
-  while (conn->offset < conn->end_offset)
+  while (quantum < CONFIG_THTTPD_SEND_QUANTUM)
     {
       ninfo("offset: %jd end_offset: %jd bytes_sent: %jd\n",
             (intmax_t)conn->offset,
             (intmax_t)conn->end_offset,
             (intmax_t)conn->hc->bytes_sent);
 
-      /* Fill the rest of the response buffer with file data */
+#ifndef CONFIG_THTTPD_SENDFILE
+      /* Fill the rest of the response buffer with file data, unless the
+       * buffer is still partially sent.
+       */
 
-      nread = read_buffer(conn);
-      if (nread < 0)
+      if (hc->file_fd >= 0 && conn->wroff == 0 &&
+          conn->offset < conn->end_offset)
         {
-          nerr("ERROR: File read error: %d\n", errno);
-          goto errout_clear_connection;
+          nread = read_buffer(conn);
+          if (nread < 0)
+            {
+              nerr("ERROR: File read error: %d\n", errno);
+              clear_connection(conn, tv);
+              return;
+            }
+
+          ninfo("Read %d bytes, buflen %d\n", nread, hc->buflen);
         }
+#endif
+
+      /* Send what remains of the buffer.  This is the response header and,
+       * without sendfile(), the file data.
+       */
+
+      if (conn->wroff < hc->buflen)
+        {
+          nwritten = write(hc->conn_fd, &hc->buffer[conn->wroff],
+                           hc->buflen - conn->wroff);
+          if (nwritten < 0)
+            {
+              goto errout_with_errno;
+            }
 
-      ninfo("Read %d bytes, buflen %d\n", nread, hc->buflen);
+          ninfo("Wrote %zd bytes\n", nwritten);
 
-      /* Send the buffer */
+          conn->active_at       = tv->tv_sec;
+          conn->wroff          += nwritten;
+          conn->hc->bytes_sent += nwritten;
+          quantum              += nwritten;
 
-      if (hc->buflen > 0)
+          if (conn->wroff >= hc->buflen)
+            {
+              hc->buflen  = 0;
+              conn->wroff = 0;
+            }
+
+          continue;
+        }
+
+      if (conn->offset >= conn->end_offset)
         {
-          /* httpd_write does not return until all bytes have been sent
-           * (or an error occurs).
-           */
+          /* The file transfer is complete -- finish the connection */
+
+          ninfo("Finish connection\n");
+          finish_connection(conn, tv);
+          return;
+        }
+
+#if defined(CONFIG_THTTPD_SENDFILE) || defined(CONFIG_THTTPD_CACHE)
+      nbytes = CONFIG_THTTPD_SEND_QUANTUM - quantum;
+      if (nbytes > conn->end_offset - conn->offset)
+        {
+          nbytes = conn->end_offset - conn->offset;
+        }
+#endif
 
-          nwritten = httpd_write(hc->conn_fd, hc->buffer, hc->buflen);
+#ifdef CONFIG_THTTPD_CACHE
+      if (hc->cache != NULL)
+        {
+          /* Send the cached file contents straight from memory */
+
+          nwritten = write(hc->conn_fd, &hc->cache->data[conn->offset],
+                           nbytes);
           if (nwritten < 0)
             {
-              nerr("ERROR: Error sending %s: %d\n",
-                   hc->encodedurl, errno);
-              goto errout_clear_connection;
+              goto errout_with_errno;
             }
 
-          /* We wrote one full buffer of data (httpd_write does not
-           * return until the full buffer is written (or an error occurs).
-           */
+          ninfo("Sent %zd cached bytes\n", nwritten);
 
           conn->active_at       = tv->tv_sec;
-          hc->buflen            = 0;
+          conn->offset         += nwritten;
+          conn->hc->bytes_sent += nwritten;
+          quantum              += nwritten;
+          continue;
+        }
+#endif
 
-          /* And update how much of the file we wrote */
+#ifdef CONFIG_THTTPD_SENDFILE
+      /* Send file data directly from the file to the socket */
 
-          conn->offset         += nread;
-          conn->hc->bytes_sent += nwritten;
-          ninfo("Wrote %d bytes\n", nwritten);
+      nwritten = sendfile(hc->conn_fd, hc->file_fd, &conn->offset, nbytes);
+      if (nwritten < 0)
+        {
+          goto errout_with_errno;
         }
-    }
+      else if (nwritten == 0)
+        {
+          /* The file is shorter than expected */
 
-  /* The file transfer is complete -- finish the connection */
+          conn->end_offset = conn->offset;
+          conn->eof        = true;
+        }
+
+      ninfo("Sent %zd bytes\n", nwritten);
+
+      conn->active_at       = tv->tv_sec;
+      conn->hc->bytes_sent += nwritten;
+      quantum              += nwritten;
+#endif
+    }
 
-  ninfo("Finish connection\n");
-  finish_connection(conn, tv);
   return;
 
-errout_clear_connection:
-  ninfo("Clear connection\n");
+errout_with_errno:
+
+  /* The socket buffer is full:  Wait for fdwatch to report it writable */
+
+  if (errno == EINTR || errno == EAGAIN || errno == EWOULDBLOCK)
+    {
+      return;
+    }
+
+  nerr("ERROR: Error sending %s: %d\n", hc->encodedurl, errno);
   clear_connection(conn, tv);
 }
 
@@ -554,7 +669,7 @@ static void clear_connection(struct connect_s *conn, struct timeval *tv)
     {
       fdwatch_del_fd(fw, conn->hc->conn_fd);
       conn->conn_state = CNST_LINGERING;
-      fdwatch_add_fd(fw, conn->hc->conn_fd, conn);
+      fdwatch_add_fd(fw, conn->hc->conn_fd, conn, FDW_READ);
       client_data.p = conn;
 
       conn->linger_timer = tmr_create(tv, linger_clear_connection,
@@ -763,7 +878,7 @@ int thttpd_main(int argc, char **argv)
     {
       if (hs->listen_fd != -1)
         {
-          fdwatch_add_fd(fw, hs->listen_fd, NULL);
+          fdwatch_add_fd(fw, hs->listen_fd, NULL, FDW_READ);
         }
     }
 
@@ -844,9 +959,9 @@ int thttpd_main(int argc, char **argv)
 
                       case CNST_SENDING:
                         {
-                          /* Send a file -- this really should be performed
-                           * on a separate thread to keep the serve from
-                           * locking up during the write.
+                          /* Send the next part of the file.  This returns
+                           * as soon as the socket would block, so one slow
+                           * client does not hold up the others.
                            */
 
                           handle_send(conn, &tv);
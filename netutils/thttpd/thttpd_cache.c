@@ -0,0 +1,271 @@
+/****************************************************************************
+ * apps/netutils/thttpd/thttpd_cache.c
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.  The
+ * ASF licenses this file to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance with the
+ * License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <stdint.h>
+#include <string.h>
+#include <debug.h>
+
+#include "config.h"
+#include "libhttpd.h"
+#include "thttpd_alloc.h"
+#include "thttpd_cache.h"
+
+#if defined(CONFIG_THTTPD) && defined(CONFIG_THTTPD_CACHE)
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+static FAR struct httpd_cache_s *g_cache;  /* Most recently used first */
+static size_t g_cacheused;                 /* Bytes charged to the budget */
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/* FNV-1a hash of a request file name */
+
+static uint32_t cache_hash(FAR const char *key)
+{
+  uint32_t hash = 2166136261u;
+
+  while (*key != '\0')
+    {
+      hash ^= (uint8_t)*key++;
+      hash *= 16777619u;
+    }
+
+  return hash;
+}
+
+/* Unlink an entry and stop charging it to the budget.  The memory is freed
+ * now, or by the last httpd_cache_release() if connections still send from
+ * it.
+ */
+
+static void cache_unlink(FAR struct httpd_cache_s *entry,
+                         FAR struct httpd_cache_s *prev)
+{
+  if (prev != NULL)
+    {
+      prev->flink = entry->flink;
+    }
+  else
+    {
+      g_cache = entry->flink;
+    }
+
+  g_cacheused   -= entry->memsize;
+  entry->flink   = NULL;
+  entry->removed = true;
+
+  ninfo("Uncached %s, %zu bytes in use\n", entry->key, g_cacheused);
+  if (entry->crefs == 0)
+    {
+      httpd_free(entry);
+    }
+}
+
+/* Evict the least recently used entry from a non-empty cache */
+
+static void cache_evict(void)
+{
+  FAR struct httpd_cache_s *entry;
+  FAR struct httpd_cache_s *prev = NULL;
+
+  for (entry = g_cache; entry->flink != NULL; entry = entry->flink)
+    {
+      prev = entry;
+    }
+
+  cache_unlink(entry, prev);
+}
+
+/* Copy a string into the entry allocation and advance the free pointer */
+
+static FAR const char *cache_strcpy(FAR char **ptr, FAR const char *str,
+                                    size_t len)
+{
+  FAR char *dest = *ptr;
+
+  memcpy(dest, str, len);
+  dest[len] = '\0';
+  *ptr     += len + 1;
+  return dest;
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/* Find the entry for a request file name and mark it most recently used */
+
+FAR struct httpd_cache_s *httpd_cache_lookup(FAR const char *key)
+{
+  FAR struct httpd_cache_s *entry;
+  FAR struct httpd_cache_s *prev = NULL;
+  uint32_t hash = cache_hash(key);
+
+  for (entry = g_cache; entry != NULL; prev = entry, entry = entry->flink)
+    {
+      if (entry->hash == hash && strcmp(entry->key, key) == 0)
+        {
+          /* Move the entry to the head of the list */
+
+          if (prev != NULL)
+            {
+              prev->flink  = entry->flink;
+              entry->flink = g_cache;
+              g_cache      = entry;
+            }
+
+          entry->crefs++;
+          return entry;
+        }
+    }
+
+  return NULL;
+}
+
+/* Read a file into a new cache entry */
+
+FAR struct httpd_cache_s *
+httpd_cache_add(FAR const char *key, FAR const char *path,
+                FAR const char *type, FAR const char *encodings,
+                FAR const char *hdrs, size_t hdrlen, int fd,
+                FAR const struct stat *sb)
+{
+  FAR struct httpd_cache_s *entry;
+  FAR char *ptr;
+  size_t keylen;
+  size_t pathlen;
+  size_t enclen;
+  size_t memsize;
+
+  if (sb->st_size > CONFIG_THTTPD_CACHE_MAXFILE)
+    {
+      return NULL;
+    }
+
+  keylen  = strlen(key);
+  pathlen = strlen(path);
+  enclen  = strlen(encodings);
+  memsize = sizeof(struct httpd_cache_s) + sb->st_size +
+            keylen + pathlen + enclen + hdrlen + 4;
+
+  if (memsize > CONFIG_THTTPD_CACHE_SIZE)
+    {
+      return NULL;
+    }
+
+  /* Replace any older copy, then make room for the new one */
+
+  entry = httpd_cache_lookup(key);
+  if (entry != NULL)
+    {
+      httpd_cache_remove(entry);
+      httpd_cache_release(entry);
+    }
+
+  while (g_cache != NULL &&
+         g_cacheused + memsize > CONFIG_THTTPD_CACHE_SIZE)
+    {
+      cache_evict();
+    }
+
+  entry = (FAR struct httpd_cache_s *)httpd_malloc(memsize);
+  if (entry == NULL)
+    {
+      return NULL;
+    }
+
+  /* The file contents follow the entry, then the strings */
+
+  ptr = (FAR char *)(entry + 1);
+  if (httpd_read(fd, ptr, sb->st_size) != sb->st_size)
+    {
+      nwarn("WARNING: Short read caching %s\n", path);
+      httpd_free(entry);
+      return NULL;
+    }
+
+  entry->data      = (FAR const uint8_t *)ptr;
+  ptr             += sb->st_size;
+  entry->key       = cache_strcpy(&ptr, key, keylen);
+  entry->path      = cache_strcpy(&ptr, path, pathlen);
+  entry->encodings = cache_strcpy(&ptr, encodings, enclen);
+  entry->hdrs      = cache_strcpy(&ptr, hdrs, hdrlen);
+  entry->type      = type;
+  entry->hdrlen    = hdrlen;
+  entry->memsize   = memsize;
+  entry->size      = sb->st_size;
+  entry->mtime     = sb->st_mtime;
+  entry->mode      = sb->st_mode;
+  entry->hash      = cache_hash(key);
+  entry->crefs     = 1;
+  entry->removed   = false;
+
+  entry->flink     = g_cache;
+  g_cache          = entry;
+  g_cacheused     += memsize;
+
+  ninfo("Cached %s as %s, %zu bytes in use\n", path, key, g_cacheused);
+  return entry;
+}
+
+/* Remove an entry whose file has changed */
+
+void httpd_cache_remove(FAR struct httpd_cache_s *entry)
+{
+  FAR struct httpd_cache_s *curr;
+  FAR struct httpd_cache_s *prev = NULL;
+
+  for (curr = g_cache; curr != NULL; prev = curr, curr = curr->flink)
+    {
+      if (curr == entry)
+        {
+          cache_unlink(entry, prev);
+          break;
+        }
+    }
+}
+
+/* Drop a reference to an entry */
+
+void httpd_cache_release(FAR struct httpd_cache_s *entry)
+{
+  DEBUGASSERT(entry->crefs > 0);
+  if (--entry->crefs == 0 && entry->removed)
+    {
+      httpd_free(entry);
+    }
+}
+
+#endif /* CONFIG_THTTPD && CONFIG_THTTPD_CACHE */
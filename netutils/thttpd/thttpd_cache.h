@@ -0,0 +1,101 @@
+/****************************************************************************
+ * apps/netutils/thttpd/thttpd_cache.h
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.  The
+ * ASF licenses this file to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance with the
+ * License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ *
+ ****************************************************************************/
+
+#ifndef __APPS_NETUTILS_THTTPD_THTTPD_CACHE_H
+#define __APPS_NETUTILS_THTTPD_THTTPD_CACHE_H
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <time.h>
+
+#include "config.h"
+
+#if defined(CONFIG_THTTPD) && defined(CONFIG_THTTPD_CACHE)
+
+/****************************************************************************
+ * Public Types
+ ****************************************************************************/
+
+/* One cached file.  The entry, its strings and the file contents are a
+ * single allocation.  Entries are only used from the main server task.
+ */
+
+struct httpd_cache_s
+{
+  FAR struct httpd_cache_s *flink; /* Next entry, most recently used first */
+  FAR const char *key;             /* Request file name (origfilename) */
+  FAR const char *path;            /* Expanded file name */
+  FAR const char *type;            /* MIME type (not malloc()ed) */
+  FAR const char *encodings;       /* MIME encodings */
+  FAR const char *hdrs;            /* Pre-built entity header lines */
+  FAR const uint8_t *data;         /* File contents */
+  size_t hdrlen;                   /* Length of hdrs */
+  size_t memsize;                  /* Bytes charged against the budget */
+  off_t size;                      /* File size */
+  time_t mtime;                    /* File modification time */
+  mode_t mode;                     /* File type and permissions */
+  uint32_t hash;                   /* Hash of key */
+  uint16_t crefs;                  /* Connections using the entry */
+  bool removed;                    /* Unlinked, free on last release */
+};
+
+/****************************************************************************
+ * Public Function Prototypes
+ ****************************************************************************/
+
+/* Find the entry for a request file name and mark it most recently used.
+ * A reference is taken on the returned entry.  Returns NULL on a miss.
+ */
+
+extern FAR struct httpd_cache_s *httpd_cache_lookup(FAR const char *key);
+
+/* Read the open file fd into a new entry, evicting the least recently used
+ * entries as needed to stay within CONFIG_THTTPD_CACHE_SIZE.  A reference is
+ * taken on the returned entry.  Returns NULL if the file cannot be cached.
+ */
+
+extern FAR struct httpd_cache_s *
+httpd_cache_add(FAR const char *key, FAR const char *path,
+                FAR const char *type, FAR const char *encodings,
+                FAR const char *hdrs, size_t hdrlen, int fd,
+                FAR const struct stat *sb);
+
+/* Remove an entry whose file has changed.  It is freed once the last
+ * connection using it releases it.
+ */
+
+extern void httpd_cache_remove(FAR struct httpd_cache_s *entry);
+
+/* Drop a reference taken by httpd_cache_lookup() or httpd_cache_add() */
+
+extern void httpd_cache_release(FAR struct httpd_cache_s *entry);
+
+#endif /* CONFIG_THTTPD && CONFIG_THTTPD_CACHE */
+#endif /* __APPS_NETUTILS_THTTPD_THTTPD_CACHE_H */
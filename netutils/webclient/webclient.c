@@ -64,6 +64,9 @@
 #include <stdlib.h>
 #include <errno.h>
 #include <inttypes.h>
+#include <poll.h>
+#include <pthread.h>
+#include <time.h>
 
 #include <arpa/inet.h>
 #include <netinet/in.h>
@@ -111,6 +114,22 @@
 #  define CONFIG_WEBCLIENT_MAX_REDIRECT 50
 #endif
 
+#ifndef CONFIG_WEBCLIENT_POOL_SIZE
+#  define CONFIG_WEBCLIENT_POOL_SIZE 4
+#endif
+
+#ifndef CONFIG_WEBCLIENT_POOL_IDLE_SEC
+#  define CONFIG_WEBCLIENT_POOL_IDLE_SEC 30
+#endif
+
+#ifndef CONFIG_WEBCLIENT_DNSCACHE_SIZE
+#  define CONFIG_WEBCLIENT_DNSCACHE_SIZE 0
+#endif
+
+#ifndef CONFIG_WEBCLIENT_DNSCACHE_TTL
+#  define CONFIG_WEBCLIENT_DNSCACHE_TTL 60
+#endif
+
 #define HTTPSTATUS_NONE            0
 #define HTTPSTATUS_OK              1
 #define HTTPSTATUS_MOVED           2
@@ -222,7 +241,48 @@ struct wget_s
   size_t data_len;
 
   FAR struct webclient_context *tunnel;
+
+#ifdef CONFIG_WEBCLIENT_KEEPALIVE
+  /* Persistent connection state */
+
+  bool keepalive;  /* Keep the connection open after the response */
+  bool reusable;   /* The server allows reusing the connection */
+  bool reused;     /* The connection was taken from the pool */
+  bool retried;    /* The request was retried on another connection */
+  bool keepconn;   /* Don't close the connection in WEBCLIENT_STATE_CLOSE */
+  bool pipelined;  /* Shares the connection with other requests */
+  bool send_only;  /* Return once the request has been sent */
+  bool pipe_ready; /* The previous response handed over the connection */
+
+  /* The request sent after this one on the same connection */
+
+  FAR struct webclient_context *pipe_next;
+#endif
+};
+
+#ifdef CONFIG_WEBCLIENT_KEEPALIVE
+/* An idle connection in the pool */
+
+struct wget_pool_s
+{
+  struct webclient_conn_s conn;
+  char hostname[CONFIG_WEBCLIENT_MAXHOSTNAME];
+  uint16_t port;
+  bool inuse;
+  time_t expiry;
 };
+#endif
+
+#if CONFIG_WEBCLIENT_DNSCACHE_SIZE > 0
+/* A cached host name lookup */
+
+struct wget_dnsent_s
+{
+  char hostname[CONFIG_WEBCLIENT_MAXHOSTNAME];
+  struct in_addr addr;
+  time_t expiry;
+};
+#endif
 
 /****************************************************************************
  * Private Data
@@ -248,11 +308,25 @@ static const char g_httpform[]       = "Content-Type: "
                                        "application/x-www-form-urlencoded";
 static const char g_httpcontsize[]   = "Content-Length: ";
 static const char g_httpconn_close[] = "Connection: close";
-#if 0
+#ifdef CONFIG_WEBCLIENT_KEEPALIVE
 static const char g_httpconn[]       = "Connection: Keep-Alive";
+static const char g_httpconnection[] = "connection: ";
+#endif
+#if 0
 static const char g_httpcache[]      = "Cache-Control: no-cache";
 #endif
 
+#ifdef CONFIG_WEBCLIENT_KEEPALIVE
+static struct wget_pool_s g_pool[CONFIG_WEBCLIENT_POOL_SIZE];
+static pthread_mutex_t g_pool_lock = PTHREAD_MUTEX_INITIALIZER;
+#endif
+
+#if CONFIG_WEBCLIENT_DNSCACHE_SIZE > 0
+static struct wget_dnsent_s g_dnscache[CONFIG_WEBCLIENT_DNSCACHE_SIZE];
+static unsigned int g_dnsnext;
+static pthread_mutex_t g_dns_lock = PTHREAD_MUTEX_INITIALIZER;
+#endif
+
 /****************************************************************************
  * Private Functions
  ****************************************************************************/
@@ -456,6 +530,15 @@ static inline int wget_parsestatus(struct webclient_context *ctx,
 
               ctx->http_status = http_status;
               ninfo("Got HTTP status %lu\n", http_status);
+
+#ifdef CONFIG_WEBCLIENT_KEEPALIVE
+              /* HTTP/1.1 connections persist unless the server says
+               * "Connection: close".
+               */
+
+              ws->reusable = strncmp(ws->line, g_http11,
+                                     strlen(g_http11)) == 0;
+#endif
               if (ctx->http_reason != NULL)
                 {
                   strlcpy(ctx->http_reason,
@@ -756,6 +839,17 @@ static inline int wget_parseheaders(struct webclient_context *ctx,
                   ninfo("transfer encodings: '%s'\n", encodings);
                   ws->internal_flags |= WGET_FLAG_CHUNKED;
                 }
+#ifdef CONFIG_WEBCLIENT_KEEPALIVE
+              else if (strncasecmp(ws->line, g_httpconnection,
+                                   strlen(g_httpconnection)) == 0)
+                {
+                  if (strcasecmp(ws->line + strlen(g_httpconnection),
+                                 "close") == 0)
+                    {
+                      ws->reusable = false;
+                    }
+                }
+#endif
             }
 
           if (found && !got_nl)
@@ -1018,6 +1112,433 @@ static inline int wget_parsechunktrailer(struct webclient_context *ctx,
   return ret;
 }
 
+/****************************************************************************
+ * Name: wget_now
+ ****************************************************************************/
+
+#if defined(CONFIG_WEBCLIENT_KEEPALIVE) || CONFIG_WEBCLIENT_DNSCACHE_SIZE > 0
+static time_t wget_now(void)
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec;
+}
+#endif
+
+/****************************************************************************
+ * Name: wget_dnscache_lookup
+ *
+ * Description:
+ *   Look up an unexpired address for hostname in the DNS cache.
+ *
+ ****************************************************************************/
+
+#if CONFIG_WEBCLIENT_DNSCACHE_SIZE > 0
+static bool wget_dnscache_lookup(FAR const char *hostname,
+                                 FAR struct in_addr *dest)
+{
+  FAR struct wget_dnsent_s *ent;
+  time_t now = wget_now();
+  bool found = false;
+  int i;
+
+  pthread_mutex_lock(&g_dns_lock);
+  for (i = 0; i < CONFIG_WEBCLIENT_DNSCACHE_SIZE; i++)
+    {
+      ent = &g_dnscache[i];
+      if (ent->hostname[0] != '\0' && now < ent->expiry &&
+          strcmp(ent->hostname, hostname) == 0)
+        {
+          *dest = ent->addr;
+          found = true;
+          break;
+        }
+    }
+
+  pthread_mutex_unlock(&g_dns_lock);
+  return found;
+}
+
+/****************************************************************************
+ * Name: wget_dnscache_add
+ *
+ * Description:
+ *   Remember the address of hostname, replacing an older entry for the
+ *   same name or else the entries in turn.
+ *
+ ****************************************************************************/
+
+static void wget_dnscache_add(FAR const char *hostname,
+                              FAR const struct in_addr *addr)
+{
+  FAR struct wget_dnsent_s *ent = NULL;
+  int i;
+
+  if (strlen(hostname) >= CONFIG_WEBCLIENT_MAXHOSTNAME)
+    {
+      return;
+    }
+
+  pthread_mutex_lock(&g_dns_lock);
+  for (i = 0; i < CONFIG_WEBCLIENT_DNSCACHE_SIZE; i++)
+    {
+      if (strcmp(g_dnscache[i].hostname, hostname) == 0)
+        {
+          ent = &g_dnscache[i];
+          break;
+        }
+    }
+
+  if (ent == NULL)
+    {
+      ent = &g_dnscache[g_dnsnext];
+      g_dnsnext = (g_dnsnext + 1) % CONFIG_WEBCLIENT_DNSCACHE_SIZE;
+    }
+
+  strlcpy(ent->hostname, hostname, sizeof(ent->hostname));
+  ent->addr   = *addr;
+  ent->expiry = wget_now() + CONFIG_WEBCLIENT_DNSCACHE_TTL;
+  pthread_mutex_unlock(&g_dns_lock);
+}
+#endif
+
+/****************************************************************************
+ * Name: wget_conn_stale
+ *
+ * Description:
+ *   An idle connection should have nothing to read.  If it is readable,
+ *   the server has closed it (or sent something unexpected).  TLS
+ *   connections are not checked.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_WEBCLIENT_KEEPALIVE
+static bool wget_conn_stale(FAR const struct webclient_conn_s *conn)
+{
+  struct pollfd pfd;
+
+  if (conn->tls)
+    {
+      return false;
+    }
+
+  pfd.fd      = conn->sockfd;
+  pfd.events  = POLLIN;
+  pfd.revents = 0;
+  return poll(&pfd, 1, 0) != 0;
+}
+
+/****************************************************************************
+ * Name: wget_pool_get
+ *
+ * Description:
+ *   Take an idle connection for the target from the pool.  conn->tls,
+ *   conn->tls_ops and conn->tls_ctx select the kind of connection.  On a
+ *   hit, the pooled connection is copied to conn and true is returned.
+ *   Expired and stale connections met on the way are closed.
+ *
+ ****************************************************************************/
+
+static bool wget_pool_get(FAR struct webclient_conn_s *conn,
+                          FAR const struct wget_target_s *target)
+{
+  FAR struct wget_pool_s *ent;
+  time_t now = wget_now();
+  bool found = false;
+  int i;
+
+  pthread_mutex_lock(&g_pool_lock);
+  for (i = 0; i < CONFIG_WEBCLIENT_POOL_SIZE && !found; i++)
+    {
+      ent = &g_pool[i];
+      if (!ent->inuse || ent->conn.tls != conn->tls ||
+          ent->port != target->port ||
+          strcmp(ent->hostname, target->hostname) != 0)
+        {
+          continue;
+        }
+
+      if (conn->tls && (ent->conn.tls_ops != conn->tls_ops ||
+                        ent->conn.tls_ctx != conn->tls_ctx))
+        {
+          continue;
+        }
+
+      ent->inuse = false;
+      if (now >= ent->expiry || wget_conn_stale(&ent->conn))
+        {
+          ninfo("Dropping idle connection to %s\n", ent->hostname);
+          webclient_conn_close(&ent->conn);
+          continue;
+        }
+
+      ninfo("Reusing connection to %s:%u\n", ent->hostname, ent->port);
+      *conn = ent->conn;
+      found = true;
+    }
+
+  pthread_mutex_unlock(&g_pool_lock);
+  return found;
+}
+
+/****************************************************************************
+ * Name: wget_pool_put
+ *
+ * Description:
+ *   Return an idle connection to the pool.  If the pool is full, the
+ *   connection idle the longest is closed to make room.
+ *
+ ****************************************************************************/
+
+static void wget_pool_put(FAR const struct webclient_conn_s *conn,
+                          FAR const struct wget_target_s *target)
+{
+  FAR struct wget_pool_s *ent = NULL;
+  struct webclient_conn_s victim;
+  bool evict = false;
+  int i;
+
+  pthread_mutex_lock(&g_pool_lock);
+  for (i = 0; i < CONFIG_WEBCLIENT_POOL_SIZE; i++)
+    {
+      if (!g_pool[i].inuse)
+        {
+          ent = &g_pool[i];
+          break;
+        }
+
+      if (ent == NULL || g_pool[i].expiry < ent->expiry)
+        {
+          ent = &g_pool[i];
+        }
+    }
+
+  if (ent->inuse)
+    {
+      victim = ent->conn;
+      evict  = true;
+    }
+
+  ent->conn   = *conn;
+  ent->port   = target->port;
+  ent->inuse  = true;
+  ent->expiry = wget_now() + CONFIG_WEBCLIENT_POOL_IDLE_SEC;
+  strlcpy(ent->hostname, target->hostname, sizeof(ent->hostname));
+  pthread_mutex_unlock(&g_pool_lock);
+
+  if (evict)
+    {
+      webclient_conn_close(&victim);
+    }
+}
+
+/****************************************************************************
+ * Name: wget_response_done
+ *
+ * Description:
+ *   Return true once the whole response body has been received on a
+ *   persistent connection.  Without a Content-Length or chunked encoding,
+ *   the body ends when the server closes the connection.
+ *
+ ****************************************************************************/
+
+static bool wget_response_done(FAR struct webclient_context *ctx,
+                               FAR struct wget_s *ws)
+{
+  if (ws->state == WEBCLIENT_STATE_WAIT_CLOSE)
+    {
+      return true;
+    }
+
+  if (ws->state != WEBCLIENT_STATE_DATA ||
+      ws->httpstatus == HTTPSTATUS_MOVED)
+    {
+      return false;
+    }
+
+  /* These responses never have a body */
+
+  if (strcmp(ctx->method, "HEAD") == 0 || ctx->http_status == 204 ||
+      ctx->http_status == 304)
+    {
+      return true;
+    }
+
+  return (ws->internal_flags & WGET_FLAG_GOT_CONTENT_LENGTH) != 0 &&
+         ws->received_body_len == ws->expected_resp_body_len;
+}
+
+/****************************************************************************
+ * Name: wget_keepconn
+ *
+ * Description:
+ *   Dispose of the connection of a complete response without closing it.
+ *   A pipelined connection, together with any part of the next response
+ *   already received, is handed over to the next request.  Otherwise the
+ *   connection goes back to the pool.
+ *
+ ****************************************************************************/
+
+static void wget_keepconn(FAR struct wget_s *ws)
+{
+  int left = ws->datend - ws->offset;
+
+  if (ws->pipe_next != NULL)
+    {
+      FAR struct wget_s *next = ws->pipe_next->ws;
+
+      if (left <= next->buflen)
+        {
+          memcpy(next->buffer, ws->buffer + ws->offset, left);
+          next->offset     = 0;
+          next->datend     = left;
+          next->pipe_ready = true;
+          return;
+        }
+
+      nerr("ERROR: %d pipelined bytes don't fit the next buffer\n", left);
+    }
+  else if (left == 0)
+    {
+      wget_pool_put(ws->conn, &ws->target);
+      return;
+    }
+
+  webclient_conn_close(ws->conn);
+}
+
+/****************************************************************************
+ * Name: wget_can_retry
+ *
+ * Description:
+ *   A pooled connection may have been closed by the server while it was
+ *   idle, which only shows once the request is sent.  Such a request can
+ *   be retried on another connection if none of the response has arrived
+ *   and the request body can be produced again.  A request is retried only
+ *   once.
+ *
+ ****************************************************************************/
+
+static bool wget_can_retry(FAR struct webclient_context *ctx,
+                           FAR struct wget_s *ws, int ret)
+{
+  if (!ws->reused || ws->retried || (ws->pipelined && !ws->send_only))
+    {
+      return false;
+    }
+
+  if (ret != -ECONNABORTED && ret != -ECONNRESET && ret != -EPIPE)
+    {
+      return false;
+    }
+
+  if (ctx->bodylen != 0 &&
+      ctx->body_callback != webclient_static_body_func)
+    {
+      return false;
+    }
+
+  return ws->state == WEBCLIENT_STATE_SEND_REQUEST ||
+         ws->state == WEBCLIENT_STATE_SEND_REQUEST_BODY ||
+         (ws->state == WEBCLIENT_STATE_STATUSLINE && ws->ndx == 0);
+}
+#endif
+
+/****************************************************************************
+ * Name: wget_init_ws
+ *
+ * Description:
+ *   Allocate and initialize the internal state of a new request.
+ *
+ ****************************************************************************/
+
+static int wget_init_ws(FAR struct webclient_context *ctx)
+{
+  FAR struct wget_s *ws;
+  int ret;
+
+  ws = calloc(1, sizeof(struct wget_s));
+  if (!ws)
+    {
+      _SET_STATE(ctx, WEBCLIENT_CONTEXT_STATE_DONE);
+      return -errno;
+    }
+
+  ws->conn = calloc(1, sizeof(struct webclient_conn_s));
+  if (!ws->conn)
+    {
+      free_ws(ws);
+      _SET_STATE(ctx, WEBCLIENT_CONTEXT_STATE_DONE);
+      return -errno;
+    }
+
+  ws->buffer = ctx->buffer;
+  ws->buflen = ctx->buflen;
+
+  /* Parse the hostname (with optional port number) and filename
+   * from the URL.
+   */
+
+  if ((ctx->flags & WEBCLIENT_FLAG_TUNNEL) == 0)
+    {
+      ret = parseurl(ctx->url, &ws->target, false);
+      if (ret != 0)
+        {
+          nwarn("WARNING: Malformed URL: %s\n", ctx->url);
+          free_ws(ws);
+          _SET_STATE(ctx, WEBCLIENT_CONTEXT_STATE_DONE);
+          return ret;
+        }
+    }
+
+  if (ctx->proxy != NULL)
+    {
+      /* Note: reject a proxy string w/o port number specified.
+       * It's better to be explicit because the default number varies
+       * among HTTP client implementations.
+       * (80, 1080, 3128, 8080, ...)
+       */
+
+      ret = parseurl(ctx->proxy, &ws->proxy, true);
+      if (ret != 0)
+        {
+          nerr("ERROR: Malformed proxy setting: %s\n", ctx->proxy);
+          free_ws(ws);
+          _SET_STATE(ctx, WEBCLIENT_CONTEXT_STATE_DONE);
+          return ret;
+        }
+
+      if (strcmp(ws->proxy.scheme, "http") ||
+          strcmp(ws->proxy.filename, "/"))
+        {
+          nerr("ERROR: Unsupported proxy setting: %s\n", ctx->proxy);
+          free_ws(ws);
+          _SET_STATE(ctx, WEBCLIENT_CONTEXT_STATE_DONE);
+          return -ENOTSUP;
+        }
+    }
+
+#ifdef CONFIG_WEBCLIENT_KEEPALIVE
+  ws->keepalive = (ctx->flags & WEBCLIENT_FLAG_KEEPALIVE) != 0 &&
+                  (ctx->flags & (WEBCLIENT_FLAG_NON_BLOCKING |
+                                 WEBCLIENT_FLAG_TUNNEL)) == 0 &&
+                  ctx->protocol_version ==
+                  WEBCLIENT_PROTOCOL_VERSION_HTTP_1_1 &&
+                  ctx->proxy == NULL;
+#if defined(CONFIG_WEBCLIENT_NET_LOCAL)
+  if (ctx->unix_socket_path != NULL)
+    {
+      ws->keepalive = false;
+    }
+#endif
+#endif
+
+  ws->state = WEBCLIENT_STATE_SOCKET;
+  ctx->ws = ws;
+  return OK;
+}
+
 /****************************************************************************
  * Name: wget_gethostip
  *
@@ -1042,6 +1563,13 @@ static int wget_gethostip(FAR char *hostname, FAR struct in_addr *dest)
   FAR struct addrinfo *info;
   FAR struct sockaddr_in *addr;
 
+#if CONFIG_WEBCLIENT_DNSCACHE_SIZE > 0
+  if (wget_dnscache_lookup(hostname, dest))
+    {
+      return OK;
+    }
+#endif
+
   memset(&hint, 0, sizeof(hint));
   hint.ai_family = AF_INET;
 
@@ -1054,6 +1582,11 @@ static int wget_gethostip(FAR char *hostname, FAR struct in_addr *dest)
   memcpy(dest, &addr->sin_addr, sizeof(struct in_addr));
 
   freeaddrinfo(info);
+
+#if CONFIG_WEBCLIENT_DNSCACHE_SIZE > 0
+  wget_dnscache_add(hostname, dest);
+#endif
+
   return OK;
 #else
   /* No host name support */
@@ -1212,69 +1745,11 @@ int webclient_perform(FAR struct webclient_context *ctx)
 
   if (ctx->ws == NULL)
     {
-      ws = calloc(1, sizeof(struct wget_s));
-      if (!ws)
-        {
-          _SET_STATE(ctx, WEBCLIENT_CONTEXT_STATE_DONE);
-          return -errno;
-        }
-
-      ws->conn = calloc(1, sizeof(struct webclient_conn_s));
-      if (!ws->conn)
-        {
-          free_ws(ws);
-          _SET_STATE(ctx, WEBCLIENT_CONTEXT_STATE_DONE);
-          return -errno;
-        }
-
-      ws->buffer = ctx->buffer;
-      ws->buflen = ctx->buflen;
-
-      /* Parse the hostname (with optional port number) and filename
-       * from the URL.
-       */
-
-      if ((ctx->flags & WEBCLIENT_FLAG_TUNNEL) == 0)
-        {
-          ret = parseurl(ctx->url, &ws->target, false);
-          if (ret != 0)
-            {
-              nwarn("WARNING: Malformed URL: %s\n", ctx->url);
-              free_ws(ws);
-              _SET_STATE(ctx, WEBCLIENT_CONTEXT_STATE_DONE);
-              return ret;
-            }
-        }
-
-      if (ctx->proxy != NULL)
+      ret = wget_init_ws(ctx);
+      if (ret < 0)
         {
-          /* Note: reject a proxy string w/o port number specified.
-           * It's better to be explicit because the default number varies
-           * among HTTP client implementations.
-           * (80, 1080, 3128, 8080, ...)
-           */
-
-          ret = parseurl(ctx->proxy, &ws->proxy, true);
-          if (ret != 0)
-            {
-              nerr("ERROR: Malformed proxy setting: %s\n", ctx->proxy);
-              free_ws(ws);
-              _SET_STATE(ctx, WEBCLIENT_CONTEXT_STATE_DONE);
-              return ret;
-            }
-
-          if (strcmp(ws->proxy.scheme, "http") ||
-              strcmp(ws->proxy.filename, "/"))
-            {
-              nerr("ERROR: Unsupported proxy setting: %s\n", ctx->proxy);
-              free_ws(ws);
-              _SET_STATE(ctx, WEBCLIENT_CONTEXT_STATE_DONE);
-              return -ENOTSUP;
-            }
+          return ret;
         }
-
-      ws->state = WEBCLIENT_STATE_SOCKET;
-      ctx->ws = ws;
     }
 
   ws = ctx->ws;
@@ -1322,6 +1797,30 @@ int webclient_perform(FAR struct webclient_context *ctx)
           ws->ndx        = 0;
           ws->redirected = 0;
 
+#ifdef CONFIG_WEBCLIENT_KEEPALIVE
+          ws->keepconn = false;
+          ws->reused   = ws->keepalive &&
+                         wget_pool_get(conn, &ws->target);
+          if (ws->reused)
+            {
+              /* Apply the timeouts of this request to the connection */
+
+              if (!conn->tls)
+                {
+                  tv.tv_sec  = ctx->timeout_sec;
+                  tv.tv_usec = 0;
+                  setsockopt(conn->sockfd, SOL_SOCKET, SO_RCVTIMEO,
+                             &tv, sizeof(struct timeval));
+                  setsockopt(conn->sockfd, SOL_SOCKET, SO_SNDTIMEO,
+                             &tv, sizeof(struct timeval));
+                }
+
+              ws->need_conn_close = true;
+              ws->state = WEBCLIENT_STATE_PREPARE_REQUEST;
+              continue;
+            }
+#endif
+
           if (conn->tls)
             {
 #if defined(CONFIG_WEBCLIENT_NET_LOCAL)
@@ -1781,9 +2280,17 @@ int webclient_perform(FAR struct webclient_context *ctx)
 
           if (ctx->protocol_version == WEBCLIENT_PROTOCOL_VERSION_HTTP_1_1)
             {
-              /* We don't implement persistect connections. */
+#ifdef CONFIG_WEBCLIENT_KEEPALIVE
+              if (ws->keepalive)
+                {
+                  dest = append(dest, ep, g_httpconn);
+                }
+              else
+#endif
+                {
+                  dest = append(dest, ep, g_httpconn_close);
+                }
 
-              dest = append(dest, ep, g_httpconn_close);
               dest = append(dest, ep, g_httpcrnl);
             }
 
@@ -1846,6 +2353,18 @@ int webclient_perform(FAR struct webclient_context *ctx)
             {
               ninfo("Finished sending request body\n");
               ws->state = WEBCLIENT_STATE_STATUSLINE;
+
+#ifdef CONFIG_WEBCLIENT_KEEPALIVE
+              /* Pipelining reads the responses after sending all of the
+               * requests.
+               */
+
+              if (ws->send_only)
+                {
+                  ws->send_only = false;
+                  return OK;
+                }
+#endif
             }
           else if (ws->data_buffer == NULL)
             {
@@ -1922,6 +2441,17 @@ int webclient_perform(FAR struct webclient_context *ctx)
         {
           for (; ; )
             {
+#ifdef CONFIG_WEBCLIENT_KEEPALIVE
+              if (ws->keepalive && wget_response_done(ctx, ws))
+                {
+                  ninfo("Response complete\n");
+                  ws->state      = WEBCLIENT_STATE_CLOSE;
+                  ws->redirected = 0;
+                  ws->keepconn   = ws->reusable;
+                  break;
+                }
+#endif
+
               if (ws->datend - ws->offset == 0)
                 {
                   size_t want = ws->buflen;
@@ -2031,7 +2561,15 @@ int webclient_perform(FAR struct webclient_context *ctx)
                     }
                 }
 
-              if (ws->state == WEBCLIENT_STATE_WAIT_CLOSE)
+              /* On a persistent connection, the data may be the next
+               * pipelined response.
+               */
+
+              if (ws->state == WEBCLIENT_STATE_WAIT_CLOSE
+#ifdef CONFIG_WEBCLIENT_KEEPALIVE
+                  && !ws->keepalive
+#endif
+                  )
                 {
                   uintmax_t received = ws->datend - ws->offset;
                   if (received != 0)
@@ -2070,6 +2608,21 @@ int webclient_perform(FAR struct webclient_context *ctx)
 
                           ws->chunk_received += received;
                         }
+#ifdef CONFIG_WEBCLIENT_KEEPALIVE
+                      else if (ws->keepalive &&
+                               (ws->internal_flags &
+                                WGET_FLAG_GOT_CONTENT_LENGTH) != 0)
+                        {
+                          uintmax_t body_left =
+                              ws->expected_resp_body_len -
+                              ws->received_body_len;
+
+                          if (received > body_left)
+                            {
+                              received = body_left;
+                            }
+                        }
+#endif
 
                       ninfo("Processing resp body %ju - %ju\n",
                             ws->received_body_len,
@@ -2162,7 +2715,17 @@ int webclient_perform(FAR struct webclient_context *ctx)
 
       if (ws->state == WEBCLIENT_STATE_CLOSE)
         {
-          webclient_conn_close(conn);
+#ifdef CONFIG_WEBCLIENT_KEEPALIVE
+          if (ws->keepconn)
+            {
+              wget_keepconn(ws);
+            }
+          else
+#endif
+            {
+              webclient_conn_close(conn);
+            }
+
           ws->need_conn_close = false;
           if (ws->redirected)
             {
@@ -2207,6 +2770,17 @@ errout_with_errno:
       webclient_conn_close(conn);
     }
 
+#ifdef CONFIG_WEBCLIENT_KEEPALIVE
+  if (wget_can_retry(ctx, ws, ret))
+    {
+      ninfo("Retrying on a new connection: %d\n", ret);
+      ws->retried = true;
+      ws->need_conn_close = false;
+      ws->state = WEBCLIENT_STATE_SOCKET;
+      return webclient_perform(ctx);
+    }
+#endif
+
   free_ws(ws);
   _SET_STATE(ctx, WEBCLIENT_CONTEXT_STATE_DONE);
   return ret;
@@ -2253,6 +2827,218 @@ void webclient_abort(FAR struct webclient_context *ctx)
   _SET_STATE(ctx, WEBCLIENT_CONTEXT_STATE_ABORTED);
 }
 
+#ifdef CONFIG_WEBCLIENT_KEEPALIVE
+/****************************************************************************
+ * Name: webclient_perform_pipelined
+ *
+ * Description:
+ *  Perform a batch of blocking HTTP/1.1 requests to the same scheme, host
+ *  and port over a single connection.  All of the requests are sent before
+ *  the first response is read, and the responses are then delivered to
+ *  the contexts in order.
+ *
+ *  No request may use a proxy, a tunnel or WEBCLIENT_FLAG_NON_BLOCKING.
+ *  If the connection fails part way through, the requests whose
+ *  responses were not received fail with -ECONNRESET.
+ *
+ * Returned Value:
+ *               0: if all of the requests completed successfully;
+ *  Negative errno: The first failure
+ *
+ ****************************************************************************/
+
+int webclient_perform_pipelined(FAR struct webclient_context **ctxs,
+                                unsigned int nctxs)
+{
+  FAR struct wget_target_s *target;
+  FAR struct wget_target_s *first;
+  FAR struct wget_s *ws;
+  unsigned int sent;
+  unsigned int i;
+  int result = OK;
+  int ret;
+
+  if (nctxs == 0)
+    {
+      return OK;
+    }
+
+  target = malloc(2 * sizeof(struct wget_target_s));
+  if (target == NULL)
+    {
+      return -ENOMEM;
+    }
+
+  /* Check that the requests can share a connection */
+
+  first = &target[1];
+  for (i = 0; i < nctxs; i++)
+    {
+      _CHECK_STATE(ctxs[i], WEBCLIENT_CONTEXT_STATE_INITIALIZED);
+
+      if ((ctxs[i]->flags & (WEBCLIENT_FLAG_NON_BLOCKING |
+                             WEBCLIENT_FLAG_TUNNEL)) != 0 ||
+          ctxs[i]->protocol_version !=
+          WEBCLIENT_PROTOCOL_VERSION_HTTP_1_1 ||
+          ctxs[i]->proxy != NULL
+#if defined(CONFIG_WEBCLIENT_NET_LOCAL)
+          || ctxs[i]->unix_socket_path != NULL
+#endif
+          )
+        {
+          free(target);
+          return -EINVAL;
+        }
+
+      ret = parseurl(ctxs[i]->url, i == 0 ? first : target, false);
+      if (ret != 0)
+        {
+          free(target);
+          return ret;
+        }
+
+      if (i > 0 && (target->port != first->port ||
+                    strcmp(target->scheme, first->scheme) != 0 ||
+                    strcmp(target->hostname, first->hostname) != 0))
+        {
+          free(target);
+          return -EINVAL;
+        }
+    }
+
+  free(target);
+
+  /* Send all of the requests */
+
+  for (sent = 0; sent < nctxs; sent++)
+    {
+      FAR struct webclient_context *ctx = ctxs[sent];
+
+      ctx->flags |= WEBCLIENT_FLAG_KEEPALIVE;
+      ret = wget_init_ws(ctx);
+      if (ret < 0)
+        {
+          if (sent > 0)
+            {
+              webclient_conn_close(ctxs[0]->ws->conn);
+            }
+
+          result = ret;
+          break;
+        }
+
+      ws            = ctx->ws;
+      ws->pipelined = true;
+      ws->send_only = true;
+
+      if (sent > 0)
+        {
+          *ws->conn           = *ctxs[0]->ws->conn;
+          ws->need_conn_close = true;
+          ws->state           = WEBCLIENT_STATE_PREPARE_REQUEST;
+        }
+
+      ret = webclient_perform(ctx);
+      if (ret < 0)
+        {
+          /* The connection has been closed */
+
+          result = ret;
+          break;
+        }
+
+      if (sent > 0)
+        {
+          ctxs[sent - 1]->ws->pipe_next = ctx;
+        }
+    }
+
+  /* Receive the responses.  Each one hands the connection over to the
+   * next request when it completes.
+   */
+
+  for (i = 0; i < sent; i++)
+    {
+      FAR struct webclient_context *ctx = ctxs[i];
+
+      ws = ctx->ws;
+      if (result < 0 || (i > 0 && !ws->pipe_ready))
+        {
+          free_ws(ws);
+          ctx->ws = NULL;
+          _SET_STATE(ctx, WEBCLIENT_CONTEXT_STATE_DONE);
+          if (result == OK)
+            {
+              result = -ECONNRESET;
+            }
+
+          continue;
+        }
+
+      ret = webclient_perform(ctx);
+      if (ret < 0 && result == OK)
+        {
+          result = ret;
+        }
+    }
+
+  return result;
+}
+
+/****************************************************************************
+ * Name: webclient_pool_flush
+ *
+ * Description:
+ *  Close all of the idle connections kept by WEBCLIENT_FLAG_KEEPALIVE.
+ *
+ ****************************************************************************/
+
+void webclient_pool_flush(void)
+{
+  int i;
+
+  pthread_mutex_lock(&g_pool_lock);
+  for (i = 0; i < CONFIG_WEBCLIENT_POOL_SIZE; i++)
+    {
+      if (g_pool[i].inuse)
+        {
+          webclient_conn_close(&g_pool[i].conn);
+          g_pool[i].inuse = false;
+        }
+    }
+
+  pthread_mutex_unlock(&g_pool_lock);
+}
+
+/****************************************************************************
+ * Name: webclient_pool_flush_tls
+ *
+ * Description:
+ *  Close the idle https connections that use the TLS context tls_ctx.
+ *  This must be called before the application frees a TLS context that
+ *  was used with WEBCLIENT_FLAG_KEEPALIVE.
+ *
+ ****************************************************************************/
+
+void webclient_pool_flush_tls(FAR void *tls_ctx)
+{
+  int i;
+
+  pthread_mutex_lock(&g_pool_lock);
+  for (i = 0; i < CONFIG_WEBCLIENT_POOL_SIZE; i++)
+    {
+      if (g_pool[i].inuse && g_pool[i].conn.tls &&
+          g_pool[i].conn.tls_ctx == tls_ctx)
+        {
+          webclient_conn_close(&g_pool[i].conn);
+          g_pool[i].inuse = false;
+        }
+    }
+
+  pthread_mutex_unlock(&g_pool_lock);
+}
+#endif
+
 /****************************************************************************
  * Name: web_post_str
  ****************************************************************************/
@@ -0,0 +1,829 @@
+/****************************************************************************
+ * apps/netutils/webclient/webclient_range.c
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.  The
+ * ASF licenses this file to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance with the
+ * License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <debug.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <inttypes.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <unistd.h>
+
+#include "netutils/webclient.h"
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+#ifndef CONFIG_WEBCLIENT_RANGES_MAX
+#  define CONFIG_WEBCLIENT_RANGES_MAX 4
+#endif
+
+#ifndef CONFIG_WEBCLIENT_RANGES_STACKSIZE
+#  define CONFIG_WEBCLIENT_RANGES_STACKSIZE PTHREAD_STACK_DEFAULT
+#endif
+
+#ifndef CONFIG_WEBCLIENT_RANGES_CHECKPOINT
+#  define CONFIG_WEBCLIENT_RANGES_CHECKPOINT 16384
+#endif
+
+#ifndef CONFIG_WEBCLIENT_RANGES_RETRIES
+#  define CONFIG_WEBCLIENT_RANGES_RETRIES 3
+#endif
+
+#define RANGE_MAGIC   0x57475231 /* "WGR1" */
+#define RANGE_MINSIZE 4096       /* Smallest range worth a request */
+#define RANGE_ETAGLEN 48
+
+/****************************************************************************
+ * Private Types
+ ****************************************************************************/
+
+/* The resume file is a header followed by one record per range */
+
+struct range_hdr_s
+{
+  uint32_t magic;
+  uint32_t nranges;
+  int64_t total;
+  char etag[RANGE_ETAGLEN];
+};
+
+struct range_rec_s
+{
+  int64_t start;
+  int64_t end;
+  int64_t done;
+};
+
+/* State shared by the ranges of a download */
+
+struct range_job_s
+{
+  FAR const struct webclient_context *tmpl;
+  webclient_range_callback_t callback;
+  FAR void *arg;
+  pthread_mutex_t lock;          /* Serializes checkpoints and callbacks */
+  int fd;                        /* The local file */
+  int statefd;                   /* The resume file */
+  off_t total;                   /* File size, -1 if ranges are unsupported */
+  char etag[RANGE_ETAGLEN];      /* Entity tag of the file, if any */
+};
+
+/* One range, also used for the probe request */
+
+struct range_worker_s
+{
+  FAR struct range_job_s *job;
+  FAR struct webclient_context *ctx; /* The request in progress */
+  struct webclient_range_s range;
+  off_t checkpoint;              /* range.done at the last checkpoint */
+  off_t crstart;                 /* First byte of the Content-Range */
+  off_t crtotal;                 /* Total size of the Content-Range */
+  pthread_t thread;
+  unsigned int index;
+  unsigned int status;           /* HTTP status of the last request */
+  int result;
+  bool started;                  /* The range runs in its own thread */
+  bool checked;                  /* The response has been validated */
+  char header[48];               /* The Range request header */
+  char etag[RANGE_ETAGLEN];      /* ETag of the response */
+};
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+static const char g_contentrange[] = "Content-Range:";
+static const char g_etag[]         = "ETag:";
+static const char g_statesuffix[]  = ".range";
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: range_header
+ *
+ * Description:
+ *   Record the Content-Range and ETag response headers.
+ *
+ ****************************************************************************/
+
+static int range_header(FAR const char *line, bool truncated,
+                        FAR void *arg)
+{
+  FAR struct range_worker_s *worker = arg;
+  FAR const char *value;
+
+  if (strncasecmp(line, g_contentrange, strlen(g_contentrange)) == 0)
+    {
+      /* bytes <first>-<last>/<total> or bytes * /<total> */
+
+      value = line + strlen(g_contentrange);
+      value += strspn(value, " ");
+      if (strncasecmp(value, "bytes ", 6) != 0)
+        {
+          return 0;
+        }
+
+      value += 6;
+      if (*value != '*')
+        {
+          worker->crstart = strtoll(value, NULL, 10);
+        }
+
+      value = strchr(value, '/');
+      if (value != NULL && value[1] != '*')
+        {
+          worker->crtotal = strtoll(value + 1, NULL, 10);
+        }
+    }
+  else if (strncasecmp(line, g_etag, strlen(g_etag)) == 0)
+    {
+      value = line + strlen(g_etag);
+      value += strspn(value, " ");
+      strlcpy(worker->etag, value, sizeof(worker->etag));
+    }
+
+  return 0;
+}
+
+/****************************************************************************
+ * Name: range_write
+ *
+ * Description:
+ *   Write received data at the current position of the range.
+ *
+ ****************************************************************************/
+
+static int range_write(FAR struct range_worker_s *worker,
+                       FAR const char *data, size_t len)
+{
+  FAR struct webclient_range_s *range = &worker->range;
+  ssize_t nwritten;
+
+  while (len > 0)
+    {
+      nwritten = pwrite(worker->job->fd, data, len,
+                        range->start + range->done);
+      if (nwritten < 0)
+        {
+          if (errno == EINTR)
+            {
+              continue;
+            }
+
+          return -errno;
+        }
+
+      range->done += nwritten;
+      data        += nwritten;
+      len         -= nwritten;
+    }
+
+  return 0;
+}
+
+/****************************************************************************
+ * Name: range_checkpoint
+ *
+ * Description:
+ *   Sync the file, record the progress of a range in the resume file and
+ *   report it.
+ *
+ ****************************************************************************/
+
+static void range_checkpoint(FAR struct range_worker_s *worker)
+{
+  FAR struct range_job_s *job = worker->job;
+  struct range_rec_s rec;
+
+  rec.start = worker->range.start;
+  rec.end   = worker->range.end;
+  rec.done  = worker->range.done;
+
+  pthread_mutex_lock(&job->lock);
+
+  /* The data must be on the media before the record says so */
+
+  fsync(job->fd);
+  if (pwrite(job->statefd, &rec, sizeof(rec),
+             sizeof(struct range_hdr_s) +
+             worker->index * sizeof(rec)) != sizeof(rec))
+    {
+      nwarn("WARNING: Failed to update the resume file: %d\n", errno);
+    }
+
+  if (job->callback != NULL)
+    {
+      job->callback(worker->index, &worker->range, job->arg);
+    }
+
+  pthread_mutex_unlock(&job->lock);
+  worker->checkpoint = worker->range.done;
+}
+
+/****************************************************************************
+ * Name: range_probe_sink
+ *
+ * Description:
+ *   If the server ignored the Range of the probe, the response carries the
+ *   whole file, which is written as it arrives.
+ *
+ ****************************************************************************/
+
+static int range_probe_sink(FAR char **buffer, int offset, int datend,
+                            FAR int *buflen, FAR void *arg)
+{
+  FAR struct range_worker_s *worker = arg;
+
+  if (worker->ctx->http_status != 200)
+    {
+      return 0;
+    }
+
+  return range_write(worker, *buffer + offset, datend - offset);
+}
+
+/****************************************************************************
+ * Name: range_sink
+ *
+ * Description:
+ *   Write the body of a range response into the region of the range.
+ *
+ ****************************************************************************/
+
+static int range_sink(FAR char **buffer, int offset, int datend,
+                      FAR int *buflen, FAR void *arg)
+{
+  FAR struct range_worker_s *worker = arg;
+  FAR struct webclient_range_s *range = &worker->range;
+  FAR struct range_job_s *job = worker->job;
+  size_t len = datend - offset;
+  int ret;
+
+  /* Make sure this is the requested part of the same file */
+
+  if (!worker->checked)
+    {
+      if (worker->ctx->http_status != 206 ||
+          worker->crstart != range->start + range->done ||
+          worker->crtotal != job->total ||
+          strcmp(worker->etag, job->etag) != 0)
+        {
+          nerr("ERROR: Range %u: unexpected response, status %u\n",
+               worker->index, worker->ctx->http_status);
+          return -EIO;
+        }
+
+      worker->checked = true;
+    }
+
+  if (len > (size_t)(range->end - range->start - range->done))
+    {
+      nerr("ERROR: Range %u: too much data\n", worker->index);
+      return -EIO;
+    }
+
+  ret = range_write(worker, *buffer + offset, len);
+  if (ret < 0)
+    {
+      return ret;
+    }
+
+  if (range->done - worker->checkpoint >=
+      CONFIG_WEBCLIENT_RANGES_CHECKPOINT)
+    {
+      range_checkpoint(worker);
+    }
+
+  return 0;
+}
+
+/****************************************************************************
+ * Name: range_perform
+ *
+ * Description:
+ *   Perform one GET request of the template with worker->header added.
+ *
+ ****************************************************************************/
+
+static int range_perform(FAR struct range_worker_s *worker,
+                         webclient_sink_callback_t sink)
+{
+  FAR const struct webclient_context *tmpl = worker->job->tmpl;
+  struct webclient_context ctx;
+  FAR const char **headers;
+  int ret;
+
+  /* The headers and the I/O buffer are a single allocation */
+
+  headers = malloc((tmpl->nheaders + 1) * sizeof(FAR const char *) +
+                   tmpl->buflen);
+  if (headers == NULL)
+    {
+      return -ENOMEM;
+    }
+
+  if (tmpl->nheaders > 0)
+    {
+      memcpy(headers, tmpl->headers,
+             tmpl->nheaders * sizeof(FAR const char *));
+    }
+
+  headers[tmpl->nheaders] = worker->header;
+
+  webclient_set_defaults(&ctx);
+  ctx.protocol_version    = tmpl->protocol_version;
+  ctx.url                 = tmpl->url;
+  ctx.proxy               = tmpl->proxy;
+#if defined(CONFIG_WEBCLIENT_NET_LOCAL)
+  ctx.unix_socket_path    = tmpl->unix_socket_path;
+#endif
+  ctx.headers             = headers;
+  ctx.nheaders            = tmpl->nheaders + 1;
+  ctx.timeout_sec         = tmpl->timeout_sec;
+  ctx.tls_ops             = tmpl->tls_ops;
+  ctx.tls_ctx             = tmpl->tls_ctx;
+  ctx.buffer              = (FAR char *)&headers[tmpl->nheaders + 1];
+  ctx.buflen              = tmpl->buflen;
+  ctx.sink_callback       = sink;
+  ctx.sink_callback_arg   = worker;
+  ctx.header_callback     = range_header;
+  ctx.header_callback_arg = worker;
+
+  worker->ctx     = &ctx;
+  worker->crstart = -1;
+  worker->crtotal = -1;
+  worker->checked = false;
+  worker->etag[0] = '\0';
+
+  ret = webclient_perform(&ctx);
+
+  worker->status = ctx.http_status;
+  worker->ctx    = NULL;
+  free(headers);
+  return ret;
+}
+
+/****************************************************************************
+ * Name: range_probe
+ *
+ * Description:
+ *   Request the first byte of the file to learn its size and entity tag.
+ *   If the server answers with the whole file instead, it has been
+ *   downloaded and job->total is set to -1.
+ *
+ ****************************************************************************/
+
+static int range_probe(FAR struct range_job_s *job,
+                       FAR struct range_worker_s *worker)
+{
+  int ret;
+
+  worker->job = job;
+  strlcpy(worker->header, "Range: bytes=0-0", sizeof(worker->header));
+
+  ret = range_perform(worker, range_probe_sink);
+  if (ret < 0)
+    {
+      return ret;
+    }
+
+  switch (worker->status)
+    {
+      case 200:
+        job->total = -1;
+        return OK;
+
+      case 206:
+      case 416:
+        if (worker->crtotal < 0)
+          {
+            nerr("ERROR: No file size in the Content-Range\n");
+            return -EPROTO;
+          }
+
+        job->total = worker->crtotal;
+        strlcpy(job->etag, worker->etag, sizeof(job->etag));
+        return OK;
+
+      default:
+        nerr("ERROR: HTTP status %u\n", worker->status);
+        return -EIO;
+    }
+}
+
+/****************************************************************************
+ * Name: range_load
+ *
+ * Description:
+ *   Load the ranges of an interrupted download of the same file.
+ *
+ * Returned Value:
+ *   The number of ranges, or zero if there is no usable resume file.
+ *
+ ****************************************************************************/
+
+static unsigned int range_load(FAR struct range_job_s *job,
+                               FAR const char *statepath,
+                               FAR struct range_worker_s *workers)
+{
+  struct range_hdr_s hdr;
+  struct range_rec_s rec;
+  unsigned int n = 0;
+  unsigned int i;
+  int fd;
+
+  fd = open(statepath, O_RDONLY);
+  if (fd < 0)
+    {
+      return 0;
+    }
+
+  if (read(fd, &hdr, sizeof(hdr)) != sizeof(hdr) ||
+      hdr.magic != RANGE_MAGIC || hdr.total != job->total ||
+      hdr.nranges == 0 || hdr.nranges > CONFIG_WEBCLIENT_RANGES_MAX ||
+      strncmp(hdr.etag, job->etag, RANGE_ETAGLEN) != 0)
+    {
+      goto out;
+    }
+
+  for (i = 0; i < hdr.nranges; i++)
+    {
+      if (read(fd, &rec, sizeof(rec)) != sizeof(rec) ||
+          rec.start < 0 || rec.done < 0 || rec.end > job->total ||
+          rec.start + rec.done > rec.end)
+        {
+          goto out;
+        }
+
+      workers[i].range.start = rec.start;
+      workers[i].range.end   = rec.end;
+      workers[i].range.done  = rec.done;
+    }
+
+  n = hdr.nranges;
+  ninfo("Resuming %u ranges\n", n);
+
+out:
+  close(fd);
+  return n;
+}
+
+/****************************************************************************
+ * Name: range_split
+ *
+ * Description:
+ *   Split the bytes from offset "from" to the end of the file into ranges.
+ *
+ ****************************************************************************/
+
+static unsigned int range_split(FAR struct range_job_s *job,
+                                FAR struct range_worker_s *workers,
+                                unsigned int nranges, off_t from)
+{
+  off_t size = job->total - from;
+  off_t step;
+  unsigned int i;
+
+  if (size / nranges < RANGE_MINSIZE)
+    {
+      nranges = size / RANGE_MINSIZE > 0 ? size / RANGE_MINSIZE : 1;
+    }
+
+  step = size / nranges;
+  for (i = 0; i < nranges; i++)
+    {
+      workers[i].range.start = from + i * step;
+      workers[i].range.end   = from + (i + 1) * step;
+      workers[i].range.done  = 0;
+    }
+
+  workers[nranges - 1].range.end = job->total;
+  return nranges;
+}
+
+/****************************************************************************
+ * Name: range_save
+ *
+ * Description:
+ *   Create the resume file and leave it open for the checkpoints.
+ *
+ ****************************************************************************/
+
+static int range_save(FAR struct range_job_s *job,
+                      FAR const char *statepath,
+                      FAR struct range_worker_s *workers,
+                      unsigned int nranges)
+{
+  struct range_hdr_s hdr;
+  struct range_rec_s rec;
+  unsigned int i;
+
+  job->statefd = open(statepath, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+  if (job->statefd < 0)
+    {
+      return -errno;
+    }
+
+  memset(&hdr, 0, sizeof(hdr));
+  hdr.magic   = RANGE_MAGIC;
+  hdr.nranges = nranges;
+  hdr.total   = job->total;
+  strlcpy(hdr.etag, job->etag, sizeof(hdr.etag));
+
+  if (write(job->statefd, &hdr, sizeof(hdr)) != sizeof(hdr))
+    {
+      return errno > 0 ? -errno : -EIO;
+    }
+
+  for (i = 0; i < nranges; i++)
+    {
+      rec.start = workers[i].range.start;
+      rec.end   = workers[i].range.end;
+      rec.done  = workers[i].range.done;
+
+      if (write(job->statefd, &rec, sizeof(rec)) != sizeof(rec))
+        {
+          return errno > 0 ? -errno : -EIO;
+        }
+    }
+
+  return OK;
+}
+
+/****************************************************************************
+ * Name: range_run
+ *
+ * Description:
+ *   Download the rest of a range, retrying from where a failed request
+ *   stopped.
+ *
+ ****************************************************************************/
+
+static int range_run(FAR struct range_worker_s *worker)
+{
+  FAR struct webclient_range_s *range = &worker->range;
+  unsigned int retries = 0;
+  int ret;
+
+  for (; ; )
+    {
+      if (range->start + range->done >= range->end)
+        {
+          ret = OK;
+          break;
+        }
+
+      snprintf(worker->header, sizeof(worker->header),
+               "Range: bytes=%jd-%jd",
+               (intmax_t)(range->start + range->done),
+               (intmax_t)(range->end - 1));
+
+      ret = range_perform(worker, range_sink);
+      if (ret == OK && range->start + range->done < range->end)
+        {
+          /* The response ended early */
+
+          ret = -ECONNRESET;
+        }
+
+      /* -EIO is a wrong response or a write error, which a retry does not
+       * help.
+       */
+
+      if (ret == OK || ret == -EIO ||
+          retries++ >= CONFIG_WEBCLIENT_RANGES_RETRIES)
+        {
+          break;
+        }
+
+      nwarn("WARNING: Range %u failed: %d, retrying\n", worker->index, ret);
+      sleep(1);
+    }
+
+  range_checkpoint(worker);
+  return ret;
+}
+
+/****************************************************************************
+ * Name: range_thread
+ ****************************************************************************/
+
+static FAR void *range_thread(FAR void *arg)
+{
+  FAR struct range_worker_s *worker = arg;
+
+  worker->result = range_run(worker);
+  return NULL;
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: webclient_get_ranges
+ ****************************************************************************/
+
+int webclient_get_ranges(FAR const struct webclient_context *ctx,
+                         FAR const char *path, unsigned int nranges,
+                         bool resume, webclient_range_callback_t callback,
+                         FAR void *arg)
+{
+  FAR struct range_worker_s *workers;
+  struct range_job_s job;
+  pthread_attr_t attr;
+  FAR char *statepath;
+  struct stat st;
+  unsigned int n = 0;
+  unsigned int i;
+  off_t from = 0;
+  int ret;
+
+  if (nranges == 0)
+    {
+      nranges = 1;
+    }
+  else if (nranges > CONFIG_WEBCLIENT_RANGES_MAX)
+    {
+      nranges = CONFIG_WEBCLIENT_RANGES_MAX;
+    }
+
+  workers = calloc(CONFIG_WEBCLIENT_RANGES_MAX, sizeof(*workers));
+  if (workers == NULL)
+    {
+      return -ENOMEM;
+    }
+
+  if (asprintf(&statepath, "%s%s", path, g_statesuffix) < 0)
+    {
+      free(workers);
+      return -ENOMEM;
+    }
+
+  memset(&job, 0, sizeof(job));
+  job.tmpl     = ctx;
+  job.callback = callback;
+  job.arg      = arg;
+  job.statefd  = -1;
+  pthread_mutex_init(&job.lock, NULL);
+
+  job.fd = open(path, O_WRONLY | O_CREAT | (resume ? 0 : O_TRUNC), 0644);
+  if (job.fd < 0)
+    {
+      ret = -errno;
+      goto errout;
+    }
+
+  /* Learn the size of the file and whether the server supports ranges */
+
+  ret = range_probe(&job, &workers[0]);
+  if (ret < 0)
+    {
+      goto errout_with_fd;
+    }
+
+  if (job.total < 0)
+    {
+      /* The whole file came in the response to the probe */
+
+      ftruncate(job.fd, workers[0].range.done);
+      unlink(statepath);
+      goto errout_with_fd;
+    }
+
+  memset(workers, 0, CONFIG_WEBCLIENT_RANGES_MAX * sizeof(*workers));
+  if (resume)
+    {
+      n = range_load(&job, statepath, workers);
+
+      /* Without a resume file, a file shorter than the download holds its
+       * beginning.  A full size file may be a preallocated one whose
+       * resume file was lost, so it is fetched again.
+       */
+
+      if (n == 0 && access(statepath, F_OK) < 0 &&
+          fstat(job.fd, &st) == 0 && st.st_size < job.total)
+        {
+          from = st.st_size;
+        }
+    }
+
+  if (n == 0)
+    {
+      n = range_split(&job, workers, nranges, from);
+    }
+
+  for (i = 0; i < n; i++)
+    {
+      workers[i].job        = &job;
+      workers[i].index      = i;
+      workers[i].checkpoint = workers[i].range.done;
+    }
+
+  /* Record the ranges before preallocating the file, so that a full size
+   * file is never left behind without its resume file.
+   */
+
+  ret = range_save(&job, statepath, workers, n);
+  if (ret < 0)
+    {
+      goto errout_with_fd;
+    }
+
+  /* Preallocate the file, so that each range writes its own region */
+
+  if (ftruncate(job.fd, job.total) < 0)
+    {
+      ret = -errno;
+      goto errout_with_fd;
+    }
+
+  /* The first range runs in this thread */
+
+  pthread_attr_init(&attr);
+  pthread_attr_setstacksize(&attr, CONFIG_WEBCLIENT_RANGES_STACKSIZE);
+  for (i = 1; i < n; i++)
+    {
+      workers[i].started = pthread_create(&workers[i].thread, &attr,
+                                          range_thread, &workers[i]) == 0;
+    }
+
+  pthread_attr_destroy(&attr);
+
+  workers[0].result = range_run(&workers[0]);
+  for (i = 1; i < n; i++)
+    {
+      if (workers[i].started)
+        {
+          pthread_join(workers[i].thread, NULL);
+        }
+      else
+        {
+          workers[i].result = range_run(&workers[i]);
+        }
+    }
+
+  for (i = 0; i < n && ret == OK; i++)
+    {
+      ret = workers[i].result;
+    }
+
+  /* Keep the resume file until the download is complete */
+
+  if (ret == OK)
+    {
+      fsync(job.fd);
+      close(job.statefd);
+      job.statefd = -1;
+      unlink(statepath);
+    }
+
+errout_with_fd:
+  if (job.statefd >= 0)
+    {
+      close(job.statefd);
+    }
+
+  close(job.fd);
+
+errout:
+  pthread_mutex_destroy(&job.lock);
+  free(statepath);
+  free(workers);
+  return ret;
+}
@@ -58,6 +58,12 @@
 #  include <pthread.h>
 #endif
 
+#ifdef CONFIG_NETUTILS_HTTPD_WORKERPOOL
+#  include <fcntl.h>
+#  include <poll.h>
+#  include <time.h>
+#endif
+
 #include <arpa/inet.h>
 
 #include "netutils/netlib.h"
@@ -114,6 +120,26 @@
 #  endif
 #endif
 
+#ifdef CONFIG_NETUTILS_HTTPD_WORKERPOOL
+#  ifndef CONFIG_NETUTILS_HTTPD_NWORKERS
+#    define CONFIG_NETUTILS_HTTPD_NWORKERS 2
+#  endif
+
+#  ifndef CONFIG_NETUTILS_HTTPD_MAXCONN
+#    define CONFIG_NETUTILS_HTTPD_MAXCONN 8
+#  endif
+
+/* Connection slot states */
+
+#  define SLOT_FREE    0  /* Not in use */
+#  define SLOT_IDLE    1  /* Waiting for a request, in the poll set */
+#  define SLOT_BUSY    2  /* Queued for or being served by a worker */
+
+/* Poll entries:  The wake-up pipe, the listen socket and every connection */
+
+#  define POOL_NFDS    (CONFIG_NETUTILS_HTTPD_MAXCONN + 2)
+#endif
+
 #ifdef CONFIG_NETUTILS_HTTPD_CLASSIC
 #  ifndef CONFIG_NETUTILS_HTTPD_INDEX
 #    ifndef CONFIG_NETUTILS_HTTPD_SCRIPT_DISABLE
@@ -124,10 +150,43 @@
 #  endif
 #endif
 
+/****************************************************************************
+ * Private Types
+ ****************************************************************************/
+
+#ifdef CONFIG_NETUTILS_HTTPD_WORKERPOOL
+/* A preallocated connection.  Only the dispatcher moves a slot out of
+ * SLOT_FREE or SLOT_IDLE; only the worker serving it moves it out of
+ * SLOT_BUSY.
+ */
+
+struct httpd_slot_s
+{
+  struct httpd_state ps;          /* Request state */
+  time_t lastactive;              /* End of the last request */
+  uint8_t status;                 /* See SLOT_* definitions */
+};
+
+struct httpd_pool_s
+{
+  pthread_mutex_t lock;           /* Protects the queue and slot states */
+  pthread_cond_t ready;           /* Signaled when work is queued */
+  int wakefd[2];                  /* Wakes the dispatcher after a request */
+  uint8_t head;                   /* Index of the oldest queued slot */
+  uint8_t nqueued;                /* Number of queued slots */
+  uint8_t queue[CONFIG_NETUTILS_HTTPD_MAXCONN];
+  struct httpd_slot_s slots[CONFIG_NETUTILS_HTTPD_MAXCONN];
+};
+#endif
+
 /****************************************************************************
  * Private Data
  ****************************************************************************/
 
+#ifdef CONFIG_NETUTILS_HTTPD_WORKERPOOL
+static struct httpd_pool_s g_pool;
+#endif
+
 /****************************************************************************
  * Private Functions
  ****************************************************************************/
@@ -174,6 +233,86 @@ static int httpd_openindex(struct httpd_state *pstate)
   return ret;
 }
 
+#ifdef CONFIG_NETUTILS_HTTPD_GZIP
+/* Open the precompressed copy "<name>.gz" of the requested file, if the
+ * client accepts gzip and such a file exists.  The request name is left
+ * unchanged so that the MIME type is still derived from it.
+ */
+
+static int httpd_opengzip(struct httpd_state *pstate)
+{
+#ifndef CONFIG_NETUTILS_HTTPD_SCRIPT_DISABLE
+  char *ptr;
+#endif
+  size_t z;
+  int ret;
+
+  if (!pstate->ht_acceptgzip)
+    {
+      return ERROR;
+    }
+
+#ifndef CONFIG_NETUTILS_HTTPD_SCRIPT_DISABLE
+  /* Scripts are expanded as they are sent */
+
+  ptr = strchr(pstate->ht_filename, ISO_PERIOD);
+  if (ptr != NULL &&
+      strncmp(ptr, ".shtml", strlen(".shtml")) == 0)
+    {
+      return ERROR;
+    }
+#endif
+
+  /* A query string would follow the suffix and hide it */
+
+  z = strlen(pstate->ht_filename);
+  if (z == 0 || pstate->ht_filename[z - 1] == '/' ||
+      strchr(pstate->ht_filename, '?') != NULL ||
+      z + sizeof(".gz") > sizeof(pstate->ht_filename))
+    {
+      return ERROR;
+    }
+
+  strlcpy(pstate->ht_filename + z, ".gz", sizeof(pstate->ht_filename) - z);
+  ret = httpd_open(pstate->ht_filename, &pstate->ht_file);
+  pstate->ht_filename[z] = '\0';
+
+  if (ret == OK)
+    {
+      ninfo("[%d] sending gzip copy of '%s'\n",
+            pstate->ht_sockfd, pstate->ht_filename);
+    }
+
+  return ret;
+}
+
+/* Check an Accept-Encoding header value for gzip with a non-zero qvalue */
+
+static bool httpd_acceptgzip(char *value)
+{
+  char *saveptr;
+  char *token;
+  char *q;
+
+  for (token = strtok_r(value, ",", &saveptr);
+       token != NULL;
+       token = strtok_r(NULL, ",", &saveptr))
+    {
+      token += strspn(token, " \t");
+      if (strncasecmp(token, "gzip", 4) != 0 ||
+          strchr("; \t", token[4]) == NULL)
+        {
+          continue;
+        }
+
+      q = strstr(token + 4, "q=");
+      return q == NULL || strtod(q + 2, NULL) > 0;
+    }
+
+  return false;
+}
+#endif
+
 static int httpd_close(struct httpd_fs_file *file)
 {
 #if defined(CONFIG_NETUTILS_HTTPD_CLASSIC)
@@ -445,7 +584,12 @@ static int httpd_sendfile(struct httpd_state *pstate)
     }
 #endif
 
+#ifdef CONFIG_NETUTILS_HTTPD_GZIP
+  pstate->ht_gzip = httpd_opengzip(pstate) == OK;
+  if (!pstate->ht_gzip && httpd_openindex(pstate) != OK)
+#else
   if (httpd_openindex(pstate) != OK)
+#endif
     {
       nwarn("WARNING: [%d] '%s' not found\n",
            pstate->ht_sockfd, pstate->ht_filename);
@@ -641,6 +785,12 @@ static inline int httpd_parse(struct httpd_state *pstate)
               {
                 pstate->ht_keepalive = true;
               }
+#endif
+#ifdef CONFIG_NETUTILS_HTTPD_GZIP
+            else if (0 == strcasecmp(start, "Accept-Encoding"))
+              {
+                pstate->ht_acceptgzip = httpd_acceptgzip(v);
+              }
 #endif
             break;
 
@@ -672,6 +822,110 @@ static inline int httpd_parse(struct httpd_state *pstate)
   return 200;
 }
 
+/****************************************************************************
+ * Name: httpd_request
+ *
+ * Description:
+ *   Receive one request on the connection and send the response.  Returns
+ *   true if the client asked to keep the connection alive for another
+ *   request.
+ *
+ ****************************************************************************/
+
+static bool httpd_request(FAR struct httpd_state *pstate)
+{
+  int status;
+
+#ifndef CONFIG_NETUTILS_HTTPD_KEEPALIVE_DISABLE
+  pstate->ht_keepalive = false;
+#endif
+#ifdef CONFIG_NETUTILS_HTTPD_GZIP
+  pstate->ht_acceptgzip = false;
+  pstate->ht_gzip       = false;
+#endif
+
+  status = httpd_parse(pstate);
+  if (status < 0)
+    {
+      /* The connection was lost, there is no one to respond to */
+
+      return false;
+    }
+  else if (status >= 400)
+    {
+      httpd_senderror(pstate, status);
+    }
+  else
+    {
+      httpd_sendfile(pstate);
+    }
+
+#ifndef CONFIG_NETUTILS_HTTPD_KEEPALIVE_DISABLE
+  return pstate->ht_keepalive;
+#else
+  return false;
+#endif
+}
+
+#if defined(CONFIG_NETUTILS_HTTPD_SINGLECONNECT) || \
+    defined(CONFIG_NETUTILS_HTTPD_WORKERPOOL)
+/****************************************************************************
+ * Name: httpd_sockopts
+ *
+ * Description:
+ *   Configure a newly accepted connection:  Linger until all data is sent
+ *   when the socket is closed, and time out receives.
+ *
+ ****************************************************************************/
+
+static int httpd_sockopts(int sockfd)
+{
+#ifdef CONFIG_NET_SOLINGER
+  struct linger ling;
+#endif
+#if CONFIG_NETUTILS_HTTPD_TIMEOUT > 0
+  struct timeval tv;
+#endif
+
+#ifdef CONFIG_NET_SOLINGER
+  ling.l_onoff  = 1;
+  ling.l_linger = 30;     /* timeout is seconds */
+  if (setsockopt(sockfd, SOL_SOCKET, SO_LINGER, &ling,
+                 sizeof(struct linger)) < 0)
+    {
+      nerr("ERROR: setsockopt SO_LINGER failure: %d\n", errno);
+      return ERROR;
+    }
+#endif
+
+#if CONFIG_NETUTILS_HTTPD_TIMEOUT > 0
+  /* Set up a receive timeout */
+
+  tv.tv_sec  = CONFIG_NETUTILS_HTTPD_TIMEOUT;
+  tv.tv_usec = 0;
+  if (setsockopt(sockfd, SOL_SOCKET, SO_RCVTIMEO, &tv,
+                 sizeof(struct timeval)) < 0)
+    {
+      nerr("ERROR: setsockopt SO_RCVTIMEO failure: %d\n", errno);
+      return ERROR;
+    }
+
+#ifdef CONFIG_NETUTILS_HTTPD_WORKERPOOL
+  /* A client that stops reading must not hold a worker indefinitely */
+
+  if (setsockopt(sockfd, SOL_SOCKET, SO_SNDTIMEO, &tv,
+                 sizeof(struct timeval)) < 0)
+    {
+      nerr("ERROR: setsockopt SO_SNDTIMEO failure: %d\n", errno);
+      return ERROR;
+    }
+#endif
+#endif
+
+  return OK;
+}
+#endif
+
 /****************************************************************************
  * Name: httpd_handler
  *
@@ -682,6 +936,7 @@ static inline int httpd_parse(struct httpd_state *pstate)
  *
  ****************************************************************************/
 
+#ifndef CONFIG_NETUTILS_HTTPD_WORKERPOOL
 static void *httpd_handler(void *arg)
 {
   struct httpd_state *pstate =
@@ -694,34 +949,22 @@ static void *httpd_handler(void *arg)
 
   if (pstate)
     {
-      int status;
+      bool keepalive;
 
       /* Re-initialize the thread state structure */
 
       memset(pstate, 0, sizeof(struct httpd_state));
       pstate->ht_sockfd = sockfd;
 
-#ifndef CONFIG_NETUTILS_HTTPD_KEEPALIVE_DISABLE
+      /* Then handle httpd commands for as long as the client keeps the
+       * connection alive.
+       */
+
       do
         {
-          pstate->ht_keepalive = false;
-#endif
-          /* Then handle the next httpd command */
-
-          status = httpd_parse(pstate);
-          if (status >= 400)
-            {
-              httpd_senderror(pstate, status);
-            }
-          else
-            {
-              httpd_sendfile(pstate);
-            }
-
-#ifndef CONFIG_NETUTILS_HTTPD_KEEPALIVE_DISABLE
+          keepalive = httpd_request(pstate);
         }
-      while (pstate->ht_keepalive);
-#endif
+      while (keepalive);
 
       /* End of command processing -- Clean up and exit */
 
@@ -734,6 +977,7 @@ static void *httpd_handler(void *arg)
   close(sockfd);
   return NULL;
 }
+#endif
 
 #ifdef CONFIG_NETUTILS_HTTPD_SINGLECONNECT
 static void single_server(uint16_t portno, pthread_startroutine_t handler,
@@ -743,12 +987,6 @@ static void single_server(uint16_t portno, pthread_startroutine_t handler,
   socklen_t addrlen;
   int listensd;
   int acceptsd;
-#ifdef CONFIG_NET_SOLINGER
-  struct linger ling;
-#endif
-#if CONFIG_NETUTILS_HTTPD_TIMEOUT > 0
-  struct timeval tv;
-#endif
 
   listensd = netlib_listenon(portno);
   if (listensd < 0)
@@ -772,44 +1010,317 @@ static void single_server(uint16_t portno, pthread_startroutine_t handler,
 
       ninfo("Connection accepted -- serving sd=%d\n", acceptsd);
 
-      /* Configure to "linger" until all data is sent
-       * when the socket is closed
-       */
-
-#ifdef CONFIG_NET_SOLINGER
-      ling.l_onoff  = 1;
-      ling.l_linger = 30;     /* timeout is seconds */
-      if (setsockopt(acceptsd, SOL_SOCKET, SO_LINGER, &ling,
-                     sizeof(struct linger)) < 0)
+      if (httpd_sockopts(acceptsd) < 0)
         {
           close(acceptsd);
-          nerr("ERROR: setsockopt SO_LINGER failure: %d\n", errno);
           break;
         }
+
+      /* Handle the request. This blocks until complete. */
+
+      handler((FAR void *)acceptsd);
+    }
+
+  /* Close the sockets */
+
+  close(acceptsd);
+  close(listensd);
+}
 #endif
 
+#ifdef CONFIG_NETUTILS_HTTPD_WORKERPOOL
+/****************************************************************************
+ * Name: pool_worker
+ *
+ * Description:
+ *   A worker thread.  Serves one request at a time from the queue, then
+ *   returns the connection to the dispatcher, or closes it if it is not
+ *   kept alive.
+ *
+ ****************************************************************************/
+
+static FAR void *pool_worker(FAR void *arg)
+{
+  FAR struct httpd_slot_s *slot;
+  bool keepalive;
+
+  for (; ; )
+    {
+      pthread_mutex_lock(&g_pool.lock);
+      while (g_pool.nqueued == 0)
+        {
+          pthread_cond_wait(&g_pool.ready, &g_pool.lock);
+        }
+
+      slot = &g_pool.slots[g_pool.queue[g_pool.head]];
+      g_pool.head = (g_pool.head + 1) % CONFIG_NETUTILS_HTTPD_MAXCONN;
+      g_pool.nqueued--;
+      pthread_mutex_unlock(&g_pool.lock);
+
+      keepalive = httpd_request(&slot->ps);
+      if (!keepalive)
+        {
+          ninfo("[%d] Closing\n", slot->ps.ht_sockfd);
+          close(slot->ps.ht_sockfd);
+        }
+
+      pthread_mutex_lock(&g_pool.lock);
+      slot->lastactive = time(NULL);
+      slot->status     = keepalive ? SLOT_IDLE : SLOT_FREE;
+      pthread_mutex_unlock(&g_pool.lock);
+
+      /* Have the dispatcher watch the connection again or accept a new one.
+       * The pipe is nonblocking; if it is full, a wake-up is pending anyway.
+       */
+
+      write(g_pool.wakefd[1], "", 1);
+    }
+
+  return NULL;
+}
+
+/****************************************************************************
+ * Name: pool_accept
+ *
+ * Description:
+ *   Accept a connection into a free slot.  The dispatcher only polls the
+ *   listen socket while a slot is free.
+ *
+ ****************************************************************************/
+
+static void pool_accept(int listensd)
+{
+  FAR struct httpd_slot_s *slot = NULL;
+  struct sockaddr_in myaddr;
+  socklen_t addrlen;
+  int acceptsd;
+  int i;
+
+  addrlen  = sizeof(struct sockaddr_in);
+  acceptsd = accept4(listensd, (FAR struct sockaddr *)&myaddr, &addrlen,
+                     SOCK_CLOEXEC);
+  if (acceptsd < 0)
+    {
+      nerr("ERROR: accept failure: %d\n", errno);
+      return;
+    }
+
+  if (httpd_sockopts(acceptsd) < 0)
+    {
+      close(acceptsd);
+      return;
+    }
+
+  pthread_mutex_lock(&g_pool.lock);
+  for (i = 0; i < CONFIG_NETUTILS_HTTPD_MAXCONN; i++)
+    {
+      if (g_pool.slots[i].status == SLOT_FREE)
+        {
+          slot = &g_pool.slots[i];
+          memset(&slot->ps, 0, sizeof(struct httpd_state));
+          slot->ps.ht_sockfd = acceptsd;
+          slot->lastactive   = time(NULL);
+          slot->status       = SLOT_IDLE;
+          break;
+        }
+    }
+
+  pthread_mutex_unlock(&g_pool.lock);
+
+  if (slot == NULL)
+    {
+      nerr("ERROR: No free connection slot\n");
+      close(acceptsd);
+      return;
+    }
+
+  ninfo("Connection accepted -- slot %d sd=%d\n", i, acceptsd);
+}
+
+/****************************************************************************
+ * Name: pool_server
+ *
+ * Description:
+ *   Serve connections with a fixed pool of worker threads and preallocated
+ *   connection slots.  This thread polls the listen socket and the idle
+ *   (kept alive) connections, and queues a connection for a worker when its
+ *   next request arrives.  A connection is not polled again until its
+ *   response has been sent, so each client has at most one request in
+ *   flight, and no connections are accepted while all slots are in use.
+ *
+ ****************************************************************************/
+
+static void pool_server(uint16_t portno)
+{
+  struct pollfd fds[POOL_NFDS];
+  uint8_t fdslot[POOL_NFDS];
+  pthread_attr_t attr;
+  pthread_t tid;
+  FAR struct httpd_slot_s *slot;
+  char dummy[8];
 #if CONFIG_NETUTILS_HTTPD_TIMEOUT > 0
-      /* Set up a receive timeout */
+  time_t now;
+#endif
+  int listensd;
+  int listenndx;
+  int nworkers;
+  int nfds;
+  int ret;
+  int i;
+
+  listensd = netlib_listenon(portno);
+  if (listensd < 0)
+    {
+      return;
+    }
+
+  if (pipe(g_pool.wakefd) < 0)
+    {
+      nerr("ERROR: pipe failure: %d\n", errno);
+      goto errout_with_listen;
+    }
+
+  fcntl(g_pool.wakefd[0], F_SETFL, O_NONBLOCK);
+  fcntl(g_pool.wakefd[1], F_SETFL, O_NONBLOCK);
 
-      tv.tv_sec  = CONFIG_NETUTILS_HTTPD_TIMEOUT;
-      tv.tv_usec = 0;
-      if (setsockopt(acceptsd, SOL_SOCKET, SO_RCVTIMEO, &tv,
-                     sizeof(struct timeval)) < 0)
+  pthread_mutex_init(&g_pool.lock, NULL);
+  pthread_cond_init(&g_pool.ready, NULL);
+
+  /* Start the workers.  Their stacks are allocated once, here. */
+
+  pthread_attr_init(&attr);
+  pthread_attr_setstacksize(&attr, CONFIG_NETUTILS_HTTPDSTACKSIZE);
+
+  for (nworkers = 0; nworkers < CONFIG_NETUTILS_HTTPD_NWORKERS; nworkers++)
+    {
+      ret = pthread_create(&tid, &attr, pool_worker, NULL);
+      if (ret != 0)
         {
-          close(acceptsd);
-          nerr("ERROR: setsockopt SO_RCVTIMEO failure: %d\n", errno);
+          nerr("ERROR: pthread_create failure: %d\n", ret);
           break;
         }
+
+      pthread_detach(tid);
+    }
+
+  pthread_attr_destroy(&attr);
+
+  if (nworkers == 0)
+    {
+      goto errout_with_pipe;
+    }
+
+  /* Begin serving connections */
+
+  for (; ; )
+    {
+      fds[0].fd     = g_pool.wakefd[0];
+      fds[0].events = POLLIN;
+      nfds          = 1;
+      listenndx     = -1;
+#if CONFIG_NETUTILS_HTTPD_TIMEOUT > 0
+      now           = time(NULL);
 #endif
 
-      /* Handle the request. This blocks until complete. */
+      pthread_mutex_lock(&g_pool.lock);
+      for (i = 0; i < CONFIG_NETUTILS_HTTPD_MAXCONN; i++)
+        {
+          slot = &g_pool.slots[i];
+          if (slot->status != SLOT_IDLE)
+            {
+              continue;
+            }
 
-      handler((FAR void *)acceptsd);
+#if CONFIG_NETUTILS_HTTPD_TIMEOUT > 0
+          if (now - slot->lastactive >= CONFIG_NETUTILS_HTTPD_TIMEOUT)
+            {
+              ninfo("[%d] Idle timeout\n", slot->ps.ht_sockfd);
+              close(slot->ps.ht_sockfd);
+              slot->status = SLOT_FREE;
+              continue;
+            }
+#endif
+
+          fds[nfds].fd     = slot->ps.ht_sockfd;
+          fds[nfds].events = POLLIN;
+          fdslot[nfds++]   = i;
+        }
+
+      for (i = 0; i < CONFIG_NETUTILS_HTTPD_MAXCONN; i++)
+        {
+          if (g_pool.slots[i].status == SLOT_FREE)
+            {
+              fds[nfds].fd     = listensd;
+              fds[nfds].events = POLLIN;
+              listenndx        = nfds++;
+              break;
+            }
+        }
+
+      pthread_mutex_unlock(&g_pool.lock);
+
+      /* Wake up once a second to expire idle connections */
+
+      ret = poll(fds, nfds, CONFIG_NETUTILS_HTTPD_TIMEOUT > 0 ? 1000 : -1);
+      if (ret < 0)
+        {
+          if (errno == EINTR)
+            {
+              continue;
+            }
+
+          nerr("ERROR: poll failure: %d\n", errno);
+          break;
+        }
+
+      if (fds[0].revents != 0)
+        {
+          do
+            {
+              ret = read(g_pool.wakefd[0], dummy, sizeof(dummy));
+            }
+          while (ret > 0);
+        }
+
+      for (i = 1; i < nfds; i++)
+        {
+          if (fds[i].revents == 0)
+            {
+              continue;
+            }
+
+          if (i == listenndx)
+            {
+              pool_accept(listensd);
+              continue;
+            }
+
+          /* A request (or a hang-up) arrived on an idle connection.  Queue
+           * it for the workers.
+           */
+
+          pthread_mutex_lock(&g_pool.lock);
+          g_pool.slots[fdslot[i]].status = SLOT_BUSY;
+          g_pool.queue[(g_pool.head + g_pool.nqueued) %
+                       CONFIG_NETUTILS_HTTPD_MAXCONN] = fdslot[i];
+          g_pool.nqueued++;
+          pthread_cond_signal(&g_pool.ready);
+          pthread_mutex_unlock(&g_pool.lock);
+        }
     }
 
-  /* Close the sockets */
+  /* The workers are detached and never exit, so the pipe stays open for
+   * them.  Only the listen socket is closed.
+   */
 
-  close(acceptsd);
+  close(listensd);
+  return;
+
+errout_with_pipe:
+  close(g_pool.wakefd[0]);
+  close(g_pool.wakefd[1]);
+
+errout_with_listen:
   close(listensd);
 }
 #endif
@@ -837,8 +1348,10 @@ int httpd_listen(void)
 {
   /* Execute httpd_handler on each connection to port 80 */
 
-#ifdef CONFIG_NETUTILS_HTTPD_SINGLECONNECT
+#if defined(CONFIG_NETUTILS_HTTPD_SINGLECONNECT)
   single_server(HTONS(80), httpd_handler, CONFIG_NETUTILS_HTTPDSTACKSIZE);
+#elif defined(CONFIG_NETUTILS_HTTPD_WORKERPOOL)
+  pool_server(HTONS(80));
 #else
   netlib_server(HTONS(80), httpd_handler, CONFIG_NETUTILS_HTTPDSTACKSIZE);
 #endif
@@ -1041,6 +1554,9 @@ int httpd_send_headers(struct httpd_state *pstate, int status, int len)
 #endif
                     "Connection: %s\r\n"
                     "Content-type: %s\r\n"
+#ifdef CONFIG_NETUTILS_HTTPD_GZIP
+                    "%s"
+#endif
                     "%s"
                     "\r\n",
                     status,
@@ -1051,6 +1567,11 @@ int httpd_send_headers(struct httpd_state *pstate, int status, int len)
                     "close",
 #endif
                     mime,
+#ifdef CONFIG_NETUTILS_HTTPD_GZIP
+                    pstate->ht_gzip ?
+                    "Content-Encoding: gzip\r\nVary: Accept-Encoding\r\n" :
+                    "",
+#endif
                     contentlen
                     );
 
@@ -39,8 +39,10 @@
  * Included Header Files
  ****************************************************************************/
 
+#include <stdbool.h>
 #include <stdint.h>
 #include <stdlib.h>
+#include <string.h>
 
 #include "netutils/httpd.h"
 
@@ -50,6 +52,17 @@
  * Pre-processor Definitions
  ****************************************************************************/
 
+/* A request name ends at the first of these characters.  Names taken from
+ * script files are terminated by white space or the end of the line rather
+ * than by a NUL, and any query string is not part of the file name.
+ */
+
+#define HTTPD_FS_DELIM " \t\r\n?"
+
+/* Marks an unused hash slot */
+
+#define HTTPD_FS_NOENTRY 0xffff
+
 /****************************************************************************
  * Private Data
  ****************************************************************************/
@@ -58,29 +71,135 @@
 static uint16_t *count;
 #endif
 
+/* The files in list order and an open addressed hash table of indices into
+ * that array.  Both are built once by httpd_fs_init().  Lookups fall back
+ * to walking the list if that was not possible.
+ */
+
+static FAR struct httpd_fsdata_file_noconst **g_fsfiles;
+static FAR uint16_t *g_fsindex;
+static uint16_t g_fsmask;
+
 /****************************************************************************
  * Private Functions
  ****************************************************************************/
 
-static uint8_t httpd_fs_strcmp(const char *str1, const char *str2)
+static uint32_t httpd_fs_hash(const char *name, size_t len)
 {
+  uint32_t hash = 2166136261u;
+
+  while (len-- > 0)
+    {
+      hash ^= (uint8_t)*name++;
+      hash *= 16777619u;
+    }
+
+  return hash;
+}
+
+static bool httpd_fs_match(const char *name, size_t len,
+                           struct httpd_fsdata_file_noconst *f)
+{
+  return strncmp(name, f->name, len) == 0 && f->name[len] == '\0';
+}
+
+/* Return the list position of the file called name, or -1 if there is no
+ * such file.
+ */
+
+static int httpd_fs_find(const char *name)
+{
+  struct httpd_fsdata_file_noconst *f;
+  size_t len = strcspn(name, HTTPD_FS_DELIM);
+  uint16_t ndx;
   int i;
 
-  i = 0;
-  for (;;)
+  if (g_fsindex != NULL)
     {
-      if (str2[i] == 0 || str1[i] == '\r' || str1[i] == '\n')
+      for (ndx = httpd_fs_hash(name, len) & g_fsmask;
+           g_fsindex[ndx] != HTTPD_FS_NOENTRY;
+           ndx = (ndx + 1) & g_fsmask)
         {
-          return 0;
+          if (httpd_fs_match(name, len, g_fsfiles[g_fsindex[ndx]]))
+            {
+              return g_fsindex[ndx];
+            }
         }
 
-      if (str1[i] != str2[i])
+      return -1;
+    }
+
+  i = 0;
+  for (f = (struct httpd_fsdata_file_noconst *)g_httpdfs_root;
+       f != NULL;
+       f = (struct httpd_fsdata_file_noconst *)f->next)
+    {
+      if (httpd_fs_match(name, len, f))
         {
-          return 1;
+          return i;
         }
 
       i++;
     }
+
+  return -1;
+}
+
+static void httpd_fs_mkindex(void)
+{
+  struct httpd_fsdata_file_noconst *f;
+  size_t nslots;
+  uint16_t ndx;
+  int i;
+
+  /* Keep the table at most half full so that probe sequences stay short */
+
+  nslots = 4;
+  while (nslots < 2 * g_httpd_numfiles)
+    {
+      nslots <<= 1;
+    }
+
+  if (nslots > HTTPD_FS_NOENTRY)
+    {
+      return;
+    }
+
+  g_fsfiles = malloc(g_httpd_numfiles * sizeof(*g_fsfiles));
+  g_fsindex = malloc(nslots * sizeof(*g_fsindex));
+  if (g_fsfiles == NULL || g_fsindex == NULL)
+    {
+      free(g_fsfiles);
+      free(g_fsindex);
+      g_fsfiles = NULL;
+      g_fsindex = NULL;
+      return;
+    }
+
+  memset(g_fsindex, 0xff, nslots * sizeof(*g_fsindex));
+  g_fsmask = nslots - 1;
+
+  i = 0;
+  for (f = (struct httpd_fsdata_file_noconst *)g_httpdfs_root;
+       f != NULL && i < g_httpd_numfiles;
+       f = (struct httpd_fsdata_file_noconst *)f->next)
+    {
+      /* Keep the first of any duplicate names, as the list walk did */
+
+      ndx = httpd_fs_hash(f->name, strlen(f->name)) & g_fsmask;
+      while (g_fsindex[ndx] != HTTPD_FS_NOENTRY &&
+             strcmp(g_fsfiles[g_fsindex[ndx]]->name, f->name) != 0)
+        {
+          ndx = (ndx + 1) & g_fsmask;
+        }
+
+      if (g_fsindex[ndx] == HTTPD_FS_NOENTRY)
+        {
+          g_fsindex[ndx] = i;
+        }
+
+      g_fsfiles[i++] = f;
+    }
 }
 
 /****************************************************************************
@@ -89,64 +208,64 @@ static uint8_t httpd_fs_strcmp(const char *str1, const char *str2)
 
 int httpd_fs_open(const char *name, struct httpd_fs_file *file)
 {
-#ifdef CONFIG_NETUTILS_HTTPDFSSTATS
-  uint16_t i = 0;
-#endif
   struct httpd_fsdata_file_noconst *f;
+  int i;
+  int j;
 
-  for (f = (struct httpd_fsdata_file_noconst *)g_httpdfs_root;
-       f != NULL;
-       f = (struct httpd_fsdata_file_noconst *)f->next)
+  i = httpd_fs_find(name);
+  if (i < 0)
     {
-      if (httpd_fs_strcmp(name, f->name) == 0)
+      return ERROR;
+    }
+
+  if (g_fsfiles != NULL)
+    {
+      f = g_fsfiles[i];
+    }
+  else
+    {
+      f = (struct httpd_fsdata_file_noconst *)g_httpdfs_root;
+      for (j = 0; j < i; j++)
         {
-          file->data = f->data;
-          file->len  = f->len;
-#ifdef CONFIG_NETUTILS_HTTPDFSSTATS
-          ++count[i];
-#endif
-          return OK;
+          f = (struct httpd_fsdata_file_noconst *)f->next;
         }
+    }
+
+  file->data = f->data;
+  file->len  = f->len;
 #ifdef CONFIG_NETUTILS_HTTPDFSSTATS
-      ++i;
-#endif
+  if (count != NULL)
+    {
+      ++count[i];
     }
+#endif
 
-  return ERROR;
+  return OK;
 }
 
 void httpd_fs_init(void)
 {
 #ifdef CONFIG_NETUTILS_HTTPDFSSTATS
-  uint16_t i;
-
-  count = (uint16_t*)malloc(g_httpd_numfiles * sizeof(uint16_t));
+  count = (uint16_t *)calloc(g_httpd_numfiles, sizeof(uint16_t));
+#endif
 
-  for (i = 0; i < g_httpd_numfiles; i++)
+  if (g_fsindex == NULL)
     {
-      count[i] = 0;
+      httpd_fs_mkindex();
     }
-#endif
 }
 
 #ifdef CONFIG_NETUTILS_HTTPDFSSTATS
 uint16_t httpd_fs_count(char *name)
 {
-  struct httpd_fsdata_file_noconst *f;
-  uint16_t i;
+  int i;
 
-  i = 0;
-  for (f = (struct httpd_fsdata_file_noconst *)g_httpdfs_root;
-      f != NULL;
-      f = (struct httpd_fsdata_file_noconst *)f->next)
+  i = httpd_fs_find(name);
+  if (i < 0 || count == NULL)
     {
-      if (httpd_fs_strcmp(name, f->name) == 0)
-        {
-          return count[i];
-        }
-      ++i;
+      return 0;
     }
 
-  return 0;
+  return count[i];
 }
 #endif /* CONFIG_NETUTILS_HTTPDFSSTATS */
@@ -35,6 +35,7 @@
 #include <stdbool.h>
 #include <unistd.h>
 #include <errno.h>
+#include <time.h>
 
 #ifdef CONFIG_NSH_STRERROR
 #  include <string.h>
@@ -387,6 +388,14 @@
 #  define CONFIG_NSH_NESTDEPTH 3
 #endif
 
+/* The maximum number of bytes of loaded scripts that are kept in memory
+ * after they complete.  Zero disables the script cache.
+ */
+
+#ifndef CONFIG_NSH_SCRIPTCACHE_SIZE
+#  define CONFIG_NSH_SCRIPTCACHE_SIZE 0
+#endif
+
 /* Define to enable dumping of all input/output buffers */
 
 #undef CONFIG_NSH_TELNETD_DUMPBUFFER
@@ -510,6 +519,10 @@
 #define NSH_HAVE_FOREACH_DIRENTRY 1
 #define NSH_HAVE_TRIMDIR          1
 #define NSH_HAVE_TRIMSPACES       1
+#define NSH_HAVE_COPYFD           1
+#define NSH_HAVE_COPYSTATS        1
+#define NSH_HAVE_WALKDIR          1
+#define NSH_HAVE_WORKPOOL         1
 
 #if !defined(CONFIG_FS_PROCFS) || defined(CONFIG_DISABLE_ENVIRON) || \
      defined(CONFIG_FS_PROCFS_EXCLUDE_ENVIRON) || !defined(NSH_HAVE_CATFILE)
@@ -553,6 +566,67 @@
 #  undef NSH_HAVE_TRIMDIR
 #endif
 
+/* nsh_copyfd used by the cp and mv commands */
+
+#if defined(CONFIG_NSH_DISABLE_CP) && \
+    (defined(CONFIG_NSH_DISABLE_MV) || !defined(NSH_HAVE_DIROPTS))
+#  undef NSH_HAVE_COPYFD
+#endif
+
+/* nsh_showcopystats used by the cp and dd commands */
+
+#if !defined(CONFIG_NSH_CMDOPT_CP_STATS) && !defined(CONFIG_NSH_CMDOPT_DD_STATS)
+#  undef NSH_HAVE_COPYSTATS
+#endif
+
+/* nsh_walkdir used by the recursive cp, rm and ls commands */
+
+#if defined(CONFIG_NSH_DISABLE_CP) && defined(CONFIG_NSH_DISABLE_LS) && \
+    (defined(CONFIG_NSH_DISABLE_RM) || !defined(NSH_HAVE_DIROPTS))
+#  undef NSH_HAVE_WALKDIR
+#endif
+
+/* The nsh_workpool_* functions used by the recursive cp and rm commands */
+
+#if defined(CONFIG_NSH_DISABLE_CP) && \
+    (defined(CONFIG_NSH_DISABLE_RM) || !defined(NSH_HAVE_DIROPTS))
+#  undef NSH_HAVE_WORKPOOL
+#endif
+
+/* Number of worker threads used by the recursive cp and rm commands.  Zero
+ * means that each file is copied or removed by the command itself.
+ */
+
+#if defined(CONFIG_DISABLE_PTHREAD) || !defined(CONFIG_NSH_WALK_NWORKERS)
+#  undef CONFIG_NSH_WALK_NWORKERS
+#  define CONFIG_NSH_WALK_NWORKERS 0
+#endif
+
+/* Size of the buffer used by nsh_copyfd() */
+
+#ifndef CONFIG_NSH_COPY_BUFSIZE
+#  define CONFIG_NSH_COPY_BUFSIZE 4096
+#endif
+
+/* Size of the buffer that collects the output of NSH commands writing into
+ * a pipeline.  Zero means that the output is written as it is produced.
+ */
+
+#if !defined(CONFIG_NSH_PIPELINE) || !defined(CONFIG_NSH_PIPELINE_BUFSIZE)
+#  undef CONFIG_NSH_PIPELINE_BUFSIZE
+#  define CONFIG_NSH_PIPELINE_BUFSIZE 0
+#endif
+
+#ifndef CONFIG_NSH_PIPELINE
+#  undef CONFIG_NSH_PIPELINE_STATS
+#endif
+
+/* The console keeps track of which of its streams are pipes */
+
+#if CONFIG_NSH_PIPELINE_BUFSIZE > 0 || defined(CONFIG_NSH_PIPELINE_STATS)
+#  define NSH_HAVE_PIPEIO 1
+#endif
+
 /* nsh_trimspaces used by the set and ps commands */
 
 #if defined(CONFIG_NSH_DISABLE_SET) && defined(CONFIG_NSH_DISABLE_PS)
@@ -626,11 +700,32 @@ struct nsh_loop_s
 #ifndef CONFIG_NSH_DISABLE_ITEF
   uint8_t   lp_iendx;          /* Saved if-then-else-fi index */
 #endif
-  long      lp_topoffs;        /* Top of loop file offset */
+  long      lp_topoffs;        /* Top of loop script offset */
 };
 #endif
 
 #ifndef CONFIG_NSH_DISABLESCRIPT
+/* A script that has been loaded into memory by nsh_script().  Only regular
+ * files that fit in the script cache are loaded; other scripts are read a
+ * line at a time from np_fd.  Blank lines, comment lines and leading white
+ * space are removed and control characters are filtered out when the
+ * script is loaded, so sc_text holds only the command lines, each
+ * terminated with '\n'.  Loops jump back by offset into sc_text instead of
+ * re-reading the script file.
+ */
+
+struct nsh_script_s
+{
+  FAR struct nsh_script_s *sc_flink; /* Next script in the script cache */
+  FAR char *sc_path;    /* Full path to the script file */
+  FAR char *sc_text;    /* Command lines of the script */
+  size_t    sc_size;    /* Number of bytes in sc_text */
+  time_t    sc_mtime;   /* Modification time of the script file */
+  off_t     sc_fsize;   /* Size of the script file */
+  uint16_t  sc_refs;    /* Number of scripts running from sc_text */
+  bool      sc_cached;  /* True: The script is in the script cache */
+};
+
 /* Define the bits that correspond to the option defined in
  * NSH_NP_SET_OPTIONS. The bit value is 1 shifted left the offset
  * of the char in NSH_NP_SET_OPTIONS string.
@@ -670,8 +765,12 @@ struct nsh_parser_s
 
 #ifndef CONFIG_NSH_DISABLESCRIPT
   int      np_fd;       /* Stream of current script */
+#if CONFIG_NSH_SCRIPTCACHE_SIZE > 0
+  FAR struct nsh_script_s *np_script; /* Current script, if in memory */
+  size_t   np_spos;     /* Offset of the next line in np_script */
+#endif
 #ifndef CONFIG_NSH_DISABLE_LOOPS
-  long     np_foffs;    /* File offset to the beginning of a line */
+  long     np_foffs;    /* Offset to the beginning of a line */
 #ifndef NSH_DISABLE_SEMICOLON
   uint16_t np_loffs;    /* Byte offset to the beginning of a command */
   bool     np_jump;     /* "Jump" to the top of the loop */
@@ -726,6 +825,48 @@ typedef CODE int (*nsh_direntry_handler_t)(FAR struct nsh_vtbl_s *vtbl,
                                            FAR struct dirent *entryp,
                                            FAR void *pvarg);
 
+/* Transfer statistics gathered by nsh_copyfd() and dd */
+
+struct nsh_copystats_s
+{
+  struct timespec cs_start;   /* Time the transfer started */
+  uint64_t        cs_nbytes;  /* Number of bytes written */
+  uint32_t        cs_nreads;  /* Number of read operations */
+  uint32_t        cs_nwrites; /* Number of write operations */
+  uint32_t        cs_nfiles;  /* Number of files processed */
+};
+
+/* This is the form of a callback from nsh_walkdir().  'path' is the full
+ * path to the entry, in a buffer of PATH_MAX bytes that the callback may
+ * extend (for example, to walk a sub-directory) as long as it restores the
+ * terminator at 'dirlen' + 1 + strlen(entryp->d_name) before returning.
+ */
+
+typedef CODE int (*nsh_walk_handler_t)(FAR struct nsh_vtbl_s *vtbl,
+                                       FAR char *path, size_t dirlen,
+                                       FAR struct dirent *entryp,
+                                       FAR void *pvarg);
+
+/* One worker of a pool created by nsh_workpool_create() */
+
+struct nsh_workpool_s; /* Defined in nsh_walk.c */
+
+struct nsh_worker_s
+{
+  FAR struct nsh_workpool_s *pool;
+  FAR char *buffer;             /* Copy buffer of this worker, or NULL */
+  size_t    buflen;             /* Size of the copy buffer */
+  struct nsh_copystats_s stats; /* Work done by this worker */
+};
+
+/* This is the form of the operation that the workers of a pool perform on
+ * each file that is submitted.  'dest' is NULL if none was submitted.
+ */
+
+typedef CODE int (*nsh_work_t)(FAR struct nsh_vtbl_s *vtbl,
+                               FAR struct nsh_worker_s *worker,
+                               FAR const char *src, FAR const char *dest);
+
 #if defined(CONFIG_NSH_VARS) && !defined(CONFIG_NSH_DISABLE_SET)
 /* Used with nsh_foreach_var() */
 
@@ -1378,6 +1519,168 @@ int nsh_foreach_direntry(FAR struct nsh_vtbl_s *vtbl, FAR const char *cmd,
                          nsh_direntry_handler_t handler, void *pvarg);
 #endif
 
+/****************************************************************************
+ * Name: nsh_copyfd
+ *
+ * Description:
+ *   Copy everything from one open file to another, up to the end of the
+ *   input file.  sendfile() is used if CONFIG_NSH_COPY_SENDFILE is
+ *   selected and the file systems support it.  Otherwise the data is
+ *   copied through the caller's buffer, if one is provided, or else
+ *   through a buffer of CONFIG_NSH_COPY_BUFSIZE bytes, or through the I/O
+ *   buffer of the session if that cannot be allocated.
+ *
+ * Input Parameters:
+ *   vtbl    - The console vtable
+ *   cmd     - NSH command name to use in error reporting
+ *   infd    - The file to copy from
+ *   outfd   - The file to copy to
+ *   buffer  - The copy buffer to use, or NULL
+ *   buflen  - The size of 'buffer'
+ *   stats   - Transfer statistics to update
+ *
+ * Returned Value:
+ *   Zero (OK) on success; -1 (ERROR) on failure.
+ *
+ ****************************************************************************/
+
+#ifdef NSH_HAVE_COPYFD
+int nsh_copyfd(FAR struct nsh_vtbl_s *vtbl, FAR const char *cmd,
+               int infd, int outfd, FAR char *buffer, size_t buflen,
+               FAR struct nsh_copystats_s *stats);
+#endif
+
+/****************************************************************************
+ * Name: nsh_walkdir
+ *
+ * Description:
+ *   Call the provided 'handler' for each entry of the directory at 'path',
+ *   except for '.' and '..'.  The name of each entry is appended to 'path'
+ *   in place, so walking a tree does not allocate a path per entry.
+ *
+ * Input Parameters:
+ *   vtbl     - The console vtable
+ *   cmd      - NSH command name to use in error reporting
+ *   path     - The full path to the directory, in a buffer of PATH_MAX
+ *              bytes.  It is restored before returning.
+ *   handler  - The handler to be called for each entry of the directory
+ *   pvarg    - User provided argument to be passed to the 'handler'
+ *
+ * Returned Value:
+ *   Zero (OK) returned on success; -1 (ERROR) returned on failure.
+ *
+ ****************************************************************************/
+
+#ifdef NSH_HAVE_WALKDIR
+int nsh_walkdir(FAR struct nsh_vtbl_s *vtbl, FAR const char *cmd,
+                FAR char *path, nsh_walk_handler_t handler,
+                FAR void *pvarg);
+#endif
+
+/****************************************************************************
+ * Name: nsh_workpool_create
+ *
+ * Description:
+ *   Create a pool of CONFIG_NSH_WALK_NWORKERS threads that apply 'work' to
+ *   the files submitted with nsh_workpool_submit().  With no worker
+ *   threads, or if they cannot be started, the work is done by the caller
+ *   of nsh_workpool_submit().
+ *
+ * Input Parameters:
+ *   vtbl     - The console vtable
+ *   cmd      - NSH command name to use in error reporting
+ *   work     - The operation to perform on each file
+ *   copybuf  - True: Give each worker a CONFIG_NSH_COPY_BUFSIZE buffer
+ *
+ * Returned Value:
+ *   The pool or NULL if it could not be allocated.
+ *
+ ****************************************************************************/
+
+#ifdef NSH_HAVE_WORKPOOL
+FAR struct nsh_workpool_s *nsh_workpool_create(FAR struct nsh_vtbl_s *vtbl,
+                                               FAR const char *cmd,
+                                               nsh_work_t work,
+                                               bool copybuf);
+#endif
+
+/****************************************************************************
+ * Name: nsh_workpool_submit
+ *
+ * Description:
+ *   Queue one file for the workers, waiting for a free queue slot if
+ *   necessary.  The paths are copied.
+ *
+ * Returned Value:
+ *   Zero (OK) on success; -1 (ERROR) with errno set if this or any earlier
+ *   work failed.
+ *
+ ****************************************************************************/
+
+#ifdef NSH_HAVE_WORKPOOL
+int nsh_workpool_submit(FAR struct nsh_workpool_s *pool,
+                        FAR const char *src, FAR const char *dest);
+#endif
+
+/****************************************************************************
+ * Name: nsh_workpool_drain
+ *
+ * Description:
+ *   Wait until all submitted work has completed.
+ *
+ * Returned Value:
+ *   Zero (OK) on success; -1 (ERROR) with errno set if any work failed.
+ *
+ ****************************************************************************/
+
+#ifdef NSH_HAVE_WORKPOOL
+int nsh_workpool_drain(FAR struct nsh_workpool_s *pool);
+#endif
+
+/****************************************************************************
+ * Name: nsh_workpool_destroy
+ *
+ * Description:
+ *   Wait for all submitted work, stop the workers and free the pool.  The
+ *   statistics of all workers are added to 'stats'.
+ *
+ * Returned Value:
+ *   Zero (OK) on success; -1 (ERROR) with errno set if any work failed.
+ *
+ ****************************************************************************/
+
+#ifdef NSH_HAVE_WORKPOOL
+int nsh_workpool_destroy(FAR struct nsh_workpool_s *pool,
+                         FAR struct nsh_copystats_s *stats);
+#endif
+
+/****************************************************************************
+ * Name: nsh_startcopystats
+ *
+ * Description:
+ *   Clear the transfer statistics and record the start time.
+ *
+ ****************************************************************************/
+
+#ifdef NSH_HAVE_COPYSTATS
+void nsh_startcopystats(FAR struct nsh_copystats_s *stats);
+#endif
+
+/****************************************************************************
+ * Name: nsh_showcopystats
+ *
+ * Description:
+ *   Show the number of bytes transferred, the elapsed time, the throughput
+ *   and the number of I/O operations per second since
+ *   nsh_startcopystats().
+ *
+ ****************************************************************************/
+
+#ifdef NSH_HAVE_COPYSTATS
+void nsh_showcopystats(FAR struct nsh_vtbl_s *vtbl,
+                       FAR const struct nsh_copystats_s *stats);
+#endif
+
 /****************************************************************************
  * Name: nsh_getpid
  *
@@ -669,7 +669,12 @@ static const struct cmdmap_s g_cmdmap[] =
 
 #ifdef CONFIG_NET_TCP
 #  ifndef CONFIG_NSH_DISABLE_WGET
+#    ifdef CONFIG_WEBCLIENT_RANGES
+  CMD_MAP("wget",     cmd_wget,     2, 7,
+    "[-c] [-n <ranges>] [-o <local-path>] <url>"),
+#    else
   CMD_MAP("wget",     cmd_wget,     2, 4, "[-o <local-path>] <url>"),
+#    endif
 #  endif
 #endif
 
@@ -685,10 +690,115 @@ static const struct cmdmap_s g_cmdmap[] =
   CMD_MAP(NULL,       NULL,         1, 1, NULL)
 };
 
+/* g_cmdmap[] is grouped by configuration option, not sorted.  This holds
+ * the indices of g_cmdmap[] in order of command name so that commands can
+ * be found with a binary search.  It is built on first use.  Two tasks
+ * building it at the same time will store the same values, so no locking
+ * is needed.
+ */
+
+static uint16_t g_cmdindex[NUM_CMDS];
+static volatile bool g_cmdsorted;
+
 /****************************************************************************
  * Private Functions
  ****************************************************************************/
 
+/****************************************************************************
+ * Name: cmd_sort
+ *
+ * Description:
+ *   Build the sorted index of the command table, if that has not already
+ *   been done.  The table is small and mostly in order, so an insertion
+ *   sort is used.
+ *
+ ****************************************************************************/
+
+static void cmd_sort(void)
+{
+  uint16_t index[NUM_CMDS];
+  int i;
+  int j;
+
+  if (g_cmdsorted)
+    {
+      return;
+    }
+
+  for (i = 0; i < (int)NUM_CMDS; i++)
+    {
+      FAR const char *cmd = g_cmdmap[i].cmd;
+
+      for (j = i; j > 0 && strcmp(g_cmdmap[index[j - 1]].cmd, cmd) > 0; j--)
+        {
+          index[j] = index[j - 1];
+        }
+
+      index[j] = i;
+    }
+
+  memcpy(g_cmdindex, index, sizeof(g_cmdindex));
+  g_cmdsorted = true;
+}
+
+/****************************************************************************
+ * Name: cmd_lowerbound
+ *
+ * Description:
+ *   Return the position in g_cmdindex[] of the first command whose first
+ *   namelen characters do not compare less than name.
+ *
+ ****************************************************************************/
+
+static int cmd_lowerbound(FAR const char *name, size_t namelen)
+{
+  int lower = 0;
+  int upper = NUM_CMDS;
+
+  cmd_sort();
+
+  while (lower < upper)
+    {
+      int mid = (lower + upper) >> 1;
+
+      if (strncmp(g_cmdmap[g_cmdindex[mid]].cmd, name, namelen) < 0)
+        {
+          lower = mid + 1;
+        }
+      else
+        {
+          upper = mid;
+        }
+    }
+
+  return lower;
+}
+
+/****************************************************************************
+ * Name: cmd_find
+ *
+ * Description:
+ *   Find a command in the command table.
+ *
+ * Returned Value:
+ *   The command table entry or NULL if there is no such command.
+ *
+ ****************************************************************************/
+
+static FAR const struct cmdmap_s *cmd_find(FAR const char *cmd)
+{
+  size_t len = strlen(cmd) + 1;  /* Include the terminator: exact match */
+  int pos    = cmd_lowerbound(cmd, len);
+
+  if (pos < (int)NUM_CMDS &&
+      strcmp(g_cmdmap[g_cmdindex[pos]].cmd, cmd) == 0)
+    {
+      return &g_cmdmap[g_cmdindex[pos]];
+    }
+
+  return NULL;
+}
+
 /****************************************************************************
  * Name: help_cmdlist
  ****************************************************************************/
@@ -843,18 +953,12 @@ static int help_cmd(FAR struct nsh_vtbl_s *vtbl, FAR const char *cmd)
 
   /* Find the command in the command table */
 
-  for (cmdmap = g_cmdmap; cmdmap->cmd; cmdmap++)
+  cmdmap = cmd_find(cmd);
+  if (cmdmap != NULL)
     {
-      /* Is this the one we are looking for? */
-
-      if (strcmp(cmdmap->cmd, cmd) == 0)
-        {
-          /* Yes... show it */
-
-          nsh_output(vtbl, "%s usage:", cmd);
-          help_showcmd(vtbl, cmdmap);
-          return OK;
-        }
+      nsh_output(vtbl, "%s usage:", cmd);
+      help_showcmd(vtbl, cmdmap);
+      return OK;
     }
 
   nsh_error(vtbl, g_fmtcmdnotfound, cmd);
@@ -1235,38 +1339,35 @@ int nsh_command(FAR struct nsh_vtbl_s *vtbl, int argc, FAR char *argv[])
 
   /* See if the command is one that we understand */
 
-  for (cmdmap = g_cmdmap; cmdmap->cmd; cmdmap++)
+  cmdmap = cmd_find(cmd);
+  if (cmdmap != NULL)
     {
-      if (strcmp(cmdmap->cmd, cmd) == 0)
-        {
-          /* Check if a valid number of arguments was provided.  We
-           * do this simple, imperfect checking here so that it does
-           * not have to be performed in each command.
-           */
+      /* Check if a valid number of arguments was provided.  We
+       * do this simple, imperfect checking here so that it does
+       * not have to be performed in each command.
+       */
 
-          if (argc < cmdmap->minargs)
-            {
-              /* Fewer than the minimum number were provided */
+      if (argc < cmdmap->minargs)
+        {
+          /* Fewer than the minimum number were provided */
 
-              nsh_error(vtbl, g_fmtargrequired, cmd);
-              return ERROR;
-            }
-          else if (argc > cmdmap->maxargs)
-            {
-              /* More than the maximum number were provided */
+          nsh_error(vtbl, g_fmtargrequired, cmd);
+          return ERROR;
+        }
+      else if (argc > cmdmap->maxargs)
+        {
+          /* More than the maximum number were provided */
 
-              nsh_error(vtbl, g_fmttoomanyargs, cmd);
-              return ERROR;
-            }
-          else
-            {
-              /* A valid number of arguments were provided (this does
-               * not mean they are right).
-               */
+          nsh_error(vtbl, g_fmttoomanyargs, cmd);
+          return ERROR;
+        }
+      else
+        {
+          /* A valid number of arguments were provided (this does
+           * not mean they are right).
+           */
 
-              handler = cmdmap->handler;
-              break;
-            }
+          handler = cmdmap->handler;
         }
     }
 
@@ -1301,17 +1402,19 @@ int nsh_extmatch_count(FAR char *name, FAR int *matches, int namelen)
   int nr_matches = 0;
   int i;
 
-  for (i = 0; i < (int)NUM_CMDS; i++)
+  /* The matching commands are adjacent in the sorted index */
+
+  for (i = cmd_lowerbound(name, namelen);
+       i < (int)NUM_CMDS &&
+       strncmp(name, g_cmdmap[g_cmdindex[i]].cmd, namelen) == 0;
+       i++)
     {
-      if (strncmp(name, g_cmdmap[i].cmd, namelen) == 0)
-        {
-          matches[nr_matches] = i;
-          nr_matches++;
+      matches[nr_matches] = g_cmdindex[i];
+      nr_matches++;
 
-          if (nr_matches >= CONFIG_READLINE_MAX_EXTCMDS)
-            {
-              break;
-            }
+      if (nr_matches >= CONFIG_READLINE_MAX_EXTCMDS)
+        {
+          break;
         }
     }
 
@@ -1339,7 +1442,7 @@ int nsh_extmatch_count(FAR char *name, FAR int *matches, int namelen)
     defined(CONFIG_READLINE_HAVE_EXTMATCH)
 FAR const char *nsh_extmatch_getname(int index)
 {
-  DEBUGASSERT(index > 0 && index <= (int)NUM_CMDS);
+  DEBUGASSERT(index >= 0 && index < (int)NUM_CMDS);
   return  g_cmdmap[index].cmd;
 }
 #endif
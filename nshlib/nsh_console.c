@@ -27,7 +27,9 @@
 #include <nuttx/config.h>
 
 #include <sys/ioctl.h>
+#include <sys/stat.h>
 #include <stdint.h>
+#include <inttypes.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <stdarg.h>
@@ -37,10 +39,20 @@
 #include <assert.h>
 #include <errno.h>
 #include <debug.h>
+#include <time.h>
 
 #include "nsh.h"
 #include "nsh_console.h"
 
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+/* Values of cn_pipes */
+
+#define CONSOLE_PIPE_IN  (1 << 0)  /* The input stream is a pipe */
+#define CONSOLE_PIPE_OUT (1 << 1)  /* The output stream is a pipe */
+
 /****************************************************************************
  * Private Types
  ****************************************************************************/
@@ -81,6 +93,9 @@ static void nsh_consoleundirect(FAR struct nsh_vtbl_s *vtbl,
                                 FAR uint8_t *save);
 static void nsh_consoleexit(FAR struct nsh_vtbl_s *vtbl,
                             int exitstatus) noreturn_function;
+#if CONFIG_NSH_PIPELINE_BUFSIZE > 0
+static int nsh_consoleflush(FAR struct nsh_vtbl_s *vtbl);
+#endif
 
 /****************************************************************************
  * Private Functions
@@ -117,6 +132,187 @@ static void nsh_closeifnotclosed(struct console_stdio_s *pstate)
   INFD(pstate) = -1;
 }
 
+/****************************************************************************
+ * Name: nsh_consolepipes
+ *
+ * Description:
+ *   Find out which of the current input and output streams are pipes.  The
+ *   output to a pipe is collected into a buffer so that the next stage of
+ *   the pipeline is woken once per buffer rather than once per line.
+ *
+ ****************************************************************************/
+
+#ifdef NSH_HAVE_PIPEIO
+static void nsh_consolepipes(FAR struct console_stdio_s *pstate)
+{
+  struct stat buf;
+
+  pstate->cn_pipes = 0;
+
+  if (INFD(pstate) >= 0 && fstat(INFD(pstate), &buf) == 0 &&
+      S_ISFIFO(buf.st_mode))
+    {
+      pstate->cn_pipes |= CONSOLE_PIPE_IN;
+    }
+
+  if (OUTFD(pstate) >= 0 && fstat(OUTFD(pstate), &buf) == 0 &&
+      S_ISFIFO(buf.st_mode))
+    {
+      pstate->cn_pipes |= CONSOLE_PIPE_OUT;
+
+#if CONFIG_NSH_PIPELINE_BUFSIZE > 0
+      /* Output is unbuffered if the buffer cannot be allocated */
+
+      if (pstate->cn_obuf == NULL)
+        {
+          pstate->cn_obuf = malloc(CONFIG_NSH_PIPELINE_BUFSIZE);
+        }
+
+      pstate->cn_oerrno = 0;
+#endif
+    }
+
+#ifdef CONFIG_NSH_PIPELINE_STATS
+  pstate->cn_nout    = 0;
+  pstate->cn_nin     = 0;
+  pstate->cn_nwrites = 0;
+  pstate->cn_nreads  = 0;
+  clock_gettime(CLOCK_MONOTONIC, &pstate->cn_start);
+#endif
+}
+#endif
+
+/****************************************************************************
+ * Name: nsh_consolestats
+ *
+ * Description:
+ *   Report the pipe I/O of the command that is done with the current
+ *   streams.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_NSH_PIPELINE_STATS
+static void nsh_consolestats(FAR struct console_stdio_s *pstate)
+{
+  struct timespec now;
+  uint64_t elapsed;
+
+  if (pstate->cn_nwrites == 0 && pstate->cn_nreads == 0)
+    {
+      return;
+    }
+
+  clock_gettime(CLOCK_MONOTONIC, &now);
+
+  elapsed  = ((uint64_t)now.tv_sec * NSEC_PER_SEC) + now.tv_nsec;
+  elapsed -= ((uint64_t)pstate->cn_start.tv_sec * NSEC_PER_SEC) +
+             pstate->cn_start.tv_nsec;
+  elapsed /= NSEC_PER_USEC;
+
+  dprintf(ERRFD(pstate), "[%d] pipe in: %" PRIu64 " bytes, %" PRIu32
+          " reads; out: %" PRIu64 " bytes, %" PRIu32 " writes; %" PRIu64
+          " usec\n", getpid(), pstate->cn_nin, pstate->cn_nreads,
+          pstate->cn_nout, pstate->cn_nwrites, elapsed);
+
+  pstate->cn_nwrites = 0;
+  pstate->cn_nreads  = 0;
+}
+#endif
+
+/****************************************************************************
+ * Name: nsh_consolewritefd
+ *
+ * Description:
+ *   Write a buffer to the output stream, counting the writes to a pipe.
+ *
+ ****************************************************************************/
+
+static ssize_t nsh_consolewritefd(FAR struct console_stdio_s *pstate,
+                                  FAR const void *buffer, size_t nbytes)
+{
+  ssize_t ret;
+
+  ret = write(OUTFD(pstate), buffer, nbytes);
+  if (ret < 0)
+    {
+      _err("ERROR: [%d] Failed to send buffer: %d\n",
+          OUTFD(pstate), errno);
+    }
+#ifdef CONFIG_NSH_PIPELINE_STATS
+  else if ((pstate->cn_pipes & CONSOLE_PIPE_OUT) != 0)
+    {
+      pstate->cn_nout += ret;
+      pstate->cn_nwrites++;
+    }
+#endif
+
+  return ret;
+}
+
+/****************************************************************************
+ * Name: nsh_consoleflushbuf
+ *
+ * Description:
+ *   Write out any output that was collected for the output pipe.
+ *
+ *   A failed write is remembered, and this and every later write to the
+ *   same pipe then fail with its errno, so that a command learns that the
+ *   reader has gone away (EPIPE) even though its own writes were
+ *   buffered.  The output that could not be written is discarded.
+ *
+ * Returned Value:
+ *   OK on success; ERROR with errno set if the output could not be
+ *   written.
+ *
+ ****************************************************************************/
+
+#if CONFIG_NSH_PIPELINE_BUFSIZE > 0
+static int nsh_consoleflushbuf(FAR struct console_stdio_s *pstate)
+{
+  size_t nwritten = 0;
+  ssize_t ret;
+
+  while (pstate->cn_oerrno == 0 && nwritten < pstate->cn_olen)
+    {
+      ret = nsh_consolewritefd(pstate, &pstate->cn_obuf[nwritten],
+                               pstate->cn_olen - nwritten);
+      if (ret <= 0)
+        {
+          pstate->cn_oerrno = ret < 0 ? errno : EIO;
+          break;
+        }
+
+      nwritten += ret;
+    }
+
+  pstate->cn_olen = 0;
+
+  if (pstate->cn_oerrno != 0)
+    {
+      set_errno(pstate->cn_oerrno);
+      return ERROR;
+    }
+
+  return OK;
+}
+#endif
+
+/****************************************************************************
+ * Name: nsh_consolebuffered
+ *
+ * Description:
+ *   Return true if the output is collected in the pipe output buffer.
+ *
+ ****************************************************************************/
+
+#if CONFIG_NSH_PIPELINE_BUFSIZE > 0
+static inline bool nsh_consolebuffered(FAR struct console_stdio_s *pstate)
+{
+  return (pstate->cn_pipes & CONSOLE_PIPE_OUT) != 0 &&
+         pstate->cn_obuf != NULL;
+}
+#endif
+
 /****************************************************************************
  * Name: nsh_consolewrite
  *
@@ -131,18 +327,33 @@ static ssize_t nsh_consolewrite(FAR struct nsh_vtbl_s *vtbl,
                                 FAR const void *buffer, size_t nbytes)
 {
   FAR struct console_stdio_s *pstate = (FAR struct console_stdio_s *)vtbl;
-  ssize_t ret;
 
-  /* Write the data to the output stream */
+#if CONFIG_NSH_PIPELINE_BUFSIZE > 0
+  /* Collect the data if it is going into a pipe */
 
-  ret = write(OUTFD(pstate), buffer, nbytes);
-  if (ret < 0)
+  if (nsh_consolebuffered(pstate))
     {
-      _err("ERROR: [%d] Failed to send buffer: %d\n",
-          OUTFD(pstate), errno);
+      if (nbytes > CONFIG_NSH_PIPELINE_BUFSIZE - pstate->cn_olen ||
+          pstate->cn_oerrno != 0)
+        {
+          if (nsh_consoleflushbuf(pstate) < 0)
+            {
+              return ERROR;
+            }
+        }
+
+      if (nbytes < CONFIG_NSH_PIPELINE_BUFSIZE)
+        {
+          memcpy(&pstate->cn_obuf[pstate->cn_olen], buffer, nbytes);
+          pstate->cn_olen += nbytes;
+          return nbytes;
+        }
     }
+#endif
 
-  return ret;
+  /* Write the data to the output stream */
+
+  return nsh_consolewritefd(pstate, buffer, nbytes);
 }
 
 /****************************************************************************
@@ -163,12 +374,25 @@ static ssize_t nsh_consoleread(FAR struct nsh_vtbl_s *vtbl,
 
   /* Read the data to the output stream */
 
+#if CONFIG_NSH_PIPELINE_BUFSIZE > 0
+  /* Whatever is waiting for the input may depend on the output */
+
+  nsh_consoleflushbuf(pstate);
+#endif
+
   ret = read(INFD(pstate), buffer, nbytes);
   if (ret < 0)
     {
       _err("ERROR: [%d] Failed to read buffer: %d\n",
           INFD(pstate), errno);
     }
+#ifdef CONFIG_NSH_PIPELINE_STATS
+  else if ((pstate->cn_pipes & CONSOLE_PIPE_IN) != 0)
+    {
+      pstate->cn_nin += ret;
+      pstate->cn_nreads++;
+    }
+#endif
 
   return ret;
 }
@@ -186,6 +410,10 @@ static int nsh_consoleioctl(FAR struct nsh_vtbl_s *vtbl,
 {
   FAR struct console_stdio_s *pstate = (FAR struct console_stdio_s *)vtbl;
 
+#if CONFIG_NSH_PIPELINE_BUFSIZE > 0
+  nsh_consoleflushbuf(pstate);
+#endif
+
   return ioctl(OUTFD(pstate), cmd, arg);
 }
 
@@ -205,9 +433,67 @@ static int nsh_consoleoutput(FAR struct nsh_vtbl_s *vtbl,
   int ret;
 
   va_start(ap, fmt);
+
+#if CONFIG_NSH_PIPELINE_BUFSIZE > 0
+  /* Format the output into the buffer if it is going into a pipe.  Output
+   * that does not fit in the buffer at all is written directly.
+   */
+
+  if (nsh_consolebuffered(pstate))
+    {
+      size_t avail = CONFIG_NSH_PIPELINE_BUFSIZE - pstate->cn_olen;
+      va_list ap2;
+
+      if (pstate->cn_oerrno != 0)
+        {
+          set_errno(pstate->cn_oerrno);
+          va_end(ap);
+          return ERROR;
+        }
+
+      va_copy(ap2, ap);
+      ret = vsnprintf(&pstate->cn_obuf[pstate->cn_olen], avail, fmt, ap2);
+      va_end(ap2);
+
+      if (ret >= 0 && ret < avail)
+        {
+          pstate->cn_olen += ret;
+          va_end(ap);
+          return ret;
+        }
+
+      /* It did not fit.  Make room and format it again, unless it is too
+       * large for the buffer.
+       */
+
+      if (nsh_consoleflushbuf(pstate) < 0)
+        {
+          va_end(ap);
+          return ERROR;
+        }
+
+      if (ret >= 0 && ret < CONFIG_NSH_PIPELINE_BUFSIZE)
+        {
+          ret = vsnprintf(pstate->cn_obuf, CONFIG_NSH_PIPELINE_BUFSIZE,
+                          fmt, ap);
+          pstate->cn_olen = ret;
+          va_end(ap);
+          return ret;
+        }
+    }
+#endif
+
   ret = vdprintf(OUTFD(pstate), fmt, ap);
   va_end(ap);
 
+#ifdef CONFIG_NSH_PIPELINE_STATS
+  if (ret > 0 && (pstate->cn_pipes & CONSOLE_PIPE_OUT) != 0)
+    {
+      pstate->cn_nout += ret;
+      pstate->cn_nwrites++;
+    }
+#endif
+
   return ret;
 }
 
@@ -260,7 +546,15 @@ static FAR char *nsh_consolelinebuffer(FAR struct nsh_vtbl_s *vtbl)
 #ifndef CONFIG_NSH_DISABLEBG
 static FAR struct nsh_vtbl_s *nsh_consoleclone(FAR struct nsh_vtbl_s *vtbl)
 {
-  FAR struct console_stdio_s *pclone = nsh_newconsole(vtbl->isctty);
+  FAR struct console_stdio_s *pclone;
+
+#if CONFIG_NSH_PIPELINE_BUFSIZE > 0
+  /* The clone writes to the same output */
+
+  nsh_consoleflushbuf((FAR struct console_stdio_s *)vtbl);
+#endif
+
+  pclone = nsh_newconsole(vtbl->isctty);
   return &pclone->cn_vtbl;
 }
 #endif
@@ -277,6 +571,17 @@ static void nsh_consolerelease(FAR struct nsh_vtbl_s *vtbl)
 {
   FAR struct console_stdio_s *pstate = (FAR struct console_stdio_s *)vtbl;
 
+#if CONFIG_NSH_PIPELINE_BUFSIZE > 0
+  /* Write out any output collected for a pipe */
+
+  nsh_consoleflushbuf(pstate);
+  free(pstate->cn_obuf);
+#endif
+
+#ifdef CONFIG_NSH_PIPELINE_STATS
+  nsh_consolestats(pstate);
+#endif
+
   /* Close the output stream */
 
   nsh_closeifnotclosed(pstate);
@@ -337,6 +642,14 @@ static void nsh_consoleredirect(FAR struct nsh_vtbl_s *vtbl, int fd_in,
   FAR struct console_stdio_s *pstate = (FAR struct console_stdio_s *)vtbl;
   FAR struct serialsave_s *ssave  = (FAR struct serialsave_s *)save;
 
+#if CONFIG_NSH_PIPELINE_BUFSIZE > 0
+  nsh_consoleflushbuf(pstate);
+#endif
+
+#ifdef CONFIG_NSH_PIPELINE_STATS
+  nsh_consolestats(pstate);
+#endif
+
   /* Redirected foreground commands */
 
   if (ssave)
@@ -354,6 +667,10 @@ static void nsh_consoleredirect(FAR struct nsh_vtbl_s *vtbl, int fd_in,
 
   OUTFD(pstate) = fd_out;
   INFD(pstate) = fd_in;
+
+#ifdef NSH_HAVE_PIPEIO
+  nsh_consolepipes(pstate);
+#endif
 }
 
 /****************************************************************************
@@ -370,10 +687,22 @@ static void nsh_consoleundirect(FAR struct nsh_vtbl_s *vtbl,
   FAR struct console_stdio_s *pstate = (FAR struct console_stdio_s *)vtbl;
   FAR struct serialsave_s *ssave = (FAR struct serialsave_s *)save;
 
+#if CONFIG_NSH_PIPELINE_BUFSIZE > 0
+  nsh_consoleflushbuf(pstate);
+#endif
+
+#ifdef CONFIG_NSH_PIPELINE_STATS
+  nsh_consolestats(pstate);
+#endif
+
   nsh_closeifnotclosed(pstate);
   ERRFD(pstate) = ERRFD(ssave);
   OUTFD(pstate) = OUTFD(ssave);
   INFD(pstate) = INFD(ssave);
+
+#ifdef NSH_HAVE_PIPEIO
+  nsh_consolepipes(pstate);
+#endif
 }
 
 /****************************************************************************
@@ -392,6 +721,23 @@ static void nsh_consoleexit(FAR struct nsh_vtbl_s *vtbl, int exitstatus)
   exit(exitstatus);
 }
 
+/****************************************************************************
+ * Name: nsh_consoleflush
+ *
+ * Description:
+ *   Write out any output collected for a pipe.  This must be done before
+ *   another task is given the output stream.  Returns ERROR with errno set
+ *   if any output to the pipe could not be written.
+ *
+ ****************************************************************************/
+
+#if CONFIG_NSH_PIPELINE_BUFSIZE > 0
+static int nsh_consoleflush(FAR struct nsh_vtbl_s *vtbl)
+{
+  return nsh_consoleflushbuf((FAR struct console_stdio_s *)vtbl);
+}
+#endif
+
 /****************************************************************************
  * Public Functions
  ****************************************************************************/
@@ -422,6 +768,9 @@ FAR struct console_stdio_s *nsh_newconsole(bool isctty)
 #endif
       pstate->cn_vtbl.linebuffer  = nsh_consolelinebuffer;
       pstate->cn_vtbl.exit        = nsh_consoleexit;
+#if CONFIG_NSH_PIPELINE_BUFSIZE > 0
+      pstate->cn_vtbl.flush       = nsh_consoleflush;
+#endif
       pstate->cn_vtbl.isctty      = isctty;
 
 #ifndef CONFIG_NSH_DISABLESCRIPT
@@ -445,6 +794,12 @@ FAR struct console_stdio_s *nsh_newconsole(bool isctty)
 
       INFD(pstate)               = STDIN_FILENO;
 
+#ifdef NSH_HAVE_PIPEIO
+      /* This is a stage of a pipeline if the streams are pipes */
+
+      nsh_consolepipes(pstate);
+#endif
+
       /* Initialize current working directory */
 
 #ifdef CONFIG_DISABLE_ENVIRON
@@ -53,6 +53,12 @@
 #define nsh_undirect(v,s)       (v)->undirect(v,s)
 #define nsh_exit(v,s)           (v)->exit(v,s)
 
+#if CONFIG_NSH_PIPELINE_BUFSIZE > 0
+#  define nsh_flush(v)          (v)->flush(v)
+#else
+#  define nsh_flush(v)
+#endif
+
 #ifdef CONFIG_CPP_HAVE_VARARGS
 #  define nsh_error(v, ...)     (v)->error(v, ##__VA_ARGS__)
 #  define nsh_output(v, ...)    (v)->output(v, ##__VA_ARGS__)
@@ -130,6 +136,9 @@ struct nsh_vtbl_s
                    FAR uint8_t *save);
   void (*undirect)(FAR struct nsh_vtbl_s *vtbl, FAR uint8_t *save);
   void (*exit)(FAR struct nsh_vtbl_s *vtbl, int status) noreturn_function;
+#if CONFIG_NSH_PIPELINE_BUFSIZE > 0
+  int (*flush)(FAR struct nsh_vtbl_s *vtbl);
+#endif
 
 #ifdef NSH_HAVE_IOBUFFER
   /* Common buffer for file I/O. */
@@ -186,6 +195,24 @@ struct console_stdio_s
   size_t varsz;
 #endif
 
+#ifdef NSH_HAVE_PIPEIO
+  /* Pipeline I/O */
+
+  uint8_t cn_pipes;   /* CONSOLE_PIPE_IN/OUT: Streams that are pipes */
+#endif
+#if CONFIG_NSH_PIPELINE_BUFSIZE > 0
+  FAR char *cn_obuf;  /* Output not yet written to the pipe, or NULL */
+  size_t cn_olen;     /* Number of bytes in cn_obuf */
+  int cn_oerrno;      /* errno of a failed write to the pipe, or 0 */
+#endif
+#ifdef CONFIG_NSH_PIPELINE_STATS
+  struct timespec cn_start; /* Time the streams were set up */
+  uint64_t cn_nout;   /* Bytes written to the output pipe */
+  uint64_t cn_nin;    /* Bytes read from the input pipe */
+  uint32_t cn_nwrites; /* Writes to the output pipe */
+  uint32_t cn_nreads; /* Reads from the input pipe */
+#endif
+
   /* Line input buffer */
 
   char   cn_line[LINE_MAX];
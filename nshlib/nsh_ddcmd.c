@@ -42,6 +42,11 @@
 #include <errno.h>
 #include <time.h>
 
+#ifdef CONFIG_NSH_CMDOPT_DD_PIPELINE
+#  include <pthread.h>
+#  include <semaphore.h>
+#endif
+
 #include "nsh.h"
 #include "nsh_console.h"
 
@@ -76,8 +81,26 @@ struct dd_s
   size_t       sectsize;   /* Size of one sector */
   size_t       nbytes;     /* Number of valid bytes in the buffer */
   FAR uint8_t *buffer;     /* Buffer of data to write to the output file */
+  struct nsh_copystats_s stats; /* Transfer statistics */
 };
 
+#ifdef CONFIG_NSH_CMDOPT_DD_PIPELINE
+/* State shared by the reader (the dd command) and the writer thread.  The
+ * reader fills the two buffers in turn and the writer empties them in the
+ * same order, so reading the next sector overlaps writing the last one.
+ */
+
+struct dd_pipe_s
+{
+  FAR struct dd_s *dd;
+  FAR uint8_t *buffer[2];  /* The two sector buffers */
+  size_t       nbytes[2];  /* Bytes in each buffer.  Zero ends the copy */
+  sem_t        filled;     /* Counts buffers that are ready to write */
+  sem_t        emptied;    /* Counts buffers that are ready to read into */
+  volatile int result;     /* Set to ERROR by the writer if a write fails */
+};
+#endif
+
 /****************************************************************************
  * Private Functions
  ****************************************************************************/
@@ -86,9 +109,9 @@ struct dd_s
  * Name: dd_write
  ****************************************************************************/
 
-static int dd_write(FAR struct dd_s *dd)
+static int dd_write(FAR struct dd_s *dd, FAR const uint8_t *buffer,
+                    size_t length)
 {
-  FAR uint8_t *buffer = dd->buffer;
   size_t written;
   ssize_t nbytes;
 
@@ -97,7 +120,7 @@ static int dd_write(FAR struct dd_s *dd)
   written = 0;
   do
     {
-      nbytes = write(dd->outfd, buffer, dd->nbytes - written);
+      nbytes = write(dd->outfd, buffer, length - written);
       if (nbytes < 0)
         {
           FAR struct nsh_vtbl_s *vtbl = dd->vtbl;
@@ -107,8 +130,10 @@ static int dd_write(FAR struct dd_s *dd)
 
       written += nbytes;
       buffer  += nbytes;
+      dd->stats.cs_nbytes += nbytes;
+      dd->stats.cs_nwrites++;
     }
-  while (written < dd->nbytes);
+  while (written < length);
 
   return OK;
 }
@@ -117,15 +142,15 @@ static int dd_write(FAR struct dd_s *dd)
  * Name: dd_read
  ****************************************************************************/
 
-static int dd_read(FAR struct dd_s *dd)
+static int dd_read(FAR struct dd_s *dd, FAR uint8_t *buffer,
+                   FAR size_t *length)
 {
-  FAR uint8_t *buffer = dd->buffer;
   ssize_t nbytes;
 
-  dd->nbytes = 0;
+  *length = 0;
   do
     {
-      nbytes = read(dd->infd, buffer, dd->sectsize - dd->nbytes);
+      nbytes = read(dd->infd, buffer, dd->sectsize - *length);
       if (nbytes < 0)
         {
           if (errno == EINTR)
@@ -138,15 +163,181 @@ static int dd_read(FAR struct dd_s *dd)
           return ERROR;
         }
 
-      dd->nbytes += nbytes;
-      buffer     += nbytes;
+      *length += nbytes;
+      buffer  += nbytes;
+      dd->stats.cs_nreads++;
+    }
+  while (*length < dd->sectsize && nbytes != 0);
+
+  dd->eof |= (*length == 0);
+  return OK;
+}
+
+/****************************************************************************
+ * Name: dd_copy
+ *
+ * Description:
+ *   Copy the sectors, alternating between reading and writing one buffer.
+ *
+ ****************************************************************************/
+
+static int dd_copy(FAR struct dd_s *dd)
+{
+  uint32_t sector = 0;
+  int ret;
+
+  while (!dd->eof && sector < dd->nsectors)
+    {
+      /* Read one sector from from the input */
+
+      ret = dd_read(dd, dd->buffer, &dd->nbytes);
+      if (ret < 0)
+        {
+          return ret;
+        }
+
+      /* Has the incoming data stream ended? */
+
+      if (!dd->eof)
+        {
+          /* Write one sector to the output file */
+
+          ret = dd_write(dd, dd->buffer, dd->nbytes);
+          if (ret < 0)
+            {
+              return ret;
+            }
+
+          /* Increment the sector number */
+
+          sector++;
+        }
     }
-  while (dd->nbytes < dd->sectsize && nbytes != 0);
 
-  dd->eof |= (dd->nbytes == 0);
   return OK;
 }
 
+/****************************************************************************
+ * Name: dd_writer
+ *
+ * Description:
+ *   The writer thread of a pipelined copy.  It writes the buffers in the
+ *   order that the reader fills them until it gets an empty buffer.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_NSH_CMDOPT_DD_PIPELINE
+static FAR void *dd_writer(FAR void *arg)
+{
+  FAR struct dd_pipe_s *ddp = (FAR struct dd_pipe_s *)arg;
+  int i = 0;
+
+  for (; ; )
+    {
+      while (sem_wait(&ddp->filled) < 0);
+
+      if (ddp->nbytes[i] == 0)
+        {
+          break;
+        }
+
+      /* After a write error, keep returning the buffers unwritten so that
+       * the reader sees the error and stops.
+       */
+
+      if (ddp->result == OK &&
+          dd_write(ddp->dd, ddp->buffer[i], ddp->nbytes[i]) < 0)
+        {
+          ddp->result = ERROR;
+        }
+
+      sem_post(&ddp->emptied);
+      i ^= 1;
+    }
+
+  return NULL;
+}
+#endif
+
+/****************************************************************************
+ * Name: dd_copy_pipelined
+ *
+ * Description:
+ *   Copy the sectors with a separate writer thread and two buffers, so
+ *   that reading from the input overlaps writing to the output.  Falls
+ *   back to dd_copy() if the thread or the second buffer is not available.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_NSH_CMDOPT_DD_PIPELINE
+static int dd_copy_pipelined(FAR struct dd_s *dd)
+{
+  struct dd_pipe_s ddp;
+  pthread_t writer;
+  uint32_t sector = 0;
+  int ret = OK;
+  int i = 0;
+
+  ddp.buffer[1] = malloc(dd->sectsize);
+  if (ddp.buffer[1] == NULL)
+    {
+      return dd_copy(dd);
+    }
+
+  ddp.dd        = dd;
+  ddp.buffer[0] = dd->buffer;
+  ddp.result    = OK;
+
+  sem_init(&ddp.filled, 0, 0);
+  sem_init(&ddp.emptied, 0, 2);
+
+  if (pthread_create(&writer, NULL, dd_writer, &ddp) != 0)
+    {
+      ret = dd_copy(dd);
+      goto errout_with_sem;
+    }
+
+  /* Each pass waits for a free buffer and fills it.  Every way out of the
+   * loop owns buffer i, which is then used to tell the writer to stop.
+   */
+
+  for (; ; )
+    {
+      while (sem_wait(&ddp.emptied) < 0);
+
+      if (ddp.result < 0 || dd->eof || sector >= dd->nsectors)
+        {
+          break;
+        }
+
+      ret = dd_read(dd, ddp.buffer[i], &ddp.nbytes[i]);
+      if (ret < 0 || dd->eof)
+        {
+          break;
+        }
+
+      sem_post(&ddp.filled);
+      i ^= 1;
+      sector++;
+    }
+
+  ddp.nbytes[i] = 0;
+  sem_post(&ddp.filled);
+  pthread_join(writer, NULL);
+
+  if (ddp.result < 0)
+    {
+      ret = ERROR;
+    }
+
+errout_with_sem:
+  sem_destroy(&ddp.emptied);
+  sem_destroy(&ddp.filled);
+  free(ddp.buffer[1]);
+  return ret;
+}
+#endif
+
 /****************************************************************************
  * Name: dd_infopen
  ****************************************************************************/
@@ -215,7 +406,7 @@ static int dd_verify(FAR const char *infile, FAR const char *outfile,
 
   while (!dd->eof && sector < dd->nsectors)
     {
-      ret = dd_read(dd);
+      ret = dd_read(dd, dd->buffer, &dd->nbytes);
       if (ret < 0)
         {
           break;
@@ -270,13 +461,6 @@ int cmd_dd(FAR struct nsh_vtbl_s *vtbl, int argc, FAR char **argv)
   struct dd_s dd;
   FAR char *infile = NULL;
   FAR char *outfile = NULL;
-#ifdef CONFIG_NSH_CMDOPT_DD_STATS
-  struct timespec ts0;
-  struct timespec ts1;
-  uint64_t elapsed;
-  uint64_t total;
-#endif
-  uint32_t sector = 0;
   int ret = ERROR;
   int i;
 
@@ -397,7 +581,7 @@ int cmd_dd(FAR struct nsh_vtbl_s *vtbl, int argc, FAR char **argv)
   /* Then perform the data transfer */
 
 #ifdef CONFIG_NSH_CMDOPT_DD_STATS
-  clock_gettime(CLOCK_MONOTONIC, &ts0);
+  nsh_startcopystats(&dd.stats);
 #endif
 
   if (dd.skip)
@@ -422,50 +606,19 @@ int cmd_dd(FAR struct nsh_vtbl_s *vtbl, int argc, FAR char **argv)
         }
     }
 
-  while (!dd.eof && sector < dd.nsectors)
-    {
-      /* Read one sector from from the input */
-
-      ret = dd_read(&dd);
-      if (ret < 0)
-        {
-          goto errout_with_outf;
-        }
-
-      /* Has the incoming data stream ended? */
-
-      if (!dd.eof)
-        {
-          /* Write one sector to the output file */
-
-          ret = dd_write(&dd);
-          if (ret < 0)
-            {
-              goto errout_with_outf;
-            }
-
-          /* Increment the sector number */
+#ifdef CONFIG_NSH_CMDOPT_DD_PIPELINE
+  ret = dd_copy_pipelined(&dd);
+#else
+  ret = dd_copy(&dd);
+#endif
 
-          sector++;
-        }
+  if (ret < 0)
+    {
+      goto errout_with_outf;
     }
 
-  ret = OK;
-
 #ifdef CONFIG_NSH_CMDOPT_DD_STATS
-  clock_gettime(CLOCK_MONOTONIC, &ts1);
-
-  elapsed  = (((uint64_t)ts1.tv_sec * NSEC_PER_SEC) + ts1.tv_nsec);
-  elapsed -= (((uint64_t)ts0.tv_sec * NSEC_PER_SEC) + ts0.tv_nsec);
-  elapsed /= NSEC_PER_USEC; /* usec */
-
-  total = ((uint64_t)sector * (uint64_t)dd.sectsize);
-
-  nsh_output(vtbl, "%" PRIu64 "bytes copied, %" PRIu64 " usec, ",
-             total, elapsed);
-  nsh_output(vtbl, "%u KB/s\n" ,
-             (unsigned int)(((double)total / 1024)
-             / ((double)elapsed / USEC_PER_SEC)));
+  nsh_showcopystats(vtbl, &dd.stats);
 #endif
 
   if (ret == 0 && (dd.oflags & O_RDONLY) != 0)
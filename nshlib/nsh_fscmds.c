@@ -94,32 +94,81 @@
 #define MB                   (1UL << 20)
 #define GB                   (1UL << 30)
 
+/****************************************************************************
+ * Private Types
+ ****************************************************************************/
+
+/* State of a recursive copy */
+
+#ifndef CONFIG_NSH_DISABLE_CP
+struct cp_walk_s
+{
+  FAR char *destpath;                  /* Destination path, PATH_MAX bytes */
+  FAR struct nsh_workpool_s *pool;     /* Workers that copy the files */
+};
+#endif
+
 /****************************************************************************
  * Private Functions
  ****************************************************************************/
 
 /****************************************************************************
- * Name: cp_handler
+ * Name: cp_file
+ *
+ * Description:
+ *   Copy one file to 'destpath', which must not be a directory.  This does
+ *   not use the I/O buffer of the session so that the workers of a pool
+ *   can copy files concurrently.
+ *
  ****************************************************************************/
 
 #ifndef CONFIG_NSH_DISABLE_CP
-static int cp_handler(FAR struct nsh_vtbl_s *vtbl, FAR const char *srcpath,
-                      FAR const char *destpath)
+static int cp_file(FAR struct nsh_vtbl_s *vtbl, FAR const char *srcpath,
+                   FAR const char *destpath, int oflags,
+                   FAR char *buffer, size_t buflen,
+                   FAR struct nsh_copystats_s *stats)
 {
-  struct stat buf;
-  FAR char *allocpath = NULL;
-  int oflags = O_WRONLY | O_CREAT | O_TRUNC;
   int rdfd;
   int wrfd;
-  int ret = ERROR;
+  int ret;
 
   rdfd = open(srcpath, O_RDONLY);
   if (rdfd < 0)
     {
       nsh_error(vtbl, g_fmtcmdfailed, "cp", "open_rdfd", NSH_ERRNO);
-      return ret;
+      return ERROR;
     }
 
+  wrfd = open(destpath, oflags, 0666);
+  if (wrfd < 0)
+    {
+      nsh_error(vtbl, g_fmtcmdfailed, "cp", "open_wrfd", NSH_ERRNO);
+      close(rdfd);
+      return ERROR;
+    }
+
+  ret = nsh_copyfd(vtbl, "cp", rdfd, wrfd, buffer, buflen, stats);
+
+  close(wrfd);
+  close(rdfd);
+  return ret;
+}
+#endif
+
+/****************************************************************************
+ * Name: cp_handler
+ ****************************************************************************/
+
+#ifndef CONFIG_NSH_DISABLE_CP
+static int cp_handler(FAR struct nsh_vtbl_s *vtbl, FAR const char *srcpath,
+                      FAR const char *destpath,
+                      FAR struct nsh_copystats_s *stats)
+{
+  struct stat buf;
+  FAR char *allocpath = NULL;
+  int oflags = O_WRONLY | O_CREAT | O_TRUNC;
+  int ret;
+
   /* Check if the destination is a directory */
 
   if (stat(destpath, &buf) == 0)
@@ -141,7 +190,7 @@ static int cp_handler(FAR struct nsh_vtbl_s *vtbl, FAR const char *srcpath,
           if (!allocpath)
             {
               nsh_error(vtbl, g_fmtcmdoutofmemory, "cp");
-              goto errout_with_rdfd;
+              return ERROR;
             }
 
           /* Open then dest for writing */
@@ -156,85 +205,97 @@ static int cp_handler(FAR struct nsh_vtbl_s *vtbl, FAR const char *srcpath,
         }
     }
 
-  wrfd = open(destpath, oflags, 0666);
-  if (wrfd < 0)
-    {
-      nsh_error(vtbl, g_fmtcmdfailed, "cp", "open_wrfd", NSH_ERRNO);
-      goto errout_with_allocpath;
-    }
+  ret = cp_file(vtbl, srcpath, destpath, oflags, NULL, 0, stats);
 
-  for (; ; )
-    {
-      ssize_t nbyteswritten;
-      ssize_t nbytesread;
-      FAR char *iobuffer = vtbl->iobuffer;
+  free(allocpath);
+  return ret;
+}
+#endif
 
-      nbytesread = read(rdfd, iobuffer, IOBUFFERSIZE);
-      if (nbytesread == 0)
-        {
-          /* End of file */
+/****************************************************************************
+ * Name: cp_work
+ *
+ * Description:
+ *   Copy one file of a recursive copy.  This runs on a worker of the pool.
+ *
+ ****************************************************************************/
 
-          ret = OK;
-          goto errout_with_wrfd;
-        }
-      else if (nbytesread < 0)
-        {
-          /* EINTR is not an error (but will still stop the copy) */
+#ifndef CONFIG_NSH_DISABLE_CP
+static int cp_work(FAR struct nsh_vtbl_s *vtbl,
+                   FAR struct nsh_worker_s *worker,
+                   FAR const char *srcpath, FAR const char *destpath)
+{
+  return cp_file(vtbl, srcpath, destpath, O_WRONLY | O_CREAT | O_TRUNC,
+                 worker->buffer, worker->buflen, &worker->stats);
+}
+#endif
 
-          if (errno == EINTR)
-            {
-              nsh_error(vtbl, g_fmtsignalrecvd, "cp");
-            }
-          else
-            {
-              /* Read error */
+/****************************************************************************
+ * Name: cp_walk
+ *
+ * Description:
+ *   Handle one directory entry of a recursive copy.  Directories are
+ *   created and walked here; files are passed to the workers.
+ *
+ ****************************************************************************/
 
-              nsh_error(vtbl, g_fmtcmdfailed, "cp", "read",
-                        NSH_ERRNO);
-            }
+#ifndef CONFIG_NSH_DISABLE_CP
+static int cp_walk(FAR struct nsh_vtbl_s *vtbl, FAR char *srcpath,
+                   size_t dirlen, FAR struct dirent *entryp,
+                   FAR void *pvarg)
+{
+  FAR struct cp_walk_s *walk = (FAR struct cp_walk_s *)pvarg;
+  FAR char *destpath = walk->destpath;
+  struct stat buf;
+  size_t destlen;
+  size_t namelen;
+  bool isdir;
+  int ret;
 
-          goto errout_with_wrfd;
-        }
+  /* Append the name of the entry to the destination path */
 
-      do
-        {
-          nbyteswritten = write(wrfd, iobuffer, nbytesread);
-          if (nbyteswritten >= 0)
-            {
-              nbytesread -= nbyteswritten;
-              iobuffer += nbyteswritten;
-            }
-          else
-            {
-              /* EINTR is not an error (but will still stop the copy) */
+  destlen = strlen(destpath);
+  namelen = strlen(entryp->d_name);
+  if (destlen + 1 + namelen >= PATH_MAX)
+    {
+      nsh_error(vtbl, g_fmtcmdfailed, "cp", "open_wrfd",
+                NSH_ERRNO_OF(ENAMETOOLONG));
+      return ERROR;
+    }
 
-              if (errno == EINTR)
-                {
-                  nsh_error(vtbl, g_fmtsignalrecvd, "cp");
-                }
-              else
-                {
-                  /* Read error */
+  destpath[destlen] = '/';
+  memcpy(&destpath[destlen + 1], entryp->d_name, namelen + 1);
 
-                  nsh_error(vtbl, g_fmtcmdfailed, "cp", "write",
-                            NSH_ERRNO);
-                }
+  /* Only links, and entries whose type the file system does not report,
+   * need a stat() to see if they refer to a directory.
+   */
 
-              goto errout_with_wrfd;
-            }
-        }
-      while (nbytesread > 0);
+  isdir = DIRENT_ISDIRECTORY(entryp->d_type);
+  if (DIRENT_ISLINK(entryp->d_type) || entryp->d_type == DT_UNKNOWN)
+    {
+      isdir = stat(srcpath, &buf) == 0 && S_ISDIR(buf.st_mode);
     }
 
-errout_with_wrfd:
-  close(wrfd);
-
-errout_with_allocpath:
-  free(allocpath);
+  if (isdir)
+    {
+#if !defined(CONFIG_DISABLE_MOUNTPOINT) || !defined(CONFIG_DISABLE_PSEUDOFS_OPERATIONS)
+      ret = mkdir(destpath, S_IRWXU | S_IRWXG | S_IROTH | S_IXOTH);
+      if (ret != OK)
+        {
+          nsh_error(vtbl, g_fmtcmdfailed, "cp", "mkdir", NSH_ERRNO);
+          goto errout;
+        }
+#endif
 
-errout_with_rdfd:
-  close(rdfd);
+      ret = nsh_walkdir(vtbl, "cp", srcpath, cp_walk, walk);
+    }
+  else
+    {
+      ret = nsh_workpool_submit(walk->pool, srcpath, destpath);
+    }
 
+errout:
+  destpath[destlen] = '\0';
   return ret;
 }
 #endif
@@ -245,86 +306,108 @@ errout_with_rdfd:
 
 #ifndef CONFIG_NSH_DISABLE_CP
 static int cp_recursive(FAR struct nsh_vtbl_s *vtbl, FAR const char *srcpath,
-                        FAR const char *destpath)
+                        FAR const char *destpath,
+                        FAR struct nsh_copystats_s *stats)
 {
-  FAR struct dirent *entry;
-  FAR char *allocdestpath;
-  FAR char *allocsrcpath;
-  struct stat buf;
-  int ret = OK;
-  DIR *dp;
+  struct cp_walk_s walk;
+  FAR char *path;
+  int ret;
+
+  /* The source and destination paths are built up in place as the tree is
+   * walked, so no memory is allocated per file.
+   */
 
-  dp = opendir(srcpath);
-  if (dp == NULL)
+  path = malloc(2 * PATH_MAX);
+  if (path == NULL)
     {
-      nsh_error(vtbl, g_fmtcmdfailed, "cp", "opendir", NSH_ERRNO);
+      nsh_error(vtbl, g_fmtcmdoutofmemory, "cp");
       return ERROR;
     }
 
-  while ((entry = readdir(dp)) != NULL && ret == OK)
+  walk.destpath = &path[PATH_MAX];
+  strlcpy(path, srcpath, PATH_MAX);
+  strlcpy(walk.destpath, strcmp(destpath, "/") == 0 ? "" : destpath,
+          PATH_MAX);
+
+  walk.pool = nsh_workpool_create(vtbl, "cp", cp_work, true);
+  if (walk.pool == NULL)
     {
-      if (strcmp(entry->d_name, ".") == 0 ||
-          strcmp(entry->d_name, "..") == 0)
-        {
-          continue;
-        }
+      free(path);
+      return ERROR;
+    }
 
-      allocsrcpath = nsh_getdirpath(vtbl, srcpath, entry->d_name);
-      if (allocsrcpath == NULL)
-        {
-          ret = ERROR;
-          continue;
-        }
+  ret = nsh_walkdir(vtbl, "cp", path, cp_walk, &walk);
 
-      ret = stat(allocsrcpath, &buf);
-      if (ret != OK)
-        {
-          nsh_error(vtbl, g_fmtcmdfailed, "cp", "stat", NSH_ERRNO);
-          goto errout_with_allocsrcpath;
-        }
+  /* The workers have already reported any failure */
 
-      allocdestpath = nsh_getdirpath(vtbl, destpath, entry->d_name);
-      if (allocdestpath == NULL)
-        {
-          ret = ERROR;
-          goto errout_with_allocsrcpath;
-        }
+  if (nsh_workpool_destroy(walk.pool, stats) < 0)
+    {
+      ret = ERROR;
+    }
 
-      if (S_ISDIR(buf.st_mode))
-        {
-#if !defined(CONFIG_DISABLE_MOUNTPOINT) || !defined(CONFIG_DISABLE_PSEUDOFS_OPERATIONS)
-          ret = mkdir(allocdestpath, S_IRWXU | S_IRWXG | S_IROTH |
-                      S_IXOTH);
-          if (ret != OK)
-            {
-              nsh_error(vtbl, g_fmtcmdfailed, "cp", "mkdir", NSH_ERRNO);
-              goto errout_with_allocdestpath;
-            }
+  free(path);
+  return ret;
+}
 #endif
 
-          ret = cp_recursive(vtbl, allocsrcpath, allocdestpath);
-          if (ret != OK)
-            {
-              goto errout_with_allocdestpath;
-            }
-        }
-      else
-        {
-          ret = cp_handler(vtbl, allocsrcpath, allocdestpath);
-          if (ret != OK)
-            {
-              goto errout_with_allocdestpath;
-            }
-        }
+/****************************************************************************
+ * Name: mv_copy
+ *
+ * Description:
+ *   Move a regular file to another file system by copying it and then
+ *   removing the original.
+ *
+ ****************************************************************************/
+
+#if defined(NSH_HAVE_DIROPTS) && !defined(CONFIG_NSH_DISABLE_MV)
+static int mv_copy(FAR struct nsh_vtbl_s *vtbl, FAR const char *cmd,
+                   FAR const char *oldpath, FAR const char *newpath)
+{
+  struct nsh_copystats_s stats;
+  struct stat buf;
+  int rdfd;
+  int wrfd;
+  int ret;
+
+  if (stat(oldpath, &buf) < 0 || !S_ISREG(buf.st_mode))
+    {
+      nsh_error(vtbl, g_fmtcmdfailed, cmd, "rename", NSH_ERRNO_OF(EXDEV));
+      return ERROR;
+    }
+
+  rdfd = open(oldpath, O_RDONLY);
+  if (rdfd < 0)
+    {
+      nsh_error(vtbl, g_fmtcmdfailed, cmd, "open", NSH_ERRNO);
+      return ERROR;
+    }
+
+  wrfd = open(newpath, O_WRONLY | O_CREAT | O_TRUNC, buf.st_mode & 0777);
+  if (wrfd < 0)
+    {
+      nsh_error(vtbl, g_fmtcmdfailed, cmd, "open", NSH_ERRNO);
+      close(rdfd);
+      return ERROR;
+    }
+
+  memset(&stats, 0, sizeof(stats));
+  ret = nsh_copyfd(vtbl, cmd, rdfd, wrfd, NULL, 0, &stats);
+
+  close(wrfd);
+  close(rdfd);
 
-errout_with_allocdestpath:
-      free(allocdestpath);
+  /* Only remove the original once the copy is complete */
 
-errout_with_allocsrcpath:
-      free(allocsrcpath);
+  if (ret < 0)
+    {
+      unlink(newpath);
+    }
+  else if (unlink(oldpath) < 0)
+    {
+      nsh_error(vtbl, g_fmtcmdfailed, cmd, "unlink", NSH_ERRNO);
+      ret = ERROR;
     }
 
-  closedir(dp);
   return ret;
 }
 #endif
@@ -603,8 +686,9 @@ static int ls_handler(FAR struct nsh_vtbl_s *vtbl, FAR const char *dirpath,
  ****************************************************************************/
 
 #if !defined(CONFIG_NSH_DISABLE_LS)
-static int ls_recursive(FAR struct nsh_vtbl_s *vtbl, FAR const char *dirpath,
-                        FAR struct dirent *entryp, FAR void *pvarg)
+static int ls_recursive(FAR struct nsh_vtbl_s *vtbl, FAR char *path,
+                        size_t dirlen, FAR struct dirent *entryp,
+                        FAR void *pvarg)
 {
   int ret = OK;
 
@@ -612,27 +696,19 @@ static int ls_recursive(FAR struct nsh_vtbl_s *vtbl, FAR const char *dirpath,
 
   if (DIRENT_ISDIRECTORY(entryp->d_type) && !ls_specialdir(entryp->d_name))
     {
-      /* Yes.. */
-
-      FAR char *newpath;
-      newpath = nsh_getdirpath(vtbl, dirpath, entryp->d_name);
-
-      /* List the directory contents */
+      /* Yes.. List the directory contents */
 
-      nsh_output(vtbl, "%s:\n", newpath);
+      nsh_output(vtbl, "%s:\n", path);
 
       /* Traverse the directory  */
 
-      ret = nsh_foreach_direntry(vtbl, "ls", newpath, ls_handler, pvarg);
+      ret = nsh_foreach_direntry(vtbl, "ls", path, ls_handler, pvarg);
       if (ret == 0)
         {
           /* Then recurse to list each directory within the directory */
 
-          ret = nsh_foreach_direntry(vtbl, "ls", newpath, ls_recursive,
-                                     pvarg);
+          ret = nsh_walkdir(vtbl, "ls", path, ls_recursive, pvarg);
         }
-
-      free(newpath);
     }
 
   return ret;
@@ -882,6 +958,7 @@ int cmd_dmesg(FAR struct nsh_vtbl_s *vtbl, int argc, FAR char **argv)
 #ifndef CONFIG_NSH_DISABLE_CP
 int cmd_cp(FAR struct nsh_vtbl_s *vtbl, int argc, FAR char **argv)
 {
+  struct nsh_copystats_s stats;
   FAR char *srcpath  = NULL;
   FAR char *destpath = NULL;
   bool recursive = false;
@@ -926,15 +1003,28 @@ int cmd_cp(FAR struct nsh_vtbl_s *vtbl, int argc, FAR char **argv)
 
   /* Now open the destination */
 
+#ifdef CONFIG_NSH_CMDOPT_CP_STATS
+  nsh_startcopystats(&stats);
+#else
+  memset(&stats, 0, sizeof(stats));
+#endif
+
   if (recursive)
     {
-      ret = cp_recursive(vtbl, srcpath, destpath);
+      ret = cp_recursive(vtbl, srcpath, destpath, &stats);
     }
   else
     {
-      ret = cp_handler(vtbl, srcpath, destpath);
+      ret = cp_handler(vtbl, srcpath, destpath, &stats);
     }
 
+#ifdef CONFIG_NSH_CMDOPT_CP_STATS
+  if (ret == OK)
+    {
+      nsh_showcopystats(vtbl, &stats);
+    }
+#endif
+
 errout_with_destpath:
   nsh_freefullpath(destpath);
 
@@ -1631,10 +1721,25 @@ int cmd_ls(FAR struct nsh_vtbl_s *vtbl, int argc, FAR char **argv)
                                  (FAR void *)((uintptr_t)lsflags));
       if (ret == OK && (lsflags & LSFLAGS_RECURSIVE) != 0)
         {
-          /* Then recurse to list each directory within the directory */
+          FAR char *path;
+
+          /* Then recurse to list each directory within the directory.  The
+           * path of each sub-directory is built up in place.
+           */
 
-          ret = nsh_foreach_direntry(vtbl, "ls", fullpath, ls_recursive,
-                                     (FAR void *)((uintptr_t)lsflags));
+          path = malloc(PATH_MAX);
+          if (path == NULL)
+            {
+              nsh_error(vtbl, g_fmtcmdoutofmemory, argv[0]);
+              ret = ERROR;
+            }
+          else
+            {
+              strlcpy(path, fullpath, PATH_MAX);
+              ret = nsh_walkdir(vtbl, "ls", path, ls_recursive,
+                                (FAR void *)((uintptr_t)lsflags));
+              free(path);
+            }
         }
     }
 
@@ -2070,7 +2175,15 @@ int cmd_mv(FAR struct nsh_vtbl_s *vtbl, int argc, FAR char **argv)
   /* Perform the mount */
 
   ret = rename(oldpath, newpath);
-  if (ret < 0)
+  if (ret < 0 && errno == EXDEV)
+    {
+      /* The paths are on different file systems.  Copy the file and
+       * remove the original.
+       */
+
+      ret = mv_copy(vtbl, argv[0], oldpath, newpath);
+    }
+  else if (ret < 0)
     {
       nsh_error(vtbl, g_fmtcmdfailed, argv[0], "rename", NSH_ERRNO);
     }
@@ -2123,75 +2236,161 @@ int cmd_readlink(FAR struct nsh_vtbl_s *vtbl, int argc, FAR char **argv)
 }
 #endif
 
+#ifdef NSH_HAVE_DIROPTS
+#ifndef CONFIG_NSH_DISABLE_RM
+static int unlink_recursive(FAR struct nsh_vtbl_s *vtbl, FAR char *path,
+                            FAR struct nsh_workpool_s *pool);
+
 /****************************************************************************
- * Name: cmd_rm
+ * Name: rm_work
+ *
+ * Description:
+ *   Remove one file of a recursive remove.  This runs on a worker of the
+ *   pool.
+ *
  ****************************************************************************/
 
-#ifdef NSH_HAVE_DIROPTS
-#ifndef CONFIG_NSH_DISABLE_RM
+static int rm_work(FAR struct nsh_vtbl_s *vtbl,
+                   FAR struct nsh_worker_s *worker,
+                   FAR const char *path, FAR const char *unused)
+{
+  return unlink(path);
+}
+
+/****************************************************************************
+ * Name: rm_walk
+ ****************************************************************************/
+
+static int rm_walk(FAR struct nsh_vtbl_s *vtbl, FAR char *path,
+                   size_t dirlen, FAR struct dirent *entryp,
+                   FAR void *pvarg)
+{
+  FAR struct nsh_workpool_s *pool = (FAR struct nsh_workpool_s *)pvarg;
+  struct stat buf;
+  bool isdir;
+
+  /* Links are removed, never followed.  Not every file system reports the
+   * type of an entry, so look it up when it is unknown.
+   */
+
+  if (entryp->d_type == DT_UNKNOWN)
+    {
+      if (lstat(path, &buf) < 0)
+        {
+          nsh_error(vtbl, g_fmtcmdfailed, "rm", "lstat", NSH_ERRNO);
+          return ERROR;
+        }
+
+      isdir = S_ISDIR(buf.st_mode);
+    }
+  else
+    {
+      isdir = DIRENT_ISDIRECTORY(entryp->d_type);
+    }
+
+  if (isdir)
+    {
+      return unlink_recursive(vtbl, path, pool);
+    }
 
-static int unlink_recursive(FAR char *path, FAR struct stat *stat)
+  return nsh_workpool_submit(pool, path, NULL);
+}
+
+/****************************************************************************
+ * Name: unlink_recursive
+ *
+ * Description:
+ *   Remove 'path', which is in a buffer of PATH_MAX bytes, and everything
+ *   below it.  Files are removed by the workers of the pool; each
+ *   directory is removed once they have finished with its contents.
+ *
+ ****************************************************************************/
+
+static int unlink_recursive(FAR struct nsh_vtbl_s *vtbl, FAR char *path,
+                            FAR struct nsh_workpool_s *pool)
 {
-  struct dirent *d;
-  size_t len;
   int ret;
-  DIR *dp;
 
-  ret = lstat(path, stat);
-  if (ret < 0)
+  ret = nsh_walkdir(vtbl, "rm", path, rm_walk, pool);
+  if (ret >= 0)
     {
-      return ret;
+      ret = nsh_workpool_drain(pool);
     }
 
-  if (!S_ISDIR(stat->st_mode))
+  if (ret >= 0)
     {
-      return unlink(path);
+      ret = rmdir(path);
     }
 
-  dp = opendir(path);
-  if (dp == NULL)
+  return ret;
+}
+
+/****************************************************************************
+ * Name: rm_recursive
+ ****************************************************************************/
+
+static int rm_recursive(FAR struct nsh_vtbl_s *vtbl,
+                        FAR const char *fullpath)
+{
+  FAR struct nsh_workpool_s *pool;
+  FAR char *path;
+  struct stat buf;
+  int errcode;
+  int ret;
+
+  ret = lstat(fullpath, &buf);
+  if (ret < 0)
     {
-      return -1;
+      return ret;
     }
 
-  len = strlen(path);
-  if (len > 0 && path[len - 1] == '/')
+  if (!S_ISDIR(buf.st_mode))
     {
-      path[--len] = '\0';
+      return unlink(fullpath);
     }
 
-  while ((d = readdir(dp)) != NULL)
+  /* The path of each entry is built up in place as the tree is walked */
+
+  path = malloc(PATH_MAX);
+  if (path == NULL)
     {
-      if (strcmp(d->d_name, ".") == 0 || strcmp(d->d_name, "..") == 0)
-        {
-          continue;
-        }
+      set_errno(ENOMEM);
+      return ERROR;
+    }
 
-      snprintf(&path[len], PATH_MAX - len, "/%s", d->d_name);
-      ret = unlink_recursive(path, stat);
-      if (ret < 0)
-        {
-          closedir(dp);
-          return ret;
-        }
+  strlcpy(path, fullpath, PATH_MAX);
+
+  pool = nsh_workpool_create(vtbl, "rm", rm_work, false);
+  if (pool == NULL)
+    {
+      free(path);
+      set_errno(ENOMEM);
+      return ERROR;
     }
 
-  ret = closedir(dp);
-  if (ret >= 0)
+  ret = unlink_recursive(vtbl, path, pool);
+  errcode = errno;
+
+  if (nsh_workpool_destroy(pool, NULL) < 0)
     {
-      path[len] = '\0';
-      ret = rmdir(path);
+      errcode = errno;
+      ret = ERROR;
     }
 
+  free(path);
+  set_errno(errcode);
   return ret;
 }
 
+/****************************************************************************
+ * Name: cmd_rm
+ ****************************************************************************/
+
 int cmd_rm(FAR struct nsh_vtbl_s *vtbl, int argc, FAR char **argv)
 {
   bool recursive = false;
   bool force = false;
   FAR char *fullpath;
-  struct stat stat;
   int ret = ERROR;
   int c;
 
@@ -2233,7 +2432,7 @@ int cmd_rm(FAR struct nsh_vtbl_s *vtbl, int argc, FAR char **argv)
     {
       if (recursive)
         {
-          ret = unlink_recursive(fullpath, &stat);
+          ret = rm_recursive(vtbl, fullpath);
         }
       else
         {
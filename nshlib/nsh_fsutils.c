@@ -27,6 +27,7 @@
 #include <nuttx/config.h>
 
 #include <sys/types.h>
+#include <sys/sendfile.h>
 #include <stdint.h>
 #include <stdbool.h>
 #include <stdio.h>
@@ -37,7 +38,12 @@
 #include <dirent.h>
 #include <assert.h>
 #include <unistd.h>
+#include <inttypes.h>
+#include <limits.h>
+#include <errno.h>
+#include <time.h>
 
+#include <nuttx/clock.h>
 #include <nuttx/lib/lib.h>
 
 #include "nsh.h"
@@ -641,3 +647,228 @@ ssize_t nsh_getpid(FAR struct nsh_vtbl_s *vtbl, FAR const char *name,
   return argv.next;
 }
 #endif
+
+/****************************************************************************
+ * Name: nsh_copyfd
+ *
+ * Description:
+ *   Copy everything from one open file to another, up to the end of the
+ *   input file.  sendfile() is used if CONFIG_NSH_COPY_SENDFILE is
+ *   selected and the file systems support it.  Otherwise the data is
+ *   copied through the caller's buffer, if one is provided, or else
+ *   through a buffer of CONFIG_NSH_COPY_BUFSIZE bytes, or through the I/O
+ *   buffer of the session if that cannot be allocated.
+ *
+ * Input Parameters:
+ *   vtbl    - The console vtable
+ *   cmd     - NSH command name to use in error reporting
+ *   infd    - The file to copy from
+ *   outfd   - The file to copy to
+ *   buffer  - The copy buffer to use, or NULL
+ *   buflen  - The size of 'buffer'
+ *   stats   - Transfer statistics to update
+ *
+ * Returned Value:
+ *   Zero (OK) on success; -1 (ERROR) on failure.
+ *
+ ****************************************************************************/
+
+#ifdef NSH_HAVE_COPYFD
+int nsh_copyfd(FAR struct nsh_vtbl_s *vtbl, FAR const char *cmd,
+               int infd, int outfd, FAR char *buffer, size_t buflen,
+               FAR struct nsh_copystats_s *stats)
+{
+  FAR char *allocbuf = NULL;
+  ssize_t nbyteswritten;
+  ssize_t nbytesread;
+  int ret = ERROR;
+
+#ifdef CONFIG_NSH_COPY_SENDFILE
+  /* Let the file systems move the data if they can.  Fall back to the copy
+   * loop if sendfile() is not supported for these files.
+   */
+
+  for (nbytesread = 0; ; nbytesread += nbyteswritten)
+    {
+      nbyteswritten = sendfile(outfd, infd, NULL, SSIZE_MAX);
+      if (nbyteswritten == 0)
+        {
+          return OK;
+        }
+      else if (nbyteswritten < 0)
+        {
+          if (nbytesread == 0 &&
+              (errno == ENOSYS || errno == EINVAL || errno == ENOTSUP))
+            {
+              break;
+            }
+
+          nsh_error(vtbl, g_fmtcmdfailed, cmd, "sendfile", NSH_ERRNO);
+          return ERROR;
+        }
+
+      stats->cs_nbytes += nbyteswritten;
+      stats->cs_nreads++;
+      stats->cs_nwrites++;
+    }
+#endif
+
+  /* Use a larger buffer than the I/O buffer if we can get one */
+
+  if (buffer == NULL)
+    {
+#if defined(NSH_HAVE_IOBUFFER) && CONFIG_NSH_COPY_BUFSIZE <= IOBUFFERSIZE
+      buffer = vtbl->iobuffer;
+      buflen = IOBUFFERSIZE;
+#else
+      allocbuf = malloc(CONFIG_NSH_COPY_BUFSIZE);
+      buffer   = allocbuf;
+      buflen   = CONFIG_NSH_COPY_BUFSIZE;
+
+#  ifdef NSH_HAVE_IOBUFFER
+      if (buffer == NULL)
+        {
+          buffer = vtbl->iobuffer;
+          buflen = IOBUFFERSIZE;
+        }
+#  endif
+#endif
+    }
+
+  if (buffer == NULL)
+    {
+      nsh_error(vtbl, g_fmtcmdoutofmemory, cmd);
+      return ERROR;
+    }
+
+  for (; ; )
+    {
+      FAR char *ptr = buffer;
+
+      nbytesread = read(infd, buffer, buflen);
+      if (nbytesread == 0)
+        {
+          /* End of file */
+
+          ret = OK;
+          break;
+        }
+      else if (nbytesread < 0)
+        {
+          /* EINTR is not an error (but will still stop the copy) */
+
+          if (errno == EINTR)
+            {
+              nsh_error(vtbl, g_fmtsignalrecvd, cmd);
+            }
+          else
+            {
+              /* Read error */
+
+              nsh_error(vtbl, g_fmtcmdfailed, cmd, "read", NSH_ERRNO);
+            }
+
+          break;
+        }
+
+      stats->cs_nreads++;
+
+      do
+        {
+          nbyteswritten = write(outfd, ptr, nbytesread);
+          if (nbyteswritten >= 0)
+            {
+              nbytesread       -= nbyteswritten;
+              ptr              += nbyteswritten;
+              stats->cs_nbytes += nbyteswritten;
+              stats->cs_nwrites++;
+            }
+          else
+            {
+              /* EINTR is not an error (but will still stop the copy) */
+
+              if (errno == EINTR)
+                {
+                  nsh_error(vtbl, g_fmtsignalrecvd, cmd);
+                }
+              else
+                {
+                  /* Write error */
+
+                  nsh_error(vtbl, g_fmtcmdfailed, cmd, "write", NSH_ERRNO);
+                }
+
+              goto errout;
+            }
+        }
+      while (nbytesread > 0);
+    }
+
+errout:
+  free(allocbuf);
+  return ret;
+}
+#endif
+
+/****************************************************************************
+ * Name: nsh_startcopystats
+ *
+ * Description:
+ *   Clear the transfer statistics and record the start time.
+ *
+ ****************************************************************************/
+
+#ifdef NSH_HAVE_COPYSTATS
+void nsh_startcopystats(FAR struct nsh_copystats_s *stats)
+{
+  memset(stats, 0, sizeof(struct nsh_copystats_s));
+  clock_gettime(CLOCK_MONOTONIC, &stats->cs_start);
+}
+#endif
+
+/****************************************************************************
+ * Name: nsh_showcopystats
+ *
+ * Description:
+ *   Show the number of bytes transferred, the elapsed time, the throughput
+ *   and the number of I/O operations per second since
+ *   nsh_startcopystats().
+ *
+ ****************************************************************************/
+
+#ifdef NSH_HAVE_COPYSTATS
+void nsh_showcopystats(FAR struct nsh_vtbl_s *vtbl,
+                       FAR const struct nsh_copystats_s *stats)
+{
+  struct timespec now;
+  uint64_t elapsed;
+  uint64_t nops;
+
+  clock_gettime(CLOCK_MONOTONIC, &now);
+
+  elapsed  = ((uint64_t)now.tv_sec * NSEC_PER_SEC) + now.tv_nsec;
+  elapsed -= ((uint64_t)stats->cs_start.tv_sec * NSEC_PER_SEC) +
+             stats->cs_start.tv_nsec;
+  elapsed /= NSEC_PER_USEC; /* usec */
+
+  if (elapsed == 0)
+    {
+      elapsed = 1;
+    }
+
+  nops = (uint64_t)stats->cs_nreads + stats->cs_nwrites;
+
+  if (stats->cs_nfiles > 0)
+    {
+      nsh_output(vtbl, "%" PRIu32 " files, ", stats->cs_nfiles);
+    }
+
+  nsh_output(vtbl, "%" PRIu64 " bytes copied, %" PRIu64 " usec, ",
+             stats->cs_nbytes, elapsed);
+  nsh_output(vtbl, "%" PRIu64 " KB/s, %" PRIu64 " IOPS "
+             "(%" PRIu32 " reads, %" PRIu32 " writes)\n",
+             (stats->cs_nbytes * USEC_PER_SEC / 1024) / elapsed,
+             nops * USEC_PER_SEC / elapsed,
+             stats->cs_nreads, stats->cs_nwrites);
+}
+#endif
@@ -346,6 +346,20 @@ static int wget_callback(FAR char **buffer, int offset, int datend,
 
   return 0;
 }
+
+/****************************************************************************
+ * Name: wget_range_callback
+ ****************************************************************************/
+
+#ifdef CONFIG_WEBCLIENT_RANGES
+static void wget_range_callback(unsigned int index,
+                                FAR const struct webclient_range_s *range,
+                                FAR void *arg)
+{
+  nsh_output((FAR struct nsh_vtbl_s *)arg, "range %u: %jd/%jd\n", index,
+             (intmax_t)range->done, (intmax_t)(range->end - range->start));
+}
+#endif
 #endif
 #endif
 
@@ -1405,6 +1419,10 @@ int cmd_wget(FAR struct nsh_vtbl_s *vtbl, int argc, FAR char **argv)
   FAR char *fullpath  = NULL;
   FAR char *url;
   FAR const char *fmt;
+#ifdef CONFIG_WEBCLIENT_RANGES
+  unsigned int nranges = 0;
+  bool resume = false;
+#endif
   bool badarg = false;
   int option;
   int fd = -1;
@@ -1412,7 +1430,7 @@ int cmd_wget(FAR struct nsh_vtbl_s *vtbl, int argc, FAR char **argv)
 
   /* Get the wget options */
 
-  while ((option = getopt(argc, argv, ":o:")) != ERROR)
+  while ((option = getopt(argc, argv, ":cn:o:")) != ERROR)
     {
       switch (option)
         {
@@ -1420,6 +1438,16 @@ int cmd_wget(FAR struct nsh_vtbl_s *vtbl, int argc, FAR char **argv)
             localfile = optarg;
             break;
 
+#ifdef CONFIG_WEBCLIENT_RANGES
+          case 'c':
+            resume = true;
+            break;
+
+          case 'n':
+            nranges = atoi(optarg);
+            break;
+#endif
+
           case ':':
             nsh_error(vtbl, g_fmtargrequired, argv[0]);
             badarg = true;
@@ -1471,6 +1499,28 @@ int cmd_wget(FAR struct nsh_vtbl_s *vtbl, int argc, FAR char **argv)
 
   fullpath = nsh_getfullpath(vtbl, localfile);
 
+#ifdef CONFIG_WEBCLIENT_RANGES
+  /* Download with parallel Range requests and/or resume */
+
+  if (nranges > 0 || resume)
+    {
+      struct webclient_context ctx;
+
+      webclient_set_defaults(&ctx);
+      ctx.url    = url;
+      ctx.buflen = CONFIG_NSH_WGET_BUFF_SIZE;
+      ret = webclient_get_ranges(&ctx, fullpath, nranges, resume,
+                                 wget_range_callback, vtbl);
+      if (ret < 0)
+        {
+          errno = -ret;
+          nsh_error(vtbl, g_fmtcmdfailed, argv[0], "wget", NSH_ERRNO);
+        }
+
+      goto exit;
+    }
+#endif
+
   /* Open the local file for writing */
 
   fd = open(fullpath, O_WRONLY | O_CREAT | O_TRUNC, 0644);
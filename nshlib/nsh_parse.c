@@ -540,6 +540,12 @@ static int nsh_execute(FAR struct nsh_vtbl_s *vtbl,
    * Note the priority is not effected by nice-ness.
    */
 
+  /* Any output of earlier commands must be written before a new task
+   * starts writing to the same stream.
+   */
+
+  nsh_flush(vtbl);
+
 #ifdef CONFIG_NSH_BUILTIN_APPS
   ret = nsh_builtin(vtbl, argv[0], argv, param);
   if (ret >= 0)
@@ -719,6 +725,15 @@ static int nsh_execute(FAR struct nsh_vtbl_s *vtbl,
 
       ret = nsh_command(vtbl, argc, argv);
 
+#if CONFIG_NSH_PIPELINE_BUFSIZE > 0
+      /* The command fails if its buffered output could not be written */
+
+      if (vtbl->np.np_redir_out && nsh_flush(vtbl) < 0)
+        {
+          ret = ERROR;
+        }
+#endif
+
       /* Restore the original output.  Undirect will close the redirection
        * file descriptor.
        */
@@ -1931,7 +1946,12 @@ static int nsh_loop(FAR struct nsh_vtbl_s *vtbl, FAR char **ppcmd,
 #endif
               np->np_lpstate[np->np_lpndx].lp_state == NSH_LOOP_WHILE ||
               np->np_lpstate[np->np_lpndx].lp_state == NSH_LOOP_UNTIL ||
-              np->np_fd < 0 || np->np_foffs < 0)
+#if CONFIG_NSH_SCRIPTCACHE_SIZE > 0
+              (np->np_script == NULL && np->np_fd < 0) ||
+#else
+              np->np_fd < 0 ||
+#endif
+              np->np_foffs < 0)
             {
               nsh_error(vtbl, g_fmtcontext, cmd);
               goto errout;
@@ -2021,15 +2041,28 @@ static int nsh_loop(FAR struct nsh_vtbl_s *vtbl, FAR char **ppcmd,
 
           if (np->np_lpstate[np->np_lpndx].lp_enable)
             {
-              /* Set the new file position to the top of the loop offset */
+#if CONFIG_NSH_SCRIPTCACHE_SIZE > 0
+              if (np->np_script != NULL)
+                {
+                  /* Set the next script line to the top of the loop */
 
-              ret = lseek(np->np_fd,
-                          np->np_lpstate[np->np_lpndx].lp_topoffs,
-                          SEEK_SET);
-              if (ret < 0)
+                  np->np_spos = np->np_lpstate[np->np_lpndx].lp_topoffs;
+                }
+              else
+#endif
                 {
-                  nsh_error(vtbl, g_fmtcmdfailed, "done", "lseek",
-                            NSH_ERRNO);
+                  /* Set the new file position to the top of the loop
+                   * offset
+                   */
+
+                  ret = lseek(np->np_fd,
+                              np->np_lpstate[np->np_lpndx].lp_topoffs,
+                              SEEK_SET);
+                  if (ret < 0)
+                    {
+                      nsh_error(vtbl, g_fmtcmdfailed, "done", "lseek",
+                                NSH_ERRNO);
+                    }
                 }
 
 #ifndef NSH_DISABLE_SEMICOLON
@@ -2746,6 +2779,15 @@ static int nsh_parse_command(FAR struct nsh_vtbl_s *vtbl, FAR char *cmdline)
               goto dynlist_free;
             }
 
+#if CONFIG_NSH_PIPELINE_BUFSIZE > 0 && defined(F_SETPIPE_SZ)
+          /* Let the pipe hold two output buffers so that one stage can
+           * fill the next buffer while the next stage reads the last one.
+           * The default size is kept if this is not possible.
+           */
+
+          fcntl(pipefd[1], F_SETPIPE_SZ, 2 * CONFIG_NSH_PIPELINE_BUFSIZE);
+#endif
+
           redirect_out_save = vtbl->np.np_redir_out;
           vtbl->np.np_redir_out = true;
           param.fd_out = pipefd[1];
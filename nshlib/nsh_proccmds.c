@@ -64,6 +64,10 @@
 #  define PS_SHOW_HEAPSIZE
 #endif
 
+/* Size of the path to a procfs file of a task: "<mountpoint>/<pid>/<name>" */
+
+#define PS_PATH_SIZE (sizeof(CONFIG_NSH_PROC_MOUNTPOINT) + NAME_MAX + 16)
+
 #ifndef CONFIG_NSH_DISABLE_PSSTACKUSAGE
 #  define PS_SHOW_STACKSIZE
 #  ifdef CONFIG_STACK_COLORATION
@@ -81,27 +85,17 @@
 
 typedef int (*exec_t)(void);
 
-/* This structure represents the parsed task characteristics */
+/* This structure represents the parsed task characteristics.  Everything
+ * except for the command line is held in place, so an array of these is a
+ * snapshot of all tasks that can be sorted and reused without allocating
+ * anything per task.
+ */
 
 struct nsh_taskstatus_s
 {
-  FAR const char *td_type;         /* Thread type */
-  FAR const char *td_groupid;      /* Group ID */
-#ifdef CONFIG_SMP
-  FAR const char *td_cpu;          /* CPU */
-#endif
-  FAR const char *td_state;        /* Thread state */
-  FAR const char *td_event;        /* Thread wait event */
-  FAR const char *td_flags;        /* Thread flags */
-  FAR const char *td_priority;     /* Thread priority */
-  FAR const char *td_policy;       /* Thread scheduler */
-#ifndef CONFIG_NSH_DISABLE_PSSIGMASK
-  FAR const char *td_sigmask;      /* Signal mask */
-#endif
-  FAR char       *td_cmdline;      /* Command line */
-  int             td_pid;          /* Task ID */
+  pid_t           td_pid;          /* Task ID */
 #ifdef NSH_HAVE_CPULOAD
-  FAR const char *td_cpuload;      /* CPU load */
+  uint32_t        td_load;         /* CPU load in tenths of a percent */
 #endif
 #ifdef PS_SHOW_HEAPSIZE
   unsigned long   td_heapsize;     /* Heap size */
@@ -113,14 +107,35 @@ struct nsh_taskstatus_s
   unsigned long   td_stack_filled; /* Stack filled percentage */
 #  endif
 #endif
-  FAR char       *td_buf;          /* Buffer for reading files */
-  size_t          td_bufsize;      /* Size of the buffer */
-  size_t          td_bufpos;       /* Position in the buffer */
+  size_t          td_cmdline;      /* Offset of the command line */
+  char            td_type[8];      /* Thread type */
+  char            td_groupid[8];   /* Group ID */
+#ifdef CONFIG_SMP
+  char            td_cpu[4];       /* CPU */
+#endif
+  char            td_state[12];    /* Thread state */
+  char            td_event[12];    /* Thread wait event */
+  char            td_flags[8];     /* Thread flags */
+  char            td_priority[4];  /* Thread priority */
+  char            td_policy[12];   /* Thread scheduler */
+#ifndef CONFIG_NSH_DISABLE_PSSIGMASK
+  char            td_sigmask[20];  /* Signal mask */
+#endif
+#ifdef NSH_HAVE_CPULOAD
+  char            td_cpuload[8];   /* CPU load */
+#endif
 };
 
+/* A snapshot of all tasks.  The arrays are kept from one refresh of top
+ * to the next and only grow when there are more tasks.
+ */
+
 struct nsh_topstatus_s
 {
-  FAR struct nsh_taskstatus_s **status;
+  FAR struct nsh_taskstatus_s *status; /* Status of each task */
+  FAR char *cmdlines;                  /* Command lines of all tasks */
+  size_t cmdlen;                       /* Bytes used in 'cmdlines' */
+  size_t cmdsize;                      /* Allocated size of 'cmdlines' */
   bool heap;
   size_t size;
   size_t index;
@@ -156,6 +171,52 @@ static const char g_stackused[] = "StackUsed:";
  * Private Functions
  ****************************************************************************/
 
+/****************************************************************************
+ * Name: ps_copyfield
+ *
+ * Description:
+ *   Copy a field of a procfs file, without any leading or trailing spaces.
+ *
+ ****************************************************************************/
+
+#ifndef CONFIG_NSH_DISABLE_PS
+static void ps_copyfield(FAR char *dest, size_t size, FAR char *src)
+{
+  strlcpy(dest, nsh_trimspaces(src), size);
+}
+#endif
+
+/****************************************************************************
+ * Name: ps_nextline
+ *
+ * Description:
+ *   Return the line at *nextline, NUL-terminated, and advance *nextline to
+ *   the line that follows it or to NULL if there is none.
+ *
+ ****************************************************************************/
+
+#ifndef CONFIG_NSH_DISABLE_PS
+static FAR char *ps_nextline(FAR char **nextline)
+{
+  FAR char *line = *nextline;
+  FAR char *ptr;
+
+  for (ptr = line + 1; *ptr != '\n' && *ptr != '\0'; ptr++);
+
+  if (*ptr == '\n')
+    {
+      *ptr++ = '\0';
+      *nextline = ptr;
+    }
+  else
+    {
+      *nextline = NULL;
+    }
+
+  return line;
+}
+#endif
+
 /****************************************************************************
  * Name: nsh_parse_statusline
  ****************************************************************************/
@@ -191,13 +252,14 @@ static void nsh_parse_statusline(FAR char *line,
     {
       /* Save the thread type */
 
-      status->td_type = nsh_trimspaces(&line[12]);
+      ps_copyfield(status->td_type, sizeof(status->td_type), &line[12]);
     }
   else if (strncmp(line, g_groupid, strlen(g_groupid)) == 0)
     {
       /* Save the Group ID */
 
-      status->td_groupid = nsh_trimspaces(&line[12]);
+      ps_copyfield(status->td_groupid, sizeof(status->td_groupid),
+                   &line[12]);
     }
 
 #ifdef CONFIG_SMP
@@ -205,7 +267,7 @@ static void nsh_parse_statusline(FAR char *line,
     {
       /* Save the current CPU */
 
-      status->td_cpu = nsh_trimspaces(&line[12]);
+      ps_copyfield(status->td_cpu, sizeof(status->td_cpu), &line[12]);
     }
 #endif
 
@@ -213,47 +275,50 @@ static void nsh_parse_statusline(FAR char *line,
     {
       FAR char *ptr;
 
-      /* Save the thread state */
-
-      status->td_state = nsh_trimspaces(&line[12]);
-
       /* Check if an event follows the state */
 
-      ptr = strchr(status->td_state, ',');
+      ptr = strchr(&line[12], ',');
       if (ptr != NULL)
         {
           *ptr++ = '\0';
-          status->td_event = nsh_trimspaces(ptr);
+          ps_copyfield(status->td_event, sizeof(status->td_event), ptr);
         }
+
+      /* Save the thread state */
+
+      ps_copyfield(status->td_state, sizeof(status->td_state), &line[12]);
     }
   else if (strncmp(line, g_flags, strlen(g_flags)) == 0)
     {
-      status->td_flags = nsh_trimspaces(&line[12]);
+      ps_copyfield(status->td_flags, sizeof(status->td_flags), &line[12]);
     }
   else if (strncmp(line, g_priority, strlen(g_priority)) == 0)
     {
       FAR char *ptr = nsh_trimspaces(&line[12]);
-      status->td_priority = ptr;
+      FAR char *end = ptr;
 
       /* If priority inheritance is enabled, use current pri, ignore base */
 
-      while (isdigit(*ptr))
+      while (isdigit(*end))
         {
-          ++ptr;
+          ++end;
         }
 
-      *ptr = '\0';
+      *end = '\0';
+      strlcpy(status->td_priority, ptr, sizeof(status->td_priority));
     }
   else if (strncmp(line, g_scheduler, strlen(g_scheduler)) == 0)
     {
       /* Skip over the SCHED_ part of the policy.  Result is max 8 bytes. */
 
-      status->td_policy = nsh_trimspaces(&line[12 + 6]);
+      ps_copyfield(status->td_policy, sizeof(status->td_policy),
+                   &line[12 + 6]);
     }
 #ifndef CONFIG_NSH_DISABLE_PSSIGMASK
   else if (strncmp(line, g_sigmask, strlen(g_sigmask)) == 0)
     {
-      status->td_sigmask = nsh_trimspaces(&line[12]);
+      ps_copyfield(status->td_sigmask, sizeof(status->td_sigmask),
+                   &line[12]);
     }
 #endif
 }
@@ -296,103 +361,71 @@ static bool ps_skipfile(FAR const struct dirent *entryp)
 
 /****************************************************************************
  * Name: ps_readprocfs
+ *
+ * Description:
+ *   Read the procfs file 'name' of the task whose directory path is in
+ *   'path', up to 'pathlen', into the I/O buffer.  Each file is parsed
+ *   before the next one is read, so one buffer serves all tasks.
+ *
  ****************************************************************************/
 
-ssize_t ps_readprocfs(FAR struct nsh_vtbl_s *vtbl, FAR const char *basepath,
-                      FAR const char *dirpath,
-                      FAR const struct dirent *entryp,
-                      FAR struct nsh_taskstatus_s *status)
+static FAR char *ps_readprocfs(FAR struct nsh_vtbl_s *vtbl,
+                               FAR const char *cmd, FAR char *path,
+                               size_t pathlen, FAR const char *name)
 {
-  FAR char *filepath = NULL;
-  int ret;
+  strlcpy(&path[pathlen], name, PS_PATH_SIZE - pathlen);
 
-  ret = asprintf(&filepath, "%s/%s/%s", dirpath, entryp->d_name, basepath);
-  if (ret < 0 || filepath == NULL)
+  if (nsh_readfile(vtbl, cmd, path, vtbl->iobuffer, IOBUFFERSIZE) < 0)
     {
-      nsh_error(vtbl, g_fmtcmdfailed, "ps", "asprintf", NSH_ERRNO);
-      status->td_buf[status->td_bufpos] = '\0';
-    }
-  else
-    {
-      ret = nsh_readfile(vtbl, "ps", filepath,
-                         status->td_buf + status->td_bufpos,
-                         status->td_bufsize - status->td_bufpos);
-      if (ret >= 0)
-        {
-          ret = strlen(status->td_buf + status->td_bufpos) + 1;
-        }
-
-      free(filepath);
+      return NULL;
     }
 
-  return ret;
+  return vtbl->iobuffer;
 }
 
 /****************************************************************************
  * Name: ps_record
+ *
+ * Description:
+ *   Gather the characteristics of one task into 'status'.  On return,
+ *   'cmdline' refers to the command line of the task in the I/O buffer.
+ *
  ****************************************************************************/
 
-static int ps_record(FAR struct nsh_vtbl_s *vtbl, FAR const char *dirpath,
+static int ps_record(FAR struct nsh_vtbl_s *vtbl, FAR const char *cmd,
+                     FAR const char *dirpath,
                      FAR const struct dirent *entryp, bool heap,
-                     FAR struct nsh_taskstatus_s *status)
+                     FAR struct nsh_taskstatus_s *status,
+                     FAR const char **cmdline)
 {
+  char path[PS_PATH_SIZE];
   FAR char *nextline;
   FAR char *line;
-  int ret;
+  int pathlen;
 
-  status->td_type = "";
-  status->td_groupid = "";
-#ifdef CONFIG_SMP
-  status->td_cpu = "";
-#endif
-  status->td_state = "";
-  status->td_event = "";
-  status->td_flags = "";
-  status->td_priority = "";
-  status->td_policy = "";
-#ifndef CONFIG_NSH_DISABLE_PSSIGMASK
-  status->td_sigmask = "";
-#endif
-  status->td_cmdline = "";
+  memset(status, 0, sizeof(struct nsh_taskstatus_s));
   status->td_pid = atoi(entryp->d_name);
-#ifdef NSH_HAVE_CPULOAD
-  status->td_cpuload = "";
-#endif
+  *cmdline = "";
 
-  /* Read the task status */
+  /* The path of every file of this task has the same prefix */
 
-  ret = ps_readprocfs(vtbl, "status", dirpath, entryp, status);
-  if (ret >= 0)
+  pathlen = snprintf(path, sizeof(path), "%s/%s/", dirpath, entryp->d_name);
+  if (pathlen < 0 || pathlen >= sizeof(path))
     {
-      /* Parse the task status. */
-
-      nextline = status->td_buf + status->td_bufpos;
-      status->td_bufpos += ret;
-      do
-        {
-          /* Find the beginning of the next line and NUL-terminate the
-           * current line.
-           */
-
-          line = nextline;
-          for (nextline++;
-               *nextline != '\n' && *nextline != '\0';
-               nextline++);
+      nsh_error(vtbl, g_fmtcmdfailed, cmd, "snprintf",
+                NSH_ERRNO_OF(ENAMETOOLONG));
+      return ERROR;
+    }
 
-          if (*nextline == '\n')
-            {
-              *nextline++ = '\0';
-            }
-          else
-            {
-              nextline = NULL;
-            }
+  /* Read the task status */
 
-          /* Parse the current line */
+  nextline = ps_readprocfs(vtbl, cmd, path, pathlen, "status");
+  while (nextline != NULL)
+    {
+      /* Parse the current line */
 
-          nsh_parse_statusline(line, status);
-        }
-      while (nextline != NULL);
+      line = ps_nextline(&nextline);
+      nsh_parse_statusline(line, status);
     }
 
 #ifdef PS_SHOW_HEAPSIZE
@@ -400,101 +433,57 @@ static int ps_record(FAR struct nsh_vtbl_s *vtbl, FAR const char *dirpath,
     {
       /* Get the Heap AllocSize */
 
-      ret = ps_readprocfs(vtbl, "heap", dirpath, entryp, status);
-      if (ret >= 0)
+      nextline = ps_readprocfs(vtbl, cmd, path, pathlen, "heap");
+      while (nextline != NULL)
         {
-          nextline = status->td_buf + status->td_bufpos;
-          do
-            {
-              /* Find the beginning of the next line and NUL-terminate
-               * the current line.
-               */
-
-              line = nextline;
-              for (nextline++;
-                  *nextline != '\n' && *nextline != '\0';
-                  nextline++);
-
-              if (*nextline == '\n')
-                {
-                  *nextline++ = '\0';
-                }
-              else
-                {
-                  nextline = NULL;
-                }
-
-              /* Parse the current line
-               *
-               *   Format:
-               *
-               *            111111111122222222223
-               *   123456789012345678901234567890
-               *   AllocSize:  xxxx
-               *   AllocBlks:  xxxx
-               */
-
-              if (strncmp(line, g_heapsize, strlen(g_heapsize)) == 0)
-                {
-                  status->td_heapsize = strtoul(&line[12], NULL, 0);
-                  break;
-                }
-            }
-          while (nextline != NULL);
-        }
-    }
-#endif
-
-#ifdef PS_SHOW_STACKSIZE
-  /* Get the StackSize and StackUsed */
-
-  ret = ps_readprocfs(vtbl, "stack", dirpath, entryp, status);
-  if (ret >= 0)
-    {
-      nextline = status->td_buf + status->td_bufpos;
-      do
-        {
-          /* Find the beginning of the next line and NUL-terminate the
-           * current line.
-           */
-
-          line = nextline;
-          for (nextline++;
-              *nextline != '\n' && *nextline != '\0';
-              nextline++);
-
-          if (*nextline == '\n')
-            {
-              *nextline++ = '\0';
-            }
-          else
-            {
-              nextline = NULL;
-            }
-
           /* Parse the current line
            *
            *   Format:
            *
            *            111111111122222222223
            *   123456789012345678901234567890
-           *   StackBase:  xxxxxxxxxx
-           *   StackSize:  xxxx
-           *   StackUsed:  xxxx
+           *   AllocSize:  xxxx
+           *   AllocBlks:  xxxx
            */
 
-          if (strncmp(line, g_stacksize, strlen(g_stacksize)) == 0)
+          line = ps_nextline(&nextline);
+          if (strncmp(line, g_heapsize, strlen(g_heapsize)) == 0)
             {
-              status->td_stack_size = strtoul(&line[12], NULL, 0);
+              status->td_heapsize = strtoul(&line[12], NULL, 0);
+              break;
             }
+        }
+    }
+#endif
+
+#ifdef PS_SHOW_STACKSIZE
+  /* Get the StackSize and StackUsed */
+
+  nextline = ps_readprocfs(vtbl, cmd, path, pathlen, "stack");
+  while (nextline != NULL)
+    {
+      /* Parse the current line
+       *
+       *   Format:
+       *
+       *            111111111122222222223
+       *   123456789012345678901234567890
+       *   StackBase:  xxxxxxxxxx
+       *   StackSize:  xxxx
+       *   StackUsed:  xxxx
+       */
+
+      line = ps_nextline(&nextline);
+      if (strncmp(line, g_stacksize, strlen(g_stacksize)) == 0)
+        {
+          status->td_stack_size = strtoul(&line[12], NULL, 0);
+        }
 #  ifdef PS_SHOW_STACKUSAGE
-          else if (strncmp(line, g_stackused, strlen(g_stackused)) == 0)
-            {
-              status->td_stack_used = strtoul(&line[12], NULL, 0);
-            }
-#  endif
+      else if (strncmp(line, g_stackused, strlen(g_stackused)) == 0)
+        {
+          status->td_stack_used = strtoul(&line[12], NULL, 0);
         }
-      while (nextline != NULL);
+#  endif
     }
 
 #  ifdef PS_SHOW_STACKUSAGE
@@ -509,28 +498,35 @@ static int ps_record(FAR struct nsh_vtbl_s *vtbl, FAR const char *dirpath,
 #endif
 
 #ifdef NSH_HAVE_CPULOAD
-  /* Get the CPU load */
+  /* Get the CPU load.  It is also kept as a number so that top can sort
+   * the tasks without parsing it again for each comparison.
+   */
 
-  ret = ps_readprocfs(vtbl, "loadavg", dirpath, entryp, status);
-  if (ret >= 0)
+  line = ps_readprocfs(vtbl, cmd, path, pathlen, "loadavg");
+  if (line != NULL)
     {
-      status->td_cpuload = nsh_trimspaces(status->td_buf +
-                                          status->td_bufpos);
-      status->td_bufpos += ret;
+      FAR char *ptr;
+
+      ps_copyfield(status->td_cpuload, sizeof(status->td_cpuload), line);
+
+      status->td_load = 10 * strtoul(status->td_cpuload, &ptr, 10);
+      if (*ptr == '.' && isdigit(ptr[1]))
+        {
+          status->td_load += ptr[1] - '0';
+        }
     }
 #endif
 
   /* Read the task/thread command line */
 
-  ret = ps_readprocfs(vtbl, "cmdline", dirpath, entryp, status);
-  if (ret >= 0)
+  line = ps_readprocfs(vtbl, cmd, path, pathlen, "cmdline");
+  if (line == NULL)
     {
-      status->td_cmdline = nsh_trimspaces(status->td_buf +
-                                          status->td_bufpos);
-      status->td_bufpos += ret;
+      return ERROR;
     }
 
-  return ret;
+  *cmdline = nsh_trimspaces(line);
+  return OK;
 }
 
 /****************************************************************************
@@ -602,7 +598,8 @@ static void ps_title(FAR struct nsh_vtbl_s *vtbl, bool heap)
  ****************************************************************************/
 
 static void ps_output(FAR struct nsh_vtbl_s *vtbl, bool heap,
-                      FAR const struct nsh_taskstatus_s *status)
+                      FAR const struct nsh_taskstatus_s *status,
+                      FAR const char *cmdline)
 {
   /* Finally, print the status information */
 
@@ -664,7 +661,7 @@ static void ps_output(FAR struct nsh_vtbl_s *vtbl, bool heap,
 #ifdef NSH_HAVE_CPULOAD
            , status->td_cpuload
 #endif
-           , status->td_cmdline);
+           , cmdline);
 }
 
 /****************************************************************************
@@ -674,7 +671,8 @@ static void ps_output(FAR struct nsh_vtbl_s *vtbl, bool heap,
 static int ps_callback(FAR struct nsh_vtbl_s *vtbl, FAR const char *dirpath,
                        FAR struct dirent *entryp, FAR void *pvarg)
 {
-  FAR struct nsh_taskstatus_s status;
+  struct nsh_taskstatus_s status;
+  FAR const char *cmdline;
   bool heap = *(FAR bool *)pvarg;
   int ret;
 
@@ -683,17 +681,13 @@ static int ps_callback(FAR struct nsh_vtbl_s *vtbl, FAR const char *dirpath,
       return OK;
     }
 
-  memset(&status, 0, sizeof(status));
-  status.td_buf = vtbl->iobuffer;
-  status.td_bufsize = IOBUFFERSIZE;
-
-  ret = ps_record(vtbl, dirpath, entryp, heap, &status);
+  ret = ps_record(vtbl, "ps", dirpath, entryp, heap, &status, &cmdline);
   if (ret < 0)
     {
       return ret;
     }
 
-  ps_output(vtbl, heap, &status);
+  ps_output(vtbl, heap, &status, cmdline);
   return ret;
 }
 #endif
@@ -709,7 +703,10 @@ static int top_callback(FAR struct nsh_vtbl_s *vtbl, FAR const char *dirpath,
 {
   FAR struct nsh_topstatus_s *topstatus = pvarg;
   FAR struct nsh_taskstatus_s *status;
-  int index = topstatus->index;
+  FAR const char *cmdline;
+  FAR void *newbuf;
+  size_t newsize;
+  size_t len;
   int ret;
 
   if (ps_skipfile(entryp))
@@ -717,64 +714,52 @@ static int top_callback(FAR struct nsh_vtbl_s *vtbl, FAR const char *dirpath,
       return OK;
     }
 
-  if (topstatus->size == 0)
-    {
-      topstatus->status = zalloc(sizeof(FAR struct nsh_taskstatus_s *) * 4);
-      if (topstatus->status == NULL)
-        {
-          nsh_error(vtbl, g_fmtcmdfailed, "top", "zalloc", NSH_ERRNO);
-          return -ENOMEM;
-        }
+  /* Grow the snapshot if there are more tasks than ever before */
 
-      topstatus->size = 4;
-    }
-  else if (topstatus->index >= topstatus->size)
+  if (topstatus->index >= topstatus->size)
     {
-      topstatus->status =
-        realloc(topstatus->status,
-                sizeof(topstatus->status[0]) * topstatus->size * 2);
-      if (topstatus->status == NULL)
+      newsize = topstatus->size > 0 ? 2 * topstatus->size : 16;
+      newbuf  = realloc(topstatus->status,
+                        newsize * sizeof(struct nsh_taskstatus_s));
+      if (newbuf == NULL)
         {
           nsh_error(vtbl, g_fmtcmdfailed, "top", "realloc", NSH_ERRNO);
           return -ENOMEM;
         }
 
-      memset(&topstatus->status[topstatus->index], 0,
-             sizeof(topstatus->status[0]) * topstatus->size);
-      topstatus->size *= 2;
+      topstatus->status = newbuf;
+      topstatus->size   = newsize;
     }
 
-  if (topstatus->status[index] != NULL)
+  status = &topstatus->status[topstatus->index];
+  ret = ps_record(vtbl, "top", dirpath, entryp, topstatus->heap, status,
+                  &cmdline);
+  if (ret < 0)
     {
-      status = topstatus->status[index];
-      status->td_bufpos = 0;
+      nsh_error(vtbl, g_fmtcmdfailed, "top", "ps_record", NSH_ERRNO);
+      return ret;
     }
-  else
-    {
-      status = zalloc(sizeof(struct nsh_taskstatus_s));
-      if (status == NULL)
-        {
-          nsh_error(vtbl, g_fmtcmdfailed, "top", "zalloc", NSH_ERRNO);
-          return -ENOMEM;
-        }
 
-      topstatus->status[index] = status;
-      status->td_buf = zalloc(IOBUFFERSIZE);
-      if (status->td_buf == NULL)
+  /* Keep the command line, which is still in the I/O buffer */
+
+  len = strlen(cmdline) + 1;
+  if (topstatus->cmdlen + len > topstatus->cmdsize)
+    {
+      newsize = topstatus->cmdsize + MAX(len, IOBUFFERSIZE);
+      newbuf  = realloc(topstatus->cmdlines, newsize);
+      if (newbuf == NULL)
         {
-          nsh_error(vtbl, g_fmtcmdfailed, "top", "zalloc", NSH_ERRNO);
+          nsh_error(vtbl, g_fmtcmdfailed, "top", "realloc", NSH_ERRNO);
           return -ENOMEM;
         }
 
-      status->td_bufsize = IOBUFFERSIZE;
+      topstatus->cmdlines = newbuf;
+      topstatus->cmdsize  = newsize;
     }
 
-  ret = ps_record(vtbl, dirpath, entryp, topstatus->heap, status);
-  if (ret < 0)
-    {
-      nsh_error(vtbl, g_fmtcmdfailed, "top", "ps_record", NSH_ERRNO);
-      return ret;
-    }
+  memcpy(&topstatus->cmdlines[topstatus->cmdlen], cmdline, len);
+  status->td_cmdline  = topstatus->cmdlen;
+  topstatus->cmdlen  += len;
 
   topstatus->index++;
   return ret;
@@ -787,31 +772,16 @@ static int top_callback(FAR struct nsh_vtbl_s *vtbl, FAR const char *dirpath,
 static int top_cmpcpuload(FAR const void *item1, FAR const void *item2)
 {
   FAR const struct nsh_taskstatus_s *status1 =
-    (FAR const struct nsh_taskstatus_s *)(*(FAR uintptr_t *)item1);
+    (FAR const struct nsh_taskstatus_s *)item1;
   FAR const struct nsh_taskstatus_s *status2 =
-    (FAR const struct nsh_taskstatus_s *)(*(FAR uintptr_t *)item2);
-  int load1 = atoi(status1->td_cpuload);
-  int load2 = atoi(status2->td_cpuload);
-  FAR const char *s1;
-  FAR const char *s2;
+    (FAR const struct nsh_taskstatus_s *)item2;
 
-  if (load1 == load2)
-    {
-      s1 = status1->td_cpuload;
-      s2 = status2->td_cpuload;
-      while (*s1++ != '.');
-      while (*s2++ != '.');
-      if (*s2 == *s1)
-        {
-          return 0;
-        }
-
-      return *s2 > *s1 ? 1 : -1;
-    }
-  else
+  if (status1->td_load == status2->td_load)
     {
-      return load2 > load1 ? 1 : -1;
+      return 0;
     }
+
+  return status2->td_load > status1->td_load ? 1 : -1;
 }
 
 /****************************************************************************
@@ -1351,7 +1321,8 @@ int cmd_top(FAR struct nsh_vtbl_s *vtbl, int argc, FAR char **argv)
 
   while (!quit)
     {
-      topstatus.index = 0;
+      topstatus.index  = 0;
+      topstatus.cmdlen = 0;
       nsh_output(vtbl, "\033[2J\033[1;1H");
       ps_title(vtbl, topstatus.heap);
 
@@ -1389,7 +1360,8 @@ int cmd_top(FAR struct nsh_vtbl_s *vtbl, int argc, FAR char **argv)
 
       for (i = 0; i < MIN(topstatus.index, num); i++)
         {
-          ps_output(vtbl, topstatus.heap, topstatus.status[i]);
+          ps_output(vtbl, topstatus.heap, &topstatus.status[i],
+                    &topstatus.cmdlines[topstatus.status[i].td_cmdline]);
         }
 
       if (vtbl->isctty && tc == 0)
@@ -1400,19 +1372,8 @@ int cmd_top(FAR struct nsh_vtbl_s *vtbl, int argc, FAR char **argv)
       sleep(delay);
     }
 
-  if (topstatus.status != NULL)
-    {
-      for (i = 0; i < topstatus.size; i++)
-        {
-          if (topstatus.status[i] != NULL)
-            {
-              free(topstatus.status[i]->td_buf);
-              free(topstatus.status[i]);
-            }
-        }
-
-      free(topstatus.status);
-    }
+  free(topstatus.cmdlines);
+  free(topstatus.status);
 
   if (vtbl->isctty && tc == 0)
     {
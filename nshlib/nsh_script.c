@@ -26,8 +26,16 @@
 
 #include <nuttx/config.h>
 
+#include <sys/stat.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <errno.h>
 #include <fcntl.h>
 #include <sched.h>
+#include <semaphore.h>
 #include <unistd.h>
 
 #include "nsh.h"
@@ -45,10 +53,401 @@
 static bool g_nsh_script_initialized;
 #endif
 
+/* Loaded scripts shared by all sessions, most recently used first */
+
+#if CONFIG_NSH_SCRIPTCACHE_SIZE > 0
+static FAR struct nsh_script_s *g_script_cache;
+static size_t g_script_cachesize;
+
+/* Protects the script cache and the reference counts of all scripts */
+
+static sem_t g_script_sem = SEM_INITIALIZER(1);
+#endif
+
 /****************************************************************************
  * Private Functions
  ****************************************************************************/
 
+#if CONFIG_NSH_SCRIPTCACHE_SIZE > 0
+/****************************************************************************
+ * Name: nsh_script_free
+ ****************************************************************************/
+
+static void nsh_script_free(FAR struct nsh_script_s *script)
+{
+  free(script->sc_text);
+  free(script);
+}
+
+/****************************************************************************
+ * Name: nsh_script_filter
+ *
+ * Description:
+ *   Filter the raw script text in place, keeping only the command lines.
+ *   Blank lines, comment lines and leading white space are removed, tabs
+ *   are replaced with spaces and other control characters (such as the
+ *   '\r' of DOS line endings) are dropped, as readline would have done.
+ *   Every line, including the last, is terminated with '\n'.  The buffer
+ *   must have room for one more byte than 'size'.
+ *
+ * Returned Value:
+ *   The size of the filtered text.
+ *
+ ****************************************************************************/
+
+static size_t nsh_script_filter(FAR char *text, size_t size)
+{
+  FAR const char *src = text;
+  FAR const char *end = text + size;
+  FAR char *dest = text;
+  bool bol = true;
+
+  while (src < end)
+    {
+      char ch = *src++;
+
+      if (ch == '\t')
+        {
+          ch = ' ';
+        }
+
+      if (bol)
+        {
+          /* Skip white space, empty lines and comments at the beginning of
+           * a line.
+           */
+
+          if (ch == ' ' || iscntrl(ch & 0xff))
+            {
+              continue;
+            }
+          else if (ch == '#')
+            {
+              while (src < end && *src != '\n')
+                {
+                  src++;
+                }
+
+              continue;
+            }
+
+          bol = false;
+        }
+
+      if (ch == '\n')
+        {
+          bol = true;
+        }
+      else if (iscntrl(ch & 0xff))
+        {
+          continue;
+        }
+
+      *dest++ = ch;
+    }
+
+  if (!bol)
+    {
+      *dest++ = '\n';
+    }
+
+  return dest - text;
+}
+
+/****************************************************************************
+ * Name: nsh_script_read
+ *
+ * Description:
+ *   Read the whole script file into memory and filter it.  The file is a
+ *   regular file no larger than the script cache.
+ *
+ ****************************************************************************/
+
+static FAR struct nsh_script_s *
+nsh_script_read(int fd, FAR const char *fullpath,
+                FAR const struct stat *buf)
+{
+  FAR struct nsh_script_s *script;
+  FAR char *text;
+  size_t fsize = buf->st_size;
+  size_t size;
+  ssize_t nread;
+
+  script = zalloc(sizeof(struct nsh_script_s) + strlen(fullpath) + 1);
+  if (script == NULL)
+    {
+      return NULL;
+    }
+
+  script->sc_path  = (FAR char *)(script + 1);
+  script->sc_mtime = buf->st_mtime;
+  script->sc_fsize = buf->st_size;
+  strcpy(script->sc_path, fullpath);
+
+  /* Allow one more byte than the size of the file to terminate the last
+   * line.
+   */
+
+  text = malloc(fsize + 1);
+  if (text == NULL)
+    {
+      goto errout;
+    }
+
+  size = 0;
+  while (size < fsize)
+    {
+      nread = read(fd, text + size, fsize - size);
+      if (nread < 0)
+        {
+          if (errno == EINTR)
+            {
+              continue;
+            }
+
+          goto errout;
+        }
+      else if (nread == 0)
+        {
+          break;
+        }
+
+      size += nread;
+    }
+
+  script->sc_text = text;
+  script->sc_size = nsh_script_filter(text, size);
+  return script;
+
+errout:
+  free(text);
+  free(script);
+  return NULL;
+}
+
+/****************************************************************************
+ * Name: nsh_script_load
+ *
+ * Description:
+ *   Get the in-memory copy of the script in the open file 'fd', either
+ *   from the script cache or by reading the file.  The caller must release
+ *   the script with nsh_script_release().  Scripts that are not regular
+ *   files or that are too large to cache are not loaded; *pscript is set to
+ *   NULL and they are read from the file a line at a time.
+ *
+ * Returned Value:
+ *   OK on success or ERROR with errno set on failure.
+ *
+ ****************************************************************************/
+
+static int nsh_script_load(int fd, FAR const char *fullpath,
+                           FAR struct nsh_script_s **pscript)
+{
+  FAR struct nsh_script_s *script;
+  FAR struct nsh_script_s *prev = NULL;
+  struct stat buf;
+
+  *pscript = NULL;
+  if (fstat(fd, &buf) < 0)
+    {
+      return ERROR;
+    }
+
+  while (sem_wait(&g_script_sem) < 0);
+
+  for (script = g_script_cache; script != NULL; script = script->sc_flink)
+    {
+      if (strcmp(script->sc_path, fullpath) == 0)
+        {
+          /* Remove the entry.  It is put back at the head of the list if
+           * it is still valid.
+           */
+
+          if (prev != NULL)
+            {
+              prev->sc_flink = script->sc_flink;
+            }
+          else
+            {
+              g_script_cache = script->sc_flink;
+            }
+
+          if (script->sc_mtime == buf.st_mtime &&
+              script->sc_fsize == buf.st_size)
+            {
+              script->sc_flink = g_script_cache;
+              g_script_cache   = script;
+              script->sc_refs++;
+              sem_post(&g_script_sem);
+              *pscript = script;
+              return OK;
+            }
+
+          /* The file has changed.  Drop the old copy once it is no longer
+           * being run.
+           */
+
+          script->sc_cached   = false;
+          g_script_cachesize -= script->sc_size;
+          if (script->sc_refs == 0)
+            {
+              nsh_script_free(script);
+            }
+
+          break;
+        }
+
+      prev = script;
+    }
+
+  sem_post(&g_script_sem);
+
+  /* Stream the script unless it could be kept in the cache */
+
+  if (!S_ISREG(buf.st_mode) || buf.st_size > CONFIG_NSH_SCRIPTCACHE_SIZE)
+    {
+      return OK;
+    }
+
+  script = nsh_script_read(fd, fullpath, &buf);
+  if (script == NULL)
+    {
+      return ERROR;
+    }
+
+  script->sc_refs = 1;
+  *pscript        = script;
+  return OK;
+}
+
+/****************************************************************************
+ * Name: nsh_script_release
+ *
+ * Description:
+ *   Release a script returned by nsh_script_load().  The script is kept in
+ *   the script cache if it fits, evicting the least recently used scripts
+ *   that are not running.
+ *
+ ****************************************************************************/
+
+static void nsh_script_release(FAR struct nsh_script_s *script)
+{
+  FAR struct nsh_script_s **oldest;
+  FAR struct nsh_script_s **link;
+  FAR struct nsh_script_s *victim;
+
+  while (sem_wait(&g_script_sem) < 0);
+
+  script->sc_refs--;
+
+  if (!script->sc_cached && script->sc_size <= CONFIG_NSH_SCRIPTCACHE_SIZE)
+    {
+      /* Find the oldest idle script.  Do not cache the script if another
+       * session has already cached the same file.
+       */
+
+      for (; ; )
+        {
+          oldest = NULL;
+
+          for (link = &g_script_cache; *link != NULL;
+               link = &(*link)->sc_flink)
+            {
+              if (strcmp((*link)->sc_path, script->sc_path) == 0)
+                {
+                  goto nocache;
+                }
+
+              if ((*link)->sc_refs == 0)
+                {
+                  oldest = link;
+                }
+            }
+
+          /* Stop when the script fits or nothing more can be evicted */
+
+          if (g_script_cachesize + script->sc_size <=
+              CONFIG_NSH_SCRIPTCACHE_SIZE || oldest == NULL)
+            {
+              break;
+            }
+
+          victim              = *oldest;
+          *oldest             = victim->sc_flink;
+          g_script_cachesize -= victim->sc_size;
+          nsh_script_free(victim);
+        }
+
+      if (g_script_cachesize + script->sc_size <=
+          CONFIG_NSH_SCRIPTCACHE_SIZE)
+        {
+          script->sc_flink    = g_script_cache;
+          script->sc_cached   = true;
+          g_script_cache      = script;
+          g_script_cachesize += script->sc_size;
+        }
+    }
+
+nocache:
+  if (!script->sc_cached && script->sc_refs == 0)
+    {
+      nsh_script_free(script);
+    }
+
+  sem_post(&g_script_sem);
+}
+
+#endif /* CONFIG_NSH_SCRIPTCACHE_SIZE > 0 */
+
+/****************************************************************************
+ * Name: nsh_script_getline
+ *
+ * Description:
+ *   Get the next line of the current script into the line buffer.  A
+ *   script in memory is copied from the current offset, since nsh_parse()
+ *   modifies the line; other scripts are read from the file.
+ *
+ * Returned Value:
+ *   The length of the line or EOF at the end of the script.
+ *
+ ****************************************************************************/
+
+static int nsh_script_getline(FAR struct nsh_vtbl_s *vtbl, FAR char *buffer)
+{
+#if CONFIG_NSH_SCRIPTCACHE_SIZE > 0
+  FAR const struct nsh_script_s *script = vtbl->np.np_script;
+  FAR const char *line;
+  FAR const char *eol;
+  size_t len;
+
+  if (script != NULL)
+    {
+      if (vtbl->np.np_spos >= script->sc_size)
+        {
+          return EOF;
+        }
+
+      /* Every line is terminated with '\n' */
+
+      line = &script->sc_text[vtbl->np.np_spos];
+      eol  = memchr(line, '\n', script->sc_size - vtbl->np.np_spos);
+      len  = eol - line + 1;
+      vtbl->np.np_spos += len;
+
+      if (len > LINE_MAX - 1)
+        {
+          len = LINE_MAX - 1;
+        }
+
+      memcpy(buffer, line, len);
+      buffer[len] = '\0';
+      return len;
+    }
+#endif
+
+  return readline_fd(buffer, LINE_MAX, vtbl->np.np_fd, -1);
+}
+
 #if defined(CONFIG_ETC_ROMFS) || defined(CONFIG_NSH_ROMFSRC)
 static int nsh_script_redirect(FAR struct nsh_vtbl_s *vtbl,
                                FAR const char *cmd,
@@ -97,10 +496,16 @@ static int nsh_script_redirect(FAR struct nsh_vtbl_s *vtbl,
 int nsh_script(FAR struct nsh_vtbl_s *vtbl, FAR const FAR char *cmd,
                FAR const char *path, bool log)
 {
+#if CONFIG_NSH_SCRIPTCACHE_SIZE > 0
+  FAR struct nsh_script_s *savescript;
+  FAR struct nsh_script_s *script;
+  size_t savepos;
+#endif
   FAR char *fullpath;
   int savestream;
   FAR char *buffer;
   int ret = ERROR;
+  int fd;
 
   /* The path to the script may relative to the current working directory */
 
@@ -115,14 +520,10 @@ int nsh_script(FAR struct nsh_vtbl_s *vtbl, FAR const FAR char *cmd,
   buffer = nsh_linebuffer(vtbl);
   if (buffer)
     {
-      /* Save the parent stream in case of nested script processing */
-
-      savestream = vtbl->np.np_fd;
-
       /* Open the file containing the script */
 
-      vtbl->np.np_fd = open(fullpath, O_RDOK | O_CLOEXEC);
-      if (vtbl->np.np_fd < 0)
+      fd = open(fullpath, O_RDOK | O_CLOEXEC);
+      if (fd < 0)
         {
           if (log)
             {
@@ -132,38 +533,81 @@ int nsh_script(FAR struct nsh_vtbl_s *vtbl, FAR const FAR char *cmd,
           /* Free the allocated path */
 
           nsh_freefullpath(fullpath);
+          return ERROR;
+        }
+
+#if CONFIG_NSH_SCRIPTCACHE_SIZE > 0
+      /* Get the script, filtered and in memory, if it can be cached.  The
+       * file is not needed after that.
+       */
 
-          /* Restore the parent script stream */
+      if (nsh_script_load(fd, fullpath, &script) < 0)
+        {
+          if (log)
+            {
+              nsh_error(vtbl, g_fmtcmdfailed, cmd, "read", NSH_ERRNO);
+            }
 
-          vtbl->np.np_fd = savestream;
+          close(fd);
+          nsh_freefullpath(fullpath);
           return ERROR;
         }
 
-      /* Loop, processing each command line in the script file (or
-       * until an error occurs)
+      if (script != NULL)
+        {
+          close(fd);
+          fd = -1;
+        }
+
+      /* Save the parent script in case of nested script processing */
+
+      savescript = vtbl->np.np_script;
+      savepos    = vtbl->np.np_spos;
+
+      vtbl->np.np_script = script;
+      vtbl->np.np_spos   = 0;
+#endif
+
+      /* Save the parent stream in case of nested script processing */
+
+      savestream     = vtbl->np.np_fd;
+      vtbl->np.np_fd = fd;
+
+      /* Loop, processing each command line in the script (or until an
+       * error occurs)
        */
 
       do
         {
 #ifndef CONFIG_NSH_DISABLE_LOOPS
-          /* Get the current file position.  This is used to control
-           * looping.  If a loop begins in the next line, then this file
-           * offset will be needed to locate the top of the loop in the
-           * script file.  Note that lseek will return -1 on failure.
+          /* Get the current script position.  This is used to control
+           * looping.  If a loop begins in the next line, then this offset
+           * will be needed to locate the top of the loop in the script.
+           * Note that lseek will return -1 on failure.
            */
 
-          vtbl->np.np_foffs = lseek(vtbl->np.np_fd, 0, SEEK_CUR);
-          vtbl->np.np_loffs = 0;
-
-          if (vtbl->np.np_foffs < 0 && log)
+#if CONFIG_NSH_SCRIPTCACHE_SIZE > 0
+          if (vtbl->np.np_script != NULL)
+            {
+              vtbl->np.np_foffs = vtbl->np.np_spos;
+            }
+          else
+#endif
             {
-              nsh_error(vtbl, g_fmtcmdfailed, "loop", "lseek", NSH_ERRNO);
+              vtbl->np.np_foffs = lseek(vtbl->np.np_fd, 0, SEEK_CUR);
+              if (vtbl->np.np_foffs < 0 && log)
+                {
+                  nsh_error(vtbl, g_fmtcmdfailed, "loop", "lseek",
+                            NSH_ERRNO);
+                }
             }
+
+          vtbl->np.np_loffs = 0;
 #endif
 
-          /* Now read the next line from the script file */
+          /* Now get the next line from the script */
 
-          ret = readline_fd(buffer, LINE_MAX, vtbl->np.np_fd, -1);
+          ret = nsh_script_getline(vtbl, buffer);
           if (ret >= 0)
             {
               /* Parse process the command.  NOTE:  this is recursive...
@@ -188,13 +632,23 @@ int nsh_script(FAR struct nsh_vtbl_s *vtbl, FAR const FAR char *cmd,
         }
       while (ret >= 0);
 
-      /* Close the script file */
+      /* Restore the parent script */
 
-      close(vtbl->np.np_fd);
+      vtbl->np.np_fd = savestream;
+      if (fd >= 0)
+        {
+          close(fd);
+        }
 
-      /* Restore the parent script stream */
+#if CONFIG_NSH_SCRIPTCACHE_SIZE > 0
+      vtbl->np.np_script = savescript;
+      vtbl->np.np_spos   = savepos;
 
-      vtbl->np.np_fd = savestream;
+      if (script != NULL)
+        {
+          nsh_script_release(script);
+        }
+#endif
     }
 
   /* Free the allocated path */
@@ -0,0 +1,604 @@
+/****************************************************************************
+ * apps/nshlib/nsh_walk.c
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.  The
+ * ASF licenses this file to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance with the
+ * License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <sys/types.h>
+#include <sys/param.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <dirent.h>
+#include <limits.h>
+#include <errno.h>
+#include <time.h>
+
+#if CONFIG_NSH_WALK_NWORKERS > 0
+#  include <pthread.h>
+#endif
+
+#include "nsh.h"
+#include "nsh_console.h"
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+/* The work queue holds two files per worker so that a worker finishing
+ * one file always finds the next one waiting.
+ */
+
+#if CONFIG_NSH_WALK_NWORKERS > 0
+#  define WORK_NSLOTS (2 * CONFIG_NSH_WALK_NWORKERS)
+#endif
+
+/****************************************************************************
+ * Private Types
+ ****************************************************************************/
+
+#ifdef NSH_HAVE_WORKPOOL
+#if CONFIG_NSH_WALK_NWORKERS > 0
+/* One queued file */
+
+struct nsh_workslot_s
+{
+  bool hasdest;                 /* True: 'dest' was submitted */
+  char src[PATH_MAX];           /* Path to the file */
+  char dest[PATH_MAX];          /* Second path, such as a copy target */
+};
+#endif
+
+struct nsh_workpool_s
+{
+  FAR struct nsh_vtbl_s *vtbl;
+  FAR const char *cmd;          /* NSH command name for error reporting */
+  nsh_work_t work;              /* The operation to perform on each file */
+  int        result;            /* ERROR once any work has failed */
+  int        errcode;           /* errno value of the first failure */
+#ifdef CONFIG_NSH_WALK_PROGRESS
+  struct timespec report;       /* Time of the last progress report */
+  uint32_t   nsubmitted;        /* Number of files submitted */
+#endif
+
+  /* With no worker threads, the work is done with worker[0] by the caller
+   * of nsh_workpool_submit().
+   */
+
+#if CONFIG_NSH_WALK_NWORKERS > 0
+  pthread_mutex_t lock;         /* Protects everything below */
+  pthread_cond_t  notempty;     /* Signaled when a file is queued */
+  pthread_cond_t  notfull;      /* Signaled when a queue slot is freed */
+  pthread_cond_t  idle;         /* Signaled when all work is complete */
+  uint8_t    head;              /* Index of the next slot to fill */
+  uint8_t    next;              /* Index of the next slot to work on */
+  uint8_t    tail;              /* Index of the oldest slot in use */
+  uint8_t    nqueued;           /* Number of slots in use */
+  uint8_t    nready;            /* Number of slots not yet worked on */
+  uint8_t    nbusy;             /* Number of workers working */
+  uint8_t    nthreads;          /* Number of worker threads running */
+  bool       stop;              /* True: The workers should exit */
+  pthread_t  threads[CONFIG_NSH_WALK_NWORKERS];
+  struct nsh_worker_s   worker[CONFIG_NSH_WALK_NWORKERS];
+  struct nsh_workslot_s slots[WORK_NSLOTS];
+#else
+  struct nsh_worker_s   worker[1];
+#endif
+};
+#endif
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: nsh_workpool_done
+ *
+ * Description:
+ *   Record the result of one piece of work.
+ *
+ ****************************************************************************/
+
+#ifdef NSH_HAVE_WORKPOOL
+static void nsh_workpool_done(FAR struct nsh_workpool_s *pool,
+                              FAR struct nsh_worker_s *worker, int ret)
+{
+  if (ret < 0 && pool->result == OK)
+    {
+      pool->result  = ERROR;
+      pool->errcode = errno;
+    }
+
+  worker->stats.cs_nfiles++;
+}
+#endif
+
+/****************************************************************************
+ * Name: nsh_workpool_result
+ ****************************************************************************/
+
+#ifdef NSH_HAVE_WORKPOOL
+static int nsh_workpool_result(FAR struct nsh_workpool_s *pool)
+{
+  if (pool->result < 0)
+    {
+      set_errno(pool->errcode);
+      return ERROR;
+    }
+
+  return OK;
+}
+#endif
+
+/****************************************************************************
+ * Name: nsh_workpool_progress
+ *
+ * Description:
+ *   Show the number of files and bytes handled so far, at most once per
+ *   second.  The counts of busy workers may be slightly out of date.
+ *
+ ****************************************************************************/
+
+#if defined(NSH_HAVE_WORKPOOL) && defined(CONFIG_NSH_WALK_PROGRESS)
+static void nsh_workpool_progress(FAR struct nsh_workpool_s *pool)
+{
+  FAR struct nsh_vtbl_s *vtbl = pool->vtbl;
+  struct timespec now;
+  uint64_t nbytes = 0;
+  int i;
+
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  if (now.tv_sec == pool->report.tv_sec)
+    {
+      return;
+    }
+
+  pool->report = now;
+
+  for (i = 0; i < nitems(pool->worker); i++)
+    {
+      nbytes += pool->worker[i].stats.cs_nbytes;
+    }
+
+  nsh_output(vtbl, "%s: %" PRIu32 " files, %" PRIu64 " KB\n",
+             pool->cmd, pool->nsubmitted, nbytes / 1024);
+}
+#endif
+
+/****************************************************************************
+ * Name: nsh_workpool_thread
+ *
+ * Description:
+ *   The body of each worker thread.
+ *
+ ****************************************************************************/
+
+#if defined(NSH_HAVE_WORKPOOL) && CONFIG_NSH_WALK_NWORKERS > 0
+static FAR void *nsh_workpool_thread(FAR void *arg)
+{
+  FAR struct nsh_worker_s *worker = (FAR struct nsh_worker_s *)arg;
+  FAR struct nsh_workpool_s *pool = worker->pool;
+  FAR struct nsh_workslot_s *slot;
+  int ret;
+
+  pthread_mutex_lock(&pool->lock);
+
+  for (; ; )
+    {
+      while (pool->nready == 0 && !pool->stop)
+        {
+          pthread_cond_wait(&pool->notempty, &pool->lock);
+        }
+
+      if (pool->nready == 0)
+        {
+          break;
+        }
+
+      /* Take the oldest file.  The slot stays in use until the work is
+       * done because the paths are used in place.
+       */
+
+      slot = &pool->slots[pool->next];
+      pool->next = (pool->next + 1) % WORK_NSLOTS;
+      pool->nready--;
+      pool->nbusy++;
+      pthread_mutex_unlock(&pool->lock);
+
+      /* Skip the remaining work once something has failed */
+
+      ret = OK;
+      if (pool->result == OK)
+        {
+          ret = pool->work(pool->vtbl, worker, slot->src,
+                           slot->hasdest ? slot->dest : NULL);
+        }
+
+      pthread_mutex_lock(&pool->lock);
+      nsh_workpool_done(pool, worker, ret);
+
+      /* Files may finish out of order, so slots are recycled from the
+       * tail only.  Mark this slot as done and release it along with any
+       * done slots after it once no older slot is still in use.
+       */
+
+      slot->src[0] = '\0';
+      while (pool->nqueued > 0 && pool->slots[pool->tail].src[0] == '\0')
+        {
+          pool->tail = (pool->tail + 1) % WORK_NSLOTS;
+          pool->nqueued--;
+        }
+
+      pool->nbusy--;
+      pthread_cond_signal(&pool->notfull);
+
+      if (pool->nqueued == 0 && pool->nbusy == 0)
+        {
+          pthread_cond_broadcast(&pool->idle);
+        }
+    }
+
+  pthread_mutex_unlock(&pool->lock);
+  return NULL;
+}
+#endif
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: nsh_walkdir
+ *
+ * Description:
+ *   Call the provided 'handler' for each entry of the directory at 'path',
+ *   except for '.' and '..'.  The name of each entry is appended to 'path'
+ *   in place, so walking a tree does not allocate a path per entry.
+ *
+ * Input Parameters:
+ *   vtbl     - The console vtable
+ *   cmd      - NSH command name to use in error reporting
+ *   path     - The full path to the directory, in a buffer of PATH_MAX
+ *              bytes.  It is restored before returning.
+ *   handler  - The handler to be called for each entry of the directory
+ *   pvarg    - User provided argument to be passed to the 'handler'
+ *
+ * Returned Value:
+ *   Zero (OK) returned on success; -1 (ERROR) returned on failure.
+ *
+ ****************************************************************************/
+
+#ifdef NSH_HAVE_WALKDIR
+int nsh_walkdir(FAR struct nsh_vtbl_s *vtbl, FAR const char *cmd,
+                FAR char *path, nsh_walk_handler_t handler,
+                FAR void *pvarg)
+{
+  FAR struct dirent *entryp;
+  size_t pathlen;
+  size_t dirlen;
+  size_t namelen;
+  DIR *dirp;
+  int ret = OK;
+
+  dirp = opendir(path);
+  if (dirp == NULL)
+    {
+      nsh_error(vtbl, g_fmtcmdfailed, cmd, "opendir", NSH_ERRNO);
+      return ERROR;
+    }
+
+  /* Remove any trailing '/' so that entries are appended as "/<name>" */
+
+  pathlen = strlen(path);
+  dirlen  = pathlen;
+  while (dirlen > 0 && path[dirlen - 1] == '/')
+    {
+      dirlen--;
+    }
+
+  while ((entryp = readdir(dirp)) != NULL)
+    {
+      if (strcmp(entryp->d_name, ".") == 0 ||
+          strcmp(entryp->d_name, "..") == 0)
+        {
+          continue;
+        }
+
+      namelen = strlen(entryp->d_name);
+      if (dirlen + 1 + namelen >= PATH_MAX)
+        {
+          nsh_error(vtbl, g_fmtcmdfailed, cmd, "readdir",
+                    NSH_ERRNO_OF(ENAMETOOLONG));
+          ret = ERROR;
+          break;
+        }
+
+      path[dirlen] = '/';
+      memcpy(&path[dirlen + 1], entryp->d_name, namelen + 1);
+
+      ret = handler(vtbl, path, dirlen, entryp, pvarg);
+      if (ret < 0)
+        {
+          ret = ERROR;
+          break;
+        }
+    }
+
+  /* Restore the directory path, including any trailing '/' */
+
+  memset(&path[dirlen], '/', pathlen - dirlen);
+  path[pathlen] = '\0';
+
+  closedir(dirp);
+  return ret;
+}
+#endif
+
+/****************************************************************************
+ * Name: nsh_workpool_create
+ *
+ * Description:
+ *   Create a pool of CONFIG_NSH_WALK_NWORKERS threads that apply 'work' to
+ *   the files submitted with nsh_workpool_submit().  With no worker
+ *   threads, or if they cannot be started, the work is done by the caller
+ *   of nsh_workpool_submit().
+ *
+ ****************************************************************************/
+
+#ifdef NSH_HAVE_WORKPOOL
+FAR struct nsh_workpool_s *nsh_workpool_create(FAR struct nsh_vtbl_s *vtbl,
+                                               FAR const char *cmd,
+                                               nsh_work_t work,
+                                               bool copybuf)
+{
+  FAR struct nsh_workpool_s *pool;
+  int i;
+
+  pool = zalloc(sizeof(struct nsh_workpool_s));
+  if (pool == NULL)
+    {
+      nsh_error(vtbl, g_fmtcmdoutofmemory, cmd);
+      return NULL;
+    }
+
+  pool->vtbl = vtbl;
+  pool->cmd  = cmd;
+  pool->work = work;
+
+#ifdef CONFIG_NSH_WALK_PROGRESS
+  clock_gettime(CLOCK_MONOTONIC, &pool->report);
+#endif
+
+  /* Each worker needs its own copy buffer since the session I/O buffer
+   * cannot be shared between threads.  Without worker threads, the copy
+   * may fall back to the I/O buffer.
+   */
+
+  for (i = 0; i < nitems(pool->worker); i++)
+    {
+      pool->worker[i].pool = pool;
+      if (copybuf)
+        {
+          pool->worker[i].buffer = malloc(CONFIG_NSH_COPY_BUFSIZE);
+          pool->worker[i].buflen = CONFIG_NSH_COPY_BUFSIZE;
+
+#if CONFIG_NSH_WALK_NWORKERS > 0
+          if (pool->worker[i].buffer == NULL)
+            {
+              while (--i >= 0)
+                {
+                  free(pool->worker[i].buffer);
+                }
+
+              free(pool);
+              nsh_error(vtbl, g_fmtcmdoutofmemory, cmd);
+              return NULL;
+            }
+#endif
+        }
+    }
+
+#if CONFIG_NSH_WALK_NWORKERS > 0
+  pthread_mutex_init(&pool->lock, NULL);
+  pthread_cond_init(&pool->notempty, NULL);
+  pthread_cond_init(&pool->notfull, NULL);
+  pthread_cond_init(&pool->idle, NULL);
+
+  for (i = 0; i < CONFIG_NSH_WALK_NWORKERS; i++)
+    {
+      if (pthread_create(&pool->threads[i], NULL, nsh_workpool_thread,
+                         &pool->worker[i]) != 0)
+        {
+          break;
+        }
+
+      pool->nthreads++;
+    }
+#endif
+
+  return pool;
+}
+#endif
+
+/****************************************************************************
+ * Name: nsh_workpool_submit
+ *
+ * Description:
+ *   Queue one file for the workers, waiting for a free queue slot if
+ *   necessary.  The paths are copied.
+ *
+ ****************************************************************************/
+
+#ifdef NSH_HAVE_WORKPOOL
+int nsh_workpool_submit(FAR struct nsh_workpool_s *pool,
+                        FAR const char *src, FAR const char *dest)
+{
+#if CONFIG_NSH_WALK_NWORKERS > 0
+  FAR struct nsh_workslot_s *slot;
+#endif
+  int ret;
+
+#ifdef CONFIG_NSH_WALK_PROGRESS
+  pool->nsubmitted++;
+  nsh_workpool_progress(pool);
+#endif
+
+#if CONFIG_NSH_WALK_NWORKERS > 0
+  if (pool->nthreads > 0)
+    {
+      pthread_mutex_lock(&pool->lock);
+
+      while (pool->nqueued >= WORK_NSLOTS && pool->result == OK)
+        {
+          pthread_cond_wait(&pool->notfull, &pool->lock);
+        }
+
+      if (pool->result == OK)
+        {
+          slot = &pool->slots[pool->head];
+          strlcpy(slot->src, src, PATH_MAX);
+          slot->hasdest = (dest != NULL);
+          if (dest != NULL)
+            {
+              strlcpy(slot->dest, dest, PATH_MAX);
+            }
+
+          pool->head = (pool->head + 1) % WORK_NSLOTS;
+          pool->nqueued++;
+          pool->nready++;
+          pthread_cond_signal(&pool->notempty);
+        }
+
+      ret = nsh_workpool_result(pool);
+      pthread_mutex_unlock(&pool->lock);
+      return ret;
+    }
+#endif
+
+  /* No worker threads.  Do the work now. */
+
+  ret = pool->work(pool->vtbl, &pool->worker[0], src, dest);
+  nsh_workpool_done(pool, &pool->worker[0], ret);
+  return nsh_workpool_result(pool);
+}
+#endif
+
+/****************************************************************************
+ * Name: nsh_workpool_drain
+ *
+ * Description:
+ *   Wait until all submitted work has completed.
+ *
+ ****************************************************************************/
+
+#ifdef NSH_HAVE_WORKPOOL
+int nsh_workpool_drain(FAR struct nsh_workpool_s *pool)
+{
+  int ret;
+
+#if CONFIG_NSH_WALK_NWORKERS > 0
+  pthread_mutex_lock(&pool->lock);
+
+  while (pool->nqueued > 0 || pool->nbusy > 0)
+    {
+      pthread_cond_wait(&pool->idle, &pool->lock);
+    }
+
+  ret = nsh_workpool_result(pool);
+  pthread_mutex_unlock(&pool->lock);
+#else
+  ret = nsh_workpool_result(pool);
+#endif
+
+  return ret;
+}
+#endif
+
+/****************************************************************************
+ * Name: nsh_workpool_destroy
+ *
+ * Description:
+ *   Wait for all submitted work, stop the workers and free the pool.  The
+ *   statistics of all workers are added to 'stats'.
+ *
+ ****************************************************************************/
+
+#ifdef NSH_HAVE_WORKPOOL
+int nsh_workpool_destroy(FAR struct nsh_workpool_s *pool,
+                         FAR struct nsh_copystats_s *stats)
+{
+  int errcode;
+  int ret;
+  int i;
+
+  ret = nsh_workpool_drain(pool);
+
+#if CONFIG_NSH_WALK_NWORKERS > 0
+  pthread_mutex_lock(&pool->lock);
+  pool->stop = true;
+  pthread_cond_broadcast(&pool->notempty);
+  pthread_mutex_unlock(&pool->lock);
+
+  for (i = 0; i < pool->nthreads; i++)
+    {
+      pthread_join(pool->threads[i], NULL);
+    }
+
+  pthread_cond_destroy(&pool->idle);
+  pthread_cond_destroy(&pool->notfull);
+  pthread_cond_destroy(&pool->notempty);
+  pthread_mutex_destroy(&pool->lock);
+#endif
+
+  for (i = 0; i < nitems(pool->worker); i++)
+    {
+      FAR struct nsh_worker_s *worker = &pool->worker[i];
+
+      if (stats != NULL)
+        {
+          stats->cs_nbytes  += worker->stats.cs_nbytes;
+          stats->cs_nreads  += worker->stats.cs_nreads;
+          stats->cs_nwrites += worker->stats.cs_nwrites;
+          stats->cs_nfiles  += worker->stats.cs_nfiles;
+        }
+
+      free(worker->buffer);
+    }
+
+  /* nsh_workpool_drain() set errno on failure but free() may change it */
+
+  errcode = pool->errcode;
+  free(pool);
+
+  if (ret < 0)
+    {
+      set_errno(errcode);
+    }
+
+  return ret;
+}
+#endif
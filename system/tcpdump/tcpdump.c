@@ -28,18 +28,26 @@
 
 #include <errno.h>
 #include <fcntl.h>
+#include <inttypes.h>
 #include <net/if.h>
 #include <net/if_arp.h>
 #include <netpacket/packet.h>
+#include <pthread.h>
 #include <stdint.h>
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 #include <sys/ioctl.h>
+#include <sys/param.h>
 #include <sys/types.h>
+#include <sys/uio.h>
+#include <time.h>
 #include <unistd.h>
 
 #include <nuttx/net/netconfig.h>
 
 #include "argtable3.h"
+#include "tcpdump_filter.h"
 
 /****************************************************************************
  * Pre-processor Definitions
@@ -52,10 +60,25 @@
 
 #define DEFAULT_SNAPLEN 262144
 
-/* https://www.tcpdump.org/linktypes.html */
+#ifndef CONFIG_SYSTEM_TCPDUMP_RINGSIZE
+#  define CONFIG_SYSTEM_TCPDUMP_RINGSIZE 65536
+#endif
 
-#define LINKTYPE_ETHERNET 1   /* IEEE 802.3 Ethernet */
-#define LINKTYPE_RAW      101 /* Raw IP */
+#ifndef CONFIG_SYSTEM_TCPDUMP_BATCHSIZE
+#  define CONFIG_SYSTEM_TCPDUMP_BATCHSIZE 4096
+#endif
+
+#ifndef CONFIG_SYSTEM_TCPDUMP_FLUSH_MSEC
+#  define CONFIG_SYSTEM_TCPDUMP_FLUSH_MSEC 1000
+#endif
+
+#ifndef CONFIG_SYSTEM_TCPDUMP_WRITER_STACKSIZE
+#  define CONFIG_SYSTEM_TCPDUMP_WRITER_STACKSIZE 2048
+#endif
+
+/* Ring space reserved for reading one packet */
+
+#define RECORD_MAXLEN (sizeof(struct pcap_pkthdr_s) + MAX_NETDEV_PKTSIZE)
 
 /****************************************************************************
  * Private Types
@@ -85,15 +108,48 @@ struct tcpdump_args_s
   FAR struct arg_str *interface;
   FAR struct arg_str *file;
   FAR struct arg_int *snaplen;
+  FAR struct arg_int *bufsize;
+  FAR struct arg_str *expr;
   FAR struct arg_end *end;
 };
 
+/* Capture ring.  The reader reads each packet straight into the ring
+ * behind room for its pcap record header, and the writer thread writes
+ * the records to the file in batches.  When the reader does not find room
+ * for a packet at the end of the buffer, it continues at the start and
+ * the data ends at "wrap".
+ */
+
+struct tcpdump_ring_s
+{
+  pthread_mutex_t lock;
+  pthread_cond_t cond;      /* Wakes up the writer */
+  FAR uint8_t *buf;
+  size_t size;
+  size_t head;              /* Where the reader stores the next record */
+  size_t tail;              /* Next byte for the writer */
+  size_t wrap;              /* End of the data before head, if wrapped */
+  size_t used;              /* Bytes waiting for the writer */
+  bool wrapped;             /* head has wrapped to the start */
+  bool exiting;             /* The reader has stopped */
+  int result;               /* The first write error */
+};
+
 struct tcpdump_cfgs_s
 {
   int fd;
   int sd;
   uint32_t snaplen;
   uint32_t linktype;
+  struct tcpdump_filter_s filter;
+  struct tcpdump_ring_s ring;
+
+  /* Packet counters */
+
+  uint32_t received;        /* Read from the socket */
+  uint32_t captured;        /* Stored in the ring */
+  uint32_t filtered;        /* Rejected by the filter */
+  uint32_t dropped;         /* Accepted, but the ring was full */
 };
 
 /****************************************************************************
@@ -148,37 +204,214 @@ static int write_filehdr(int fd, uint32_t snaplen, uint32_t linktype)
 }
 
 /****************************************************************************
- * Name: write_packet
+ * Name: write_iov
  ****************************************************************************/
 
-static int write_packet(int fd, uint32_t snaplen, uint32_t pkt_len,
-                        FAR const void *buf, FAR const struct timespec *ts)
+static int write_iov(int fd, FAR struct iovec *iov, int iovcnt)
 {
-  struct pcap_pkthdr_s hdr =
+  ssize_t nwritten;
+
+  while (iovcnt > 0)
     {
-      ts->tv_sec,            /* ts_sec */
-      ts->tv_nsec,           /* ts_nsec */
-      MIN(snaplen, pkt_len), /* caplen */
-      pkt_len                /* len */
-    };
+      nwritten = writev(fd, iov, iovcnt);
+      if (nwritten < 0)
+        {
+          if (errno == EINTR)
+            {
+              continue;
+            }
 
-  /* Write hdr into file. */
+          perror("ERROR: writev() failed");
+          return -errno;
+        }
 
-  if (write(fd, &hdr, sizeof(hdr)) < 0)
+      /* Skip what has been written */
+
+      while (iovcnt > 0 && (size_t)nwritten >= iov->iov_len)
+        {
+          nwritten -= iov->iov_len;
+          iov++;
+          iovcnt--;
+        }
+
+      if (iovcnt > 0)
+        {
+          iov->iov_base = (FAR uint8_t *)iov->iov_base + nwritten;
+          iov->iov_len -= nwritten;
+        }
+    }
+
+  return OK;
+}
+
+/****************************************************************************
+ * Name: ring_reserve
+ *
+ * Description:
+ *   Find room for the largest record at the head of the ring.  Returns
+ *   -ENOSPC if the ring is too full, or the error of the writer.
+ *
+ ****************************************************************************/
+
+static int ring_reserve(FAR struct tcpdump_ring_s *ring,
+                        FAR uint8_t **rec)
+{
+  int ret;
+
+  pthread_mutex_lock(&ring->lock);
+  ret = ring->result;
+  if (ret == OK)
     {
-      perror("ERROR: write() failed");
-      return -errno;
+      if (ring->used == 0)
+        {
+          ring->head    = 0;
+          ring->tail    = 0;
+          ring->wrapped = false;
+        }
+
+      if (ring->wrapped)
+        {
+          if (ring->tail - ring->head < RECORD_MAXLEN)
+            {
+              ret = -ENOSPC;
+            }
+        }
+      else if (ring->size - ring->head < RECORD_MAXLEN)
+        {
+          if (ring->tail < RECORD_MAXLEN)
+            {
+              ret = -ENOSPC;
+            }
+          else
+            {
+              ring->wrap    = ring->head;
+              ring->head    = 0;
+              ring->wrapped = true;
+            }
+        }
     }
 
-  /* Write pkt into file. */
+  *rec = ring->buf + ring->head;
+  pthread_mutex_unlock(&ring->lock);
+  return ret;
+}
+
+/****************************************************************************
+ * Name: ring_commit
+ ****************************************************************************/
 
-  if (write(fd, buf, hdr.caplen) < 0)
+static void ring_commit(FAR struct tcpdump_ring_s *ring, size_t len)
+{
+  pthread_mutex_lock(&ring->lock);
+  ring->head += len;
+  ring->used += len;
+  if (ring->used >= CONFIG_SYSTEM_TCPDUMP_BATCHSIZE)
     {
-      perror("ERROR: write() failed");
-      return -errno;
+      pthread_cond_signal(&ring->cond);
     }
 
-  return OK;
+  pthread_mutex_unlock(&ring->lock);
+}
+
+/****************************************************************************
+ * Name: ring_writer
+ *
+ * Description:
+ *   Write the records in the ring to the file.  Writes are whole multiples
+ *   of CONFIG_SYSTEM_TCPDUMP_BATCHSIZE ending at a file offset aligned to
+ *   it, unless nothing has filled a batch for
+ *   CONFIG_SYSTEM_TCPDUMP_FLUSH_MSEC or the capture is ending.
+ *
+ ****************************************************************************/
+
+static FAR void *ring_writer(FAR void *arg)
+{
+  FAR struct tcpdump_cfgs_s *cfgs = arg;
+  FAR struct tcpdump_ring_s *ring = &cfgs->ring;
+  size_t offset = sizeof(struct pcap_filehdr_s);
+  struct timespec abstime;
+  struct iovec iov[2];
+  size_t first;
+  size_t n;
+  bool flush;
+  int iovcnt;
+  int ret;
+
+  pthread_mutex_lock(&ring->lock);
+  for (; ; )
+    {
+      flush = false;
+      while (ring->used < CONFIG_SYSTEM_TCPDUMP_BATCHSIZE &&
+             !ring->exiting && !flush)
+        {
+          clock_gettime(CLOCK_REALTIME, &abstime);
+          abstime.tv_sec  += CONFIG_SYSTEM_TCPDUMP_FLUSH_MSEC / 1000;
+          abstime.tv_nsec += (CONFIG_SYSTEM_TCPDUMP_FLUSH_MSEC % 1000) *
+                             1000000;
+          if (abstime.tv_nsec >= 1000000000)
+            {
+              abstime.tv_sec++;
+              abstime.tv_nsec -= 1000000000;
+            }
+
+          flush = pthread_cond_timedwait(&ring->cond, &ring->lock,
+                                         &abstime) == ETIMEDOUT;
+        }
+
+      if (ring->used == 0)
+        {
+          if (ring->exiting)
+            {
+              break;
+            }
+
+          continue;
+        }
+
+      n = ring->used;
+      if (!flush && !ring->exiting)
+        {
+          n = (offset + n) / CONFIG_SYSTEM_TCPDUMP_BATCHSIZE *
+              CONFIG_SYSTEM_TCPDUMP_BATCHSIZE - offset;
+        }
+
+      /* The data may be in two pieces */
+
+      first = (ring->wrapped ? ring->wrap : ring->head) - ring->tail;
+      first = MIN(first, n);
+
+      iov[0].iov_base = ring->buf + ring->tail;
+      iov[0].iov_len  = first;
+      iov[1].iov_base = ring->buf;
+      iov[1].iov_len  = n - first;
+      iovcnt          = n > first ? 2 : 1;
+
+      pthread_mutex_unlock(&ring->lock);
+      ret = write_iov(cfgs->fd, iov, iovcnt);
+      pthread_mutex_lock(&ring->lock);
+
+      if (ret < 0)
+        {
+          ring->result = ret;
+          break;
+        }
+
+      if (ring->wrapped && n >= ring->wrap - ring->tail)
+        {
+          ring->tail    = n - (ring->wrap - ring->tail);
+          ring->wrapped = false;
+        }
+      else
+        {
+          ring->tail += n;
+        }
+
+      ring->used -= n;
+      offset     += n;
+    }
+
+  pthread_mutex_unlock(&ring->lock);
+  return NULL;
 }
 
 /****************************************************************************
@@ -239,11 +472,17 @@ static uint32_t get_linktype(FAR const char *ifname)
  * Name: do_capture
  ****************************************************************************/
 
-static void do_capture(FAR const struct tcpdump_cfgs_s *cfgs)
+static void do_capture(FAR struct tcpdump_cfgs_s *cfgs)
 {
-  ssize_t len;
-  uint8_t buf[MAX_NETDEV_PKTSIZE];
+  FAR struct tcpdump_ring_s *ring = &cfgs->ring;
+  uint8_t hdrbuf[FILTER_HDRLEN];
+  struct pcap_pkthdr_s hdr;
+  pthread_attr_t attr;
+  pthread_t writer;
   struct timespec ts;
+  FAR uint8_t *rec;
+  ssize_t len = 0;
+  int ret;
 
   /* Write file header */
 
@@ -252,31 +491,109 @@ static void do_capture(FAR const struct tcpdump_cfgs_s *cfgs)
       return;
     }
 
+  pthread_attr_init(&attr);
+  pthread_attr_setstacksize(&attr, CONFIG_SYSTEM_TCPDUMP_WRITER_STACKSIZE);
+  ret = pthread_create(&writer, &attr, ring_writer, cfgs);
+  pthread_attr_destroy(&attr);
+  if (ret != 0)
+    {
+      errno = ret;
+      perror("ERROR: pthread_create() failed");
+      return;
+    }
+
   /* Dump packets */
 
-  while ((len = read(cfgs->sd, buf, sizeof(buf))) >= 0 && !g_exiting)
+  while (!g_exiting)
     {
-      if (len == 0)
+      ret = ring_reserve(ring, &rec);
+      if (ret == -ENOSPC)
         {
+          /* Read just enough of the packet to know whether it was wanted */
+
+          len = read(cfgs->sd, hdrbuf, sizeof(hdrbuf));
+          if (len < 0)
+            {
+              break;
+            }
+
+          if (len > 0)
+            {
+              cfgs->received++;
+              if (filter_match(&cfgs->filter, cfgs->linktype, hdrbuf, len))
+                {
+                  cfgs->dropped++;
+                }
+              else
+                {
+                  cfgs->filtered++;
+                }
+            }
+
           continue;
         }
+      else if (ret < 0)
+        {
+          /* The writer failed */
 
-      if (clock_gettime(CLOCK_REALTIME, &ts) < 0)
+          break;
+        }
+
+      /* Read the packet into the ring, behind room for the record header */
+
+      len = read(cfgs->sd, rec + sizeof(hdr), MAX_NETDEV_PKTSIZE);
+      if (len < 0)
         {
-          perror("ERROR: clock_gettime() failed");
-          return;
+          break;
+        }
+      else if (len == 0)
+        {
+          continue;
+        }
+
+      cfgs->received++;
+      if (!filter_match(&cfgs->filter, cfgs->linktype,
+                        rec + sizeof(hdr), len))
+        {
+          cfgs->filtered++;
+          continue;
         }
 
-      if (write_packet(cfgs->fd, cfgs->snaplen, len, buf, &ts) < 0)
+      if (clock_gettime(CLOCK_REALTIME, &ts) < 0)
         {
-          return;
+          perror("ERROR: clock_gettime() failed");
+          break;
         }
+
+      /* Only the snapshot length is kept in the ring */
+
+      hdr.ts_sec  = ts.tv_sec;
+      hdr.ts_nsec = ts.tv_nsec;
+      hdr.caplen  = MIN(cfgs->snaplen, (uint32_t)len);
+      hdr.len     = len;
+      memcpy(rec, &hdr, sizeof(hdr));
+
+      ring_commit(ring, sizeof(hdr) + hdr.caplen);
+      cfgs->captured++;
     }
 
-  if (!g_exiting)
+  if (len < 0 && !g_exiting)
     {
       perror("ERROR: read() failed");
     }
+
+  /* Let the writer drain the ring */
+
+  pthread_mutex_lock(&ring->lock);
+  ring->exiting = true;
+  pthread_cond_signal(&ring->cond);
+  pthread_mutex_unlock(&ring->lock);
+  pthread_join(writer, NULL);
+
+  printf("%" PRIu32 " packets captured\n", cfgs->captured);
+  printf("%" PRIu32 " packets received\n", cfgs->received);
+  printf("%" PRIu32 " packets rejected by filter\n", cfgs->filtered);
+  printf("%" PRIu32 " packets dropped by buffer\n", cfgs->dropped);
 }
 
 /****************************************************************************
@@ -297,6 +614,10 @@ int main(int argc, FAR char *argv[])
   args.file      = arg_str1("w", NULL, "file", "Path to dump file");
   args.snaplen   = arg_int0("s", "snapshot-length", "snaplen",
                             "Max dump length of each packet");
+  args.bufsize   = arg_int0("B", "buffer-size", "KiB",
+                            "Capture ring size");
+  args.expr      = arg_strn(NULL, NULL, "expression", 0, FILTER_MAXINSN,
+                            "Filter expression");
   args.end       = arg_end(3);
 
   nerrors = arg_parse(argc, argv, (FAR void**)&args);
@@ -308,6 +629,12 @@ int main(int argc, FAR char *argv[])
       goto out;
     }
 
+  memset(&cfgs, 0, sizeof(cfgs));
+  if (filter_compile(&cfgs.filter, args.expr->count, args.expr->sval) < 0)
+    {
+      goto out;
+    }
+
   ifindex = if_nametoindex(args.interface->sval[0]);
   if (ifindex == 0)
     {
@@ -329,7 +656,7 @@ int main(int argc, FAR char *argv[])
       goto out;
     }
 
-  if (args.snaplen->count > 0)
+  if (args.snaplen->count > 0 && *args.snaplen->ival > 0)
     {
       cfgs.snaplen = *args.snaplen->ival;
     }
@@ -338,14 +665,45 @@ int main(int argc, FAR char *argv[])
       cfgs.snaplen = DEFAULT_SNAPLEN;
     }
 
+  /* The writer must be able to fill a batch while the reader still has
+   * room for a packet.
+   */
+
+  if (args.bufsize->count > 0)
+    {
+      cfgs.ring.size = (size_t)*args.bufsize->ival * 1024;
+    }
+  else
+    {
+      cfgs.ring.size = CONFIG_SYSTEM_TCPDUMP_RINGSIZE;
+    }
+
+  cfgs.ring.size = MAX(cfgs.ring.size, 2 * RECORD_MAXLEN +
+                                      CONFIG_SYSTEM_TCPDUMP_BATCHSIZE);
+  cfgs.ring.buf  = malloc(cfgs.ring.size);
+  if (cfgs.ring.buf == NULL)
+    {
+      printf("Failed to allocate a %zu byte capture ring\n",
+             cfgs.ring.size);
+      goto out_with_sd;
+    }
+
+  pthread_mutex_init(&cfgs.ring.lock, NULL);
+  pthread_cond_init(&cfgs.ring.cond, NULL);
+
   cfgs.linktype = get_linktype(args.interface->sval[0]);
 
   do_capture(&cfgs);
 
+  pthread_cond_destroy(&cfgs.ring.cond);
+  pthread_mutex_destroy(&cfgs.ring.lock);
+  free(cfgs.ring.buf);
+
+out_with_sd:
   close(cfgs.sd);
   close(cfgs.fd);
 
 out:
-  arg_freetable((FAR void **)&args, 1);
+  arg_freetable((FAR void **)&args, sizeof(args) / sizeof(FAR void *));
   return 0;
 }
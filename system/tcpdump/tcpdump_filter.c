@@ -0,0 +1,601 @@
+/****************************************************************************
+ * apps/system/tcpdump/tcpdump_filter.c
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.  The
+ * ASF licenses this file to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance with the
+ * License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <sys/param.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "tcpdump_filter.h"
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+/* Filter instructions */
+
+#define FILTER_OP_PROTO   0  /* Match protocol "value" */
+#define FILTER_OP_HOST4   1  /* Match IPv4 address "addr" */
+#define FILTER_OP_HOST6   2  /* Match IPv6 address "addr" */
+#define FILTER_OP_PORT    3  /* Match TCP or UDP port "value" */
+#define FILTER_OP_AND     4
+#define FILTER_OP_OR      5
+#define FILTER_OP_NOT     6
+
+/* Directions of host and port */
+
+#define FILTER_DIR_SRC    1
+#define FILTER_DIR_DST    2
+#define FILTER_DIR_ANY    (FILTER_DIR_SRC | FILTER_DIR_DST)
+
+/* Protocols */
+
+#define FILTER_PROTO_ARP   0
+#define FILTER_PROTO_IP    1
+#define FILTER_PROTO_IP6   2
+#define FILTER_PROTO_TCP   3
+#define FILTER_PROTO_UDP   4
+#define FILTER_PROTO_ICMP  5
+#define FILTER_PROTO_ICMP6 6
+
+#define ETHTYPE_IP        0x0800
+#define ETHTYPE_ARP       0x0806
+#define ETHTYPE_VLAN      0x8100
+#define ETHTYPE_IP6       0x86dd
+
+#define FILTER_GET16(p)   (((uint16_t)(p)[0] << 8) | (p)[1])
+
+/****************************************************************************
+ * Private Types
+ ****************************************************************************/
+
+/* Parser state.  The expression is read one token at a time from the
+ * words of the command line.
+ */
+
+struct filter_parser_s
+{
+  FAR struct tcpdump_filter_s *filter;
+  FAR const char **argv;
+  int argc;
+  int argi;                 /* Word holding the next token */
+  FAR const char *pos;      /* Position of the next token in the word */
+  char tok[48];             /* Current token, empty at the end */
+};
+
+/* The fields of a packet the filter looks at */
+
+struct filter_pkt_s
+{
+  FAR const uint8_t *src;   /* Source address, NULL if not IP */
+  FAR const uint8_t *dst;   /* Destination address */
+  uint16_t ethtype;         /* Network layer protocol */
+  uint16_t sport;           /* TCP or UDP source port */
+  uint16_t dport;           /* TCP or UDP destination port */
+  uint8_t proto;            /* IP protocol */
+  bool ports;               /* sport and dport are valid */
+};
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+static FAR const char *g_protos[] =
+{
+  "arp", "ip", "ip6", "tcp", "udp", "icmp", "icmp6"
+};
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: filter_next
+ *
+ * Description:
+ *   Read the next token into p->tok.  Tokens are separated by white space
+ *   within a word as well as by word boundaries, so a quoted expression
+ *   works too.  Parentheses and '!' are tokens of their own even when
+ *   attached to a word.
+ *
+ ****************************************************************************/
+
+static void filter_next(FAR struct filter_parser_s *p)
+{
+  FAR const char *start;
+  size_t len;
+
+  while (p->pos != NULL)
+    {
+      p->pos += strspn(p->pos, " \t");
+      if (*p->pos != '\0')
+        {
+          break;
+        }
+
+      p->pos = ++p->argi < p->argc ? p->argv[p->argi] : NULL;
+    }
+
+  if (p->pos == NULL)
+    {
+      p->tok[0] = '\0';
+      return;
+    }
+
+  if (strchr("()!", *p->pos) != NULL)
+    {
+      len = 1;
+    }
+  else
+    {
+      len = strcspn(p->pos, "() \t");
+    }
+
+  start   = p->pos;
+  p->pos += len;
+
+  if (len >= sizeof(p->tok))
+    {
+      len = sizeof(p->tok) - 1;
+    }
+
+  memcpy(p->tok, start, len);
+  p->tok[len] = '\0';
+}
+
+/****************************************************************************
+ * Name: filter_emit
+ ****************************************************************************/
+
+static FAR struct filter_insn_s *filter_emit(FAR struct filter_parser_s *p,
+                                             uint8_t op)
+{
+  FAR struct filter_insn_s *insn;
+
+  if (p->filter->ninsn >= FILTER_MAXINSN)
+    {
+      fprintf(stderr, "ERROR: filter expression too long\n");
+      return NULL;
+    }
+
+  insn = &p->filter->insn[p->filter->ninsn++];
+  memset(insn, 0, sizeof(*insn));
+  insn->op = op;
+  return insn;
+}
+
+/****************************************************************************
+ * Name: filter_primitive
+ ****************************************************************************/
+
+static int filter_primitive(FAR struct filter_parser_s *p)
+{
+  FAR struct filter_insn_s *insn;
+  uint8_t dir = FILTER_DIR_ANY;
+  FAR char *end;
+  long port;
+  int i;
+
+  if (strcmp(p->tok, "src") == 0 || strcmp(p->tok, "dst") == 0)
+    {
+      dir = p->tok[0] == 's' ? FILTER_DIR_SRC : FILTER_DIR_DST;
+      filter_next(p);
+    }
+
+  if (strcmp(p->tok, "host") == 0)
+    {
+      filter_next(p);
+      insn = filter_emit(p, FILTER_OP_HOST4);
+      if (insn == NULL)
+        {
+          return -EINVAL;
+        }
+
+      if (inet_pton(AF_INET6, p->tok, insn->addr) == 1)
+        {
+          insn->op = FILTER_OP_HOST6;
+        }
+      else if (inet_pton(AF_INET, p->tok, insn->addr) != 1)
+        {
+          fprintf(stderr, "ERROR: bad host address '%s'\n", p->tok);
+          return -EINVAL;
+        }
+
+      insn->dir = dir;
+      filter_next(p);
+      return OK;
+    }
+
+  if (strcmp(p->tok, "port") == 0)
+    {
+      filter_next(p);
+      port = strtol(p->tok, &end, 10);
+      if (end == p->tok || *end != '\0' || port < 0 || port > 65535)
+        {
+          fprintf(stderr, "ERROR: bad port '%s'\n", p->tok);
+          return -EINVAL;
+        }
+
+      insn = filter_emit(p, FILTER_OP_PORT);
+      if (insn == NULL)
+        {
+          return -EINVAL;
+        }
+
+      insn->dir   = dir;
+      insn->value = port;
+      filter_next(p);
+      return OK;
+    }
+
+  if (dir == FILTER_DIR_ANY)
+    {
+      for (i = 0; i < nitems(g_protos); i++)
+        {
+          if (strcmp(p->tok, g_protos[i]) == 0)
+            {
+              insn = filter_emit(p, FILTER_OP_PROTO);
+              if (insn == NULL)
+                {
+                  return -EINVAL;
+                }
+
+              insn->value = i;
+              filter_next(p);
+              return OK;
+            }
+        }
+    }
+
+  fprintf(stderr, "ERROR: syntax error in filter at '%s'\n", p->tok);
+  return -EINVAL;
+}
+
+/****************************************************************************
+ * Name: filter_expr
+ *
+ * Description:
+ *   expr   := term { ("or" | "||") term }
+ *   term   := factor { ["and" | "&&"] factor }
+ *   factor := ("not" | "!") factor | "(" expr ")" | primitive
+ *
+ ****************************************************************************/
+
+static int filter_expr(FAR struct filter_parser_s *p);
+
+static int filter_factor(FAR struct filter_parser_s *p)
+{
+  int ret;
+
+  if (strcmp(p->tok, "not") == 0 || strcmp(p->tok, "!") == 0)
+    {
+      filter_next(p);
+      ret = filter_factor(p);
+      if (ret < 0 || filter_emit(p, FILTER_OP_NOT) == NULL)
+        {
+          return -EINVAL;
+        }
+
+      return OK;
+    }
+
+  if (strcmp(p->tok, "(") == 0)
+    {
+      filter_next(p);
+      ret = filter_expr(p);
+      if (ret < 0)
+        {
+          return ret;
+        }
+
+      if (strcmp(p->tok, ")") != 0)
+        {
+          fprintf(stderr, "ERROR: missing ')' in filter\n");
+          return -EINVAL;
+        }
+
+      filter_next(p);
+      return OK;
+    }
+
+  return filter_primitive(p);
+}
+
+static int filter_term(FAR struct filter_parser_s *p)
+{
+  int ret;
+
+  ret = filter_factor(p);
+  while (ret == OK && p->tok[0] != '\0' && strcmp(p->tok, ")") != 0 &&
+         strcmp(p->tok, "or") != 0 && strcmp(p->tok, "||") != 0)
+    {
+      if (strcmp(p->tok, "and") == 0 || strcmp(p->tok, "&&") == 0)
+        {
+          filter_next(p);
+        }
+
+      ret = filter_factor(p);
+      if (ret == OK && filter_emit(p, FILTER_OP_AND) == NULL)
+        {
+          ret = -EINVAL;
+        }
+    }
+
+  return ret;
+}
+
+static int filter_expr(FAR struct filter_parser_s *p)
+{
+  int ret;
+
+  ret = filter_term(p);
+  while (ret == OK &&
+         (strcmp(p->tok, "or") == 0 || strcmp(p->tok, "||") == 0))
+    {
+      filter_next(p);
+      ret = filter_term(p);
+      if (ret == OK && filter_emit(p, FILTER_OP_OR) == NULL)
+        {
+          ret = -EINVAL;
+        }
+    }
+
+  return ret;
+}
+
+/****************************************************************************
+ * Name: filter_decode
+ ****************************************************************************/
+
+static void filter_decode(FAR struct filter_pkt_s *pkt, uint32_t linktype,
+                          FAR const uint8_t *buf, size_t len)
+{
+  size_t off = 0;
+  size_t l4;
+
+  memset(pkt, 0, sizeof(*pkt));
+
+  if (linktype == LINKTYPE_ETHERNET)
+    {
+      if (len < 14)
+        {
+          return;
+        }
+
+      pkt->ethtype = FILTER_GET16(buf + 12);
+      off = 14;
+      if (pkt->ethtype == ETHTYPE_VLAN && len >= 18)
+        {
+          pkt->ethtype = FILTER_GET16(buf + 16);
+          off = 18;
+        }
+    }
+  else if (len > 0)
+    {
+      pkt->ethtype = (buf[0] >> 4) == 6 ? ETHTYPE_IP6 : ETHTYPE_IP;
+    }
+
+  if (pkt->ethtype == ETHTYPE_IP && len >= off + 20)
+    {
+      pkt->proto = buf[off + 9];
+      pkt->src   = buf + off + 12;
+      pkt->dst   = buf + off + 16;
+      l4         = off + (buf[off] & 0x0f) * 4;
+
+      /* Only the first fragment has the ports */
+
+      if ((FILTER_GET16(buf + off + 6) & 0x1fff) != 0)
+        {
+          return;
+        }
+    }
+  else if (pkt->ethtype == ETHTYPE_IP6 && len >= off + 40)
+    {
+      pkt->proto = buf[off + 6];
+      pkt->src   = buf + off + 8;
+      pkt->dst   = buf + off + 24;
+      l4         = off + 40;
+    }
+  else
+    {
+      return;
+    }
+
+  if ((pkt->proto == IPPROTO_TCP || pkt->proto == IPPROTO_UDP) &&
+      len >= l4 + 4)
+    {
+      pkt->sport = FILTER_GET16(buf + l4);
+      pkt->dport = FILTER_GET16(buf + l4 + 2);
+      pkt->ports = true;
+    }
+}
+
+/****************************************************************************
+ * Name: filter_proto
+ ****************************************************************************/
+
+static bool filter_proto(FAR const struct filter_pkt_s *pkt, uint16_t proto)
+{
+  switch (proto)
+    {
+      case FILTER_PROTO_ARP:
+        return pkt->ethtype == ETHTYPE_ARP;
+
+      case FILTER_PROTO_IP:
+        return pkt->ethtype == ETHTYPE_IP;
+
+      case FILTER_PROTO_IP6:
+        return pkt->ethtype == ETHTYPE_IP6;
+
+      case FILTER_PROTO_TCP:
+        return pkt->src != NULL && pkt->proto == IPPROTO_TCP;
+
+      case FILTER_PROTO_UDP:
+        return pkt->src != NULL && pkt->proto == IPPROTO_UDP;
+
+      case FILTER_PROTO_ICMP:
+        return pkt->ethtype == ETHTYPE_IP && pkt->src != NULL &&
+               pkt->proto == IPPROTO_ICMP;
+
+      case FILTER_PROTO_ICMP6:
+        return pkt->ethtype == ETHTYPE_IP6 && pkt->src != NULL &&
+               pkt->proto == IPPROTO_ICMP6;
+
+      default:
+        return false;
+    }
+}
+
+/****************************************************************************
+ * Name: filter_test
+ ****************************************************************************/
+
+static bool filter_test(FAR const struct filter_pkt_s *pkt,
+                        FAR const struct filter_insn_s *insn)
+{
+  size_t alen;
+
+  switch (insn->op)
+    {
+      case FILTER_OP_PROTO:
+        return filter_proto(pkt, insn->value);
+
+      case FILTER_OP_HOST4:
+      case FILTER_OP_HOST6:
+        if (pkt->src == NULL ||
+            pkt->ethtype != (insn->op == FILTER_OP_HOST4 ?
+                             ETHTYPE_IP : ETHTYPE_IP6))
+          {
+            return false;
+          }
+
+        alen = insn->op == FILTER_OP_HOST4 ? 4 : 16;
+        return ((insn->dir & FILTER_DIR_SRC) != 0 &&
+                memcmp(pkt->src, insn->addr, alen) == 0) ||
+               ((insn->dir & FILTER_DIR_DST) != 0 &&
+                memcmp(pkt->dst, insn->addr, alen) == 0);
+
+      case FILTER_OP_PORT:
+        return pkt->ports &&
+               (((insn->dir & FILTER_DIR_SRC) != 0 &&
+                 pkt->sport == insn->value) ||
+                ((insn->dir & FILTER_DIR_DST) != 0 &&
+                 pkt->dport == insn->value));
+
+      default:
+        return false;
+    }
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: filter_compile
+ ****************************************************************************/
+
+int filter_compile(FAR struct tcpdump_filter_s *filter, int argc,
+                   FAR const char **argv)
+{
+  struct filter_parser_s p;
+  int ret;
+
+  filter->ninsn = 0;
+  if (argc == 0)
+    {
+      return OK;
+    }
+
+  memset(&p, 0, sizeof(p));
+  p.filter = filter;
+  p.argv   = argv;
+  p.argc   = argc;
+  p.pos    = argv[0];
+  filter_next(&p);
+
+  ret = filter_expr(&p);
+  if (ret == OK && p.tok[0] != '\0')
+    {
+      fprintf(stderr, "ERROR: syntax error in filter at '%s'\n", p.tok);
+      ret = -EINVAL;
+    }
+
+  return ret;
+}
+
+/****************************************************************************
+ * Name: filter_match
+ ****************************************************************************/
+
+bool filter_match(FAR const struct tcpdump_filter_s *filter,
+                  uint32_t linktype, FAR const uint8_t *pkt, size_t len)
+{
+  bool stack[FILTER_MAXINSN];
+  struct filter_pkt_s info;
+  int sp = 0;
+  int i;
+
+  if (filter->ninsn == 0)
+    {
+      return true;
+    }
+
+  filter_decode(&info, linktype, pkt, len);
+
+  for (i = 0; i < filter->ninsn; i++)
+    {
+      FAR const struct filter_insn_s *insn = &filter->insn[i];
+
+      switch (insn->op)
+        {
+          case FILTER_OP_AND:
+            sp--;
+            stack[sp - 1] = stack[sp - 1] && stack[sp];
+            break;
+
+          case FILTER_OP_OR:
+            sp--;
+            stack[sp - 1] = stack[sp - 1] || stack[sp];
+            break;
+
+          case FILTER_OP_NOT:
+            stack[sp - 1] = !stack[sp - 1];
+            break;
+
+          default:
+            stack[sp++] = filter_test(&info, insn);
+            break;
+        }
+    }
+
+  return stack[0];
+}
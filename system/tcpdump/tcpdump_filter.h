@@ -0,0 +1,101 @@
+/****************************************************************************
+ * apps/system/tcpdump/tcpdump_filter.h
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.  The
+ * ASF licenses this file to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance with the
+ * License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ *
+ ****************************************************************************/
+
+#ifndef __APPS_SYSTEM_TCPDUMP_TCPDUMP_FILTER_H
+#define __APPS_SYSTEM_TCPDUMP_TCPDUMP_FILTER_H
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+/* https://www.tcpdump.org/linktypes.html */
+
+#define LINKTYPE_ETHERNET 1   /* IEEE 802.3 Ethernet */
+#define LINKTYPE_RAW      101 /* Raw IP */
+
+#define FILTER_MAXINSN    32  /* Instructions in a compiled filter */
+
+/* The headers a filter looks at fit in this many bytes: Ethernet with a
+ * VLAN tag (18), an IPv4 header with the maximum of options (60) and the
+ * ports (4).  An IPv6 header and the ports take less.
+ */
+
+#define FILTER_HDRLEN     (18 + 60 + 4)
+
+/****************************************************************************
+ * Public Types
+ ****************************************************************************/
+
+/* One instruction of a filter.  The program is in postfix order: the
+ * tests push their result, and the logical operators combine the top of
+ * the stack.
+ */
+
+struct filter_insn_s
+{
+  uint8_t op;        /* FILTER_OP_xxx */
+  uint8_t dir;       /* FILTER_DIR_xxx, for host and port */
+  uint16_t value;    /* FILTER_PROTO_xxx or port number */
+  uint8_t addr[16];  /* Address for host */
+};
+
+struct tcpdump_filter_s
+{
+  struct filter_insn_s insn[FILTER_MAXINSN];
+  int ninsn;         /* Zero matches every packet */
+};
+
+/****************************************************************************
+ * Public Function Prototypes
+ ****************************************************************************/
+
+/* Compile the filter expression made of the words in argv, using a subset
+ * of the pcap-filter syntax:
+ *
+ *   arp, ip, ip6, tcp, udp, icmp, icmp6
+ *   [src|dst] host <IPv4 or IPv6 address>
+ *   [src|dst] port <number>
+ *   not, !, and, &&, or, ||, ( )
+ *
+ * Adjacent primitives are and'ed.  Returns OK, or -EINVAL with a message
+ * printed for a bad expression.
+ */
+
+int filter_compile(FAR struct tcpdump_filter_s *filter, int argc,
+                   FAR const char **argv);
+
+/* Run a compiled filter on the first len bytes of a packet */
+
+bool filter_match(FAR const struct tcpdump_filter_s *filter,
+                  uint32_t linktype, FAR const uint8_t *pkt, size_t len);
+
+#endif /* __APPS_SYSTEM_TCPDUMP_TCPDUMP_FILTER_H */
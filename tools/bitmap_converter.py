@@ -80,13 +80,21 @@ def encode_row(img, palette, y):
   return entries
 
 def write_image(outfile, img, palette):
-  '''Write the image contents to the output file.'''
+  '''Write the image contents to the output file.  Returns the index of
+  the first RLE entry and its pixel count for each row.
+  '''
 
   outfile.write('static const NXWidgets::SRlePaletteBitmapEntry bitmap[] =\n')
   outfile.write('{\n')
 
+  rowstarts = []
+  offset = 0
+
   for y in range(0, img.size[1]):
     entries = encode_row(img, palette, y)
+    rowstarts.append((offset, entries[0][0]))
+    offset += len(entries)
+
     row = ""
     for r, c in entries:
       if len(row) > 60:
@@ -99,9 +107,26 @@ def write_image(outfile, img, palette):
     outfile.write('  ' + row + '/* Row %d */\n' % y)
 
   outfile.write('};\n\n')
+  return rowstarts
+
 
+def write_rowindex(outfile, rowstarts, interval):
+  '''Write the row index used by CRlePaletteBitmap to seek to a row without
+  decoding all of the rows above it.  Runs never span rows so each indexed
+  row starts at the beginning of an RLE entry.
+  '''
+
+  outfile.write('static const NXWidgets::SRlePaletteRowIndex rowindex[] =\n')
+  outfile.write('{\n')
 
-def write_descriptor(outfile, name):
+  for y in range(0, len(rowstarts), interval):
+    offset, remaining = rowstarts[y]
+    outfile.write('  {%6d, %3d},  /* Row %d */\n' % (offset, remaining, y))
+
+  outfile.write('};\n\n')
+
+
+def write_descriptor(outfile, name, interval):
   '''Write the public descriptor structure for the image.'''
 
   outfile.write('extern const struct NXWidgets::SRlePaletteBitmap g_%s =\n' % name)
@@ -112,17 +137,32 @@ def write_descriptor(outfile, name):
   outfile.write('  BITMAP_WIDTH,\n')
   outfile.write('  BITMAP_HEIGHT,\n')
   outfile.write('  {palette, hilight_palette},\n')
-  outfile.write('  bitmap\n')
+  if interval > 0:
+    outfile.write('  bitmap,\n')
+    outfile.write('  rowindex,\n')
+    outfile.write('  %d\n' % interval)
+  else:
+    outfile.write('  bitmap\n')
+
   outfile.write('};\n')
 
 if __name__ == '__main__':
   import sys
   import os.path
 
-  if len(sys.argv) != 3:
-    print "Usage: bitmap_converter.py source.png output.cxx"
+  if len(sys.argv) not in (3, 4):
+    print "Usage: bitmap_converter.py source.png output.cxx [rowinterval]"
+    print "  rowinterval: Emit a row index entry every rowinterval rows"
+    print "               (1-255).  Default: no row index"
     sys.exit(1)
 
+  interval = 0
+  if len(sys.argv) == 4:
+    interval = int(sys.argv[3])
+    if interval < 0 or interval > 255:
+      print "rowinterval must be in the range 0-255"
+      sys.exit(1)
+
   img = Image.open(sys.argv[1]).convert("RGB")
   outfile = open(sys.argv[2], 'w')
   palette = get_palette(img)
@@ -146,5 +186,7 @@ if __name__ == '__main__':
   name = os.path.splitext(os.path.basename(sys.argv[1]))[0]
 
   write_palette(outfile, palette)
-  write_image(outfile, img, palette)
-  write_descriptor(outfile, name)
+  rowstarts = write_image(outfile, img, palette)
+  if interval > 0:
+    write_rowindex(outfile, rowstarts, interval)
+  write_descriptor(outfile, name, interval)